@@ -128,6 +128,10 @@ constexpr uint8_t kVppOnWEVcRegisterBit = 4;
 constexpr float kVppInitial = 12.0f;
 /** @brief VDD/GEN : VDD Initial value, in Volts. */
 constexpr float kVddInitial = 5.0f;
+/** @brief VPP/GEN : VPP Maximum value (range of the feedback), in Volts. */
+constexpr float kVppMaximum = kVppAdcVRef * kVppDivider;
+/** @brief VDD/GEN : VDD Maximum value (range of the feedback), in Volts. */
+constexpr float kVddMaximum = kVddAdcVRef * kVddDivider;
 
 // ---------------------------------------------------------------------------
 
@@ -166,6 +170,14 @@ constexpr uint kBusAddrRckPin = 1;
 
 /** @brief COMM : Communication timeout, in milliseconds. */
 constexpr uint32_t kCommTimeOut = 50;
+/** @brief COMM : Stream (Write Range) timeout, in milliseconds. */
+constexpr uint32_t kCommStreamTimeOut = 500;
+/** @brief COMM : Size of the receive ring (Write Range), in bytes. */
+constexpr uint32_t kCommRingSize = 4096;
+/** @brief COMM : Maximum payload of a frame (Frame opcode), in bytes. */
+constexpr uint16_t kCommFrameMaxSize = 4352;
+/** @brief COMM : Maximum length of the buffer opcodes, in bytes. */
+constexpr uint16_t kCommMaxBufferSize = 4096;
 
 // ---------------------------------------------------------------------------
 
@@ -565,6 +565,24 @@ bool Device::blankCheck(size_t count) {
     return success;
 }
 
+bool Device::blankCheckRange(size_t count, size_t& dirty, size_t& first) {
+    // BlankCheck Range
+    dirty = 0;
+    first = count;
+    // check data at current address (all the range)
+    // and increment address
+    for (size_t i = 0; i < count; i++) {
+        // Verify
+        if (!blankCheck_()) {
+            if (!dirty) first = i;
+            dirty++;
+        }
+        // increment address
+        if (!addrInc()) return false;
+    }
+    return true;
+}
+
 bool Device::getId(uint32_t& id) {
     // GetID
 
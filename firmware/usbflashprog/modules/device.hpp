@@ -323,6 +323,18 @@ class Device {
      * @return True if success, false otherwise.
      */
     bool blankCheck(size_t count = 64);
+    /**
+     * @brief Device Blank Check of a range, counting the non-blank cells.
+     * @details Checks all bytes/words of a range (count bytes/words) at
+     *   current address (it does not stop at the first non-blank one), and
+     *   increment the address.
+     * @param count Number of bytes/words to check.
+     * @param dirty[out] Number of non-blank bytes/words.
+     * @param first[out] Offset (from the current address) of the first
+     *   non-blank byte/word. Equals to count if the range is blank.
+     * @return True if success, false otherwise.
+     */
+    bool blankCheckRange(size_t count, size_t& dirty, size_t& first);
     /**
      * @brief Device Get ID.
      * @param id[out] Manufacturer ID (MSB); Device ID (LSB).
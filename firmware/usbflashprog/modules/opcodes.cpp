@@ -16,21 +16,37 @@
 // ---------------------------------------------------------------------------
 
 #include <cmath>
+#include <cstring>
 #include "modules/opcodes.hpp"
 
 // ---------------------------------------------------------------------------
 
-TCmdOpCode &TCmdOpCode::operator=(const TCmdOpCode &src) {
-    this->code = src.code;
-    this->descr = src.descr;
-    this->params = src.params;
-    this->result = src.result;
-    return *this;
-}
+/* @brief Number of opcodes in the table. */
+constexpr size_t kCmdOpCodeCount = sizeof(kCmdOpCodes) / sizeof(kCmdOpCodes[0]);
+
+static_assert(kCmdOpCodeCount < 0xFF, "too many opcodes for the index");
+
+/* @brief Index of the opcodes table, by code (built at compile time). */
+typedef struct TCmdOpCodeIndex {
+    /* @brief Position of each code in the table (0xFF if unknown). */
+    uint8_t pos[256];
+    /* @brief Constructor. */
+    constexpr TCmdOpCodeIndex() : pos() {
+        for (auto &item : pos) item = 0xFF;
+        for (size_t i = 0; i < kCmdOpCodeCount; i++) {
+            pos[kCmdOpCodes[i].code] = i;
+        }
+    }
+} TCmdOpCodeIndex;
+
+/* @brief Index of the opcodes table (in flash). */
+static constexpr TCmdOpCodeIndex kCmdOpCodeIndex;
+
+// ---------------------------------------------------------------------------
 
 bool operator==(const TCmdOpCode &a, const TCmdOpCode &b) {
-    return (a.code == b.code && a.descr == b.descr && a.params == b.params &&
-            a.result == b.result);
+    return (a.code == b.code && !strcmp(a.descr, b.descr) &&
+            a.params == b.params && a.result == b.result);
 }
 
 // ---------------------------------------------------------------------------
@@ -45,18 +61,23 @@ bool OpCode::isOk(const void *buf, size_t size) {
 
 TCmdOpCode OpCode::getOpCode(const void *buf, size_t size) {
     if (!buf || !size) {
-        return kCmdOpCodes.at(kCmdNop);
+        return kCmdOpCodes[0];
     }
     const uint8_t *pbuf = static_cast<const uint8_t *>(buf);
     return getOpCode(pbuf[0]);
 }
 
 TCmdOpCode OpCode::getOpCode(uint8_t code) {
-    auto it = kCmdOpCodes.find(static_cast<kCmdOpCodeEnum>(code));
-    if (it == kCmdOpCodes.end()) {
-        return kCmdOpCodes.at(kCmdNop);
+    const TCmdOpCode *opcode = findOpCode(code);
+    if (!opcode) {
+        return kCmdOpCodes[0];
     }
-    return it->second;
+    return *opcode;
+}
+
+const TCmdOpCode *OpCode::findOpCode(uint8_t code) {
+    uint8_t pos = kCmdOpCodeIndex.pos[code];
+    return (pos == 0xFF) ? nullptr : &kCmdOpCodes[pos];
 }
 
 float OpCode::getValueAsFloat(const void *buf, size_t size) {
@@ -20,8 +20,8 @@
 
 // ---------------------------------------------------------------------------
 
-#include <string>
-#include <map>
+#include <cstddef>
+#include <cstdint>
 
 // ---------------------------------------------------------------------------
 
@@ -45,6 +45,14 @@ enum kCmdResponseValueEnum {
 
 // ---------------------------------------------------------------------------
 
+/** @brief Size of the data chunks of the stream opcodes, in bytes. */
+constexpr uint16_t kCmdStreamChunkSize = 256;
+
+/** @brief Version of the communication protocol (see kCmdProtoCaps). */
+constexpr uint8_t kCmdProtoVersion = 1;
+
+// ---------------------------------------------------------------------------
+
 /** @brief Enumeration of the OpCodes. */
 enum kCmdOpCodeEnum {
     /** @brief OPCODE / NOP : Opcode NOP. */
@@ -334,7 +342,263 @@ enum kCmdOpCodeEnum {
     /** @brief OPCODE / DEVICE : Opcode Device Unprotect. */
     kCmdDeviceUnprotect = 0x8C,
     /** @brief OPCODE / DEVICE : Opcode Device Protect. */
-    kCmdDeviceProtect = 0x8D
+    kCmdDeviceProtect = 0x8D,
+    /**
+     * @brief OPCODE / DEVICE : Opcode Device Read Range (stream).
+     * @details The first parameter (three bytes) represents the start
+     *   address. The second parameter (three bytes) represents the size
+     *   of the range, in bytes. MSB first.<br/>
+     *   The response is OK (or NOK), followed by the data stream, in
+     *   chunks of kCmdStreamChunkSize bytes (the last may be smaller).
+     *   Each chunk starts with OK and ends with its CRC-16 (two bytes,
+     *   MSB first). If an error occurs, a NOK is sent instead of the next
+     *   chunk, and the stream ends.<br/>
+     *   Any byte received from the host during the stream cancels it
+     *   (a NOK is sent instead of the next chunk). If the size is zero,
+     *   only the OK is sent.<br/>
+     *   If the RLE encoding was selected (see kCmdProtoEncoding), each
+     *   chunk is sent as OK, the length of the encoded data (two bytes),
+     *   the encoded data and the CRC-16 of the decoded data.
+     * <pre>
+     * +---------------------------------------------------+
+     * |Sequence                         | Description     |
+     * | Host     : 8E aa aa aa ss ss ss | Read Range      |
+     * | Firmware : A1                   | Accepted        |
+     * | Firmware : A1 [data] cc cc      | Chunk (repeats) |
+     * | Firmware : A1 ll ll [rle] cc cc | Chunk (RLE)     |
+     * | Firmware : A0                   | Error/canceled  |
+     * +---------------------------------------------------+
+     * </pre>
+     * @see kCmdStreamChunkSize
+     */
+    kCmdDeviceReadRange = 0x8E,
+    /**
+     * @brief OPCODE / DEVICE : Opcode Device Write Range (stream).
+     * @details The first parameter (three bytes) represents the start
+     *   address. The second parameter (three bytes) represents the size
+     *   of the range, in bytes (multiple of the block size). The third
+     *   parameter (two bytes) represents the block size, in bytes (up to
+     *   kCmdStreamChunkSize). The fourth parameter (one byte) is nonzero
+     *   to write the blocks as sectors. MSB first.<br/>
+     *   The response is OK (or NOK), followed by the number of credits
+     *   (one byte, zero if NOK): the number of blocks that the host can
+     *   send ahead of the acknowledgments. Each block is followed by its CRC-16
+     *   (two bytes, MSB first). The firmware receives the blocks into a
+     *   ring buffer while programming, and acknowledges each programmed
+     *   block with OK (returning one credit).<br/>
+     *   If an error occurs (including a CRC error), a NOK is sent and the
+     *   stream ends. The firmware then discards the bytes the host is
+     *   allowed to send (credits not returned yet), and the host must
+     *   complete them. A block with an invalid CRC cancels the stream.
+     *   If the size is zero, only the OK and the credits are sent.<br/>
+     *   If the RLE encoding was selected (see kCmdProtoEncoding), each
+     *   block is sent as the length of the encoded data (two bytes), the
+     *   encoded data and the CRC-16 of the decoded data. The credits are
+     *   then granted for the worst case (incompressible) blocks.
+     * <pre>
+     * +-------------------------------------------------------------+
+     * |Sequence                                   | Description     |
+     * | Host     : 8F aa aa aa ss ss ss bb bb ff  | Write Range     |
+     * | Firmware : A1 nn                          | Accepted        |
+     * | Host     : [data] cc cc                   | Block (repeats) |
+     * | Host     : ll ll [rle] cc cc              | Block (RLE)     |
+     * | Firmware : A1                             | Ack (repeats)   |
+     * | Firmware : A0                             | Error/canceled  |
+     * +-------------------------------------------------------------+
+     * </pre>
+     * @see kCmdStreamChunkSize
+     */
+    kCmdDeviceWriteRange = 0x8F,
+    /**
+     * @brief OPCODE / DEVICE : Opcode Device Read Byte/Word buffer
+     *   and Increment Address (wide length).
+     * @details The parameter (two bytes) represents the buffer size,
+     *   in bytes.<br/>
+     *   The return is [size] bytes. MSB first.
+     */
+    kCmdDeviceReadW = 0x90,
+    /**
+     * @brief OPCODE / DEVICE : Opcode Device Write Byte/Word buffer,
+     *   verify and Increment Address (wide length).
+     * @details The first parameter (two bytes) represents the buffer size,
+     *   in bytes.<br/>
+     *   The second parameter ([size] bytes) is the data to write. MSB first.
+     */
+    kCmdDeviceWriteW = 0x91,
+    /**
+     * @brief OPCODE / DEVICE : Opcode Device Verify Byte/Word buffer
+     *   and Increment Address (wide length).
+     * @details The first parameter (two bytes) represents the buffer size,
+     *   in bytes.<br/>
+     *   The second parameter ([size] bytes) is the data to verify. MSB first.
+     */
+    kCmdDeviceVerifyW = 0x92,
+    /**
+     * @brief OPCODE / DEVICE : Opcode Device Check if Byte/Word buffer is Blank
+     *   and Increment Address (wide length).
+     * @details The parameter (two bytes) represents the buffer size,
+     *   in bytes.
+     */
+    kCmdDeviceBlankCheckW = 0x93,
+    /**
+     * @brief OPCODE / DEVICE : Opcode Device CRC32 of Range.
+     * @details The first parameter (three bytes) represents the start
+     *   address. The second parameter (three bytes) represents the size
+     *   of the range, in bytes. MSB first.<br/>
+     *   The firmware reads the range and the return is its CRC-32 (four
+     *   bytes, MSB first), the same of Checksum::crc32() over the data
+     *   read. On error, the response is NOK followed by four zero bytes.
+     * <pre>
+     * +---------------------------------------------------+
+     * |Sequence                         | Description     |
+     * | Host     : 94 aa aa aa ss ss ss | CRC32 Range     |
+     * | Firmware : A1 cc cc cc cc       | CRC-32          |
+     * +---------------------------------------------------+
+     * </pre>
+     */
+    kCmdDeviceCrc32Range = 0x94,
+    /**
+     * @brief OPCODE / DEVICE : Opcode Device Blank Check of Range.
+     * @details The first parameter (three bytes) represents the start
+     *   address. The second parameter (three bytes) represents the size
+     *   of the range, in bytes. MSB first.<br/>
+     *   The firmware checks all the range (it does not stop at the first
+     *   non-blank byte/word). The return is the address of the first
+     *   non-blank byte/word (four bytes) and the number of non-blank
+     *   bytes/words (four bytes), MSB first. The range is blank if the
+     *   number is zero. On error, the response is NOK followed by eight
+     *   zero bytes.
+     * <pre>
+     * +-------------------------------------------------------------+
+     * |Sequence                                 | Description       |
+     * | Host     : 95 aa aa aa ss ss ss         | Blank Check Range |
+     * | Firmware : A1 ff ff ff ff nn nn nn nn   | First / Count     |
+     * +-------------------------------------------------------------+
+     * </pre>
+     */
+    kCmdDeviceBlankCheckRange = 0x95,
+    /**
+     * @brief OPCODE / DEVICE : Opcode Device Setup.
+     * @details Sets up a whole device session in one command. It is the
+     *   same of Device Configure, Set tWP, Set tWC, VDD Set, VPP Set and
+     *   Device Setup Bus, in this order. The parameters are:
+     * <pre>
+     * +-------------------------------------------+
+     * |Byte | Size | Description                  |
+     * |  0  |  1   | Algorithm                    |
+     * |  1  |  1   | Flags (see Device Configure) |
+     * |  2  |  2   | VDD voltage (see VDD Set)    |
+     * |  4  |  2   | VPP voltage (see VPP Set)    |
+     * |  6  |  4   | tWP, in microseconds         |
+     * | 10  |  4   | tWC, in microseconds         |
+     * | 14  |  1   | Operation (see Setup Bus)    |
+     * | 15  |  1   | Values to keep (see Keep)    |
+     * +-------------------------------------------+
+     * </pre>
+     *   The voltages and times flagged in the keep mask are ignored (the
+     *   current values are kept). The algorithm, the operation and the
+     *   voltages (not negative) are validated before any parameter
+     *   is applied: if invalid, the response is NOK and nothing is
+     *   changed. If the bus setup fails, the response is NOK, and the
+     *   other settings are kept applied. The support of this opcode is
+     *   reported by kCmdProtoCaps (kCmdProtoFeatureDeviceSetup).
+     * <pre>
+     * +-----------------------------------------------+
+     * |Sequence                     | Description     |
+     * | Host     : 96 aa ff vv.. kk | Device Setup    |
+     * | Firmware : A1               | Setup OK        |
+     * +-----------------------------------------------+
+     * </pre>
+     * @see kCmdDeviceAlgorithmEnum
+     * @see kCmdDeviceOperationEnum
+     * @see kCmdDeviceSetupKeepEnum
+     */
+    kCmdDeviceSetup = 0x96,
+
+    /**
+     * @brief OPCODE / PROTOCOL : Opcode Tag.
+     * @details The parameter (one byte) is a sequence tag, that is echoed
+     *   back before the response of the next command. It allows the host
+     *   to keep several commands in flight (pipelining) and to match each
+     *   response with its command.<br/>
+     *   If a tagged command fails, all the following tagged commands are
+     *   discarded (NOK) until an untagged command is received.
+     * <pre>
+     * +-----------------------------------------------+
+     * |Sequence               | Description           |
+     * | Host     : F0 tt op.. | Tagged command        |
+     * | Firmware : tt A1 ..   | Tag and OK response   |
+     * | Firmware : tt A0      | Tag and NOK response  |
+     * +-----------------------------------------------+
+     * </pre>
+     */
+    kCmdProtoTag = 0xF0,
+    /**
+     * @brief OPCODE / PROTOCOL : Opcode Encoding.
+     * @details The parameter (one byte) selects the encoding of the data
+     *   stream of the next command (Read Range or Write Range). It is
+     *   valid only for the next command, that is sent with the default
+     *   (raw) encoding otherwise.<br/>
+     *   The response is OK if the firmware supports the encoding, or
+     *   NOK (and the raw encoding is kept) if not.
+     * <pre>
+     * +-----------------------------------------------+
+     * |Sequence               | Description           |
+     * | Host     : F1 ee      | Encoding              |
+     * | Firmware : A1         | Encoding selected     |
+     * | Host     : op..       | Stream command        |
+     * +-----------------------------------------------+
+     * </pre>
+     * @see kCmdProtoEncodingEnum
+     */
+    kCmdProtoEncoding = 0xF1,
+    /**
+     * @brief OPCODE / PROTOCOL : Opcode Frame.
+     * @details Carries one command (opcode, params and data) in a frame
+     *   with a sequence number, a length and a CRC-16, so that a
+     *   corrupted or lost frame is detected and retransmitted.<br/>
+     *   The first parameter (one byte) is the sequence number. The second
+     *   parameter (two bytes) is the length of the payload (the command).
+     *   The payload and the CRC-16 (two bytes, MSB first) follow. The CRC
+     *   is the Checksum::crc16() of the sequence, length and payload, with
+     *   initial value zero.<br/>
+     *   The response is a frame with the same sequence number, the length
+     *   and the response of the command as payload, and the CRC-16. An
+     *   empty payload means that the frame was rejected (bad CRC or
+     *   length), and must be retransmitted.<br/>
+     *   A retransmitted frame (same sequence number of the last executed
+     *   frame) is not executed again: the firmware resends the last
+     *   response. The sequence number zero synchronizes (no command is
+     *   executed), so an all-zero frame is a probe, that is also a
+     *   sequence of NOPs for an old firmware.<br/>
+     *   Stream and protocol opcodes can not be framed (NOK).
+     * <pre>
+     * +---------------------------------------------------------+
+     * |Sequence                           | Description         |
+     * | Host     : F2 ss ll ll op.. cc cc | Framed command      |
+     * | Firmware : ss ll ll A1.. cc cc    | Framed response     |
+     * | Firmware : ss 00 00 cc cc         | Frame rejected      |
+     * +---------------------------------------------------------+
+     * </pre>
+     */
+    kCmdProtoFrame = 0xF2,
+    /**
+     * @brief OPCODE / PROTOCOL : Opcode Get Capabilities.
+     * @details Returns the protocol version (one byte, see
+     *   kCmdProtoVersion), the maximum length of the buffer opcodes
+     *   (two bytes, MSB first) and the feature bitmap (two bytes, MSB
+     *   first, see kCmdProtoFeatureEnum).<br/>
+     *   It has no parameters, so an old firmware responds only NOK
+     *   (unknown opcode).
+     * <pre>
+     * +--------------------------------------------------+
+     * |Sequence                      | Description       |
+     * | Host     : F3                | Get Capabilities  |
+     * | Firmware : A1 vv mm mm ff ff | Capabilities      |
+     * +--------------------------------------------------+
+     * </pre>
+     */
+    kCmdProtoCaps = 0xF3
 };
 
 // ---------------------------------------------------------------------------
@@ -356,6 +620,23 @@ enum kCmdDeviceOperationEnum {
 
 // ---------------------------------------------------------------------------
 
+/**
+ * @brief Enumeration of the values kept by a Device Setup (bit mask).
+ * @see kCmdDeviceSetup
+ */
+enum kCmdDeviceSetupKeepEnum {
+    /** @brief CMD / DEVICE : Keeps the current VDD voltage. */
+    kCmdDeviceSetupKeepVdd = 0x01,
+    /** @brief CMD / DEVICE : Keeps the current VPP voltage. */
+    kCmdDeviceSetupKeepVpp = 0x02,
+    /** @brief CMD / DEVICE : Keeps the current tWP. */
+    kCmdDeviceSetupKeepTwp = 0x04,
+    /** @brief CMD / DEVICE : Keeps the current tWC. */
+    kCmdDeviceSetupKeepTwc = 0x08
+};
+
+// ---------------------------------------------------------------------------
+
 /**
  * @brief Enumeration of the Device Algorithms.
  * @see kCmdDeviceConfigure
@@ -385,6 +666,46 @@ enum kCmdDeviceAlgorithmEnum {
 
 // ---------------------------------------------------------------------------
 
+/**
+ * @brief Enumeration of the Features (bitmap).
+ * @see kCmdProtoCaps
+ */
+enum kCmdProtoFeatureEnum {
+    /** @brief FEATURE : Tagged commands (kCmdProtoTag). */
+    kCmdProtoFeatureTag = 0x0001,
+    /** @brief FEATURE : Wide length buffer opcodes (kCmdDeviceReadW...). */
+    kCmdProtoFeatureWide = 0x0002,
+    /** @brief FEATURE : Read Range stream (kCmdDeviceReadRange). */
+    kCmdProtoFeatureReadRange = 0x0004,
+    /** @brief FEATURE : Write Range stream (kCmdDeviceWriteRange). */
+    kCmdProtoFeatureWriteRange = 0x0008,
+    /** @brief FEATURE : CRC32 Range (kCmdDeviceCrc32Range). */
+    kCmdProtoFeatureCrc32Range = 0x0010,
+    /** @brief FEATURE : Blank Check Range (kCmdDeviceBlankCheckRange). */
+    kCmdProtoFeatureBlankRange = 0x0020,
+    /** @brief FEATURE : RLE encoding of the streams (kCmdProtoEncoding). */
+    kCmdProtoFeatureRle = 0x0040,
+    /** @brief FEATURE : Device Setup (kCmdDeviceSetup). */
+    kCmdProtoFeatureDeviceSetup = 0x0080,
+    /** @brief FEATURE : Framed transport (kCmdProtoFrame). */
+    kCmdProtoFeatureFrame = 0x0100
+};
+
+// ---------------------------------------------------------------------------
+
+/**
+ * @brief Enumeration of the Data Stream Encodings.
+ * @see kCmdProtoEncoding
+ */
+enum kCmdProtoEncodingEnum {
+    /** @brief CMD / PROTOCOL : Defines the raw encoding (default). */
+    kCmdProtoEncodingRaw = 0x00,
+    /** @brief CMD / PROTOCOL : Defines the RLE encoding (PackBits). */
+    kCmdProtoEncodingRle = 0x01
+};
+
+// ---------------------------------------------------------------------------
+
 /**
  * @ingroup Firmware
  * @brief Defines an opcode to run.
@@ -395,17 +716,11 @@ typedef struct TCmdOpCode {
     /** @brief OpCode. */
     kCmdOpCodeEnum code;
     /** @brief Opcode description. */
-    std::string descr;
+    const char *descr;
     /** @brief Number of bytes of the required parameters. */
     uint8_t params;
     /** @brief Number of bytes of the response. */
-    uint8_t result;
-    /**
-     * @brief Assign Operator.
-     * @param src TCmdOpCode source object.
-     * @return Reference for this.
-     */
-    TCmdOpCode &operator=(const TCmdOpCode &src);
+    uint16_t result;
     /**
      * @brief Equality Operator.
      * @param a One object.
@@ -417,70 +732,87 @@ typedef struct TCmdOpCode {
 
 // ---------------------------------------------------------------------------
 
-/** @brief Type of opcodes group (map). */
-typedef std::map<kCmdOpCodeEnum, TCmdOpCode> TCmdOpCodeMap;
-
-// ---------------------------------------------------------------------------
-
 // clang-format off
-/** @brief OPCODE : Opcodes group (map). */
-static const TCmdOpCodeMap kCmdOpCodes = {
-    {kCmdNop                  , {kCmdNop                  , "Nop"                    , 0, 0}},
-
-    {kCmdVddCtrl              , {kCmdVddCtrl              , "Vdd Ctrl"               , 1, 0}},
-    {kCmdVddSetV              , {kCmdVddSetV              , "Vdd SetV"               , 2, 0}},
-    {kCmdVddGetV              , {kCmdVddGetV              , "Vdd GetV"               , 0, 2}},
-    {kCmdVddGetDuty           , {kCmdVddGetDuty           , "Vdd GetDuty"            , 0, 2}},
-    {kCmdVddGetCal            , {kCmdVddGetCal            , "Vdd GetCal"             , 0, 2}},
-    {kCmdVddInitCal           , {kCmdVddInitCal           , "Vdd InitCal"            , 0, 0}},
-    {kCmdVddSaveCal           , {kCmdVddSaveCal           , "Vdd SaveCal"            , 2, 0}},
-    {kCmdVddOnVpp             , {kCmdVddOnVpp             , "Vdd On Vpp"             , 1, 0}},
-
-    {kCmdVppCtrl              , {kCmdVppCtrl              , "Vpp Ctrl"               , 1, 0}},
-    {kCmdVppSetV              , {kCmdVppSetV              , "Vpp SetV"               , 2, 0}},
-    {kCmdVppGetV              , {kCmdVppGetV              , "Vpp GetV"               , 0, 2}},
-    {kCmdVppGetDuty           , {kCmdVppGetDuty           , "Vpp GetDuty"            , 0, 2}},
-    {kCmdVppGetCal            , {kCmdVppGetCal            , "Vpp GetCal"             , 0, 2}},
-    {kCmdVppInitCal           , {kCmdVppInitCal           , "Vpp InitCal"            , 0, 0}},
-    {kCmdVppSaveCal           , {kCmdVppSaveCal           , "Vpp SaveCal"            , 2, 0}},
-    {kCmdVppOnA9              , {kCmdVppOnA9              , "Vpp On A9"              , 1, 0}},
-    {kCmdVppOnA18             , {kCmdVppOnA18             , "Vpp On A18"             , 1, 0}},
-    {kCmdVppOnCE              , {kCmdVppOnCE              , "Vpp On CE"              , 1, 0}},
-    {kCmdVppOnOE              , {kCmdVppOnOE              , "Vpp On OE"              , 1, 0}},
-    {kCmdVppOnWE              , {kCmdVppOnWE              , "Vpp On WE"              , 1, 0}},
-
-    {kCmdBusCE                , {kCmdBusCE                , "Set CE"                 , 1, 0}},
-    {kCmdBusOE                , {kCmdBusOE                , "Set OE"                 , 1, 0}},
-    {kCmdBusWE                , {kCmdBusWE                , "Set WE"                 , 1, 0}},
-
-    {kCmdBusAddrClr           , {kCmdBusAddrClr           , "Addr Clr"               , 0, 0}},
-    {kCmdBusAddrInc           , {kCmdBusAddrInc           , "Addr Inc"               , 0, 0}},
-    {kCmdBusAddrSet           , {kCmdBusAddrSet           , "Addr Set"               , 3, 0}},
-    {kCmdBusAddrSetB          , {kCmdBusAddrSetB          , "Addr SetByte"           , 1, 0}},
-    {kCmdBusAddrSetW          , {kCmdBusAddrSetW          , "Addr SetWord"           , 2, 0}},
-
-    {kCmdBusDataClr           , {kCmdBusDataClr           , "Data Clr"               , 0, 0}},
-    {kCmdBusDataSet           , {kCmdBusDataSet           , "Data Set"               , 1, 0}},
-    {kCmdBusDataSetW          , {kCmdBusDataSetW          , "Data SetWord"           , 2, 0}},
-    {kCmdBusDataGet           , {kCmdBusDataGet           , "Data Get"               , 0, 1}},
-    {kCmdBusDataGetW          , {kCmdBusDataGetW          , "Data GetWord"           , 0, 2}},
-
-    {kCmdDeviceSetTwp         , {kCmdDeviceSetTwp         , "Device Set Twp"         , 4, 0}},
-    {kCmdDeviceSetTwc         , {kCmdDeviceSetTwc         , "Device Set Twc"         , 4, 0}},
-    {kCmdDeviceConfigure      , {kCmdDeviceConfigure      , "Device Configure"       , 2, 0}},
-    {kCmdDeviceSetupBus       , {kCmdDeviceSetupBus       , "Device Setup Bus"       , 1, 0}},
-    {kCmdDeviceRead           , {kCmdDeviceRead           , "Device Read"            , 1, 0}},
-    {kCmdDeviceWrite          , {kCmdDeviceWrite          , "Device Write"           , 1, 0}},
-    {kCmdDeviceWriteSector    , {kCmdDeviceWriteSector    , "Device WriteSector"     , 2, 0}},
-    {kCmdDeviceVerify         , {kCmdDeviceVerify         , "Device Verify"          , 1, 0}},
-    {kCmdDeviceBlankCheck     , {kCmdDeviceBlankCheck     , "Device BlankCheck"      , 1, 0}},
-    {kCmdDeviceGetId          , {kCmdDeviceGetId          , "Device GetID"           , 0, 4}},
-    {kCmdDeviceErase          , {kCmdDeviceErase          , "Device Erase"           , 0, 0}},
-    {kCmdDeviceUnprotect      , {kCmdDeviceUnprotect      , "Device Unprotect"       , 0, 0}},
-    {kCmdDeviceProtect        , {kCmdDeviceProtect        , "Device Protect"         , 0, 0}}
+/**
+ * @brief OPCODE : Opcodes group (table, in flash).
+ * @details The first entry is the NOP. See OpCode::findOpCode() for the
+ *  lookup by code. The host software has a copy of this table (compared
+ *  by the unit tests).
+ */
+static constexpr TCmdOpCode kCmdOpCodes[] = {
+    {kCmdNop                  , "Nop"                    , 0, 0},
+
+    {kCmdVddCtrl              , "Vdd Ctrl"               , 1, 0},
+    {kCmdVddSetV              , "Vdd SetV"               , 2, 0},
+    {kCmdVddGetV              , "Vdd GetV"               , 0, 2},
+    {kCmdVddGetDuty           , "Vdd GetDuty"            , 0, 2},
+    {kCmdVddGetCal            , "Vdd GetCal"             , 0, 2},
+    {kCmdVddInitCal           , "Vdd InitCal"            , 0, 0},
+    {kCmdVddSaveCal           , "Vdd SaveCal"            , 2, 0},
+    {kCmdVddOnVpp             , "Vdd On Vpp"             , 1, 0},
+
+    {kCmdVppCtrl              , "Vpp Ctrl"               , 1, 0},
+    {kCmdVppSetV              , "Vpp SetV"               , 2, 0},
+    {kCmdVppGetV              , "Vpp GetV"               , 0, 2},
+    {kCmdVppGetDuty           , "Vpp GetDuty"            , 0, 2},
+    {kCmdVppGetCal            , "Vpp GetCal"             , 0, 2},
+    {kCmdVppInitCal           , "Vpp InitCal"            , 0, 0},
+    {kCmdVppSaveCal           , "Vpp SaveCal"            , 2, 0},
+    {kCmdVppOnA9              , "Vpp On A9"              , 1, 0},
+    {kCmdVppOnA18             , "Vpp On A18"             , 1, 0},
+    {kCmdVppOnCE              , "Vpp On CE"              , 1, 0},
+    {kCmdVppOnOE              , "Vpp On OE"              , 1, 0},
+    {kCmdVppOnWE              , "Vpp On WE"              , 1, 0},
+
+    {kCmdBusCE                , "Set CE"                 , 1, 0},
+    {kCmdBusOE                , "Set OE"                 , 1, 0},
+    {kCmdBusWE                , "Set WE"                 , 1, 0},
+
+    {kCmdBusAddrClr           , "Addr Clr"               , 0, 0},
+    {kCmdBusAddrInc           , "Addr Inc"               , 0, 0},
+    {kCmdBusAddrSet           , "Addr Set"               , 3, 0},
+    {kCmdBusAddrSetB          , "Addr SetByte"           , 1, 0},
+    {kCmdBusAddrSetW          , "Addr SetWord"           , 2, 0},
+
+    {kCmdBusDataClr           , "Data Clr"               , 0, 0},
+    {kCmdBusDataSet           , "Data Set"               , 1, 0},
+    {kCmdBusDataSetW          , "Data SetWord"           , 2, 0},
+    {kCmdBusDataGet           , "Data Get"               , 0, 1},
+    {kCmdBusDataGetW          , "Data GetWord"           , 0, 2},
+
+    {kCmdDeviceSetTwp         , "Device Set Twp"         , 4, 0},
+    {kCmdDeviceSetTwc         , "Device Set Twc"         , 4, 0},
+    {kCmdDeviceConfigure      , "Device Configure"       , 2, 0},
+    {kCmdDeviceSetupBus       , "Device Setup Bus"       , 1, 0},
+    {kCmdDeviceRead           , "Device Read"            , 1, 0},
+    {kCmdDeviceWrite          , "Device Write"           , 1, 0},
+    {kCmdDeviceWriteSector    , "Device WriteSector"     , 2, 0},
+    {kCmdDeviceVerify         , "Device Verify"          , 1, 0},
+    {kCmdDeviceBlankCheck     , "Device BlankCheck"      , 1, 0},
+    {kCmdDeviceGetId          , "Device GetID"           , 0, 4},
+    {kCmdDeviceErase          , "Device Erase"           , 0, 0},
+    {kCmdDeviceUnprotect      , "Device Unprotect"       , 0, 0},
+    {kCmdDeviceProtect        , "Device Protect"         , 0, 0},
+    {kCmdDeviceReadRange      , "Device ReadRange"       , 6, 0},
+    {kCmdDeviceWriteRange     , "Device WriteRange"      , 9, 1},
+    {kCmdDeviceReadW          , "Device ReadW"           , 2, 0},
+    {kCmdDeviceWriteW         , "Device WriteW"          , 2, 0},
+    {kCmdDeviceVerifyW        , "Device VerifyW"         , 2, 0},
+    {kCmdDeviceBlankCheckW    , "Device BlankCheckW"     , 2, 0},
+    {kCmdDeviceCrc32Range     , "Device Crc32Range"      , 6, 4},
+    {kCmdDeviceBlankCheckRange, "Device BlankCheckRange" , 6, 8},
+    {kCmdDeviceSetup          , "Device Setup"           ,16, 0},
+
+    {kCmdProtoTag             , "Proto Tag"              , 1, 0},
+    {kCmdProtoEncoding        , "Proto Encoding"         , 1, 0},
+    {kCmdProtoFrame           , "Proto Frame"            , 3, 0},
+    {kCmdProtoCaps            , "Proto Caps"             , 0, 5}
 };
 // clang-format on
 
+static_assert(kCmdOpCodes[0].code == kCmdNop,
+              "the first opcode of kCmdOpCodes must be the NOP");
+
 // ---------------------------------------------------------------------------
 
 /**
@@ -515,6 +847,14 @@ class OpCode {
      * @return Opcode of the operation, or kCmdNop if not found.
      */
     static TCmdOpCode getOpCode(uint8_t code);
+    /**
+     * @brief Finds an opcode in the table (by an index built at compile
+     *  time).
+     * @param code Code (byte).
+     * @return Pointer to the opcode in kCmdOpCodes, or nullptr if not
+     *  found.
+     */
+    static const TCmdOpCode *findOpCode(uint8_t code);
     /**
      * @brief Gets the param value as float.
      * @param buf Pointer to the buffer that contains the result
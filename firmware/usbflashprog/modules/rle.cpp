@@ -0,0 +1,94 @@
+// ---------------------------------------------------------------------------
+// USB EPROM/Flash Programmer
+//
+// Copyright (2024) Robson Martins
+//
+// This work is licensed under a Creative Commons Attribution-NonCommercial-
+// ShareAlike 4.0 International License.
+// ---------------------------------------------------------------------------
+/**
+ * @ingroup Firmware
+ * @file modules/rle.cpp
+ * @brief Implementation of the RLE Codec Class.
+ *
+ * @author Robson Martins (https://www.robsonmartins.com)
+ */
+// ---------------------------------------------------------------------------
+
+#include <cstring>
+#include "modules/rle.hpp"
+
+// ---------------------------------------------------------------------------
+
+/* @brief Maximum length of a packet, in bytes. */
+constexpr size_t kRlePacketMax = 128;
+/* @brief Minimum length of a run worth encoding, in bytes. */
+constexpr size_t kRleRunMin = 3;
+/* @brief No operation control byte. */
+constexpr uint8_t kRleNop = 0x80;
+
+// ---------------------------------------------------------------------------
+
+size_t Rle::encode(const void *src, size_t size, void *dst) {
+    const uint8_t *in = static_cast<const uint8_t *>(src);
+    uint8_t *out = static_cast<uint8_t *>(dst);
+    size_t pos = 0, len = 0;
+    while (pos < size) {
+        size_t run = 1;
+        while (pos + run < size && run < kRlePacketMax &&
+               in[pos + run] == in[pos]) {
+            run++;
+        }
+        if (run >= kRleRunMin) {
+            out[len++] = static_cast<uint8_t>(257 - run);
+            out[len++] = in[pos];
+            pos += run;
+            continue;
+        }
+        // collect literals until the next run worth encoding
+        size_t ctrl = len++, literal = 0;
+        while (pos < size && literal < kRlePacketMax) {
+            if (pos + kRleRunMin <= size && in[pos] == in[pos + 1] &&
+                in[pos] == in[pos + 2]) {
+                break;
+            }
+            out[len++] = in[pos++];
+            literal++;
+        }
+        out[ctrl] = static_cast<uint8_t>(literal - 1);
+    }
+    return len;
+}
+
+bool Rle::decode(const void *src, size_t size, void *dst, size_t capacity,
+                 size_t &decoded) {
+    const uint8_t *in = static_cast<const uint8_t *>(src);
+    uint8_t *out = static_cast<uint8_t *>(dst);
+    size_t pos = 0;
+    decoded = 0;
+    while (pos < size) {
+        uint8_t ctrl = in[pos++];
+        if (ctrl == kRleNop) continue;
+        if (ctrl < kRleNop) {
+            size_t count = ctrl + 1;
+            if (pos + count > size || decoded + count > capacity) {
+                return false;
+            }
+            memcpy(out + decoded, in + pos, count);
+            pos += count;
+            decoded += count;
+        } else {
+            size_t count = 257 - ctrl;
+            if (pos >= size || decoded + count > capacity) {
+                return false;
+            }
+            memset(out + decoded, in[pos++], count);
+            decoded += count;
+        }
+    }
+    return true;
+}
+
+size_t Rle::maxEncodedSize(size_t size) {
+    return size + (size + kRlePacketMax - 1) / kRlePacketMax;
+}
@@ -0,0 +1,71 @@
+// ---------------------------------------------------------------------------
+// USB EPROM/Flash Programmer
+//
+// Copyright (2024) Robson Martins
+//
+// This work is licensed under a Creative Commons Attribution-NonCommercial-
+// ShareAlike 4.0 International License.
+// ---------------------------------------------------------------------------
+/**
+ * @ingroup Firmware
+ * @file modules/rle.hpp
+ * @brief Header of the RLE Codec Class.
+ *
+ * @author Robson Martins (https://www.robsonmartins.com)
+ */
+// ---------------------------------------------------------------------------
+
+#ifndef MODULES_RLE_HPP_
+#define MODULES_RLE_HPP_
+
+// ---------------------------------------------------------------------------
+
+#include <cstddef>
+#include <cstdint>
+
+// ---------------------------------------------------------------------------
+
+/**
+ * @ingroup Firmware
+ * @brief RLE Codec Class
+ * @details The purpose of this class is to compress the data streams of the
+ *  communication protocol (PackBits run-length encoding).
+ *
+ *  Each packet starts with a control byte <tt>n</tt>:
+ *  - <tt>0..127</tt>: <tt>n + 1</tt> literal bytes follow;
+ *  - <tt>129..255</tt>: the next byte is repeated <tt>257 - n</tt> times;
+ *  - <tt>128</tt>: no operation.
+ * @nosubgrouping
+ */
+class Rle {
+  public:
+    /**
+     * @brief Encodes a buffer.
+     * @param src Pointer to the source (raw) buffer.
+     * @param size Size of source buffer, in bytes.
+     * @param dst Pointer to the destination buffer. Must have at least
+     *  maxEncodedSize(size) bytes.
+     * @return Size of encoded data, in bytes.
+     */
+    static size_t encode(const void *src, size_t size, void *dst);
+    /**
+     * @brief Decodes a buffer.
+     * @param src Pointer to the source (encoded) buffer.
+     * @param size Size of source buffer, in bytes.
+     * @param dst Pointer to the destination buffer.
+     * @param capacity Size of destination buffer, in bytes.
+     * @param[out] decoded Size of decoded data, in bytes.
+     * @return True if success, false if the encoded data is malformed
+     *  or does not fit in the destination buffer.
+     */
+    static bool decode(const void *src, size_t size, void *dst,
+                       size_t capacity, size_t &decoded);
+    /**
+     * @brief Returns the worst case size of encoded data.
+     * @param size Size of raw data, in bytes.
+     * @return Maximum size of encoded data, in bytes.
+     */
+    static size_t maxEncodedSize(size_t size);
+};
+
+#endif  // MODULES_RLE_HPP_
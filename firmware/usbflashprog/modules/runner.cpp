@@ -16,14 +16,125 @@
 // ---------------------------------------------------------------------------
 
 #include <cmath>
+#include <cstring>
 
 #include "config.hpp"
 #include "hal/string.hpp"
+#include "modules/checksum.hpp"
+#include "modules/rle.hpp"
 #include "modules/runner.hpp"
 
 // ---------------------------------------------------------------------------
 
-Runner::Runner() {}
+Runner::Runner()
+    : tagged_(false),
+      fenced_(false),
+      encoding_(kCmdProtoEncodingRaw),
+      framed_(false),
+      framePos_(0),
+      frameSeq_(-1) {}
+
+// clang-format off
+constexpr Runner::THandlerEntry Runner::kHandlers_[] = {
+    {kCmdNop                  ,  0, 0, &Runner::nop_},
+
+    {kCmdVddCtrl              ,  1, 0, &Runner::vddCtrl_},
+    {kCmdVddSetV              ,  2, 0, &Runner::vddSetV_},
+    {kCmdVddGetV              ,  0, 2, &Runner::vddGetV_},
+    {kCmdVddGetDuty           ,  0, 2, &Runner::vddGetDuty_},
+    {kCmdVddGetCal            ,  0, 2, &Runner::vddGetCal_},
+    {kCmdVddInitCal           ,  0, 0, &Runner::vddInitCal_},
+    {kCmdVddSaveCal           ,  2, 0, &Runner::vddSaveCal_},
+    {kCmdVddOnVpp             ,  1, 0, &Runner::vddOnVpp_},
+
+    {kCmdVppCtrl              ,  1, 0, &Runner::vppCtrl_},
+    {kCmdVppSetV              ,  2, 0, &Runner::vppSetV_},
+    {kCmdVppGetV              ,  0, 2, &Runner::vppGetV_},
+    {kCmdVppGetDuty           ,  0, 2, &Runner::vppGetDuty_},
+    {kCmdVppGetCal            ,  0, 2, &Runner::vppGetCal_},
+    {kCmdVppInitCal           ,  0, 0, &Runner::vppInitCal_},
+    {kCmdVppSaveCal           ,  2, 0, &Runner::vppSaveCal_},
+    {kCmdVppOnA9              ,  1, 0, &Runner::vppOnA9_},
+    {kCmdVppOnA18             ,  1, 0, &Runner::vppOnA18_},
+    {kCmdVppOnCE              ,  1, 0, &Runner::vppOnCE_},
+    {kCmdVppOnOE              ,  1, 0, &Runner::vppOnOE_},
+    {kCmdVppOnWE              ,  1, 0, &Runner::vppOnWE_},
+
+    {kCmdBusCE                ,  1, 0, &Runner::busCE_},
+    {kCmdBusOE                ,  1, 0, &Runner::busOE_},
+    {kCmdBusWE                ,  1, 0, &Runner::busWE_},
+
+    {kCmdBusAddrClr           ,  0, 0, &Runner::addrClr_},
+    {kCmdBusAddrInc           ,  0, 0, &Runner::addrInc_},
+    {kCmdBusAddrSet           ,  3, 0, &Runner::addrSet_},
+    {kCmdBusAddrSetB          ,  1, 0, &Runner::addrSetB_},
+    {kCmdBusAddrSetW          ,  2, 0, &Runner::addrSetW_},
+
+    {kCmdBusDataClr           ,  0, 0, &Runner::dataClr_},
+    {kCmdBusDataSet           ,  1, 0, &Runner::dataSet_},
+    {kCmdBusDataSetW          ,  2, 0, &Runner::dataSetW_},
+    {kCmdBusDataGet           ,  0, 1, &Runner::dataGet_},
+    {kCmdBusDataGetW          ,  0, 2, &Runner::dataGetW_},
+
+    {kCmdDeviceSetTwp         ,  4, 0, &Runner::deviceSetTwp_},
+    {kCmdDeviceSetTwc         ,  4, 0, &Runner::deviceSetTwc_},
+    {kCmdDeviceConfigure      ,  2, 0, &Runner::deviceConfigure_},
+    {kCmdDeviceSetupBus       ,  1, 0, &Runner::deviceSetupBus_},
+    {kCmdDeviceRead           ,  1, 0, &Runner::deviceRead_},
+    {kCmdDeviceWrite          ,  1, 0, &Runner::deviceWrite_},
+    {kCmdDeviceWriteSector    ,  2, 0, &Runner::deviceWriteSector_},
+    {kCmdDeviceVerify         ,  1, 0, &Runner::deviceVerify_},
+    {kCmdDeviceBlankCheck     ,  1, 0, &Runner::deviceBlankCheck_},
+    {kCmdDeviceGetId          ,  0, 4, &Runner::deviceGetId_},
+    {kCmdDeviceErase          ,  0, 0, &Runner::deviceErase_},
+    {kCmdDeviceUnprotect      ,  0, 0, &Runner::deviceUnprotect_},
+    {kCmdDeviceProtect        ,  0, 0, &Runner::deviceProtect_},
+    {kCmdDeviceReadRange      ,  6, 0, &Runner::deviceReadRange_},
+    {kCmdDeviceWriteRange     ,  9, 1, &Runner::deviceWriteRange_},
+    {kCmdDeviceReadW          ,  2, 0, &Runner::deviceReadW_},
+    {kCmdDeviceWriteW         ,  2, 0, &Runner::deviceWriteW_},
+    {kCmdDeviceVerifyW        ,  2, 0, &Runner::deviceVerifyW_},
+    {kCmdDeviceBlankCheckW    ,  2, 0, &Runner::deviceBlankCheckW_},
+    {kCmdDeviceCrc32Range     ,  6, 4, &Runner::deviceCrc32Range_},
+    {kCmdDeviceBlankCheckRange,  6, 8, &Runner::deviceBlankCheckRange_},
+    {kCmdDeviceSetup          , 16, 0, &Runner::deviceSetup_},
+
+    {kCmdProtoTag             ,  1, 0, &Runner::protoTag_},
+    {kCmdProtoEncoding        ,  1, 0, &Runner::protoEncoding_},
+    {kCmdProtoFrame           ,  3, 0, &Runner::runFrame_},
+    {kCmdProtoCaps            ,  0, 5, &Runner::getCaps_}
+};
+// clang-format on
+
+constexpr size_t Runner::kHandlerCount_ =
+    sizeof(Runner::kHandlers_) / sizeof(Runner::kHandlers_[0]);
+
+constexpr std::array<uint8_t, 256> Runner::makeDispatch_() {
+    std::array<uint8_t, 256> result{};
+    for (auto &index : result) index = kNoHandler_;
+    for (size_t i = 0; i < kHandlerCount_; i++) {
+        result[kHandlers_[i].code] = i;
+    }
+    return result;
+}
+
+constexpr bool Runner::hasHandlers_() {
+    constexpr auto dispatch = makeDispatch_();
+    size_t count = 0;
+    for (const auto &opcode : kCmdOpCodes) {
+        uint8_t index = dispatch[opcode.code];
+        if (index == kNoHandler_) return false;
+        const THandlerEntry &entry = kHandlers_[index];
+        if (entry.params != opcode.params || entry.result != opcode.result) {
+            return false;
+        }
+        count++;
+    }
+    // one handler for each opcode (none left over)
+    return count == kHandlerCount_;
+}
+
+const std::array<uint8_t, 256> Runner::kDispatch_ = makeDispatch_();
 
 void Runner::init() {
     device_.init();
@@ -36,9 +147,9 @@ void Runner::loop() {
     data.insert(data.end(), c & 0xFF);
     command_.clear();
     command_.insert(command_.end(), data.begin(), data.end());
-    auto code = findOpCode_();
-    if (code != kCmdOpCodes.end() && code->second.params) {
-        data = readByte_(code->second.params);
+    auto entry = findHandler_();
+    if (entry && entry->params) {
+        data = readByte_(entry->params);
         command_.insert(command_.end(), data.begin(), data.end());
     }
     runCommand_();
@@ -47,6 +158,15 @@ void Runner::loop() {
 
 Runner::TByteArray Runner::readByte_(size_t len) {
     TByteArray result;
+    if (framed_) {
+        // data of a framed command comes from the payload
+        if (len && framePos_ + len <= frameIn_.size()) {
+            result.insert(result.end(), frameIn_.begin() + framePos_,
+                          frameIn_.begin() + framePos_ + len);
+            framePos_ += len;
+        }
+        return result;
+    }
     if (len) {
         uint8_t *buf = new uint8_t[len];
         if (serial_.getBuf(buf, len, kCommTimeOut * 1000) == len) {
@@ -58,420 +178,761 @@ Runner::TByteArray Runner::readByte_(size_t len) {
     return result;
 }
 
-TCmdOpCodeMap::const_iterator Runner::findOpCode_() {
-    if (command_.size() < 1) return kCmdOpCodes.end();
-    return kCmdOpCodes.find(static_cast<kCmdOpCodeEnum>(command_[0]));
+const Runner::THandlerEntry *Runner::findHandler_() {
+    if (command_.size() < 1) return nullptr;
+    uint8_t index = kDispatch_[command_[0]];
+    return (index != kNoHandler_) ? &kHandlers_[index] : nullptr;
 }
 
 void Runner::runCommand_() {
     if (command_.size() < 1) return;
-    auto code = findOpCode_();
-    if (code == kCmdOpCodes.end() ||
-        command_.size() < (code->second.params + 1)) {
+    static_assert(hasHandlers_(), "each opcode needs one handler");
+    auto entry = findHandler_();
+    if (!entry || command_.size() < (entry->params + 1U)) {
         // opcode not found or nparams invalid
-        serial_.putChar(kCmdResponseNok);
+        putChar_(kCmdResponseNok);
+        tagged_ = false;
+        encoding_ = kCmdProtoEncodingRaw;
+        return;
+    }
+    if (entry->code == kCmdProtoFrame) {
+        (this->*entry->handler)();
+        return;
+    }
+    // an unframed command ends the retransmission of the last frame
+    if (!framed_) frameSeq_ = -1;
+    if (entry->code == kCmdProtoTag || entry->code == kCmdProtoEncoding) {
+        // prefix of the next command
+        (this->*entry->handler)();
         return;
     }
-    if (code->first == kCmdNop) {  // NOP
-        serial_.putChar(kCmdResponseOk);
+    // an untagged command ends the discarding of a failed pipeline
+    if (!tagged_) fenced_ = false;
+    if (fenced_) {
+        discardCommand_(entry->code);
+        putChar_(kCmdResponseNok);
+        tagged_ = false;
+        encoding_ = kCmdProtoEncodingRaw;
+        return;
+    }
+    (this->*entry->handler)();
+    tagged_ = false;
+    encoding_ = kCmdProtoEncodingRaw;
+}
+
+void Runner::protoTag_() {
+    // echoes the tag, the response of the next command follows it
+    putChar_(getParamAsByte_());
+    tagged_ = true;
+}
+
+void Runner::protoEncoding_() {
+    // selects the encoding of the stream of the next command
+    encoding_ = getParamAsByte_();
+    if (encoding_ == kCmdProtoEncodingRaw ||
+        encoding_ == kCmdProtoEncodingRle) {
+        putChar_(kCmdResponseOk);
     } else {
-        runVddCommand_(code->first);
-        runVppCommand_(code->first);
-        runCtrlBusCommand_(code->first);
-        runAddrBusCommand_(code->first);
-        runDataBusCommand_(code->first);
+        encoding_ = kCmdProtoEncodingRaw;
+        putChar_(kCmdResponseNok);
+    }
+}
 
-        runDeviceSettingsCommand_(code->first);
-        runDeviceReadCommand_(code->first);
-        runDeviceWriteCommand_(code->first);
-        runDeviceVerifyCommand_(code->first);
-        runDeviceGetIdCommand_(code->first);
-        runDeviceEraseCommand_(code->first);
-        runDeviceProtectCommand_(code->first);
+void Runner::runFrame_() {
+    uint8_t seq = getParamAsByte_();
+    uint16_t len = OpCode::getValueAsWord(command_.data() + 1, 3);
+    TByteArray header(command_.begin() + 1, command_.end());
+    TByteArray payload;
+    if (len <= kCommFrameMaxSize) payload = readByte_(len + 2);
+    bool valid = (payload.size() == len + 2U);
+    if (valid) {
+        uint16_t crc = Checksum::crc16(header.data(), header.size(), 0);
+        crc = Checksum::crc16(payload.data(), len, crc);
+        valid = (crc == ((payload[len] << 8) | payload[len + 1]));
+    }
+    if (!valid) {
+        // corrupted or incomplete frame: discards the rest of the input
+        while (serial_.getChar(kCommTimeOut * 1000) != PICO_ERROR_TIMEOUT) {
+        }
+        putFrame_(seq, TByteArray());
+        return;
+    }
+    if (!seq) {
+        // synchronization
+        frameSeq_ = -1;
+        putFrame_(seq, TByteArray());
+        return;
     }
+    if (seq == frameSeq_) {
+        // retransmission: resends the last response, without running
+        putFrame_(seq, frameOut_);
+        return;
+    }
+    payload.resize(len);
+    command_ = payload;
+    auto entry = findHandler_();
+    frameOut_.clear();
+    frameIn_.swap(payload);
+    framePos_ = entry ? static_cast<size_t>(entry->params + 1)
+                      : frameIn_.size();
+    if (framePos_ > frameIn_.size()) framePos_ = frameIn_.size();
+    command_.resize(framePos_);
+    framed_ = true;
+    if (!len || !entry || !isFrameable_(entry->code)) {
+        putChar_(kCmdResponseNok);
+    } else {
+        runCommand_();
+    }
+    framed_ = false;
+    frameIn_.clear();
+    frameSeq_ = seq;
+    putFrame_(seq, frameOut_);
 }
 
-void Runner::runVddCommand_(uint8_t opcode) {
-    float v;
-    TByteArray response;
+void Runner::getCaps_() {
+    uint16_t features = kCmdProtoFeatureTag | kCmdProtoFeatureWide |
+                        kCmdProtoFeatureReadRange |
+                        kCmdProtoFeatureWriteRange |
+                        kCmdProtoFeatureCrc32Range |
+                        kCmdProtoFeatureBlankRange | kCmdProtoFeatureRle |
+                        kCmdProtoFeatureDeviceSetup | kCmdProtoFeatureFrame;
+    TByteArray response(6);
+    response[0] = kCmdResponseOk;
+    response[1] = kCmdProtoVersion;
+    response[2] = (kCommMaxBufferSize >> 8) & 0xFF;
+    response[3] = kCommMaxBufferSize & 0xFF;
+    response[4] = (features >> 8) & 0xFF;
+    response[5] = features & 0xFF;
+    putBuf_(response.data(), response.size());
+}
+
+bool Runner::isFrameable_(uint8_t opcode) {
     switch (opcode) {
-        case kCmdVddCtrl:
-            serial_.putChar(kCmdResponseOk, true);
-            device_.vddCtrl(getParamAsBool_());
-            break;
-        case kCmdVddSetV:
-            serial_.putChar(kCmdResponseOk, true);
-            device_.vddSetV(getParamAsFloat_());
-            break;
-        case kCmdVddGetV:
-            v = device_.vddGetV();
-            response.resize(3);
-            response[0] = kCmdResponseOk;
-            createParamsFromFloat_(&response, v);
-            serial_.putBuf(response.data(), response.size());
-            break;
-        case kCmdVddGetDuty:
-            v = device_.vddGetDuty();
-            response.resize(3);
-            response[0] = kCmdResponseOk;
-            createParamsFromFloat_(&response, v);
-            serial_.putBuf(response.data(), response.size());
-            break;
-        case kCmdVddGetCal:
-            v = device_.vddGetCal();
-            response.resize(3);
-            response[0] = kCmdResponseOk;
-            createParamsFromFloat_(&response, v);
-            serial_.putBuf(response.data(), response.size());
-            break;
-        case kCmdVddInitCal:
-            serial_.putChar(kCmdResponseOk, true);
-            device_.vddInitCal();
-            break;
-        case kCmdVddSaveCal:
-            serial_.putChar(kCmdResponseOk, true);
-            device_.vddSaveCal(getParamAsFloat_());
-            break;
-        case kCmdVddOnVpp:
-            serial_.putChar(kCmdResponseOk, true);
-            device_.vddOnVpp(getParamAsBool_());
-            break;
+        case kCmdDeviceReadRange:
+        case kCmdDeviceWriteRange:
+        case kCmdProtoTag:
+        case kCmdProtoEncoding:
+        case kCmdProtoFrame:
+            return false;
         default:
-            break;
+            return true;
     }
 }
 
-void Runner::runVppCommand_(uint8_t opcode) {
-    float v;
-    TByteArray response;
-    switch (opcode) {
-        case kCmdVppCtrl:
-            serial_.putChar(kCmdResponseOk, true);
-            device_.vppCtrl(getParamAsBool_());
-            break;
-        case kCmdVppSetV:
-            serial_.putChar(kCmdResponseOk, true);
-            device_.vppSetV(getParamAsFloat_());
-            break;
-        case kCmdVppGetV:
-            v = device_.vppGetV();
-            response.resize(3);
-            response[0] = kCmdResponseOk;
-            createParamsFromFloat_(&response, v);
-            serial_.putBuf(response.data(), response.size());
-            break;
-        case kCmdVppGetDuty:
-            v = device_.vppGetDuty();
-            response.resize(3);
-            response[0] = kCmdResponseOk;
-            createParamsFromFloat_(&response, v);
-            serial_.putBuf(response.data(), response.size());
-            break;
-        case kCmdVppGetCal:
-            v = device_.vppGetCal();
-            response.resize(3);
-            response[0] = kCmdResponseOk;
-            createParamsFromFloat_(&response, v);
-            serial_.putBuf(response.data(), response.size());
-            break;
-        case kCmdVppInitCal:
-            serial_.putChar(kCmdResponseOk, true);
-            device_.vppInitCal();
-            break;
-        case kCmdVppSaveCal:
-            serial_.putChar(kCmdResponseOk, true);
-            device_.vppSaveCal(getParamAsFloat_());
-            break;
-        case kCmdVppOnA9:
-            serial_.putChar(kCmdResponseOk, true);
-            device_.vppOnA9(getParamAsBool_());
-            break;
-        case kCmdVppOnA18:
-            serial_.putChar(kCmdResponseOk, true);
-            device_.vppOnA18(getParamAsBool_());
-            break;
-        case kCmdVppOnCE:
-            serial_.putChar(kCmdResponseOk, true);
-            device_.vppOnCE(getParamAsBool_());
-            break;
-        case kCmdVppOnOE:
-            serial_.putChar(kCmdResponseOk, true);
-            device_.vppOnOE(getParamAsBool_());
-            break;
-        case kCmdVppOnWE:
-            serial_.putChar(kCmdResponseOk, true);
-            device_.vppOnWE(getParamAsBool_());
-            break;
+bool Runner::isAlgorithm_(uint8_t algo) {
+    switch (algo) {
+        case kCmdDeviceAlgorithmUnknown:
+        case kCmdDeviceAlgorithmSRAM:
+        case kCmdDeviceAlgorithmEPROM:
+        case kCmdDeviceAlgorithmEEPROM28C64:
+        case kCmdDeviceAlgorithmEEPROM28C256:
+        case kCmdDeviceAlgorithmFlash28F:
+        case kCmdDeviceAlgorithmFlashSST28SF:
+        case kCmdDeviceAlgorithmFlashAm28F:
+        case kCmdDeviceAlgorithmFlashI28F:
+            return true;
         default:
-            break;
+            return false;
     }
 }
 
-void Runner::runCtrlBusCommand_(uint8_t opcode) {
-    switch (opcode) {
-        case kCmdBusCE:
-            serial_.putChar(kCmdResponseOk, true);
-            device_.setCE(getParamAsBool_());
-            break;
-        case kCmdBusOE:
-            serial_.putChar(kCmdResponseOk, true);
-            device_.setOE(getParamAsBool_());
-            break;
-        case kCmdBusWE:
-            serial_.putChar(kCmdResponseOk, true);
-            device_.setWE(getParamAsBool_());
-            break;
-        default:
-            break;
+void Runner::putFrame_(uint8_t seq, const TByteArray &payload) {
+    TByteArray frame(3);
+    frame[0] = seq;
+    frame[1] = (payload.size() >> 8) & 0xFF;
+    frame[2] = payload.size() & 0xFF;
+    frame.insert(frame.end(), payload.begin(), payload.end());
+    uint16_t crc = Checksum::crc16(frame.data(), frame.size(), 0);
+    frame.push_back((crc >> 8) & 0xFF);
+    frame.push_back(crc & 0xFF);
+    serial_.putBuf(frame.data(), frame.size(), true);
+}
+
+void Runner::putChar_(char c, bool flush) {
+    if (framed_) {
+        frameOut_.push_back(c);
+    } else {
+        serial_.putChar(c, flush);
     }
 }
 
-void Runner::runAddrBusCommand_(uint8_t opcode) {
-    switch (opcode) {
-        case kCmdBusAddrClr:
-            if (device_.addrClr()) {
-                serial_.putChar(kCmdResponseOk);
-            } else {
-                serial_.putChar(kCmdResponseNok);
-            }
-            break;
-        case kCmdBusAddrInc:
-            if (device_.addrInc()) {
-                serial_.putChar(kCmdResponseOk);
-            } else {
-                serial_.putChar(kCmdResponseNok);
-            }
-            break;
-        case kCmdBusAddrSet:
-            if (device_.addrSet(getParamAsDWord_())) {
-                serial_.putChar(kCmdResponseOk);
-            } else {
-                serial_.putChar(kCmdResponseNok);
-            }
-            break;
-        case kCmdBusAddrSetB:
-            if (device_.addrSetB(getParamAsByte_())) {
-                serial_.putChar(kCmdResponseOk);
-            } else {
-                serial_.putChar(kCmdResponseNok);
-            }
-            break;
-        case kCmdBusAddrSetW:
-            if (device_.addrSetW(getParamAsWord_())) {
-                serial_.putChar(kCmdResponseOk);
-            } else {
-                serial_.putChar(kCmdResponseNok);
-            }
-            break;
-        default:
-            break;
+void Runner::putBuf_(const void *src, size_t len, bool flush) {
+    if (framed_) {
+        const uint8_t *p = static_cast<const uint8_t *>(src);
+        frameOut_.insert(frameOut_.end(), p, p + len);
+    } else {
+        serial_.putBuf(src, len, flush);
     }
 }
 
-void Runner::runDataBusCommand_(uint8_t opcode) {
-    uint16_t w;
-    TByteArray response;
+void Runner::discardCommand_(uint8_t opcode) {
     switch (opcode) {
-        case kCmdBusDataClr:
-            if (device_.dataClr()) {
-                serial_.putChar(kCmdResponseOk);
-            } else {
-                serial_.putChar(kCmdResponseNok);
-            }
-            break;
-        case kCmdBusDataSet:
-            if (device_.dataSet(getParamAsByte_())) {
-                serial_.putChar(kCmdResponseOk);
-            } else {
-                serial_.putChar(kCmdResponseNok);
-            }
-            break;
-        case kCmdBusDataSetW:
-            if (device_.dataSetW(getParamAsWord_())) {
-                serial_.putChar(kCmdResponseOk);
-            } else {
-                serial_.putChar(kCmdResponseNok);
-            }
-            break;
-        case kCmdBusDataGet:
-            w = device_.dataGet();
-            response.resize(2);
-            response[0] = kCmdResponseOk;
-            createParamsFromByte_(&response, w);
-            serial_.putBuf(response.data(), response.size());
+        case kCmdDeviceWrite:
+        case kCmdDeviceVerify:
+            readByte_(getParamAsByte_());
             break;
-        case kCmdBusDataGetW:
-            w = device_.dataGetW();
-            response.resize(3);
-            response[0] = kCmdResponseOk;
-            createParamsFromWord_(&response, w);
-            serial_.putBuf(response.data(), response.size());
+        case kCmdDeviceWriteSector:
+        case kCmdDeviceWriteW:
+        case kCmdDeviceVerifyW:
+            readByte_(getParamAsWord_());
             break;
         default:
             break;
     }
 }
 
-void Runner::runDeviceSettingsCommand_(uint8_t opcode) {
-    switch (opcode) {
-        case kCmdDeviceSetTwp:
-            serial_.putChar(kCmdResponseOk, true);
-            device_.setTwp(getParamAsDWord_());
-            break;
-        case kCmdDeviceSetTwc:
-            serial_.putChar(kCmdResponseOk, true);
-            device_.setTwc(getParamAsDWord_());
-            break;
-        case kCmdDeviceConfigure:
-            serial_.putChar(kCmdResponseOk, true);
-            device_.configure(getParamAsWord_());
-            break;
-        case kCmdDeviceSetupBus:
-            if (device_.setupBus(getParamAsByte_())) {
-                serial_.putChar(kCmdResponseOk, true);
-                sleep_ms(kStabilizationTime);
-            } else {
-                serial_.putChar(kCmdResponseNok);
-            }
-            break;
-        default:
-            break;
+void Runner::putResult_(bool success, bool fence) {
+    if (success) {
+        putChar_(kCmdResponseOk);
+        return;
+    }
+    putChar_(kCmdResponseNok);
+    // in a pipeline, the next commands are discarded
+    if (fence) fenced_ = tagged_;
+}
+
+void Runner::putFloat_(float value) {
+    TByteArray response(3);
+    response[0] = kCmdResponseOk;
+    createParamsFromFloat_(&response, value);
+    putBuf_(response.data(), response.size());
+}
+
+void Runner::nop_() {
+    putChar_(kCmdResponseOk);
+}
+
+void Runner::vddCtrl_() {
+    putChar_(kCmdResponseOk, true);
+    device_.vddCtrl(getParamAsBool_());
+}
+
+void Runner::vddSetV_() {
+    putChar_(kCmdResponseOk, true);
+    device_.vddSetV(getParamAsFloat_());
+}
+
+void Runner::vddGetV_() {
+    putFloat_(device_.vddGetV());
+}
+
+void Runner::vddGetDuty_() {
+    putFloat_(device_.vddGetDuty());
+}
+
+void Runner::vddGetCal_() {
+    putFloat_(device_.vddGetCal());
+}
+
+void Runner::vddInitCal_() {
+    putChar_(kCmdResponseOk, true);
+    device_.vddInitCal();
+}
+
+void Runner::vddSaveCal_() {
+    putChar_(kCmdResponseOk, true);
+    device_.vddSaveCal(getParamAsFloat_());
+}
+
+void Runner::vddOnVpp_() {
+    putChar_(kCmdResponseOk, true);
+    device_.vddOnVpp(getParamAsBool_());
+}
+
+void Runner::vppCtrl_() {
+    putChar_(kCmdResponseOk, true);
+    device_.vppCtrl(getParamAsBool_());
+}
+
+void Runner::vppSetV_() {
+    putChar_(kCmdResponseOk, true);
+    device_.vppSetV(getParamAsFloat_());
+}
+
+void Runner::vppGetV_() {
+    putFloat_(device_.vppGetV());
+}
+
+void Runner::vppGetDuty_() {
+    putFloat_(device_.vppGetDuty());
+}
+
+void Runner::vppGetCal_() {
+    putFloat_(device_.vppGetCal());
+}
+
+void Runner::vppInitCal_() {
+    putChar_(kCmdResponseOk, true);
+    device_.vppInitCal();
+}
+
+void Runner::vppSaveCal_() {
+    putChar_(kCmdResponseOk, true);
+    device_.vppSaveCal(getParamAsFloat_());
+}
+
+void Runner::vppOnA9_() {
+    putChar_(kCmdResponseOk, true);
+    device_.vppOnA9(getParamAsBool_());
+}
+
+void Runner::vppOnA18_() {
+    putChar_(kCmdResponseOk, true);
+    device_.vppOnA18(getParamAsBool_());
+}
+
+void Runner::vppOnCE_() {
+    putChar_(kCmdResponseOk, true);
+    device_.vppOnCE(getParamAsBool_());
+}
+
+void Runner::vppOnOE_() {
+    putChar_(kCmdResponseOk, true);
+    device_.vppOnOE(getParamAsBool_());
+}
+
+void Runner::vppOnWE_() {
+    putChar_(kCmdResponseOk, true);
+    device_.vppOnWE(getParamAsBool_());
+}
+
+void Runner::busCE_() {
+    putChar_(kCmdResponseOk, true);
+    device_.setCE(getParamAsBool_());
+}
+
+void Runner::busOE_() {
+    putChar_(kCmdResponseOk, true);
+    device_.setOE(getParamAsBool_());
+}
+
+void Runner::busWE_() {
+    putChar_(kCmdResponseOk, true);
+    device_.setWE(getParamAsBool_());
+}
+
+void Runner::addrClr_() {
+    putResult_(device_.addrClr());
+}
+
+void Runner::addrInc_() {
+    putResult_(device_.addrInc());
+}
+
+void Runner::addrSet_() {
+    putResult_(device_.addrSet(getParamAsDWord_()));
+}
+
+void Runner::addrSetB_() {
+    putResult_(device_.addrSetB(getParamAsByte_()));
+}
+
+void Runner::addrSetW_() {
+    putResult_(device_.addrSetW(getParamAsWord_()));
+}
+
+void Runner::dataClr_() {
+    putResult_(device_.dataClr());
+}
+
+void Runner::dataSet_() {
+    putResult_(device_.dataSet(getParamAsByte_()));
+}
+
+void Runner::dataSetW_() {
+    putResult_(device_.dataSetW(getParamAsWord_()));
+}
+
+void Runner::dataGet_() {
+    TByteArray response(2);
+    response[0] = kCmdResponseOk;
+    createParamsFromByte_(&response, device_.dataGet());
+    putBuf_(response.data(), response.size());
+}
+
+void Runner::dataGetW_() {
+    TByteArray response(3);
+    response[0] = kCmdResponseOk;
+    createParamsFromWord_(&response, device_.dataGetW());
+    putBuf_(response.data(), response.size());
+}
+
+void Runner::deviceSetTwp_() {
+    putChar_(kCmdResponseOk, true);
+    device_.setTwp(getParamAsDWord_());
+}
+
+void Runner::deviceSetTwc_() {
+    putChar_(kCmdResponseOk, true);
+    device_.setTwc(getParamAsDWord_());
+}
+
+void Runner::deviceConfigure_() {
+    putChar_(kCmdResponseOk, true);
+    device_.configure(getParamAsWord_());
+}
+
+void Runner::deviceSetupBus_() {
+    if (device_.setupBus(getParamAsByte_())) {
+        putChar_(kCmdResponseOk, true);
+        sleep_ms(kStabilizationTime);
+    } else {
+        putChar_(kCmdResponseNok);
+    }
+}
+
+void Runner::deviceSetup_() {
+    const uint8_t *params = command_.data();
+    uint16_t config = OpCode::getValueAsWord(params, 3);
+    float vdd = OpCode::getValueAsFloat(params + 2, 3);
+    float vpp = OpCode::getValueAsFloat(params + 4, 3);
+    uint32_t twp = OpCode::getValueAsDWord(params + 6, 5);
+    uint32_t twc = OpCode::getValueAsDWord(params + 10, 5);
+    uint8_t operation = params[15];
+    uint8_t keep = params[16];
+    // validates all the params before applying any of them
+    if (!isAlgorithm_(config >> 8) || operation > kCmdDeviceOperationGetId ||
+        vdd > kVddMaximum || vpp > kVppMaximum) {
+        putChar_(kCmdResponseNok);
+        fenced_ = tagged_;
+        return;
+    }
+    device_.configure(config);
+    if (!(keep & kCmdDeviceSetupKeepTwp)) device_.setTwp(twp);
+    if (!(keep & kCmdDeviceSetupKeepTwc)) device_.setTwc(twc);
+    if (!(keep & kCmdDeviceSetupKeepVdd)) device_.vddSetV(vdd);
+    if (!(keep & kCmdDeviceSetupKeepVpp)) device_.vppSetV(vpp);
+    if (device_.setupBus(operation)) {
+        putChar_(kCmdResponseOk, true);
+        sleep_ms(kStabilizationTime);
+    } else {
+        // bus error: the settings are kept (as with Device Setup Bus)
+        putChar_(kCmdResponseNok);
+        fenced_ = tagged_;
     }
 }
 
-void Runner::runDeviceReadCommand_(uint8_t opcode) {
-    TByteArray response;
-    uint8_t blockSize;
+void Runner::deviceRead_() {
+    readBlock_(getParamAsByte_());
+}
+
+void Runner::deviceReadW_() {
+    readBlock_(getParamAsWord_());
+}
+
+void Runner::readBlock_(uint16_t size) {
     bool is16bit = device_.getSettings().flags.is16bit;
-    switch (opcode) {
-        case kCmdDeviceRead:
-            blockSize = getParamAsByte_();
-            response = device_.read(is16bit ? (blockSize / 2) : blockSize);
-            if (response.size() == blockSize) {
-                response.insert(response.begin(), kCmdResponseOk);
-                serial_.putBuf(response.data(), response.size());
-            } else {
-                serial_.putChar(kCmdResponseNok);
-            }
-            break;
-        default:
-            break;
+    TByteArray response = device_.read(is16bit ? (size / 2) : size);
+    if (response.size() == size) {
+        response.insert(response.begin(), kCmdResponseOk);
+        putBuf_(response.data(), response.size());
+    } else {
+        putResult_(false, true);
     }
 }
 
-void Runner::runDeviceWriteCommand_(uint8_t opcode) {
-    TByteArray buffer;
-    uint16_t sectorSize;
+void Runner::deviceReadRange_() {
+    readRange_(OpCode::getValueAsDWord(command_.data(), 4),
+               OpCode::getValueAsDWord(command_.data() + 3, 4));
+}
+
+void Runner::readRange_(uint32_t addr, uint32_t size) {
     bool is16bit = device_.getSettings().flags.is16bit;
-    switch (opcode) {
-        case kCmdDeviceWrite:
-            sectorSize = getParamAsByte_();
-            buffer = readByte_(sectorSize);
-            if (device_.write(buffer, is16bit ? (sectorSize / 2) : sectorSize,
-                              true)) {
-                serial_.putChar(kCmdResponseOk);
-            } else {
-                serial_.putChar(kCmdResponseNok);
-            }
-            break;
-        case kCmdDeviceWriteSector:
-            sectorSize = getParamAsWord_();
-            buffer = readByte_(sectorSize);
-            if (device_.writeSector(
-                    buffer, is16bit ? (sectorSize / 2) : sectorSize, true)) {
-                serial_.putChar(kCmdResponseOk);
-            } else {
-                serial_.putChar(kCmdResponseNok);
-            }
-            break;
-        default:
-            break;
+    if ((is16bit && (size % 2)) || (size && !device_.addrSet(addr))) {
+        putChar_(kCmdResponseNok);
+        fenced_ = tagged_;
+        return;
+    }
+    putChar_(kCmdResponseOk);
+    bool rle = (encoding_ == kCmdProtoEncodingRle);
+    TByteArray chunk, encoded;
+    size_t len, encodedLen;
+    uint16_t crc;
+    if (rle) encoded.resize(Rle::maxEncodedSize(kCmdStreamChunkSize) + 5);
+    while (size) {
+        // any byte from host cancels the stream
+        if (serial_.getChar(0) != PICO_ERROR_TIMEOUT) break;
+        len = (size < kCmdStreamChunkSize) ? size : kCmdStreamChunkSize;
+        chunk = device_.read(is16bit ? (len / 2) : len);
+        if (chunk.size() != len) break;
+        crc = Checksum::crc16(chunk.data(), chunk.size());
+        if (rle) {
+            // OK + encoded length + encoded data + CRC16 (of decoded data)
+            encodedLen = Rle::encode(chunk.data(), len, encoded.data() + 3);
+            encoded[0] = kCmdResponseOk;
+            encoded[1] = (encodedLen >> 8) & 0xFF;
+            encoded[2] = encodedLen & 0xFF;
+            encoded[encodedLen + 3] = (crc >> 8) & 0xFF;
+            encoded[encodedLen + 4] = crc & 0xFF;
+            putBuf_(encoded.data(), encodedLen + 5);
+        } else {
+            chunk.insert(chunk.begin(), kCmdResponseOk);
+            chunk.push_back((crc >> 8) & 0xFF);
+            chunk.push_back(crc & 0xFF);
+            putBuf_(chunk.data(), chunk.size());
+        }
+        gpio_.togglePin(PICO_DEFAULT_LED_PIN);
+        size -= len;
+    }
+    if (size) {
+        // error or canceled
+        putChar_(kCmdResponseNok);
+        fenced_ = tagged_;
     }
 }
 
-void Runner::runDeviceVerifyCommand_(uint8_t opcode) {
-    TByteArray buffer;
-    uint8_t blockSize;
+void Runner::deviceWrite_() {
+    writeBlock_(getParamAsByte_(), false);
+}
+
+void Runner::deviceWriteW_() {
+    writeBlock_(getParamAsWord_(), false);
+}
+
+void Runner::deviceWriteSector_() {
+    writeBlock_(getParamAsWord_(), true);
+}
+
+void Runner::writeBlock_(uint16_t size, bool sector) {
     bool is16bit = device_.getSettings().flags.is16bit;
-    switch (opcode) {
-        case kCmdDeviceVerify:
-            blockSize = getParamAsByte_();
-            buffer = readByte_(blockSize);
-            if (device_.verify(buffer, is16bit ? (blockSize / 2) : blockSize)) {
-                serial_.putChar(kCmdResponseOk);
-            } else {
-                serial_.putChar(kCmdResponseNok);
+    TByteArray buffer = readByte_(size);
+    uint16_t len = is16bit ? (size / 2) : size;
+    putResult_(sector ? device_.writeSector(buffer, len, true)
+                      : device_.write(buffer, len, true),
+               true);
+}
+
+void Runner::deviceWriteRange_() {
+    writeRange_(OpCode::getValueAsDWord(command_.data(), 4),
+                OpCode::getValueAsDWord(command_.data() + 3, 4),
+                OpCode::getValueAsWord(command_.data() + 6, 3),
+                OpCode::getValueAsBool(command_.data() + 8, 2));
+}
+
+void Runner::writeRange_(uint32_t addr, uint32_t size, uint16_t block,
+                         bool sector) {
+    bool is16bit = device_.getSettings().flags.is16bit;
+    bool rle = (encoding_ == kCmdProtoEncodingRle);
+    // one slot per block: [encoded length] + data + CRC16
+    size_t slot = rle ? (Rle::maxEncodedSize(block) + 4) : (block + 2);
+    size_t credits = kCommRingSize / slot;
+    if (credits > 0xFF) credits = 0xFF;
+    TByteArray response(2);
+    if (size && (!block || block > kCmdStreamChunkSize || (size % block) ||
+                 (is16bit && (block % 2)) || !device_.addrSet(addr))) {
+        response[0] = kCmdResponseNok;
+        response[1] = 0;
+        putBuf_(response.data(), response.size());
+        fenced_ = tagged_;
+        return;
+    }
+    response[0] = kCmdResponseOk;
+    response[1] = credits;
+    putBuf_(response.data(), response.size());
+    if (!size) return;
+    // receive ring (slots of blocks + CRC), filled while programming
+    TByteArray ring(credits * slot);
+    TByteArray buffer(block);
+    size_t blocks = size / block;
+    size_t head = 0, tail = 0, queued = 0, pos = 0, len = 0;
+    size_t encoded, decoded;
+    size_t expect = rle ? 2 : slot;
+    size_t received = 0, programmed = 0;
+    uint8_t *data;
+    uint16_t crc;
+    int c;
+    bool success = true;
+    while (programmed < blocks) {
+        // receive the bytes already available (waits for a whole block)
+        while (received < blocks && queued < credits) {
+            c = serial_.getChar(queued ? 0 : kCommStreamTimeOut * 1000);
+            if (c == PICO_ERROR_TIMEOUT) break;
+            ring[head * slot + pos] = c & 0xFF;
+            if (rle && pos < 2) len = ((len << 8) | (c & 0xFF)) & 0xFFFF;
+            pos++;
+            if (rle && pos == 2) {
+                expect = len + 4;
+                // encoded block larger than the slot
+                if (expect > slot) {
+                    success = false;
+                    break;
+                }
             }
-            break;
-        case kCmdDeviceBlankCheck:
-            blockSize = getParamAsByte_();
-            if (device_.blankCheck(is16bit ? (blockSize / 2) : blockSize)) {
-                serial_.putChar(kCmdResponseOk);
-            } else {
-                serial_.putChar(kCmdResponseNok);
+            if (pos == expect) {
+                head = (head + 1) % credits;
+                queued++;
+                received++;
+                pos = len = 0;
+                expect = rle ? 2 : slot;
             }
+        }
+        if (!success || !queued) {
+            success = false;
             break;
-        default:
+        }
+        data = ring.data() + tail * slot;
+        tail = (tail + 1) % credits;
+        queued--;
+        if (rle) {
+            encoded = (data[0] << 8) | data[1];
+            if (!Rle::decode(data + 2, encoded, buffer.data(), block,
+                             decoded) ||
+                decoded != block) {
+                success = false;
+                break;
+            }
+            data += encoded + 2;
+        } else {
+            memcpy(buffer.data(), data, block);
+            data += block;
+        }
+        crc = (data[0] << 8) | data[1];
+        if (Checksum::crc16(buffer.data(), buffer.size()) != crc) {
+            // CRC error (or canceled by host)
+            success = false;
             break;
+        }
+        if (sector) {
+            success = device_.writeSector(
+                buffer, is16bit ? (block / 2) : block, true);
+        } else {
+            success = device_.write(buffer, is16bit ? (block / 2) : block,
+                                    true);
+        }
+        if (!success) break;
+        programmed++;
+        putChar_(kCmdResponseOk);
+        gpio_.togglePin(PICO_DEFAULT_LED_PIN);
+    }
+    if (success) return;
+    putChar_(kCmdResponseNok);
+    fenced_ = tagged_;
+    // discards the blocks that the host is allowed to send
+    size_t total = programmed + credits;
+    if (total > blocks) total = blocks;
+    while (received < total) {
+        c = serial_.getChar(kCommStreamTimeOut * 1000);
+        if (c == PICO_ERROR_TIMEOUT) break;
+        if (rle && pos < 2) len = ((len << 8) | (c & 0xFF)) & 0xFFFF;
+        pos++;
+        if (rle && pos == 2) expect = len + 4;
+        if (pos == expect) {
+            received++;
+            pos = len = 0;
+            expect = rle ? 2 : slot;
+        }
     }
 }
 
-void Runner::runDeviceGetIdCommand_(uint8_t opcode) {
-    uint32_t dw;
-    TByteArray response;
-    switch (opcode) {
-        case kCmdDeviceGetId:
-            if (device_.getId(dw)) {
-                // response
-                response.resize(5);
-                response[0] = kCmdResponseOk;
-                createParamsFromDWord_(&response, dw);
-                serial_.putBuf(response.data(), response.size());
-            } else {
-                serial_.putChar(kCmdResponseNok);
-            }
-            break;
-        default:
+void Runner::deviceVerify_() {
+    verifyBlock_(getParamAsByte_());
+}
+
+void Runner::deviceVerifyW_() {
+    verifyBlock_(getParamAsWord_());
+}
+
+void Runner::verifyBlock_(uint16_t size) {
+    bool is16bit = device_.getSettings().flags.is16bit;
+    TByteArray buffer = readByte_(size);
+    putResult_(device_.verify(buffer, is16bit ? (size / 2) : size), true);
+}
+
+void Runner::deviceBlankCheck_() {
+    blankCheckBlock_(getParamAsByte_());
+}
+
+void Runner::deviceBlankCheckW_() {
+    blankCheckBlock_(getParamAsWord_());
+}
+
+void Runner::blankCheckBlock_(uint16_t size) {
+    bool is16bit = device_.getSettings().flags.is16bit;
+    putResult_(device_.blankCheck(is16bit ? (size / 2) : size), true);
+}
+
+void Runner::deviceCrc32Range_() {
+    crc32Range_(OpCode::getValueAsDWord(command_.data(), 4),
+                OpCode::getValueAsDWord(command_.data() + 3, 4));
+}
+
+void Runner::deviceBlankCheckRange_() {
+    blankCheckRange_(OpCode::getValueAsDWord(command_.data(), 4),
+                     OpCode::getValueAsDWord(command_.data() + 3, 4));
+}
+
+void Runner::crc32Range_(uint32_t addr, uint32_t size) {
+    bool is16bit = device_.getSettings().flags.is16bit;
+    bool success =
+        !(is16bit && (size % 2)) && (!size || device_.addrSet(addr));
+    uint32_t crc = 0;
+    TByteArray chunk;
+    size_t len;
+    while (success && size) {
+        len = (size < kCmdStreamChunkSize) ? size : kCmdStreamChunkSize;
+        chunk = device_.read(is16bit ? (len / 2) : len);
+        if (chunk.size() != len) {
+            success = false;
             break;
+        }
+        crc = Checksum::crc32(chunk.data(), chunk.size(), crc);
+        gpio_.togglePin(PICO_DEFAULT_LED_PIN);
+        size -= len;
     }
+    if (!success && tagged_) {
+        // in a pipeline, a NOK has no result
+        putChar_(kCmdResponseNok);
+        fenced_ = true;
+        return;
+    }
+    TByteArray response(5);
+    response[0] = success ? kCmdResponseOk : kCmdResponseNok;
+    createParamsFromDWord_(&response, success ? crc : 0);
+    putBuf_(response.data(), response.size());
 }
 
-void Runner::runDeviceEraseCommand_(uint8_t opcode) {
-    switch (opcode) {
-        case kCmdDeviceErase:
-            if (device_.erase()) {
-                // response
-                serial_.putChar(kCmdResponseOk);
-            } else {
-                serial_.putChar(kCmdResponseNok);
-            }
-            break;
-        default:
-            break;
+void Runner::blankCheckRange_(uint32_t addr, uint32_t size) {
+    bool is16bit = device_.getSettings().flags.is16bit;
+    size_t dirty = 0, first = 0;
+    bool success = !(is16bit && (size % 2)) &&
+                   (!size || (device_.addrSet(addr) &&
+                              device_.blankCheckRange(
+                                  is16bit ? (size / 2) : size, dirty, first)));
+    if (!success && tagged_) {
+        // in a pipeline, a NOK has no result
+        putChar_(kCmdResponseNok);
+        fenced_ = true;
+        return;
     }
+    TByteArray response(9);
+    response[0] = success ? kCmdResponseOk : kCmdResponseNok;
+    OpCode::setDWord(response.data(), 5, (success && dirty) ? addr + first : 0);
+    OpCode::setDWord(response.data() + 4, 5, success ? dirty : 0);
+    putBuf_(response.data(), response.size());
 }
 
-void Runner::runDeviceProtectCommand_(uint8_t opcode) {
-    switch (opcode) {
-        case kCmdDeviceProtect:
-            if (device_.protect()) {
-                // response
-                serial_.putChar(kCmdResponseOk);
-            } else {
-                serial_.putChar(kCmdResponseNok);
-            }
-            break;
-        case kCmdDeviceUnprotect:
-            if (device_.unprotect()) {
-                // response
-                serial_.putChar(kCmdResponseOk);
-            } else {
-                serial_.putChar(kCmdResponseNok);
-            }
-            break;
-        default:
-            break;
+void Runner::deviceGetId_() {
+    uint32_t id;
+    if (!device_.getId(id)) {
+        putChar_(kCmdResponseNok);
+        return;
     }
+    TByteArray response(5);
+    response[0] = kCmdResponseOk;
+    createParamsFromDWord_(&response, id);
+    putBuf_(response.data(), response.size());
+}
+
+void Runner::deviceErase_() {
+    putResult_(device_.erase());
+}
+
+void Runner::deviceProtect_() {
+    putResult_(device_.protect());
+}
+
+void Runner::deviceUnprotect_() {
+    putResult_(device_.unprotect());
 }
 
 bool Runner::getParamAsBool_() {
@@ -18,6 +18,7 @@
 #ifndef MODULES_RUNNER_HPP_
 #define MODULES_RUNNER_HPP_
 
+#include <array>
 #include <vector>
 #include "hal/serial.hpp"
 #include "hal/gpio.hpp"
@@ -59,6 +60,50 @@ class Runner {
     TByteArray command_;
     /* @brief Device Handler instance. */
     Device device_;
+    /* @brief Indicates if the current command is tagged. */
+    bool tagged_;
+    /* @brief Indicates if a tagged command failed (discards the next). */
+    bool fenced_;
+    /* @brief Encoding of the stream of the current command. */
+    uint8_t encoding_;
+    /* @brief Indicates if a framed command is running. */
+    bool framed_;
+    /* @brief Payload (command and data) of the running frame. */
+    TByteArray frameIn_;
+    /* @brief Read position into the payload of the running frame. */
+    size_t framePos_;
+    /* @brief Response of the last frame (resent on retransmission). */
+    TByteArray frameOut_;
+    /* @brief Sequence of the last frame, or -1 if none. */
+    int frameSeq_;
+    /* @brief Runs the received command (handler of an opcode). */
+    typedef void (Runner::*THandler)();
+    /* @brief Entry of the table of handlers. */
+    typedef struct {
+        /* @brief Code of the opcode. */
+        uint8_t code;
+        /* @brief Number of params, in bytes (as in kCmdOpCodes). */
+        uint8_t params;
+        /* @brief Size of the response, in bytes (as in kCmdOpCodes). */
+        uint16_t result;
+        /* @brief Handler of the opcode. */
+        THandler handler;
+    } THandlerEntry;
+    /* @brief Handlers of the opcodes (one for each opcode). */
+    static const THandlerEntry kHandlers_[];
+    /* @brief Number of handlers. */
+    static const size_t kHandlerCount_;
+    /* @brief Index of a code without handler, in the dispatch table. */
+    static constexpr uint8_t kNoHandler_ = 0xFF;
+    /* @brief Dispatch table: index of each code into kHandlers_. */
+    static const std::array<uint8_t, 256> kDispatch_;
+    /* @brief Builds the dispatch table (at compile time). */
+    static constexpr std::array<uint8_t, 256> makeDispatch_();
+    /*
+     * @brief Checks (at compile time) if each opcode has one handler, with
+     *   the sizes of kCmdOpCodes.
+     */
+    static constexpr bool hasHandlers_();
     /*
      * @brief Reads bytes from serial.
      * @param len Number of bytes (default is one).
@@ -66,11 +111,11 @@ class Runner {
      */
     TByteArray readByte_(size_t len = 1);
     /*
-     * @brief Finds the opcode into the command string.
-     * @return Constant iterator to opcode map.
-     *  TCmdOpCodeMap::end() if not found.
+     * @brief Finds the handler of the opcode into the command string.
+     * @return Pointer to the entry in kHandlers_, or nullptr if not
+     *  found.
      */
-    TCmdOpCodeMap::const_iterator findOpCode_();
+    const THandlerEntry *findHandler_();
     /*
      * @brief Gets the first parameter as boolean.
      * @return Parameter as boolean.
@@ -126,67 +171,231 @@ class Runner {
     void createParamsFromDWord_(TByteArray *response, u_int32_t src);
     /* @brief Runs the received command. */
     void runCommand_();
+    /* @brief Receives, checks and runs a framed command (Frame opcode). */
+    void runFrame_();
+    /* @brief Sends the capabilities of the firmware (Caps opcode). */
+    void getCaps_();
     /*
-     * @brief Runs the received command, if it's a VDD Generator opcode.
+     * @brief Checks if an opcode can be framed.
      * @param opcode Opcode of the command.
+     * @return True if it can be framed, false otherwise.
      */
-    void runVddCommand_(uint8_t opcode);
+    bool isFrameable_(uint8_t opcode);
     /*
-     * @brief Runs the received command, if it's a VPP Generator opcode.
-     * @param opcode Opcode of the command.
+     * @brief Sends a response frame.
+     * @param seq Sequence number.
+     * @param payload Response of the command (empty if rejected).
      */
-    void runVppCommand_(uint8_t opcode);
+    void putFrame_(uint8_t seq, const TByteArray &payload);
     /*
-     * @brief Runs the received command, if it's a Ctrl Bus opcode.
-     * @param opcode Opcode of the command.
+     * @brief Sends a char, or appends it to the response of the running
+     *   frame.
+     * @param c Char to send.
+     * @param flush If true, flushes the output. Default is false.
      */
-    void runCtrlBusCommand_(uint8_t opcode);
+    void putChar_(char c, bool flush = false);
     /*
-     * @brief Runs the received command, if it's an Address Bus opcode.
-     * @param opcode Opcode of the command.
+     * @brief Sends a buffer, or appends it to the response of the running
+     *   frame.
+     * @param src Buffer to send.
+     * @param len Size of the buffer, in bytes.
+     * @param flush If true, flushes the output. Default is false.
      */
-    void runAddrBusCommand_(uint8_t opcode);
+    void putBuf_(const void *src, size_t len, bool flush = false);
     /*
-     * @brief Runs the received command, if it's a Data Bus opcode.
-     * @param opcode Opcode of the command.
+     * @brief Checks if a value is a known device algorithm.
+     * @param algo Algorithm (see kCmdDeviceAlgorithmEnum).
+     * @return True if known, false otherwise.
      */
-    void runDataBusCommand_(uint8_t opcode);
+    bool isAlgorithm_(uint8_t algo);
     /*
-     * @brief Runs the received command, if it's a Device Settings opcode.
+     * @brief Discards the data that follows the received command
+     *   (if any), without running it.
      * @param opcode Opcode of the command.
      */
-    void runDeviceSettingsCommand_(uint8_t opcode);
+    void discardCommand_(uint8_t opcode);
     /*
-     * @brief Runs the received command, if it's a Device Read opcode.
-     * @param opcode Opcode of the command.
+     * @brief Sends the result of a command (OK or NOK).
+     * @param success True to send OK, false to send NOK.
+     * @param fence If true, a NOK discards the next commands of a
+     *   pipeline.
      */
-    void runDeviceReadCommand_(uint8_t opcode);
+    void putResult_(bool success, bool fence = false);
     /*
-     * @brief Runs the received command, if it's a Device Write opcode.
-     * @param opcode Opcode of the command.
+     * @brief Sends OK and a float point value.
+     * @param value Value to send.
      */
-    void runDeviceWriteCommand_(uint8_t opcode);
+    void putFloat_(float value);
+    /* @brief Runs the NOP opcode. */
+    void nop_();
+    /* @brief Runs the Tag opcode (echoes the tag of the next command). */
+    void protoTag_();
+    /* @brief Runs the Encoding opcode (of the next command). */
+    void protoEncoding_();
+    /* @brief Runs the VDD Ctrl opcode. */
+    void vddCtrl_();
+    /* @brief Runs the VDD Set opcode. */
+    void vddSetV_();
+    /* @brief Runs the VDD Get opcode. */
+    void vddGetV_();
+    /* @brief Runs the VDD Get Duty opcode. */
+    void vddGetDuty_();
+    /* @brief Runs the VDD Get Calibration opcode. */
+    void vddGetCal_();
+    /* @brief Runs the VDD Init Calibration opcode. */
+    void vddInitCal_();
+    /* @brief Runs the VDD Save Calibration opcode. */
+    void vddSaveCal_();
+    /* @brief Runs the VDD on VPP opcode. */
+    void vddOnVpp_();
+    /* @brief Runs the VPP Ctrl opcode. */
+    void vppCtrl_();
+    /* @brief Runs the VPP Set opcode. */
+    void vppSetV_();
+    /* @brief Runs the VPP Get opcode. */
+    void vppGetV_();
+    /* @brief Runs the VPP Get Duty opcode. */
+    void vppGetDuty_();
+    /* @brief Runs the VPP Get Calibration opcode. */
+    void vppGetCal_();
+    /* @brief Runs the VPP Init Calibration opcode. */
+    void vppInitCal_();
+    /* @brief Runs the VPP Save Calibration opcode. */
+    void vppSaveCal_();
+    /* @brief Runs the VPP on A9 opcode. */
+    void vppOnA9_();
+    /* @brief Runs the VPP on A18 opcode. */
+    void vppOnA18_();
+    /* @brief Runs the VPP on CE opcode. */
+    void vppOnCE_();
+    /* @brief Runs the VPP on OE opcode. */
+    void vppOnOE_();
+    /* @brief Runs the VPP on WE opcode. */
+    void vppOnWE_();
+    /* @brief Runs the CE opcode. */
+    void busCE_();
+    /* @brief Runs the OE opcode. */
+    void busOE_();
+    /* @brief Runs the WE opcode. */
+    void busWE_();
+    /* @brief Runs the Address Clear opcode. */
+    void addrClr_();
+    /* @brief Runs the Address Increment opcode. */
+    void addrInc_();
+    /* @brief Runs the Address Set opcode. */
+    void addrSet_();
+    /* @brief Runs the Address Set Byte opcode. */
+    void addrSetB_();
+    /* @brief Runs the Address Set Word opcode. */
+    void addrSetW_();
+    /* @brief Runs the Data Clear opcode. */
+    void dataClr_();
+    /* @brief Runs the Data Set opcode. */
+    void dataSet_();
+    /* @brief Runs the Data Set Word opcode. */
+    void dataSetW_();
+    /* @brief Runs the Data Get opcode. */
+    void dataGet_();
+    /* @brief Runs the Data Get Word opcode. */
+    void dataGetW_();
+    /* @brief Runs the Device Set tWP opcode. */
+    void deviceSetTwp_();
+    /* @brief Runs the Device Set tWC opcode. */
+    void deviceSetTwc_();
+    /* @brief Runs the Device Configure opcode. */
+    void deviceConfigure_();
+    /* @brief Runs the Device Setup Bus opcode. */
+    void deviceSetupBus_();
     /*
-     * @brief Runs the received command, if it's a Device Verify opcode.
-     * @param opcode Opcode of the command.
+     * @brief Sets up a device session at once (Device Setup opcode).
      */
-    void runDeviceVerifyCommand_(uint8_t opcode);
+    void deviceSetup_();
+    /* @brief Runs the Device Read opcode. */
+    void deviceRead_();
+    /* @brief Runs the Device Read Word opcode. */
+    void deviceReadW_();
     /*
-     * @brief Runs the received command, if it's a Device Get ID opcode.
-     * @param opcode Opcode of the command.
+     * @brief Reads a block of the device.
+     * @param size Size of the block, in bytes.
      */
-    void runDeviceGetIdCommand_(uint8_t opcode);
+    void readBlock_(uint16_t size);
+    /* @brief Runs the Device Read Range opcode. */
+    void deviceReadRange_();
     /*
-     * @brief Runs the received command, if it's a Device Erase opcode.
-     * @param opcode Opcode of the command.
+     * @brief Streams a range of the device (Read Range opcode).
+     * @param addr Start address.
+     * @param size Size of the range, in bytes.
      */
-    void runDeviceEraseCommand_(uint8_t opcode);
+    void readRange_(uint32_t addr, uint32_t size);
+    /* @brief Runs the Device Write opcode. */
+    void deviceWrite_();
+    /* @brief Runs the Device Write Word opcode. */
+    void deviceWriteW_();
+    /* @brief Runs the Device Write Sector opcode. */
+    void deviceWriteSector_();
     /*
-     * @brief Runs the received command, if it's a Device
-     *   Protect/Unprotect opcode.
-     * @param opcode Opcode of the command.
+     * @brief Writes a block received after the command to the device.
+     * @param size Size of the block, in bytes.
+     * @param sector If true, writes the block as a sector.
+     */
+    void writeBlock_(uint16_t size, bool sector);
+    /* @brief Runs the Device Write Range opcode. */
+    void deviceWriteRange_();
+    /*
+     * @brief Programs a range of the device from a stream of blocks
+     *   (Write Range opcode).
+     * @param addr Start address.
+     * @param size Size of the range, in bytes.
+     * @param block Block size, in bytes.
+     * @param sector If true, writes the blocks as sectors.
+     */
+    void writeRange_(uint32_t addr, uint32_t size, uint16_t block,
+                     bool sector);
+    /* @brief Runs the Device Verify opcode. */
+    void deviceVerify_();
+    /* @brief Runs the Device Verify Word opcode. */
+    void deviceVerifyW_();
+    /*
+     * @brief Verifies the device against a block received after the
+     *   command.
+     * @param size Size of the block, in bytes.
+     */
+    void verifyBlock_(uint16_t size);
+    /* @brief Runs the Device Blank Check opcode. */
+    void deviceBlankCheck_();
+    /* @brief Runs the Device Blank Check Word opcode. */
+    void deviceBlankCheckW_();
+    /*
+     * @brief Blank checks a block of the device.
+     * @param size Size of the block, in bytes.
+     */
+    void blankCheckBlock_(uint16_t size);
+    /* @brief Runs the Device CRC32 Range opcode. */
+    void deviceCrc32Range_();
+    /*
+     * @brief Calculates the CRC-32 of a range of the device
+     *   (CRC32 Range opcode).
+     * @param addr Start address.
+     * @param size Size of the range, in bytes.
+     */
+    void crc32Range_(uint32_t addr, uint32_t size);
+    /* @brief Runs the Device Blank Check Range opcode. */
+    void deviceBlankCheckRange_();
+    /*
+     * @brief Blank checks a range of the device, counting the non-blank
+     *   cells (Blank Check Range opcode).
+     * @param addr Start address.
+     * @param size Size of the range, in bytes.
      */
-    void runDeviceProtectCommand_(uint8_t opcode);
+    void blankCheckRange_(uint32_t addr, uint32_t size);
+    /* @brief Runs the Device Get ID opcode. */
+    void deviceGetId_();
+    /* @brief Runs the Device Erase opcode. */
+    void deviceErase_();
+    /* @brief Runs the Device Protect opcode. */
+    void deviceProtect_();
+    /* @brief Runs the Device Unprotect opcode. */
+    void deviceUnprotect_();
 };
 
 #endif  // MODULES_RUNNER_HPP_
@@ -69,18 +69,21 @@ extern "C" inline void gpio_set_dir(uint gpio, bool out) {}
 
 extern "C" inline void gpio_put(uint gpio, bool value) {
     gpioData[gpio] = value;
+    if (mockHooks.gpioPut) mockHooks.gpioPut(gpio, value);
 }
 
 extern "C" inline void gpio_xor_mask(uint32_t mask) {
     for (uint bit = 0; bit < 32; bit++) {
-        if (mask | (1 << bit)) {
+        if (mask & (1u << bit)) {
             gpioData[bit] = !(gpioData[bit]);
+            if (mockHooks.gpioPut) mockHooks.gpioPut(bit, gpioData[bit]);
         }
     }
 }
 
 extern "C" inline bool gpio_get(uint gpio) {
-    return gpioData[gpio];
+    int value = mockHooks.gpioGet ? mockHooks.gpioGet(gpio) : -1;
+    return (value < 0) ? gpioData[gpio] : (value != 0);
 }
 
 extern "C" inline bool gpio_is_pulled_down(uint gpio) {
@@ -61,6 +61,31 @@ typedef unsigned int uint;
 
 // ---------------------------------------------------------------------------
 
+/**
+ * @brief Hooks of the mocks, used by the host simulator to run the
+ *   firmware against virtual hardware. A null hook keeps the default
+ *   behaviour of the mock.
+ */
+typedef struct TMockHooks {
+    /** @brief Replaces sleep_us and sleep_ms. */
+    void (*sleepUs)(uint64_t us);
+    /** @brief Replaces getchar_timeout_us. */
+    int (*getChar)(uint32_t timeout_us);
+    /** @brief Replaces putchar_raw. */
+    void (*putChar)(int c);
+    /** @brief Replaces stdio_flush. */
+    void (*flush)(void);
+    /** @brief Called after gpio_put (and gpio_xor_mask). */
+    void (*gpioPut)(uint gpio, bool value);
+    /** @brief Called by gpio_get (a negative result keeps the mock). */
+    int (*gpioGet)(uint gpio);
+} TMockHooks;
+
+/** @brief Hooks of the mocks (shared by all translation units). */
+inline TMockHooks mockHooks = {};
+
+// ---------------------------------------------------------------------------
+
 #if defined(REAL_MOCK_IMPLEMENTATION) && defined(UNIX)
 static struct termios _orig_termios;
 #else
@@ -70,6 +95,10 @@ constexpr char kStdioMockPredefinedChar = 'A';
 // ---------------------------------------------------------------------------
 
 extern "C" inline void sleep_us(uint64_t us) {
+    if (mockHooks.sleepUs) {
+        mockHooks.sleepUs(us);
+        return;
+    }
 #ifdef WINDOWS
     Sleep(us / 1000);
 #elif defined(UNIX)
@@ -78,6 +107,10 @@ extern "C" inline void sleep_us(uint64_t us) {
 }
 
 extern "C" inline void sleep_ms(uint32_t ms) {
+    if (mockHooks.sleepUs) {
+        mockHooks.sleepUs(static_cast<uint64_t>(ms) * 1000);
+        return;
+    }
 #ifdef WINDOWS
     Sleep(ms);
 #elif defined(UNIX)
@@ -92,6 +125,7 @@ extern "C" inline void stdio_init_all(void) {
 }
 
 extern "C" inline int getchar_timeout_us(uint32_t timeout_us) {
+    if (mockHooks.getChar) return mockHooks.getChar(timeout_us);
 #if defined(REAL_MOCK_IMPLEMENTATION) && defined(UNIX)
     if (!kbhit(timeout_us)) {
         return PICO_ERROR_TIMEOUT;
@@ -103,6 +137,10 @@ extern "C" inline int getchar_timeout_us(uint32_t timeout_us) {
 }
 
 extern "C" inline int putchar_raw(int c) {
+    if (mockHooks.putChar) {
+        mockHooks.putChar(c);
+        return c;
+    }
 #if defined(REAL_MOCK_IMPLEMENTATION) && defined(UNIX)
     std::cout << static_cast<char>(c);
 #endif  // REAL_MOCK_IMPLEMENTATION
@@ -110,6 +148,10 @@ extern "C" inline int putchar_raw(int c) {
 }
 
 extern "C" inline void stdio_flush(void) {
+    if (mockHooks.flush) {
+        mockHooks.flush();
+        return;
+    }
 #if defined(REAL_MOCK_IMPLEMENTATION) && defined(UNIX)
     std::cout.flush();
 #endif  // REAL_MOCK_IMPLEMENTATION
@@ -16,9 +16,15 @@
 // ---------------------------------------------------------------------------
 
 #include <cstring>
+#include <iterator>
 #include "opcodes_test.hpp"
 #include "modules/opcodes.hpp"
 
+// the copy of the protocol in the host software
+namespace host {
+#include "../../../../software/usbflashprog/backend/opcodes.hpp"
+}  // namespace host
+
 // ---------------------------------------------------------------------------
 
 TEST_F(OpCodeTest, is_ok) {
@@ -32,6 +38,31 @@ TEST_F(OpCodeTest, is_ok) {
     EXPECT_EQ(OpCode::isOk(buf, sizeof(buf)), true);
 }
 
+TEST_F(OpCodeTest, host_table) {
+    EXPECT_EQ(host::kCmdProtoVersion, kCmdProtoVersion);
+    EXPECT_EQ(host::kCmdStreamChunkSize, kCmdStreamChunkSize);
+    ASSERT_EQ(std::size(host::kCmdOpCodes), std::size(kCmdOpCodes));
+    for (size_t i = 0; i < std::size(kCmdOpCodes); i++) {
+        const auto &op = kCmdOpCodes[i];
+        const auto &hostOp = host::kCmdOpCodes[i];
+        EXPECT_EQ(static_cast<int>(hostOp.code), static_cast<int>(op.code));
+        EXPECT_STREQ(hostOp.descr, op.descr);
+        EXPECT_EQ(hostOp.params, op.params) << op.descr;
+        EXPECT_EQ(hostOp.result, op.result) << op.descr;
+    }
+}
+
+TEST_F(OpCodeTest, find_opcode) {
+    for (const auto &op : kCmdOpCodes) {
+        const TCmdOpCode *found = OpCode::findOpCode(op.code);
+        ASSERT_NE(found, nullptr);
+        EXPECT_EQ(*found, op);
+    }
+    EXPECT_EQ(OpCode::findOpCode(0xFF), nullptr);
+    uint8_t buf[1] = {0xFF};
+    EXPECT_EQ(OpCode::getOpCode(buf, sizeof(buf)), kCmdOpCodes[0]);
+}
+
 TEST_F(OpCodeTest, get_opcode) {
     uint8_t buf[32];
     memset(buf, 0, sizeof(buf));
@@ -45,6 +76,56 @@ TEST_F(OpCodeTest, get_opcode) {
     buf[0] = kCmdVppCtrl;
     op = OpCode::getOpCode(kCmdVppCtrl);
     EXPECT_EQ(OpCode::getOpCode(buf, sizeof(buf)), op);
+    buf[0] = kCmdProtoTag;
+    op = OpCode::getOpCode(kCmdProtoTag);
+    EXPECT_EQ(OpCode::getOpCode(buf, sizeof(buf)), op);
+    EXPECT_EQ(op.params, 1);
+    EXPECT_EQ(op.result, 0);
+    buf[0] = kCmdDeviceReadRange;
+    op = OpCode::getOpCode(kCmdDeviceReadRange);
+    EXPECT_EQ(OpCode::getOpCode(buf, sizeof(buf)), op);
+    EXPECT_EQ(op.params, 6);
+    EXPECT_EQ(op.result, 0);
+    buf[0] = kCmdDeviceWriteRange;
+    op = OpCode::getOpCode(kCmdDeviceWriteRange);
+    EXPECT_EQ(OpCode::getOpCode(buf, sizeof(buf)), op);
+    EXPECT_EQ(op.params, 9);
+    EXPECT_EQ(op.result, 1);
+    buf[0] = kCmdDeviceReadW;
+    op = OpCode::getOpCode(kCmdDeviceReadW);
+    EXPECT_EQ(OpCode::getOpCode(buf, sizeof(buf)), op);
+    EXPECT_EQ(op.params, 2);
+    EXPECT_EQ(op.result, 0);
+    buf[0] = kCmdDeviceCrc32Range;
+    op = OpCode::getOpCode(kCmdDeviceCrc32Range);
+    EXPECT_EQ(OpCode::getOpCode(buf, sizeof(buf)), op);
+    EXPECT_EQ(op.params, 6);
+    EXPECT_EQ(op.result, 4);
+    buf[0] = kCmdDeviceBlankCheckRange;
+    op = OpCode::getOpCode(kCmdDeviceBlankCheckRange);
+    EXPECT_EQ(OpCode::getOpCode(buf, sizeof(buf)), op);
+    EXPECT_EQ(op.params, 6);
+    EXPECT_EQ(op.result, 8);
+    buf[0] = kCmdDeviceSetup;
+    op = OpCode::getOpCode(kCmdDeviceSetup);
+    EXPECT_EQ(OpCode::getOpCode(buf, sizeof(buf)), op);
+    EXPECT_EQ(op.params, 16);
+    EXPECT_EQ(op.result, 0);
+    buf[0] = kCmdProtoEncoding;
+    op = OpCode::getOpCode(kCmdProtoEncoding);
+    EXPECT_EQ(OpCode::getOpCode(buf, sizeof(buf)), op);
+    EXPECT_EQ(op.params, 1);
+    EXPECT_EQ(op.result, 0);
+    buf[0] = kCmdProtoFrame;
+    op = OpCode::getOpCode(kCmdProtoFrame);
+    EXPECT_EQ(OpCode::getOpCode(buf, sizeof(buf)), op);
+    EXPECT_EQ(op.params, 3);
+    EXPECT_EQ(op.result, 0);
+    buf[0] = kCmdProtoCaps;
+    op = OpCode::getOpCode(kCmdProtoCaps);
+    EXPECT_EQ(OpCode::getOpCode(buf, sizeof(buf)), op);
+    EXPECT_EQ(op.params, 0);
+    EXPECT_EQ(op.result, 5);
     buf[0] = 0xFF;
     op = OpCode::getOpCode(kCmdNop);
     EXPECT_EQ(OpCode::getOpCode(buf, sizeof(buf)), op);
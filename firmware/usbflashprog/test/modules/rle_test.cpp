@@ -0,0 +1,49 @@
+// ---------------------------------------------------------------------------
+// USB EPROM/Flash Programmer
+//
+// Copyright (2024) Robson Martins
+//
+// This work is licensed under a Creative Commons Attribution-NonCommercial-
+// ShareAlike 4.0 International License.
+// ---------------------------------------------------------------------------
+/**
+ * @ingroup UnitTests
+ * @file test/modules/rle_test.cpp
+ * @brief Implementation of Unit Test for RLE Codec Class.
+ *
+ * @author Robson Martins (https://www.robsonmartins.com)
+ */
+// ---------------------------------------------------------------------------
+
+#include <cstring>
+#include "rle_test.hpp"
+#include "modules/rle.hpp"
+
+// ---------------------------------------------------------------------------
+
+TEST_F(RleTest, encode_decode) {
+    uint8_t raw[300], enc[310], dec[300];
+    size_t decoded = 0;
+    memset(raw, 0xFF, sizeof(raw));
+    for (size_t i = 0; i < 100; i++) raw[i] = static_cast<uint8_t>(i * 7);
+    raw[200] = 0x00;
+
+    EXPECT_EQ(Rle::encode(raw, 0, enc), 0);
+    EXPECT_EQ(Rle::maxEncodedSize(sizeof(raw)), 303);
+    size_t len = Rle::encode(raw, sizeof(raw), enc);
+    EXPECT_LT(len, sizeof(raw));
+    EXPECT_TRUE(Rle::decode(enc, len, dec, sizeof(dec), decoded));
+    EXPECT_EQ(decoded, sizeof(raw));
+    EXPECT_EQ(memcmp(raw, dec, sizeof(raw)), 0);
+    EXPECT_FALSE(Rle::decode(enc, len, dec, sizeof(dec) - 1, decoded));
+    EXPECT_FALSE(Rle::decode(enc, len - 1, dec, sizeof(dec), decoded));
+
+    for (size_t i = 0; i < sizeof(raw); i++) {
+        raw[i] = static_cast<uint8_t>(i * 13 + (i >> 3));
+    }
+    len = Rle::encode(raw, sizeof(raw), enc);
+    EXPECT_LE(len, Rle::maxEncodedSize(sizeof(raw)));
+    EXPECT_TRUE(Rle::decode(enc, len, dec, sizeof(dec), decoded));
+    EXPECT_EQ(decoded, sizeof(raw));
+    EXPECT_EQ(memcmp(raw, dec, sizeof(raw)), 0);
+}
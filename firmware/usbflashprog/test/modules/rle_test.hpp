@@ -0,0 +1,43 @@
+// ---------------------------------------------------------------------------
+// USB EPROM/Flash Programmer
+//
+// Copyright (2024) Robson Martins
+//
+// This work is licensed under a Creative Commons Attribution-NonCommercial-
+// ShareAlike 4.0 International License.
+// ---------------------------------------------------------------------------
+/**
+ * @ingroup UnitTests
+ * @file test/modules/rle_test.hpp
+ * @brief Header of Unit Test for RLE Codec Class.
+ *
+ * @author Robson Martins (https://www.robsonmartins.com)
+ */
+// ---------------------------------------------------------------------------
+
+#ifndef TEST_MODULES_RLE_TEST_HPP_
+#define TEST_MODULES_RLE_TEST_HPP_
+
+#include <gtest/gtest.h>
+
+// ---------------------------------------------------------------------------
+
+/**
+ * @ingroup UnitTests
+ * @brief Test class for RLE Codec Class.
+ * @details The purpose of this class is to test the RLE Codec Class.
+ * @nosubgrouping
+ */
+class RleTest : public testing::Test {
+  protected:
+    /** @brief Constructor. */
+    RleTest() {}
+    /** @brief Destructor. */
+    ~RleTest() override {}
+    /** @brief Sets Up the test. */
+    void SetUp() override {}
+    /** @brief Teardown of the test. */
+    void TearDown() override {}
+};
+
+#endif  // TEST_MODULES_RLE_TEST_HPP_
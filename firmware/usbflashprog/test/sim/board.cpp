@@ -0,0 +1,134 @@
+// ---------------------------------------------------------------------------
+// USB EPROM/Flash Programmer
+//
+// Copyright (2024) Robson Martins
+//
+// This work is licensed under a Creative Commons Attribution-NonCommercial-
+// ShareAlike 4.0 International License.
+// ---------------------------------------------------------------------------
+/**
+ * @ingroup UnitTests
+ * @file test/sim/board.cpp
+ * @brief Implementation of the Virtual Board Class (firmware simulator).
+ *
+ * @author Robson Martins (https://www.robsonmartins.com)
+ */
+// ---------------------------------------------------------------------------
+
+#include <algorithm>
+
+#include "board.hpp"
+#include "config.hpp"
+
+// ---------------------------------------------------------------------------
+
+VirtualBoard::VirtualBoard(TChipKind kind, size_t size)
+    : kind_(kind), memory_(size ? size : kDefaultSize) {
+    reset();
+}
+
+void VirtualBoard::reset() {
+    std::fill(memory_.begin(), memory_.end(), 0xFFFF);
+    std::fill(pins_, pins_ + 32, false);
+    addr_ = {0, 0};
+    data_ = {0, 0};
+    in_ = 0;
+    reads_ = 0;
+    writes_ = 0;
+}
+
+void VirtualBoard::gpioPut(uint gpio, bool value) {
+    if (gpio >= 32 || pins_[gpio] == value) return;
+    pins_[gpio] = value;
+    switch (gpio) {
+        // address bus (74xx595)
+        case kBusAddrClkPin:
+            if (value) {
+                addr_.shift = (addr_.shift << 1) | pins_[kBusAddrSinPin];
+            }
+            break;
+        case kBusAddrClrPin:
+            if (!value) addr_.shift = 0;
+            break;
+        case kBusAddrRckPin:
+            if (value) addr_.latch = addr_.shift;
+            break;
+        // data bus (74xx595 and 74xx165, sharing CLK and CLR/PL)
+        case kBusDataClkPin:
+            if (value) {
+                data_.shift = (data_.shift << 1) | pins_[kBusDataSinPin];
+                if (pins_[kBusDataClrPin]) in_ >>= 1;
+            }
+            break;
+        case kBusDataClrPin:
+            if (!value) {
+                data_.shift = 0;
+                in_ = busValue_();
+            }
+            break;
+        case kBusDataRckPin:
+            if (value) data_.latch = data_.shift;
+            break;
+        // control bus (active HI on the GPIO)
+        case kBusWEPin:
+            if (pins_[kBusCEPin] && !pins_[kBusOEPin]) write_();
+            break;
+        default:
+            break;
+    }
+}
+
+int VirtualBoard::gpioGet(uint gpio) const {
+    if (gpio == kBusDataSoutPin) return in_ & 1;
+    return -1;
+}
+
+VirtualBoard::TChipKind VirtualBoard::getKind() const {
+    return kind_;
+}
+
+size_t VirtualBoard::getSize() const {
+    return memory_.size();
+}
+
+uint32_t VirtualBoard::getAddress() const {
+    return addr_.latch;
+}
+
+uint16_t VirtualBoard::getData() const {
+    return data_.latch & 0xFFFF;
+}
+
+uint16_t VirtualBoard::getCell(uint32_t addr) const {
+    return memory_[addr % memory_.size()];
+}
+
+void VirtualBoard::setCell(uint32_t addr, uint16_t value) {
+    memory_[addr % memory_.size()] = value;
+}
+
+uint64_t VirtualBoard::getReads() const {
+    return reads_;
+}
+
+uint64_t VirtualBoard::getWrites() const {
+    return writes_;
+}
+
+uint16_t VirtualBoard::busValue_() {
+    if (!pins_[kBusCEPin] || !pins_[kBusOEPin]) return getData();
+    reads_++;
+    return getCell(addr_.latch);
+}
+
+void VirtualBoard::write_() {
+    uint16_t &cell = memory_[addr_.latch % memory_.size()];
+    if (kind_ == kChipEprom) {
+        // programs only with VPP on (a toggle of PGM/~CE is just a read)
+        if (!pins_[kVppCtrlPin]) return;
+        cell &= getData();
+    } else {
+        cell = getData();
+    }
+    writes_++;
+}
@@ -0,0 +1,156 @@
+// ---------------------------------------------------------------------------
+// USB EPROM/Flash Programmer
+//
+// Copyright (2024) Robson Martins
+//
+// This work is licensed under a Creative Commons Attribution-NonCommercial-
+// ShareAlike 4.0 International License.
+// ---------------------------------------------------------------------------
+/**
+ * @ingroup UnitTests
+ * @file test/sim/board.hpp
+ * @brief Header of the Virtual Board Class (firmware simulator).
+ *
+ * @author Robson Martins (https://www.robsonmartins.com)
+ */
+// ---------------------------------------------------------------------------
+
+#ifndef TEST_SIM_BOARD_HPP_
+#define TEST_SIM_BOARD_HPP_
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#include "pico/stdlib.h"
+
+// ---------------------------------------------------------------------------
+
+/**
+ * @ingroup UnitTests
+ * @brief Virtual Board Class.
+ * @details The purpose of this class is to model the hardware behind the
+ *  GPIO pins of the programmer (the shift registers of the address and
+ *  data buses, the control bus and the memory chip in the socket), so the
+ *  firmware can run on the host against it.
+ *  <br/>The pin events come from the GPIO mock (see TMockHooks). Only the
+ *  read and write cycles of the chip are modelled: the command sets of the
+ *  flash memories and the software data protection are not.
+ *  <br/>Not thread safe: must be fed by the thread that runs the Device.
+ * @nosubgrouping
+ */
+class VirtualBoard {
+  public:
+    /** @brief Kind of the memory chip in the socket. */
+    enum TChipKind {
+        /** @brief Static RAM (a write overwrites the cell). */
+        kChipSram,
+        /**
+         * @brief EPROM (a write only clears bits, and only with VPP on).
+         */
+        kChipEprom
+    };
+
+    /** @brief Default size of the memory chip (cells). */
+    static constexpr size_t kDefaultSize = 0x80000;
+
+    /**
+     * @brief Constructor.
+     * @param kind Kind of the memory chip.
+     * @param size Size of the memory chip (cells).
+     */
+    explicit VirtualBoard(TChipKind kind = kChipSram,
+                          size_t size = kDefaultSize);
+    /**
+     * @brief Resets the board (the registers are cleared and the memory is
+     *  erased).
+     */
+    void reset();
+    /**
+     * @brief Handles a change of a GPIO pin (called by gpio_put).
+     * @param gpio Pin number.
+     * @param value Level of the pin.
+     */
+    void gpioPut(uint gpio, bool value);
+    /**
+     * @brief Returns the level of a GPIO pin driven by the board.
+     * @param gpio Pin number.
+     * @return Level of the pin (0 or 1), or -1 if the pin is not driven by
+     *  the board.
+     */
+    int gpioGet(uint gpio) const;
+    /**
+     * @brief Returns the kind of the memory chip.
+     * @return Kind of the memory chip.
+     */
+    TChipKind getKind() const;
+    /**
+     * @brief Returns the size of the memory chip.
+     * @return Size of the memory chip (cells).
+     */
+    size_t getSize() const;
+    /**
+     * @brief Returns the value on the outputs of the address register.
+     * @return Address.
+     */
+    uint32_t getAddress() const;
+    /**
+     * @brief Returns the value on the outputs of the data register.
+     * @return Data.
+     */
+    uint16_t getData() const;
+    /**
+     * @brief Returns a cell of the memory chip.
+     * @param addr Address (wraps around the size).
+     * @return Value of the cell.
+     */
+    uint16_t getCell(uint32_t addr) const;
+    /**
+     * @brief Sets a cell of the memory chip.
+     * @param addr Address (wraps around the size).
+     * @param value Value of the cell.
+     */
+    void setCell(uint32_t addr, uint16_t value);
+    /**
+     * @brief Returns the number of read cycles of the memory chip.
+     * @return Number of reads.
+     */
+    uint64_t getReads() const;
+    /**
+     * @brief Returns the number of write cycles of the memory chip.
+     * @return Number of writes.
+     */
+    uint64_t getWrites() const;
+
+  private:
+    /* @brief Model of a 74xx595 (serial in, parallel out). */
+    typedef struct {
+        /* @brief Shift register. */
+        uint32_t shift;
+        /* @brief Storage register (outputs). */
+        uint32_t latch;
+    } TOutRegister;
+
+    /* @brief Kind of the memory chip. */
+    TChipKind kind_;
+    /* @brief Cells of the memory chip. */
+    std::vector<uint16_t> memory_;
+    /* @brief Levels of the pins. */
+    bool pins_[32];
+    /* @brief Address register. */
+    TOutRegister addr_;
+    /* @brief Data output register. */
+    TOutRegister data_;
+    /* @brief Data input register (74xx165, parallel in, serial out). */
+    uint32_t in_;
+    /* @brief Number of read cycles. */
+    uint64_t reads_;
+    /* @brief Number of write cycles. */
+    uint64_t writes_;
+    /* @brief Returns the value on the data lines of the socket. */
+    uint16_t busValue_();
+    /* @brief Writes the data register to the current address. */
+    void write_();
+};
+
+#endif  // TEST_SIM_BOARD_HPP_
@@ -0,0 +1,117 @@
+// ---------------------------------------------------------------------------
+// USB EPROM/Flash Programmer
+//
+// Copyright (2024) Robson Martins
+//
+// This work is licensed under a Creative Commons Attribution-NonCommercial-
+// ShareAlike 4.0 International License.
+// ---------------------------------------------------------------------------
+/**
+ * @ingroup UnitTests
+ * @file test/sim/board_test.cpp
+ * @brief Implementation of Unit Test for Virtual Board Class.
+ *
+ * @author Robson Martins (https://www.robsonmartins.com)
+ */
+// ---------------------------------------------------------------------------
+
+#include "board_test.hpp"
+#include "config.hpp"
+
+// ---------------------------------------------------------------------------
+
+VirtualBoard VirtualBoardTest::board_ = VirtualBoard(VirtualBoard::kChipSram,
+                                                     0x10000);
+
+// ---------------------------------------------------------------------------
+
+VirtualBoardTest::VirtualBoardTest() {}
+
+VirtualBoardTest::~VirtualBoardTest() {}
+
+void VirtualBoardTest::SetUp() {
+    board_ = VirtualBoard(VirtualBoard::kChipSram, 0x10000);
+    mockHooks.gpioPut = [](uint gpio, bool value) {
+        board_.gpioPut(gpio, value);
+    };
+    mockHooks.gpioGet = [](uint gpio) { return board_.gpioGet(gpio); };
+    addr_.configure(kBusAddrSinPin, kBusAddrClkPin, kBusAddrClrPin,
+                    kBusAddrRckPin, 0xFF, 0);
+    dataOut_.configure(kBusDataSinPin, kBusDataClkPin, kBusDataClrPin,
+                       kBusDataRckPin, 0xFF, 0);
+    dataIn_.configure(kBusDataClrPin, kBusDataClkPin, 0xFF, kBusDataSoutPin,
+                      0xFF, 0);
+    gpio_.resetPin(kBusCEPin);
+    gpio_.resetPin(kBusOEPin);
+    gpio_.resetPin(kBusWEPin);
+    gpio_.resetPin(kVppCtrlPin);
+}
+
+void VirtualBoardTest::TearDown() {
+    mockHooks = {};
+}
+
+// ---------------------------------------------------------------------------
+
+TEST_F(VirtualBoardTest, registers) {
+    addr_.writeDWord(0x12345);
+    EXPECT_EQ(board_.getAddress(), 0x12345);
+    addr_.writeByte(0);
+    EXPECT_EQ(board_.getAddress(), 0x00000);
+    dataOut_.writeWord(0xBEEF);
+    EXPECT_EQ(board_.getData(), 0xBEEF);
+    dataOut_.writeByte(0x5A);
+    EXPECT_EQ(board_.getData(), 0x005A);
+    // data bus value when the chip is not selected
+    dataIn_.load();
+    EXPECT_EQ(dataIn_.readByte(true), 0x5A);
+    EXPECT_EQ(board_.getReads(), 0);
+}
+
+TEST_F(VirtualBoardTest, sram) {
+    EXPECT_EQ(board_.getKind(), VirtualBoard::kChipSram);
+    EXPECT_EQ(board_.getSize(), 0x10000);
+    EXPECT_EQ(board_.getCell(0x1234), 0xFFFF);
+    addr_.writeWord(0x1234);
+    dataOut_.writeWord(0x1357);
+    gpio_.setPin(kBusCEPin);
+    gpio_.setPin(kBusWEPin);
+    gpio_.resetPin(kBusWEPin);
+    EXPECT_EQ(board_.getCell(0x1234), 0x1357);
+    EXPECT_EQ(board_.getWrites(), 2);
+    // no write while OE is asserted
+    gpio_.setPin(kBusOEPin);
+    dataOut_.writeWord(0x2468);
+    gpio_.setPin(kBusWEPin);
+    gpio_.resetPin(kBusWEPin);
+    EXPECT_EQ(board_.getCell(0x1234), 0x1357);
+    // read
+    board_.setCell(0x10100, 0xCAFE);
+    addr_.writeWord(0x0100);
+    dataIn_.load();
+    EXPECT_EQ(dataIn_.readWord(true), 0xCAFE);
+    dataIn_.load();
+    EXPECT_EQ(dataIn_.readByte(true), 0xFE);
+    // the CLR of the data output register is the PL of the input register
+    EXPECT_EQ(board_.getReads(), 3);
+}
+
+TEST_F(VirtualBoardTest, eprom) {
+    board_ = VirtualBoard(VirtualBoard::kChipEprom, 0x100);
+    EXPECT_EQ(board_.getKind(), VirtualBoard::kChipEprom);
+    addr_.writeByte(0x10);
+    dataOut_.writeByte(0x0F);
+    gpio_.setPin(kBusCEPin);
+    // PGM/~CE toggled without VPP (read)
+    gpio_.setPin(kBusWEPin);
+    gpio_.resetPin(kBusWEPin);
+    EXPECT_EQ(board_.getCell(0x10), 0xFFFF);
+    // program pulse with VPP
+    gpio_.setPin(kVppCtrlPin);
+    gpio_.setPin(kBusWEPin);
+    EXPECT_EQ(board_.getCell(0x10), 0x000F);
+    // bits are only cleared
+    dataOut_.writeByte(0xF3);
+    gpio_.resetPin(kBusWEPin);
+    EXPECT_EQ(board_.getCell(0x10), 0x0003);
+}
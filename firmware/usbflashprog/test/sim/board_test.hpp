@@ -0,0 +1,58 @@
+// ---------------------------------------------------------------------------
+// USB EPROM/Flash Programmer
+//
+// Copyright (2024) Robson Martins
+//
+// This work is licensed under a Creative Commons Attribution-NonCommercial-
+// ShareAlike 4.0 International License.
+// ---------------------------------------------------------------------------
+/**
+ * @ingroup UnitTests
+ * @file test/sim/board_test.hpp
+ * @brief Header of Unit Test for Virtual Board Class.
+ *
+ * @author Robson Martins (https://www.robsonmartins.com)
+ */
+// ---------------------------------------------------------------------------
+
+#ifndef TEST_SIM_BOARD_TEST_HPP_
+#define TEST_SIM_BOARD_TEST_HPP_
+
+#include <gtest/gtest.h>
+#include "sim/board.hpp"
+#include "hal/gpio.hpp"
+#include "circuits/74hc595.hpp"
+#include "circuits/74hc165.hpp"
+
+// ---------------------------------------------------------------------------
+
+/**
+ * @ingroup UnitTests
+ * @brief Test class for Virtual Board.
+ * @details The purpose of this class is to test the Virtual Board class
+ *  of the firmware simulator, driven by the shift register classes.
+ * @nosubgrouping
+ */
+class VirtualBoardTest : public testing::Test {
+  protected:
+    /** @brief Constructor. */
+    VirtualBoardTest();
+    /** @brief Destructor. */
+    ~VirtualBoardTest() override;
+    /** @brief Sets Up the test. */
+    void SetUp() override;
+    /** @brief Teardown of the test. */
+    void TearDown() override;
+    /* @brief Virtual Board class object to test. */
+    static VirtualBoard board_;
+    /* @brief GPIO (control bus). */
+    Gpio gpio_;
+    /* @brief Address register. */
+    HC595 addr_;
+    /* @brief Data output register. */
+    HC595 dataOut_;
+    /* @brief Data input register. */
+    HC165 dataIn_;
+};
+
+#endif  // TEST_SIM_BOARD_TEST_HPP_
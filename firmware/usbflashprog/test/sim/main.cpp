@@ -0,0 +1,335 @@
+// ---------------------------------------------------------------------------
+// USB EPROM/Flash Programmer
+//
+// Copyright (2024) Robson Martins
+//
+// This work is licensed under a Creative Commons Attribution-NonCommercial-
+// ShareAlike 4.0 International License.
+// ---------------------------------------------------------------------------
+/**
+ * @ingroup UnitTests
+ * @file test/sim/main.cpp
+ * @brief Implementation of the Firmware Simulator Main Routine.
+ * @details Runs the firmware (Runner) on the host against a VirtualBoard,
+ *  served over a pseudo-terminal, so the software can open it as if it
+ *  were the programmer.
+ *  <br/>Usage: ufprog_sim [--chip sram|eprom] [--size cells]
+ *  [--link path] [--link-rate bytes/s] [--no-pace]
+ *
+ * @author Robson Martins (https://www.robsonmartins.com)
+ */
+// ---------------------------------------------------------------------------
+
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>  // NOLINT
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "board.hpp"
+#include "modules/runner.hpp"
+
+// ---------------------------------------------------------------------------
+
+/* @brief Size of the input and output buffers of the pty. */
+constexpr size_t kSimBufferSize = 4096;
+
+/* @brief Clock of the host. */
+typedef std::chrono::steady_clock TClock;
+
+/* @brief State of the simulator. */
+static struct {
+    /* @brief Virtual board. */
+    VirtualBoard *board = nullptr;
+    /* @brief Thread that runs the firmware (core 0). */
+    std::thread::id mainThread;
+    /* @brief File descriptor of the master side of the pty. */
+    int fd = -1;
+    /* @brief Received data. */
+    std::vector<uint8_t> in;
+    /* @brief Position of the next received byte. */
+    size_t inPos = 0;
+    /* @brief Data to send. */
+    std::vector<uint8_t> out;
+    /* @brief Virtual time (nanoseconds). */
+    uint64_t virtualNs = 0;
+    /* @brief Time to transfer one byte over the link (nanoseconds). */
+    uint64_t byteNs = 0;
+    /* @brief Paces the virtual time with the host time. */
+    bool pace = true;
+    /* @brief Host time of the pacing mark. */
+    TClock::time_point markHost;
+    /* @brief Virtual time of the pacing mark (nanoseconds). */
+    uint64_t markVirtualNs = 0;
+    /* @brief Number of bytes received and sent. */
+    uint64_t bytesIn = 0, bytesOut = 0;
+    /* @brief Number of commands, by opcode. */
+    std::map<uint8_t, uint64_t> commands;
+} sim;
+
+/* @brief Set by the signal handler to stop the simulator. */
+static volatile sig_atomic_t stopRequested = 0;
+
+// ---------------------------------------------------------------------------
+
+/* @brief Restarts the pacing from now. */
+static void markPace() {
+    sim.markHost = TClock::now();
+    sim.markVirtualNs = sim.virtualNs;
+}
+
+/*
+ * @brief Advances the virtual time, and sleeps while it is ahead of the
+ *  host time (if pacing).
+ */
+static void advance(uint64_t ns) {
+    sim.virtualNs += ns;
+    if (!sim.pace) return;
+    auto virt = std::chrono::nanoseconds(sim.virtualNs - sim.markVirtualNs);
+    auto host = TClock::now() - sim.markHost;
+    // sleeps only in slices of 1 ms (short delays are accumulated)
+    if (virt - host >= std::chrono::milliseconds(1)) {
+        std::this_thread::sleep_for(virt - host);
+    }
+}
+
+/* @brief Sends the buffered data to the pty. */
+static void flushOut() {
+    size_t pos = 0;
+    while (pos < sim.out.size()) {
+        ssize_t n = ::write(sim.fd, sim.out.data() + pos, sim.out.size() - pos);
+        if (n > 0) {
+            pos += n;
+        } else if (n < 0 && errno != EAGAIN && errno != EINTR) {
+            break;
+        } else {
+            // gives up if nobody reads the pty
+            pollfd pfd = {sim.fd, POLLOUT, 0};
+            if (::poll(&pfd, 1, 1000) <= 0) break;
+        }
+    }
+    sim.bytesOut += pos;
+    sim.out.clear();
+}
+
+/*
+ * @brief Waits for data from the pty.
+ * @param timeoutMs Timeout, in milliseconds (negative to wait forever).
+ * @return True if data was received, false otherwise.
+ */
+static bool waitIn(int timeoutMs) {
+    if (sim.inPos < sim.in.size()) return true;
+    flushOut();
+    auto start = TClock::now();
+    pollfd pfd = {sim.fd, POLLIN, 0};
+    bool received = false;
+    if (::poll(&pfd, 1, timeoutMs) > 0 && (pfd.revents & POLLIN)) {
+        uint8_t buf[kSimBufferSize];
+        ssize_t n = ::read(sim.fd, buf, sizeof(buf));
+        if (n > 0) {
+            sim.in.assign(buf, buf + n);
+            sim.inPos = 0;
+            sim.bytesIn += n;
+            received = true;
+        }
+    }
+    // the time waiting is spent by the firmware too
+    sim.virtualNs += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                         TClock::now() - start)
+                         .count();
+    markPace();
+    return received;
+}
+
+// ---------------------------------------------------------------------------
+
+/* @brief Hook of sleep_us and sleep_ms. */
+static void hookSleepUs(uint64_t us) {
+    if (std::this_thread::get_id() != sim.mainThread) {
+        // core 1 (voltage generators) really sleeps
+        std::this_thread::sleep_for(std::chrono::microseconds(us));
+        return;
+    }
+    advance(us * 1000);
+    std::this_thread::yield();
+}
+
+/* @brief Hook of getchar_timeout_us. */
+static int hookGetChar(uint32_t timeout_us) {
+    if (sim.inPos >= sim.in.size() &&
+        !waitIn(static_cast<int>((timeout_us + 999) / 1000))) {
+        return PICO_ERROR_TIMEOUT;
+    }
+    advance(sim.byteNs);
+    return sim.in[sim.inPos++];
+}
+
+/* @brief Hook of putchar_raw. */
+static void hookPutChar(int c) {
+    sim.out.push_back(static_cast<uint8_t>(c));
+    advance(sim.byteNs);
+    if (sim.out.size() >= kSimBufferSize) flushOut();
+}
+
+/* @brief Hook of stdio_flush. */
+static void hookFlush() {
+    // sent when the firmware waits for the next input
+}
+
+/* @brief Hook of gpio_put. */
+static void hookGpioPut(uint gpio, bool value) {
+    if (std::this_thread::get_id() != sim.mainThread) return;
+    sim.board->gpioPut(gpio, value);
+}
+
+/* @brief Hook of gpio_get. */
+static int hookGpioGet(uint gpio) {
+    if (std::this_thread::get_id() != sim.mainThread) return -1;
+    return sim.board->gpioGet(gpio);
+}
+
+// ---------------------------------------------------------------------------
+
+/* @brief Handles SIGINT and SIGTERM. */
+static void onSignal(int) {
+    stopRequested = 1;
+}
+
+/* @brief Prints the usage of the simulator. */
+static void usage(const char *name) {
+    fprintf(stderr,
+            "Usage: %s [--chip sram|eprom] [--size cells] [--link path]\n"
+            "          [--link-rate bytes/s] [--no-pace]\n",
+            name);
+}
+
+/* @brief Prints the statistics of the session. */
+static void printStats() {
+    fprintf(stderr, "virtual time: %.3f s\n", sim.virtualNs / 1e9);
+    fprintf(stderr, "bytes in: %llu, bytes out: %llu\n",
+            static_cast<unsigned long long>(sim.bytesIn),    // NOLINT
+            static_cast<unsigned long long>(sim.bytesOut));  // NOLINT
+    fprintf(stderr, "chip reads: %llu, chip writes: %llu\n",
+            static_cast<unsigned long long>(sim.board->getReads()),    // NOLINT
+            static_cast<unsigned long long>(sim.board->getWrites()));  // NOLINT
+    for (const auto &cmd : sim.commands) {
+        fprintf(stderr, "command 0x%02X: %llu\n", cmd.first,
+                static_cast<unsigned long long>(cmd.second));  // NOLINT
+    }
+}
+
+/**
+ * @ingroup UnitTests
+ * @brief Main routine of the firmware simulator.
+ * @param argc Number of arguments.
+ * @param argv Array of arguments.
+ * @return Error code (zero if success).
+ */
+int main(int argc, char **argv) {
+    VirtualBoard::TChipKind kind = VirtualBoard::kChipSram;
+    size_t size = VirtualBoard::kDefaultSize;
+    std::string link;
+    uint64_t linkRate = 0;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if (arg == "--chip" && hasValue) {
+            std::string value = argv[++i];
+            if (value == "sram") {
+                kind = VirtualBoard::kChipSram;
+            } else if (value == "eprom") {
+                kind = VirtualBoard::kChipEprom;
+            } else {
+                usage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "--size" && hasValue) {
+            size = std::strtoul(argv[++i], nullptr, 0);
+        } else if (arg == "--link" && hasValue) {
+            link = argv[++i];
+        } else if (arg == "--link-rate" && hasValue) {
+            linkRate = std::strtoull(argv[++i], nullptr, 0);
+        } else if (arg == "--no-pace") {
+            sim.pace = false;
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    // pseudo-terminal
+    sim.fd = posix_openpt(O_RDWR | O_NOCTTY);
+    if (sim.fd < 0 || grantpt(sim.fd) != 0 || unlockpt(sim.fd) != 0) {
+        perror("posix_openpt");
+        return 1;
+    }
+    std::string slaveName = ptsname(sim.fd);
+    // keeps the slave opened, so the master survives the clients
+    int slave = ::open(slaveName.c_str(), O_RDWR | O_NOCTTY);
+    if (slave < 0) {
+        perror("open");
+        return 1;
+    }
+    termios tio;
+    if (tcgetattr(slave, &tio) == 0) {
+        cfmakeraw(&tio);
+        tcsetattr(slave, TCSANOW, &tio);
+    }
+    fcntl(sim.fd, F_SETFL, fcntl(sim.fd, F_GETFL) | O_NONBLOCK);
+    if (!link.empty()) {
+        ::unlink(link.c_str());
+        if (::symlink(slaveName.c_str(), link.c_str()) != 0) {
+            perror("symlink");
+            return 1;
+        }
+    }
+    printf("%s\n", slaveName.c_str());
+    fflush(stdout);
+
+    // virtual board
+    VirtualBoard board(kind, size);
+    sim.board = &board;
+    sim.mainThread = std::this_thread::get_id();
+    sim.byteNs = linkRate ? 1000000000ull / linkRate : 0;
+    mockHooks.sleepUs = hookSleepUs;
+    mockHooks.getChar = hookGetChar;
+    mockHooks.putChar = hookPutChar;
+    mockHooks.flush = hookFlush;
+    mockHooks.gpioPut = hookGpioPut;
+    mockHooks.gpioGet = hookGpioGet;
+
+    struct sigaction action = {};
+    action.sa_handler = onSignal;
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+
+    // firmware
+    Runner runner;
+    markPace();
+    runner.init();
+    while (!stopRequested) {
+        // waits for the next command (the firmware polls without timeout)
+        if (!waitIn(200)) continue;
+        sim.commands[sim.in[sim.inPos]]++;
+        runner.loop();
+    }
+    flushOut();
+    mockHooks = {};
+
+    printStats();
+    if (!link.empty()) ::unlink(link.c_str());
+    ::close(slave);
+    ::close(sim.fd);
+    return 0;
+}
@@ -0,0 +1,49 @@
+// ---------------------------------------------------------------------------
+// USB EPROM/Flash Programmer
+//
+// Copyright (2024) Robson Martins
+//
+// This work is licensed under a Creative Commons Attribution-NonCommercial-
+// ShareAlike 4.0 International License.
+// ---------------------------------------------------------------------------
+/**
+ * @ingroup Software
+ * @file backend/checksum.cpp
+ * @brief Implementation of the Checksum Helper Class.
+ *
+ * @author Robson Martins (https://www.robsonmartins.com)
+ */
+// ---------------------------------------------------------------------------
+
+#include "backend/checksum.hpp"
+
+// ---------------------------------------------------------------------------
+
+uint16_t Checksum::crc16(const void *buf, size_t size, uint16_t crc) {
+    if (!buf || !size) {
+        return crc;
+    }
+    const uint8_t *pbuf = static_cast<const uint8_t *>(buf);
+    for (size_t i = 0; i < size; i++) {
+        crc ^= static_cast<uint16_t>(pbuf[i]) << 8;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? ((crc << 1) ^ 0x1021) : (crc << 1);
+        }
+    }
+    return crc;
+}
+
+uint32_t Checksum::crc32(const void *buf, size_t size, uint32_t crc) {
+    if (!buf || !size) {
+        return crc;
+    }
+    const uint8_t *pbuf = static_cast<const uint8_t *>(buf);
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++) {
+        crc ^= pbuf[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 1) ? ((crc >> 1) ^ 0xEDB88320) : (crc >> 1);
+        }
+    }
+    return ~crc;
+}
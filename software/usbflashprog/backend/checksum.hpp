@@ -0,0 +1,58 @@
+// ---------------------------------------------------------------------------
+// USB EPROM/Flash Programmer
+//
+// Copyright (2024) Robson Martins
+//
+// This work is licensed under a Creative Commons Attribution-NonCommercial-
+// ShareAlike 4.0 International License.
+// ---------------------------------------------------------------------------
+/**
+ * @ingroup Software
+ * @file backend/checksum.hpp
+ * @brief Header of the Checksum Helper Class.
+ *
+ * @author Robson Martins (https://www.robsonmartins.com)
+ */
+// ---------------------------------------------------------------------------
+
+#ifndef BACKEND_CHECKSUM_HPP_
+#define BACKEND_CHECKSUM_HPP_
+
+// ---------------------------------------------------------------------------
+
+#include <cstddef>
+#include <cstdint>
+
+// ---------------------------------------------------------------------------
+
+/**
+ * @ingroup Software
+ * @brief Checksum Helper Class
+ * @details The purpose of this class is to calculate the checksums used
+ *  by the communication protocol.
+ * @nosubgrouping
+ */
+class Checksum {
+  public:
+    /**
+     * @brief Calculates the CRC-16/CCITT (polynomial 0x1021) of a buffer.
+     * @param buf Pointer to the buffer.
+     * @param size Size of buffer, in bytes.
+     * @param crc Initial value (or the CRC of the previous buffer, to
+     *  calculate it incrementally). Default is 0xFFFF.
+     * @return CRC-16 value.
+     */
+    static uint16_t crc16(const void *buf, size_t size, uint16_t crc = 0xFFFF);
+    /**
+     * @brief Calculates the CRC-32 (ISO-HDLC, polynomial 0x04C11DB7,
+     *  reflected) of a buffer.
+     * @param buf Pointer to the buffer.
+     * @param size Size of buffer, in bytes.
+     * @param crc CRC of the previous buffer, to calculate it
+     *  incrementally. Default is 0 (no previous buffer).
+     * @return CRC-32 value.
+     */
+    static uint32_t crc32(const void *buf, size_t size, uint32_t crc = 0);
+};
+
+#endif  // BACKEND_CHECKSUM_HPP_
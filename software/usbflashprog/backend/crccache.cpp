@@ -0,0 +1,58 @@
+// ---------------------------------------------------------------------------
+// USB EPROM/Flash Programmer
+//
+// Copyright (2024) Robson Martins
+//
+// This work is licensed under a Creative Commons Attribution-NonCommercial-
+// ShareAlike 4.0 International License.
+// ---------------------------------------------------------------------------
+/**
+ * @ingroup Software
+ * @file backend/crccache.cpp
+ * @brief Implementation of the CRC Cache Class.
+ *
+ * @author Robson Martins (https://www.robsonmartins.com)
+ */
+// ---------------------------------------------------------------------------
+
+#include "backend/crccache.hpp"
+#include "backend/checksum.hpp"
+
+// ---------------------------------------------------------------------------
+
+CrcCache::CrcCache() : hits_(0) {}
+
+void CrcCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    crcs_.clear();
+    hits_ = 0;
+}
+
+uint32_t CrcCache::crc32(const void *image, uint32_t offset,
+                         uint32_t length) {
+    uint64_t key = (static_cast<uint64_t>(offset) << 32) | length;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = crcs_.find(key);
+        if (it != crcs_.end()) {
+            hits_++;
+            return it->second;
+        }
+    }
+    // calculated out of the lock: the other threads are not blocked
+    uint32_t crc = Checksum::crc32(
+        static_cast<const uint8_t *>(image) + offset, length);
+    std::lock_guard<std::mutex> lock(mutex_);
+    crcs_[key] = crc;
+    return crc;
+}
+
+size_t CrcCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return crcs_.size();
+}
+
+uint32_t CrcCache::getHits() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return hits_;
+}
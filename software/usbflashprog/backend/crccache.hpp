@@ -0,0 +1,75 @@
+// ---------------------------------------------------------------------------
+// USB EPROM/Flash Programmer
+//
+// Copyright (2024) Robson Martins
+//
+// This work is licensed under a Creative Commons Attribution-NonCommercial-
+// ShareAlike 4.0 International License.
+// ---------------------------------------------------------------------------
+/**
+ * @ingroup Software
+ * @file backend/crccache.hpp
+ * @brief Header of the CRC Cache Class.
+ *
+ * @author Robson Martins (https://www.robsonmartins.com)
+ */
+// ---------------------------------------------------------------------------
+
+#ifndef BACKEND_CRCCACHE_HPP_
+#define BACKEND_CRCCACHE_HPP_
+
+// ---------------------------------------------------------------------------
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+
+// ---------------------------------------------------------------------------
+
+/**
+ * @ingroup Software
+ * @brief CRC Cache Class
+ * @details The purpose of this class is to calculate the CRC-32 of the
+ *   ranges of an image only once, when several devices (gang mode) verify
+ *   the same image. The ranges are identified by their offset and length,
+ *   so a cache must be used with one image only (or cleared when the
+ *   image changes). It can be shared by several threads.
+ * @nosubgrouping
+ */
+class CrcCache {
+  public:
+    /** @brief Constructor. */
+    CrcCache();
+    /** @brief Clears the cache. */
+    void clear();
+    /**
+     * @brief Returns the CRC-32 of a range of the image, calculating it
+     *   only if it is not in the cache.
+     * @param image Pointer to the image.
+     * @param offset Offset of the range, in bytes.
+     * @param length Length of the range, in bytes.
+     * @return CRC-32 of the range (same as Checksum::crc32).
+     */
+    uint32_t crc32(const void *image, uint32_t offset, uint32_t length);
+    /**
+     * @brief Returns the number of ranges in the cache.
+     * @return Number of ranges.
+     */
+    size_t size() const;
+    /**
+     * @brief Returns the number of CRCs found in the cache.
+     * @return Number of hits since the last clear().
+     */
+    uint32_t getHits() const;
+
+  private:
+    /* @brief Protects the cache (shared by the device threads). */
+    mutable std::mutex mutex_;
+    /* @brief CRCs, by range (offset in the high 32 bits, and length). */
+    std::unordered_map<uint64_t, uint32_t> crcs_;
+    /* @brief Number of CRCs found in the cache. */
+    uint32_t hits_;
+};
+
+#endif  // BACKEND_CRCCACHE_HPP_
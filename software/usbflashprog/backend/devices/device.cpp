@@ -34,6 +34,11 @@ Q_LOGGING_CATEGORY(device, "device")
 
 // ---------------------------------------------------------------------------
 
+/* @brief Part of the operation used to measure each buffer size (1/n). */
+constexpr uint32_t kTuneSampleDivisor = 16;
+
+// ---------------------------------------------------------------------------
+
 // clang-format off
 /* @brief List of Manufacturers. */
 const QMap<uint8_t, QString> kManufacturerList = {
@@ -95,6 +100,7 @@ TDeviceCapabilities::TDeviceCapabilities()
       hasSectorSize(false),
       hasFastProg(false),
       hasSkipFF(false),
+      hasDiffProg(false),
       hasVDD(false),
       hasVPP(false) {}
 
@@ -131,6 +137,7 @@ QString TDeviceInformation::toString() const {
     ts << ", hasSectorSize=" << (capability.hasSectorSize ? 1 : 0);
     ts << ", hasFastProg=" << (capability.hasFastProg ? 1 : 0);
     ts << ", hasSkipFF=" << (capability.hasSkipFF ? 1 : 0);
+    ts << ", hasDiffProg=" << (capability.hasDiffProg ? 1 : 0);
     ts << ", hasVDD=" << (capability.hasVDD ? 1 : 0);
     ts << ", hasVPP=" << (capability.hasVPP ? 1 : 0);
     ts << "]";
@@ -152,7 +159,10 @@ Device::Device(QObject *parent)
       vee_(12.0f),
       skipFF_(false),
       fastProg_(false),
+      diffProg_(false),
+      autoTune_(false),
       sectorSize_(0),
+      dirtyCount_(0),
       algo_(kCmdDeviceAlgorithmUnknown),
       runner_(this) {
     info_.deviceType = kDeviceParallelMemory;
@@ -168,6 +178,7 @@ Device::Device(QObject *parent)
     info_.capability.hasSectorSize = false;
     info_.capability.hasFastProg = false;
     info_.capability.hasSkipFF = false;
+    info_.capability.hasDiffProg = false;
     info_.capability.hasVDD = true;
     info_.capability.hasVPP = false;
     flags_.skipFF = false;
@@ -193,14 +204,39 @@ QString Device::getPort() const {
     return port_;
 }
 
-uint8_t Device::getBufferSize() const {
+uint16_t Device::getBufferSize() const {
     return runner_.getBufferSize();
 }
 
-void Device::setBufferSize(uint8_t value) {
+void Device::setBufferSize(uint16_t value) {
     runner_.setBufferSize(value);
 }
 
+void Device::setAutoTune(bool value) {
+    if (autoTune_ != value) autoTune_ = value;
+    DEBUG << "Buffer Auto-Tune: " << QString("%1").arg(autoTune_ ? 1 : 0);
+}
+
+bool Device::getAutoTune() const {
+    return autoTune_;
+}
+
+const CommStats &Device::getStats() const {
+    return runner_.getStats();
+}
+
+void Device::resetStats() {
+    runner_.resetStats();
+}
+
+bool Device::setTraceFile(const QString &filename) {
+    return runner_.setTraceFile(filename);
+}
+
+void Device::setCrcCache(std::shared_ptr<CrcCache> cache) {
+    crcCache_ = cache;
+}
+
 void Device::setSize(uint32_t value) {
     if (size_ != value) {
         if (value) size_ = value;
@@ -296,6 +332,15 @@ bool Device::getFastProg() const {
     return fastProg_;
 }
 
+void Device::setDiffProg(bool value) {
+    if (diffProg_ != value) diffProg_ = value;
+    DEBUG << "Program Differences: " << QString("%1").arg(diffProg_ ? 1 : 0);
+}
+
+bool Device::getDiffProg() const {
+    return diffProg_;
+}
+
 void Device::setSectorSize(uint16_t value) {
     if (sectorSize_ != value) sectorSize_ = value;
     DEBUG << "Sector Size: " << QString("%1").arg(sectorSize_);
@@ -305,12 +350,19 @@ uint16_t Device::getSectorSize() const {
     return sectorSize_;
 }
 
+uint32_t Device::getDirtyCount() const {
+    return dirtyCount_;
+}
+
+const QVector<uint32_t> &Device::getMismatches() const {
+    return mismatches_;
+}
+
 TDeviceInformation Device::getInfo() const {
     return info_;
 }
 
 void Device::cancel() {
-    if (canceling_) return;
     canceling_ = true;
 }
 
@@ -351,3 +403,43 @@ bool Device::unprotect() {
 bool Device::protect() {
     return false;
 }
+
+void Device::startTuning_(uint32_t total) {
+    uint16_t size = getBufferSize();
+    uint32_t sample = total / kTuneSampleDivisor;
+    // short operations do not give a reliable measure
+    if (!autoTune_ || sample < size * 4UL) {
+        tuner_.start(size, 0, 0);
+        return;
+    }
+    tuner_.start(size, runner_.getMaxBufferSize(), sample, total);
+    DEBUG << "Tuning buffer size from:" << QString("%1").arg(size);
+}
+
+int Device::tuneBlockSize_(uint32_t position, uint32_t end) {
+    uint16_t size = getBufferSize();
+    uint16_t next = tuner_.getSize();
+    // a candidate that does not divide the range is never sampled
+    while (tuner_.isTuning() && next != size && (end % next)) {
+        tuner_.skip();
+        next = tuner_.getSize();
+    }
+    if (!next || next == size || (position % next) || (end % next)) {
+        return size;
+    }
+    setBufferSize(next);
+    size = getBufferSize();
+    if (!tuner_.isTuning()) {
+        INFO << "Buffer size tuned:" << QString("%1").arg(size);
+    }
+    return size;
+}
+
+uint32_t Device::tuneBlocks_(uint32_t position, uint32_t blocks) const {
+    uint16_t size = getBufferSize();
+    uint16_t align = tuner_.isTuning() ? tuner_.getMaxSize()
+                                       : tuner_.getSize();
+    if (!align || align <= size || !blocks) return blocks;
+    uint32_t limit = (align - position % align) / size;
+    return qMax(1U, qMin(blocks, limit));
+}
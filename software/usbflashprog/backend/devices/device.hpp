@@ -23,12 +23,14 @@
 #include <QObject>
 #include <QString>
 #include <QByteArray>
+#include <QVector>
+#include <atomic>
+#include <memory>
+
+#include "backend/tuner.hpp"
+#include "backend/crccache.hpp"
 
-#ifndef TEST_BUILD
 #include "backend/runner.hpp"
-#else
-#include "test/emulator/emulator.hpp"
-#endif
 
 // ---------------------------------------------------------------------------
 
@@ -37,7 +39,7 @@
  * @brief Default size of buffer of the device commands (write, read, verify,
  *   blank check), in bytes.
  */
-constexpr uint8_t kDefaultDeviceBufferSize = 64;
+constexpr uint16_t kDefaultDeviceBufferSize = 64;
 
 // ---------------------------------------------------------------------------
 
@@ -101,6 +103,8 @@ typedef struct TDeviceCapabilities {
     bool hasFastProg;
     /** @brief Device has Skip Prog 0xFF configuration. */
     bool hasSkipFF;
+    /** @brief Device has Program Differences configuration. */
+    bool hasDiffProg;
     /** @brief Device has VDD Adjust configuration. */
     bool hasVDD;
     /** @brief Device has VPP Adjust configuration. */
@@ -181,12 +185,48 @@ class Device : public QObject {
      * @brief Returns the current buffer size value for buffer operations.
      * @return Buffer size, in bytes.
      */
-    uint8_t getBufferSize() const;
+    uint16_t getBufferSize() const;
     /**
      * @brief Sets the buffer size value for buffer operations.
      * @param value Buffer size, in bytes.
      */
-    void setBufferSize(uint8_t value);
+    void setBufferSize(uint16_t value);
+    /**
+     * @brief Sets the Buffer Size Auto-Tune.
+     * @details If enabled, the first part of the program, read and verify
+     *   operations is used to measure the throughput of some buffer sizes.
+     *   The best one is used for the rest of the operation, and is
+     *   returned by getBufferSize() after it.
+     * @param value If true (default), enables auto-tune, disables
+     * otherwise.
+     */
+    void setAutoTune(bool value = true);
+    /**
+     * @brief Returns the configured Buffer Size Auto-Tune.
+     * @return If true, auto-tune is enabled, disabled otherwise.
+     */
+    bool getAutoTune() const;
+    /**
+     * @brief Returns the communication statistics.
+     * @return Statistics recorded since the last resetStats().
+     */
+    const CommStats &getStats() const;
+    /** @brief Clears the communication statistics. */
+    void resetStats();
+    /**
+     * @brief Records the communication to a trace file.
+     * @param filename Name of the trace file. Empty to stop recording.
+     * @return True if success, false otherwise.
+     */
+    bool setTraceFile(const QString &filename);
+    /**
+     * @brief Sets the cache of the CRCs of the image to verify.
+     * @details Used by the devices of a gang (same image), so that the CRC
+     *   of each range is calculated only once.
+     * @param cache Pointer to the cache (shared), or empty to calculate
+     *   the CRCs in each operation (default).
+     */
+    void setCrcCache(std::shared_ptr<CrcCache> cache);
     /**
      * @brief Sets the tWP.
      * @param us tWP value, in microseconds.
@@ -269,6 +309,19 @@ class Device : public QObject {
      * @return If true, fast prog/erase is enabled, disabled otherwise.
      */
     virtual bool getFastProg() const;
+    /**
+     * @brief Sets the Program Differences.
+     * @details If enabled, the device is compared with the buffer before
+     *   programming, and only the blocks that differ are written.
+     * @param value If true (default), enables program differences,
+     * disables otherwise.
+     */
+    virtual void setDiffProg(bool value = true);
+    /**
+     * @brief Returns the configured Program Differences.
+     * @return If true, program differences is enabled, disabled otherwise.
+     */
+    virtual bool getDiffProg() const;
     /**
      * @brief Sets the Sector Size.
      * @param value Sector size, in bytes.
@@ -279,6 +332,22 @@ class Device : public QObject {
      * @return Sector size value, in bytes.
      */
     virtual uint16_t getSectorSize() const;
+    /**
+     * @brief Returns the number of non-blank bytes/words found by the last
+     *   blank check.
+     * @return Number of non-blank bytes/words. Zero if the device is
+     *   blank, or if the count is not available.
+     */
+    virtual uint32_t getDirtyCount() const;
+    /**
+     * @brief Returns the addresses that differ from the buffer, found by
+     *   the last verify.
+     * @details Only the verify that reads the device and compares it on
+     *   the host finds all of them. The verify on the device stops at the
+     *   first mismatched block, and then the list is empty.
+     * @return Addresses (bytes/words), in ascending order.
+     */
+    virtual const QVector<uint32_t> &getMismatches() const;
     /**
      * @brief Returns the Device Information.
      * @return Device Information.
@@ -286,6 +355,8 @@ class Device : public QObject {
     virtual TDeviceInformation getInfo() const;
     /**
      * @brief Cancels the active operation (if any).
+     *   Thread-safe: may be called while an operation is running on
+     *   the thread of the device.
      */
     virtual void cancel();
     /**
@@ -354,8 +425,8 @@ class Device : public QObject {
   protected:
     /* @brief Maximum attempts to program a byte. */
     int maxAttemptsProg_;
-    /* @brief True if is about the canceling. */
-    bool canceling_;
+    /* @brief True if is about the canceling (set from any thread). */
+    std::atomic<bool> canceling_;
     /* @brief Device size, in bytes. */
     uint32_t size_;
     /* @brief tWP, in microseconds. */
@@ -363,11 +434,7 @@ class Device : public QObject {
     /* @brief tWC, in microseconds. */
     uint32_t twc_;
     /* @brief Device settings. */
-#ifndef TEST_BUILD
     Runner::TDeviceFlags flags_;
-#else
-    Emulator::TDeviceFlags flags_;
-#endif
     /* @brief VDD to Read, in volts. */
     float vddRd_;
     /* @brief VDD to Program, in volts. */
@@ -380,20 +447,53 @@ class Device : public QObject {
     bool skipFF_;
     /* @brief Enables fast prog/erase. */
     bool fastProg_;
+    /* @brief Enables program differences. */
+    bool diffProg_;
+    /* @brief Enables buffer size auto-tune. */
+    bool autoTune_;
+    /* @brief Buffer size tuner. */
+    BufferTuner tuner_;
+    /* @brief Cache of the CRCs of the image (shared by a gang). */
+    std::shared_ptr<CrcCache> crcCache_;
     /* @brief Sector size, in bytes (0 = byte mode). */
     uint16_t sectorSize_;
+    /* @brief Non-blank bytes/words found by the last blank check. */
+    uint32_t dirtyCount_;
+    /* @brief Addresses that differ, found by the last verify. */
+    QVector<uint32_t> mismatches_;
     /* @brief Chip algorithm. */
     kCmdDeviceAlgorithmEnum algo_;
     /* @brief Serial port path. */
     QString port_;
     /* @brief The Runner instance. */
-#ifndef TEST_BUILD
     Runner runner_;
-#else
-    Emulator runner_;
-#endif
     /* @brief Device information. */
     TDeviceInformation info_;
+
+  protected:
+    /*
+     * @brief Starts the buffer size auto-tune (if enabled).
+     * @param total Amount of data of the operation, in bytes (zero keeps
+     *   the current buffer size).
+     */
+    void startTuning_(uint32_t total);
+    /*
+     * @brief Applies the buffer size chosen by the tuner.
+     * @details The size is changed only at a position (and range end)
+     *   aligned to it.
+     * @param position Current position, in bytes.
+     * @param end End of the range, in bytes.
+     * @return Buffer size to use from position, in bytes.
+     */
+    int tuneBlockSize_(uint32_t position, uint32_t end);
+    /*
+     * @brief Limits the number of blocks of a transfer, so that it ends
+     *   at a position where the tuner can change the buffer size.
+     * @param position Current position, in bytes.
+     * @param blocks Number of blocks to transfer.
+     * @return Number of blocks to transfer (at least one).
+     */
+    uint32_t tuneBlocks_(uint32_t position, uint32_t blocks) const;
 };
 
 #endif  // BACKEND_DEVICES_DEVICE_HPP_
@@ -39,6 +39,7 @@ EEPROM::EEPROM(QObject *parent) : ParDevice(parent) {
     info_.capability.hasBlankCheck = true;
     info_.capability.hasVDD = true;
     info_.capability.hasErase = true;
+    info_.capability.hasDiffProg = true;
     vddRd_ = 5.0f;
     vddWr_ = 5.0f;
     vpp_ = 12.0f;
@@ -78,6 +79,10 @@ bool EEPROM::eraseDevice() {
     return true;
 }
 
+bool EEPROM::isRewritable_() const {
+    return true;
+}
+
 // ---------------------------------------------------------------------------
 
 EEPROM28C::EEPROM28C(QObject *parent) : EEPROM(parent) {
@@ -51,6 +51,8 @@ class EEPROM : public ParDevice {
   protected:
     /* Reimplemented */
     virtual bool eraseDevice();
+    /* Reimplemented */
+    virtual bool isRewritable_() const;
 };
 
 // ---------------------------------------------------------------------------
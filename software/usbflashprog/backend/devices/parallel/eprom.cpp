@@ -40,6 +40,7 @@ EPROM::EPROM(QObject *parent) : ParDevice(parent) {
     info_.capability.hasGetId = true;
     info_.capability.hasVDD = true;
     info_.capability.hasVPP = true;
+    info_.capability.hasDiffProg = true;
     skipFF_ = true;
     twp_ = 600;
     twc_ = 8;
@@ -41,6 +41,7 @@ Flash28F::Flash28F(QObject *parent) : ParDevice(parent) {
     info_.capability.hasVPP = true;
     info_.capability.hasErase = true;
     info_.capability.hasGetId = true;
+    info_.capability.hasDiffProg = true;
     vddRd_ = 5.0f;
     vddWr_ = 5.0f;
     vpp_ = 12.0f;
@@ -16,10 +16,13 @@
 // ---------------------------------------------------------------------------
 
 #include <QByteArray>
+#include <QElapsedTimer>
 #include <QRandomGenerator>
 #include <QLoggingCategory>
+#include <cstring>
 
 #include "backend/devices/parallel/pdevice.hpp"
+#include "backend/checksum.hpp"
 
 // ---------------------------------------------------------------------------
 // Logging
@@ -34,6 +37,21 @@ Q_LOGGING_CATEGORY(devicePar, "device.parallel")
 
 // ---------------------------------------------------------------------------
 
+/* @brief Size of the range processed by the firmware per request (verify
+ *   by hash, blank check by range), in bytes. The firmware must read it
+ *   within the timeout. */
+constexpr uint32_t kRangeSize = 0x8000;
+
+/* @brief Minimum run of blank blocks skipped while programming. Shorter
+ *   runs are cheaper to send than to end and restart the stream. */
+constexpr int kMinSkipBlocks = 4;
+
+/* @brief Size of the slices compared at once in the verify by read, in
+ *   bytes. Only the slices that differ are compared byte by byte. */
+constexpr int kCompareSliceSize = 64;
+
+// ---------------------------------------------------------------------------
+
 ParDevice::ParDevice(QObject *parent) : Device(parent) {
     info_.deviceType = kDeviceParallelMemory;
     info_.name = "Parallel Device";
@@ -72,14 +90,28 @@ bool ParDevice::program(const QByteArray &buffer, bool verify) {
     uint32_t total = qMin(size_, static_cast<uint32_t>(buffer.size()));
     if (flags_.is16bit) total /= 2;
     canceling_ = false;
+    changedBlocks_.clear();
+    // Program differences: compares the device first (Read operation)
+    if (diffProg_) {
+        bool success = initDevice(kDeviceOpRead);
+        if (success) success = diffDevice(buffer, changedBlocks_);
+        finalizeDevice();
+        if (!success) {
+            changedBlocks_.clear();
+            WARNING << "Error programming device";
+            return false;
+        }
+    }
     // Init pins/bus to Prog operation
     if (!initDevice(kDeviceOpProg)) {
+        changedBlocks_.clear();
         WARNING << "Error programming device";
         return false;
     }
     bool error = false;
     // Program the device
     if (!programDevice(buffer)) error = true;
+    changedBlocks_.clear();
     // Close resources
     finalizeDevice();
     // If error, returns
@@ -254,23 +286,42 @@ bool ParDevice::programDevice(const QByteArray &buffer) {
     if (flags_.is16bit) total /= 2;
     uint16_t data = 0xFFFF;
     int increment = (flags_.is16bit ? 2 : 1);
-    if (!runner_.deviceSetTwp(twp_) || !runner_.deviceSetTwc(twc_)) {
-        emit onProgress(current, total, true, false);
-        WARNING << "Program error: setting tWP or tWC";
-        return false;
-    }
     QByteArray block;
     int blockSize = (sectorSize_ ? sectorSize_ : getBufferSize());
     uint32_t count = blockSize;
     if (flags_.is16bit && count >= 2) count /= 2;
+    // sectors are written one by one, blocks are pipelined
+    int window = (sectorSize_ ? 1 : runner_.getWindowSize());
     int i = 0;
+    int attempt = 1;
+    int blocks, limit;
+    uint32_t start, done;
     bool success;
-    while (i < buffer.size()) {
-        // Repeat for n max attempts
-        for (int attempt = 1; attempt <= maxAttemptsProg_; attempt++) {
+    QElapsedTimer timer;
+    // stream the blocks, if supported by the firmware
+    bool streaming = false, streamable = true;
+    uint32_t streamStart = 0, streamCurrent = 0;
+    int streamI = 0, streamEnd = 0;
+    int end;
+    // sectors have a fixed size
+    startTuning_(sectorSize_ ? 0 : total * increment);
+    // plan the job: the blank blocks are skipped (jumping the address)
+    for (const auto &segment : planProgram_(buffer, blockSize)) {
+        i = segment.first;
+        end = segment.second;
+        if (runner_.addrGet() != i / increment) {
+            if (!runner_.addrSet(i / increment)) {
+                emit onProgress(current, total, true, false);
+                WARNING << "Program error: setting address";
+                return false;
+            }
+            current = i / increment;
+            emit onProgress(current, total);
+        }
+        while (i < end) {
             if ((current % 0x100) == 0) emit onProgress(current, total);
-            runner_.processEvents();
             if (canceling_) {
+                if (streaming) runner_.deviceWriteRangeEnd();
                 emit onProgress(current, total, true, false, true);
                 DEBUG << QString("Program canceled at 0x%1 of 0x%2")
                              .arg(current, 6, 16, QChar('0'))
@@ -278,38 +329,86 @@ bool ParDevice::programDevice(const QByteArray &buffer) {
                 return false;
             }
 
-            // Repeat for each byte/word in block size
-            block.clear();
-            do {
-                data = buffer[i] & 0xFF;
-                if (flags_.is16bit) {
-                    data <<= 8;                      // MSB
-                    data |= (buffer[i + 1] & 0xFF);  // LSB
-                }
-                // Insert data into block buffer
-                if (flags_.is16bit) block.append((data & 0xFF00) >> 8);
-                block.append(data & 0xFF);
-                i += increment;
-            } while (block.size() < blockSize);  // one block
+            if (!streaming && !sectorSize_) {
+                blockSize = tuneBlockSize_(i, end);
+                count = blockSize;
+                if (flags_.is16bit && count >= 2) count /= 2;
+            }
+
+            if (!streaming && streamable) {
+                streamStart = runner_.addrGet();
+                streamCurrent = current;
+                streamI = i;
+                // while tuning, each stream is a sample of one block size
+                blocks = tuneBlocks_(i, (end - i + blockSize - 1) / blockSize);
+                streamEnd = qMin(end, i + blocks * blockSize);
+                timer.start();
+                streaming = runner_.deviceWriteRangeBegin(
+                    streamStart, blocks * blockSize, blockSize,
+                    sectorSize_ != 0);
+                // blocks larger than a chunk are not streamed, but a
+                // smaller size (chosen by the tuner) may be
+                streamable = streaming || blockSize > kCmdStreamChunkSize;
+            }
+            limit = (streaming ? 1 : tuneBlocks_(i, window));
+
+            // Blocks in window: a slice of the buffer (the words are sent
+            // MSB first, as stored). The runner pads the last block.
+            blocks = qMin(limit, (end - i + blockSize - 1) / blockSize);
+            block.setRawData(buffer.constData() + i,
+                             qMin(blocks * blockSize, buffer.size() - i));
+            i += blocks * blockSize;
 
             // Write data
-            if (sectorSize_) {
+            start = runner_.addrGet();
+            if (!streaming) timer.start();
+            if (streaming) {
+                // Send the block (written while the next ones are arriving)
+                success = runner_.deviceWriteRangeNext(block);
+                // Last block: wait for the blocks in flight
+                if (success && i >= streamEnd) {
+                    success = runner_.deviceWriteRangeEnd();
+                }
+            } else if (sectorSize_) {
                 // Write (and verify) sector
                 success = runner_.deviceWriteSector(block, sectorSize_);
             } else {
-                // Write (and verify) block
-                success = runner_.deviceWrite(block);
+                // Write (and verify) blocks
+                success = runner_.deviceWriteBlocks(block);
             }
 
             // increment address
             if (success) {
-                current += count;
-                break;
+                current += blocks * count;
+                // streamed blocks are confirmed only at the end
+                if (!streaming || i >= streamEnd) attempt = 1;
+                // measure the link (a stream as a whole)
+                if (!streaming) {
+                    tuner_.addSample(blockSize, blocks * blockSize,
+                                     timer.nsecsElapsed() / 1000, false);
+                } else if (i >= streamEnd) {
+                    streaming = false;
+                    tuner_.addSample(blockSize, i - streamI,
+                                     timer.nsecsElapsed() / 1000, false);
+                }
+                continue;
+            }
+            // rewind to the first block not written
+            if (streaming) {
+                streaming = false;
+                done = (runner_.addrGet() - streamStart) / count;
+                current = streamCurrent + done * count;
+                i = streamI + done * blockSize;
             } else {
-                i -= blockSize;
+                done = sectorSize_ ? 0 : (runner_.addrGet() - start) / count;
+                current += done * count;
+                i -= (blocks - done) * blockSize;
             }
+            tuner_.addSample(blockSize, done * blockSize,
+                             timer.nsecsElapsed() / 1000, true);
+            if (done) attempt = 1;
 
-            // Error
+            // Error (after n max attempts)
             if (attempt == maxAttemptsProg_) {
                 emit onProgress(current, total, true, false);
                 data = buffer[i] & 0xFF;
@@ -326,13 +425,56 @@ bool ParDevice::programDevice(const QByteArray &buffer) {
                                     QChar('0'));
                 return false;
             }
+            attempt++;
         }
     }
     DEBUG << "Program OK";
     return true;
 }
 
+QList<QPair<int, int>> ParDevice::planProgram_(const QByteArray &buffer,
+                                               int blockSize) const {
+    QList<QPair<int, int>> result;
+    int size = buffer.size();
+    if (!size || blockSize <= 0) return result;
+    int start = -1, last = 0, end, n = 0;
+    bool blankGap = true;
+    for (int i = 0; i < size; i += blockSize, n++) {
+        end = qMin(i + blockSize, size);
+        bool blank = flags_.skipFF;
+        for (int j = i; j < end && blank; j++) {
+            blank = (static_cast<uint8_t>(buffer[j]) == 0xFF);
+        }
+        if (blank) continue;
+        if (n < changedBlocks_.size() && !changedBlocks_[n]) {
+            blankGap = false;
+            continue;
+        }
+        // a short run of blank blocks is written with the data (the
+        // firmware skips the 0xFF bytes), unchanged blocks are not
+        if (start >= 0 && i > last &&
+            (!blankGap || (i - last) >= kMinSkipBlocks * blockSize)) {
+            result.append(qMakePair(start, last));
+            start = -1;
+        }
+        if (start < 0) start = i;
+        last = end;
+        blankGap = true;
+    }
+    if (start >= 0) result.append(qMakePair(start, last));
+    return result;
+}
+
 bool ParDevice::verifyDevice(const QByteArray &buffer) {
+    uint32_t crc;
+    mismatches_.clear();
+    // the firmware calculates the CRC-32 of the ranges (empty range probe)
+    if (runner_.deviceCrc32Range(runner_.addrGet(), 0, crc)) {
+        return verifyDeviceByHash(buffer);
+    }
+    // the firmware streams the ranges: compares on the host, so the data
+    // is not sent back to the device
+    if (runner_.hasReadRange()) return verifyDeviceByRead(buffer);
     DEBUG << "Verifying data...";
     uint32_t current = 0;
     uint32_t total = qMin(size_, static_cast<uint32_t>(buffer.size()));
@@ -340,14 +482,21 @@ bool ParDevice::verifyDevice(const QByteArray &buffer) {
     uint16_t data = 0xFFFF;
     int increment = (flags_.is16bit ? 2 : 1);
     QByteArray block;
-    int blockSize = getBufferSize();
-    uint32_t count = blockSize;
-    if (flags_.is16bit && count >= 2) count /= 2;
+    int blockSize;
+    uint32_t count;
+    uint32_t window = runner_.getWindowSize();
+    uint32_t blocks, start, done;
     bool success;
+    QElapsedTimer timer;
     int i = 0;
-    for (current = 0; current < total; current += count) {
+    startTuning_(total * increment);
+    for (current = 0; current < total; current += blocks * count) {
+        blockSize = tuneBlockSize_(i, total * increment);
+        count = blockSize;
+        if (flags_.is16bit && count >= 2) count /= 2;
+        blocks = qMin(window, (total - current + count - 1) / count);
+        blocks = tuneBlocks_(i, blocks);
         if ((current % 0x100) == 0) emit onProgress(current, total);
-        runner_.processEvents();
         if (canceling_) {
             emit onProgress(current, total, true, false, true);
             DEBUG << QString("Verify canceled at 0x%1 of 0x%2")
@@ -356,28 +505,26 @@ bool ParDevice::verifyDevice(const QByteArray &buffer) {
             return false;
         }
 
-        // Repeat for each byte/word in block size
-        block.clear();
-        do {
-            if (i >= buffer.size()) break;
-            data = buffer[i] & 0xFF;
-            if (flags_.is16bit) {
-                data <<= 8;                      // MSB
-                data |= (buffer[i + 1] & 0xFF);  // LSB
-            }
-            // Insert data into block buffer
-            if (flags_.is16bit) block.append((data & 0xFF00) >> 8);
-            block.append(data & 0xFF);
-            i += increment;
-        } while (block.size() < blockSize);  // one block
+        // Blocks in window: a slice of the buffer (the words are sent
+        // MSB first, as stored). The runner pads the last block.
+        block.setRawData(buffer.constData() + i,
+                         qMin<int>(blocks * blockSize, buffer.size() - i));
+        i += block.size();
 
-        // Verify block
-        success = runner_.deviceVerify(block);
+        // Verify blocks
+        start = runner_.addrGet();
+        timer.start();
+        success = runner_.deviceVerifyBlocks(block);
+        tuner_.addSample(blockSize, block.size(), timer.nsecsElapsed() / 1000,
+                         !success);
 
         // Error
         if (!success) {
+            // rewind to the first block not verified
+            done = (runner_.addrGet() - start) / count;
+            current += done * count;
+            i -= block.size() - done * blockSize;
             emit onProgress(current, total, true, false);
-            i -= blockSize;
             data = buffer[i] & 0xFF;
             if (flags_.is16bit) {
                 data <<= 8;                      // MSB
@@ -395,40 +542,302 @@ bool ParDevice::verifyDevice(const QByteArray &buffer) {
     return true;
 }
 
+bool ParDevice::verifyDeviceByHash(const QByteArray &buffer) {
+    DEBUG << "Verifying data (by hash)...";
+    uint32_t current = 0;
+    uint32_t total = qMin(size_, static_cast<uint32_t>(buffer.size()));
+    if (flags_.is16bit) total /= 2;
+    uint32_t count = getBufferSize();
+    if (flags_.is16bit && count >= 2) count /= 2;
+    uint32_t range = flags_.is16bit ? (kRangeSize / 2) : kRangeSize;
+    uint32_t length, half;
+    bool match, error = false;
+    for (current = 0; current < total; current += length) {
+        emit onProgress(current, total);
+        if (canceling_) {
+            emit onProgress(current, total, true, false, true);
+            DEBUG << QString("Verify canceled at 0x%1 of 0x%2")
+                         .arg(current, 6, 16, QChar('0'))
+                         .arg(total, 6, 16, QChar('0'));
+            return false;
+        }
+        length = qMin(range, total - current);
+        if (!verifyRangeByHash_(buffer, current, length, match)) {
+            error = true;
+            break;
+        }
+        if (match) continue;
+        // bisect the range down to the first mismatched block
+        while (length > count) {
+            half = ((length / count + 1) / 2) * count;
+            if (!verifyRangeByHash_(buffer, current, half, match)) {
+                error = true;
+                break;
+            }
+            if (match) {
+                current += half;
+                length -= half;
+            } else {
+                length = half;
+            }
+        }
+        break;
+    }
+    if (current >= total) {
+        DEBUG << "Verify OK";
+        return true;
+    }
+    // reads the rest of the device, to find all the mismatched addresses
+    // (if it matches now, the device returns unstable data)
+    if (!error && runner_.hasReadRange() &&
+        !verifyDeviceByRead(buffer, current)) {
+        return false;
+    }
+    emit onProgress(current, total, true, false);
+    WARNING << QString("Verify error at 0x%1 of 0x%2")
+                   .arg(current, 6, 16, QChar('0'))
+                   .arg(total, 6, 16, QChar('0'));
+    return false;
+}
+
+bool ParDevice::verifyDeviceByRead(const QByteArray &buffer,
+                                   uint32_t from) {
+    DEBUG << "Verifying data (by read)...";
+    uint32_t total = qMin(size_, static_cast<uint32_t>(buffer.size()));
+    if (flags_.is16bit) total /= 2;
+    int increment = (flags_.is16bit ? 2 : 1);
+    uint32_t current = qMin(from, total);
+    QByteArray data;
+    data.reserve(kCmdStreamChunkSize);
+    mismatches_.clear();
+    if (current < total &&
+        !runner_.deviceReadRangeBegin(current,
+                                      (total - current) * increment)) {
+        emit onProgress(current, total, true, false);
+        WARNING << QString("Verify error at 0x%1 of 0x%2")
+                       .arg(current, 6, 16, QChar('0'))
+                       .arg(total, 6, 16, QChar('0'));
+        return false;
+    }
+    while (current < total) {
+        emit onProgress(current, total);
+        if (canceling_) {
+            runner_.deviceReadRangeEnd();
+            emit onProgress(current, total, true, false, true);
+            DEBUG << QString("Verify canceled at 0x%1 of 0x%2")
+                         .arg(current, 6, 16, QChar('0'))
+                         .arg(total, 6, 16, QChar('0'));
+            return false;
+        }
+        data.resize(0);
+        if (!runner_.deviceReadRangeNext(data)) {
+            emit onProgress(current, total, true, false);
+            WARNING << QString("Read error at 0x%1 of 0x%2")
+                           .arg(current, 6, 16, QChar('0'))
+                           .arg(total, 6, 16, QChar('0'));
+            return false;
+        }
+        compareData_(buffer, current * increment, data);
+        current += data.size() / increment;
+    }
+    if (mismatches_.isEmpty()) {
+        DEBUG << "Verify OK";
+        return true;
+    }
+    emit onProgress(mismatches_.first(), total, true, false);
+    WARNING << QString("Verify error at 0x%1 of 0x%2. Mismatches: %3")
+                   .arg(mismatches_.first(), 6, 16, QChar('0'))
+                   .arg(total, 6, 16, QChar('0'))
+                   .arg(mismatches_.size());
+    return false;
+}
+
+void ParDevice::compareData_(const QByteArray &buffer, int offset,
+                             const QByteArray &data) {
+    int increment = (flags_.is16bit ? 2 : 1);
+    int length = qMin(data.size(), buffer.size() - offset);
+    const char *expected = buffer.constData() + offset;
+    const char *actual = data.constData();
+    uint32_t address;
+    for (int i = 0; i < length; i += kCompareSliceSize) {
+        int size = qMin(kCompareSliceSize, length - i);
+        if (!memcmp(actual + i, expected + i, size)) continue;
+        for (int j = i; j < i + size; j++) {
+            if (actual[j] == expected[j]) continue;
+            address = (offset + j) / increment;
+            // both bytes of a word may differ
+            if (mismatches_.isEmpty() || mismatches_.last() != address) {
+                mismatches_.append(address);
+            }
+        }
+    }
+}
+
+bool ParDevice::verifyRangeByHash_(const QByteArray &buffer,
+                                   uint32_t address, uint32_t length,
+                                   bool &match) {
+    int increment = (flags_.is16bit ? 2 : 1);
+    int offset = qMin(static_cast<int>(address * increment), buffer.size());
+    int size = qMin(static_cast<int>(length * increment),
+                    buffer.size() - offset);
+    uint32_t crc = 0, expected;
+    match = false;
+    if (!runner_.deviceCrc32Range(address, size, crc)) return false;
+    if (crcCache_) {
+        expected = crcCache_->crc32(buffer.constData(), offset, size);
+    } else {
+        expected = Checksum::crc32(buffer.constData() + offset, size);
+    }
+    match = (crc == expected);
+    return true;
+}
+
+bool ParDevice::diffDevice(const QByteArray &buffer,
+                           QVector<bool> &changed) {
+    DEBUG << "Comparing data...";
+    int blockSize = (sectorSize_ ? sectorSize_ : getBufferSize());
+    int blocks = (buffer.size() + blockSize - 1) / blockSize;
+    uint32_t crc;
+    changed.clear();
+    // the firmware calculates the CRC-32 of the ranges (empty range probe)
+    if (isRewritable_() &&
+        runner_.deviceCrc32Range(runner_.addrGet(), 0, crc)) {
+        changed.resize(blocks);
+        uint32_t current = 0;
+        uint32_t total = qMin(size_, static_cast<uint32_t>(buffer.size()));
+        if (flags_.is16bit) total /= 2;
+        uint32_t count = blockSize;
+        if (flags_.is16bit && count >= 2) count /= 2;
+        uint32_t range = flags_.is16bit ? (kRangeSize / 2) : kRangeSize;
+        uint32_t length;
+        for (current = 0; current < total; current += length) {
+            emit onProgress(current, total);
+            if (canceling_) {
+                emit onProgress(current, total, true, false, true);
+                DEBUG << QString("Compare canceled at 0x%1 of 0x%2")
+                             .arg(current, 6, 16, QChar('0'))
+                             .arg(total, 6, 16, QChar('0'));
+                return false;
+            }
+            length = qMin(range, total - current);
+            if (!diffRangeByHash_(buffer, current, length, count, changed)) {
+                emit onProgress(current, total, true, false);
+                WARNING << QString("Compare error at 0x%1 of 0x%2")
+                               .arg(current, 6, 16, QChar('0'))
+                               .arg(total, 6, 16, QChar('0'));
+                return false;
+            }
+        }
+    } else {
+        // reads the device
+        QByteArray data;
+        if (!readDevice(data)) return false;
+        changed.resize(blocks);
+        bool erase = false;
+        uint8_t current, value;
+        for (int i = 0; i < buffer.size(); i++) {
+            current = (i < data.size()) ? data[i] : 0xFF;
+            value = buffer[i];
+            if (current == value) continue;
+            changed[i / blockSize] = true;
+            // the bits can only be programmed from 1 to 0
+            if (!isRewritable_() && (current & value) != value) erase = true;
+        }
+        if (erase) {
+            WARNING << "Program differences: the device must be erased."
+                    << "Programming all the blocks";
+            changed.clear();
+        }
+    }
+    int count = 0;
+    for (bool item : changed) {
+        if (item) count++;
+    }
+    DEBUG << "Compare OK. Changed blocks:" << count << "of" << blocks;
+    return true;
+}
+
+bool ParDevice::diffRangeByHash_(const QByteArray &buffer,
+                                 uint32_t address, uint32_t length,
+                                 uint32_t count, QVector<bool> &changed) {
+    bool match;
+    if (!verifyRangeByHash_(buffer, address, length, match)) return false;
+    if (match) return true;
+    if (length <= count) {
+        changed[address / count] = true;
+        return true;
+    }
+    // bisect the range (aligned to the block size)
+    uint32_t half = ((length / count + 1) / 2) * count;
+    return diffRangeByHash_(buffer, address, half, count, changed) &&
+           diffRangeByHash_(buffer, address + half, length - half, count,
+                            changed);
+}
+
 bool ParDevice::readDevice(QByteArray &buffer) {
     DEBUG << "Reading data...";
     uint32_t current = 0;
     uint32_t total = size_;
     if (flags_.is16bit) total /= 2;
-    int blockSize = getBufferSize();
-    uint32_t count = blockSize;
-    if (flags_.is16bit && count >= 2) count /= 2;
-    QByteArray data;
+    int increment = (flags_.is16bit ? 2 : 1);
+    int blockSize;
+    uint32_t count;
+    uint32_t window = runner_.getWindowSize();
+    uint32_t blocks;
+    int offset, received;
+    // the data is received in place
     buffer.clear();
+    buffer.reserve(size_);
     bool success;
-    for (current = 0; current < total; current += count) {
+    QElapsedTimer timer;
+    // stream the whole range, if supported by the firmware
+    bool streaming = runner_.deviceReadRangeBegin(runner_.addrGet(), size_);
+    // the stream does not use the buffer size
+    startTuning_(streaming ? 0 : size_);
+    for (current = 0; current < total;) {
+        blockSize = tuneBlockSize_(current * increment, size_);
+        count = blockSize;
+        if (flags_.is16bit && count >= 2) count /= 2;
+        blocks = qMin(window, (total - current + count - 1) / count);
+        blocks = tuneBlocks_(current * increment, blocks);
         if (current % 0x100 == 0) emit onProgress(current, total);
-        runner_.processEvents();
         if (canceling_) {
+            if (streaming) runner_.deviceReadRangeEnd();
             emit onProgress(current, total, true, false, true);
             DEBUG << QString("Read canceled at 0x%1 of 0x%2")
                          .arg(current, 6, 16, QChar('0'))
                          .arg(total, 6, 16, QChar('0'));
             return false;
         }
-        // Read block
-        data = runner_.deviceRead();
-        success = (data.size() == blockSize);
+        // Read blocks (or the next chunk of the stream)
+        offset = buffer.size();
+        if (streaming) {
+            success = runner_.deviceReadRangeNext(buffer);
+        } else {
+            timer.start();
+            success = runner_.deviceReadBlocks(blocks, buffer);
+        }
+        received = buffer.size() - offset;
+        if (!streaming) {
+            success = success && (received == blocks * blockSize);
+            tuner_.addSample(blockSize, received,
+                             timer.nsecsElapsed() / 1000, !success);
+        }
         // Error
         if (!success) {
+            if (!streaming) current += (received / blockSize) * count;
+            buffer.resize(offset);
             emit onProgress(current, total, true, false);
             WARNING << QString("Read error at 0x%1 of 0x%2")
                            .arg(current, 6, 16, QChar('0'))
                            .arg(total, 6, 16, QChar('0'));
             return false;
         }
-        // Copy data
-        buffer.append(data);
+        if (streaming) {
+            current += (flags_.is16bit ? received / 2 : received);
+        } else {
+            current += blocks * count;
+        }
     }
     DEBUG << "Read OK";
     return true;
@@ -441,11 +850,8 @@ bool ParDevice::eraseDevice() {
     if (flags_.is16bit) total /= 2;
     uint32_t count = getBufferSize();
     if (flags_.is16bit && count >= 2) count /= 2;
-    if (!runner_.deviceSetTwp(twp_) || !runner_.deviceSetTwc(twc_)) {
-        emit onProgress(current, total, true, false);
-        WARNING << "Erase error: setting tWP or tWC";
-        return false;
-    }
+    uint32_t window = runner_.getWindowSize();
+    uint32_t blocks;
     // VPP on
     runner_.vppCtrl(true);
     // Repeat for n max attempts
@@ -453,9 +859,9 @@ bool ParDevice::eraseDevice() {
         // Erase entire chip
         bool success = true;
         if (!runner_.deviceErase()) success = false;
-        for (current = 0; current < total; current += count) {
+        for (current = 0; current < total; current += blocks * count) {
+            blocks = qMin(window, (total - current + count - 1) / count);
             if (current % 0x100 == 0) emit onProgress(current, total);
-            runner_.processEvents();
             if (canceling_) {
                 emit onProgress(current, total, true, false, true);
                 DEBUG << QString("Erase canceled at 0x%1 of 0x%2")
@@ -465,8 +871,8 @@ bool ParDevice::eraseDevice() {
             }
             // Verify data, if not in Fast Erase mode
             if (!fastProg_) {
-                // Check block
-                if (success && !runner_.deviceBlankCheck()) {
+                // Check blocks
+                if (success && !runner_.deviceBlankCheckBlocks(blocks)) {
                     success = false;
                 }
             }
@@ -493,6 +899,12 @@ bool ParDevice::eraseDevice() {
 }
 
 bool ParDevice::blankCheckDevice() {
+    uint32_t dirty, first;
+    dirtyCount_ = 0;
+    // the firmware checks the ranges (empty range probe)
+    if (runner_.deviceBlankCheckRange(runner_.addrGet(), 0, dirty, first)) {
+        return blankCheckDeviceByRange();
+    }
     DEBUG << "Blank checking data...";
     uint32_t current = 0;
     uint32_t total = size_;
@@ -500,10 +912,12 @@ bool ParDevice::blankCheckDevice() {
     int increment = flags_.is16bit ? 2 : 1;
     uint32_t count = getBufferSize();
     if (flags_.is16bit && count >= 2) count /= 2;
+    uint32_t window = runner_.getWindowSize();
+    uint32_t blocks, start;
     bool success;
-    for (current = 0; current < total; current += count) {
+    for (current = 0; current < total; current += blocks * count) {
+        blocks = qMin(window, (total - current + count - 1) / count);
         if ((current % 0x100) == 0) emit onProgress(current, total);
-        runner_.processEvents();
         if (canceling_) {
             emit onProgress(current, total, true, false, true);
             DEBUG << QString("Blank Check canceled at 0x%1 of 0x%2")
@@ -511,10 +925,12 @@ bool ParDevice::blankCheckDevice() {
                          .arg(total, 6, 16, QChar('0'));
             return false;
         }
-        // Check block
-        success = runner_.deviceBlankCheck();
+        // Check blocks
+        start = runner_.addrGet();
+        success = runner_.deviceBlankCheckBlocks(blocks);
         // Error
         if (!success) {
+            current += ((runner_.addrGet() - start) / count) * count;
             emit onProgress(current, total, true, false);
             WARNING << QString("Blank Check error at 0x%1 of 0x%2")
                            .arg(current, 6, 16, QChar('0'))
@@ -526,6 +942,48 @@ bool ParDevice::blankCheckDevice() {
     return true;
 }
 
+bool ParDevice::blankCheckDeviceByRange() {
+    DEBUG << "Blank checking data (by range)...";
+    uint32_t current = 0;
+    uint32_t total = size_;
+    if (flags_.is16bit) total /= 2;
+    int increment = flags_.is16bit ? 2 : 1;
+    uint32_t range = flags_.is16bit ? (kRangeSize / 2) : kRangeSize;
+    uint32_t length, dirty, first, firstDirty = 0;
+    for (current = 0; current < total; current += length) {
+        emit onProgress(current, total);
+        if (canceling_) {
+            emit onProgress(current, total, true, false, true);
+            DEBUG << QString("Blank Check canceled at 0x%1 of 0x%2")
+                         .arg(current, 6, 16, QChar('0'))
+                         .arg(total, 6, 16, QChar('0'));
+            return false;
+        }
+        length = qMin(range, total - current);
+        if (!runner_.deviceBlankCheckRange(current, length * increment, dirty,
+                                           first)) {
+            emit onProgress(current, total, true, false);
+            WARNING << QString("Blank Check error at 0x%1 of 0x%2")
+                           .arg(current, 6, 16, QChar('0'))
+                           .arg(total, 6, 16, QChar('0'));
+            return false;
+        }
+        // checks all the device, to count the non-blank bytes/words
+        if (dirty && !dirtyCount_) firstDirty = first;
+        dirtyCount_ += dirty;
+    }
+    if (dirtyCount_) {
+        emit onProgress(firstDirty, total, true, false);
+        WARNING << QString("Blank Check error at 0x%1 of 0x%2. Non-blank: %3")
+                       .arg(firstDirty, 6, 16, QChar('0'))
+                       .arg(total, 6, 16, QChar('0'))
+                       .arg(dirtyCount_);
+        return false;
+    }
+    DEBUG << "Blank Check OK";
+    return true;
+}
+
 bool ParDevice::getIdDevice(TDeviceID &deviceId) {
     DEBUG << "Getting ID...";
     uint32_t current = 0;
@@ -547,11 +1005,6 @@ bool ParDevice::protectDevice(bool protect) {
     uint32_t current = 0;
     uint32_t total = size_;
     if (flags_.is16bit) total /= 2;
-    if (!runner_.deviceSetTwp(twp_) || !runner_.deviceSetTwc(twc_)) {
-        emit onProgress(current, total, true, false);
-        WARNING << "Protect/Unprotect error: setting tWP or tWC";
-        return false;
-    }
     // Protect/Unprotect
     bool success;
     if (protect) {
@@ -575,52 +1028,49 @@ bool ParDevice::initDevice(kDeviceOperation operation) {
         WARNING << "Error opening serial port";
         return false;
     }
-    if (!runner_.deviceConfigure(algo_, flags_)) {
-        emit onProgress(0, size_, true, false);
-        WARNING << "Error configuring device";
-        return false;
-    }
-    bool success = true;
+    float vdd = 0.0f, vpp = 0.0f;
+    uint8_t keep = kCmdDeviceSetupKeepVdd | kCmdDeviceSetupKeepVpp;
+    kCmdDeviceOperationEnum busOperation = kCmdDeviceOperationReset;
     switch (operation) {
         case kDeviceOpRead:
             // VDD Rd
-            if (!runner_.vddSet(vddRd_) ||
-                !runner_.deviceSetupBus(kCmdDeviceOperationRead)) {
-                success = false;
-            }
+            vdd = vddRd_;
+            keep = kCmdDeviceSetupKeepVpp;
+            busOperation = kCmdDeviceOperationRead;
             break;
         case kDeviceOpProg:
             // VDD Wr / VPP
-            if (!runner_.vddSet(vddWr_) || !runner_.vppSet(vpp_) ||
-                !runner_.deviceSetupBus(kCmdDeviceOperationProg)) {
-                success = false;
-            }
+            vdd = vddWr_;
+            vpp = vpp_;
+            keep = 0;
+            busOperation = kCmdDeviceOperationProg;
             break;
         case kDeviceOpErase:
             // VDD Wr / VEE
-            if (!runner_.vddSet(vddWr_) || !runner_.vppSet(vee_) ||
-                !runner_.deviceSetupBus(kCmdDeviceOperationProg)) {
-                success = false;
-            }
+            vdd = vddWr_;
+            vpp = vee_;
+            keep = 0;
+            busOperation = kCmdDeviceOperationProg;
             break;
         case kDeviceOpGetId:
             // VDD Rd / VEE
-            if (!runner_.vddSet(vddRd_) || !runner_.vppSet(vee_) ||
-                !runner_.deviceResetBus()) {
-                success = false;
-            }
+            vdd = vddRd_;
+            vpp = vee_;
+            keep = 0;
             break;
         case kDeviceOpReset:
         default:
-            if (!runner_.deviceResetBus()) success = false;
             break;
     }
-    if (success) {
-        DEBUG << "Initialize OK";
-    } else {
-        DEBUG << "Error initializing device";
+    // configuration, timings, voltages and bus in one command
+    if (!runner_.deviceSetup(algo_, flags_, vdd, vpp, twp_, twc_,
+                             busOperation, keep)) {
+        emit onProgress(0, size_, true, false);
+        WARNING << "Error initializing device";
+        return false;
     }
-    return success;
+    DEBUG << "Initialize OK";
+    return true;
 }
 
 void ParDevice::finalizeDevice() {
@@ -637,6 +1087,10 @@ bool ParDevice::finalizeDevice(uint32_t current, uint32_t total, bool done,
     return success;
 }
 
+bool ParDevice::isRewritable_() const {
+    return false;
+}
+
 QByteArray ParDevice::generateRandomData_() {
     DEBUG << "Generating Random Data...";
     QByteArray buffer(size_, 0);
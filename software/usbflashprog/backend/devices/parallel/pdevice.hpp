@@ -23,6 +23,9 @@
 #include <QObject>
 #include <QString>
 #include <QByteArray>
+#include <QList>
+#include <QPair>
+#include <QVector>
 
 #include "backend/devices/device.hpp"
 
@@ -85,10 +88,48 @@ class ParDevice : public Device {
     virtual bool programDevice(const QByteArray &buffer);
     /**
      * @brief Verify the device.
+     * @details Picks the strategy supported by the firmware: by the CRC-32
+     *   of the ranges (verifyDeviceByHash()), by reading the device with
+     *   the Read Range stream (verifyDeviceByRead()), or by sending the
+     *   blocks to compare on the device.
      * @param buffer Data to compare.
      * @return True if success, false otherwise.
      */
     virtual bool verifyDevice(const QByteArray &buffer);
+    /**
+     * @brief Verify the device comparing the CRC-32 of each range,
+     *   calculated by the firmware, with the CRC-32 of the buffer.
+     *   A mismatched range is bisected down to the first mismatched block.
+     *   If the firmware streams the ranges, the device is then read from
+     *   that block, to find all the mismatched addresses.
+     * @param buffer Data to compare.
+     * @return True if success, false otherwise.
+     */
+    virtual bool verifyDeviceByHash(const QByteArray &buffer);
+    /**
+     * @brief Verify the device reading it with the Read Range stream and
+     *   comparing the data on the host, so the data is not sent to the
+     *   device. All the mismatched addresses are recorded (see
+     *   getMismatches()).
+     * @param buffer Data to compare.
+     * @param from Start address, in bytes/words (default is zero).
+     * @return True if success, false otherwise.
+     */
+    virtual bool verifyDeviceByRead(const QByteArray &buffer,
+                                    uint32_t from = 0);
+    /**
+     * @brief Compares the device with the buffer, per block to program
+     *   (program differences mode).
+     * @details If the device can be rewritten without erasing, the CRC-32
+     *   of the ranges (calculated by the firmware) are compared, bisected
+     *   down to the blocks. Otherwise, the device is read, and if a block
+     *   can not be programmed over the current data, all the blocks are
+     *   marked as changed.
+     * @param buffer Data to compare.
+     * @param[out] changed One flag per block, true if the block differs.
+     * @return True if success, false otherwise.
+     */
+    virtual bool diffDevice(const QByteArray &buffer, QVector<bool> &changed);
     /**
      * @brief Read the device.
      * @param buffer[out] Data to read.
@@ -111,6 +152,12 @@ class ParDevice : public Device {
      * @return True if success, false otherwise.
      */
     virtual bool blankCheckDevice();
+    /**
+     * @brief Blank Check the device by ranges, checked by the firmware
+     *   (counting all the non-blank bytes/words).
+     * @return True if success, false otherwise.
+     */
+    virtual bool blankCheckDeviceByRange();
     /**
      * @brief Protect/Unprotect the device.
      * @param protect If true, protects the device.
@@ -147,6 +194,53 @@ class ParDevice : public Device {
     /* @brief Generates a buffer with a specified pattern data.
      * @return Buffer with pattern data. */
     virtual QByteArray generatePatternData_();
+    /* @brief Compares the CRC-32 of a range of the device with the
+     *   CRC-32 of the same range of the buffer.
+     * @param buffer Data to compare.
+     * @param address Start address of the range.
+     * @param length Length of the range, in bytes/words.
+     * @param[out] match True if the CRCs are equal, false otherwise.
+     * @return True if success, false otherwise (communication error). */
+    bool verifyRangeByHash_(const QByteArray &buffer, uint32_t address,
+                            uint32_t length, bool &match);
+    /* @brief Compares the data read from the device with the buffer,
+     *   appending the mismatched addresses to the list.
+     * @param buffer Data to compare.
+     * @param offset Offset of the data in the buffer, in bytes.
+     * @param data Data read from the device (the bytes after the end of
+     *   the buffer are ignored). */
+    void compareData_(const QByteArray &buffer, int offset,
+                      const QByteArray &data);
+    /* @brief Indicates if the device can be rewritten without erasing.
+     * @return True if rewritable, false otherwise (default). */
+    virtual bool isRewritable_() const;
+    /* @brief Compares the CRC-32 of a range of the device with the buffer,
+     *   bisecting a mismatched range down to the blocks.
+     * @param buffer Data to compare.
+     * @param address Start address of the range.
+     * @param length Length of the range, in bytes/words.
+     * @param count Block size, in bytes/words.
+     * @param[out] changed Flags of the blocks that differ.
+     * @return True if success, false otherwise (communication error). */
+    bool diffRangeByHash_(const QByteArray &buffer, uint32_t address,
+                          uint32_t length, uint32_t count,
+                          QVector<bool> &changed);
+    /* @brief Plans the programming job: finds the segments of the buffer
+     *   to write. If the firmware skips the 0xFF bytes, the runs of blank
+     *   blocks (all 0xFF) are left out, so they are neither sent nor
+     *   written. In program differences mode, the unchanged blocks are
+     *   left out too.
+     * @param buffer Data to write.
+     * @param blockSize Block size, in bytes.
+     * @return List of segments (first byte, last byte + 1) of the buffer,
+     *   aligned to the block size (except the end of the buffer). */
+    QList<QPair<int, int>> planProgram_(const QByteArray &buffer,
+                                        int blockSize) const;
+
+  private:
+    /* @brief Blocks that differ from the device (program differences
+     *   mode). If empty, all the blocks are written. */
+    QVector<bool> changedBlocks_;
 };
 
 #endif  // BACKEND_DEVICES_PARALLEL_DEVICE_HPP_
@@ -0,0 +1,150 @@
+// ---------------------------------------------------------------------------
+// USB EPROM/Flash Programmer
+//
+// Copyright (2024) Robson Martins
+//
+// This work is licensed under a Creative Commons Attribution-NonCommercial-
+// ShareAlike 4.0 International License.
+// ---------------------------------------------------------------------------
+/**
+ * @ingroup Software
+ * @file backend/gang.cpp
+ * @brief Implementation of the Gang Class.
+ *
+ * @author Robson Martins (https://www.robsonmartins.com)
+ */
+// ---------------------------------------------------------------------------
+
+#include <QLoggingCategory>
+
+#include "backend/gang.hpp"
+
+// ---------------------------------------------------------------------------
+// Logging
+
+Q_LOGGING_CATEGORY(gang, "gang")
+
+#define DEBUG qCDebug(gang)
+#define INFO qCInfo(gang)
+#define WARNING qCWarning(gang)
+#define CRITICAL qCCritical(gang)
+#define FATAL qCFatal(gang)
+
+// ---------------------------------------------------------------------------
+
+Gang::Gang(QObject *parent)
+    : QObject(parent), crcCache_(std::make_shared<CrcCache>()), running_(0) {}
+
+Gang::~Gang() {
+    clear();
+}
+
+void Gang::addStation(Device *device) {
+    if (!device) return;
+    int index = stations_.size();
+    TGangStation station;
+    station.device = device;
+    station.thread = new QThread(this);
+    station.running = false;
+    station.success = false;
+    device->setCrcCache(crcCache_);
+    connect(
+        device, &Device::onProgress, this,
+        [this, index](uint32_t current, uint32_t total, bool done,
+                      bool success, bool canceled) {
+            emit onProgress(index, current, total, done, success, canceled);
+        },
+        Qt::QueuedConnection);
+    // the device operations run on the thread of the station
+    device->setParent(nullptr);
+    device->moveToThread(station.thread);
+    station.thread->start();
+    stations_.push_back(station);
+    DEBUG << "Station" << index << "added:" << device->getPort();
+}
+
+void Gang::clear() {
+    cancel();
+    for (auto &station : stations_) {
+        station.device->disconnect();
+        // deleted on the thread of the station, after the running operation
+        station.device->deleteLater();
+        station.thread->quit();
+        station.thread->wait();
+        delete station.thread;
+    }
+    stations_.clear();
+    running_ = 0;
+}
+
+int Gang::getCount() const {
+    return stations_.size();
+}
+
+QString Gang::getPort(int station) const {
+    if (station < 0 || station >= stations_.size()) return QString();
+    return stations_[station].device->getPort();
+}
+
+Device *Gang::getDevice(int station) const {
+    if (station < 0 || station >= stations_.size()) return nullptr;
+    return stations_[station].device;
+}
+
+bool Gang::start(const QByteArray &image, TGangAction action) {
+    if (running_ || stations_.isEmpty() || !action) return false;
+    // the CRCs are kept while the image is the same
+    if (image != image_) crcCache_->clear();
+    image_ = image;
+    running_ = stations_.size();
+    DEBUG << "Starting" << running_ << "stations...";
+    for (int i = 0; i < stations_.size(); i++) {
+        TGangStation &station = stations_[i];
+        station.running = true;
+        station.success = false;
+        Device *device = station.device;
+        // the image is implicitly shared (not copied)
+        QByteArray data = image_;
+        QMetaObject::invokeMethod(
+            device,
+            [this, i, device, data, action]() {
+                bool result = action(device, data);
+                QMetaObject::invokeMethod(
+                    this, [this, i, result]() { finishStation_(i, result); },
+                    Qt::QueuedConnection);
+            },
+            Qt::QueuedConnection);
+    }
+    return true;
+}
+
+void Gang::cancel() {
+    for (auto &station : stations_) {
+        if (station.running) station.device->cancel();
+    }
+}
+
+bool Gang::isRunning() const {
+    return running_ > 0;
+}
+
+bool Gang::getResult(int station) const {
+    if (station < 0 || station >= stations_.size()) return false;
+    return !stations_[station].running && stations_[station].success;
+}
+
+void Gang::finishStation_(int station, bool success) {
+    if (station >= stations_.size() || !stations_[station].running) return;
+    stations_[station].running = false;
+    stations_[station].success = success;
+    DEBUG << "Station" << station << (success ? "passed" : "failed");
+    emit onStationFinished(station, success);
+    if (--running_ > 0) return;
+    int passed = 0;
+    for (const auto &item : stations_) {
+        if (item.success) passed++;
+    }
+    INFO << "Gang finished:" << passed << "passed,"
+         << (stations_.size() - passed) << "failed";
+    emit onFinished(passed, stations_.size() - passed);
+}
@@ -0,0 +1,170 @@
+// ---------------------------------------------------------------------------
+// USB EPROM/Flash Programmer
+//
+// Copyright (2024) Robson Martins
+//
+// This work is licensed under a Creative Commons Attribution-NonCommercial-
+// ShareAlike 4.0 International License.
+// ---------------------------------------------------------------------------
+/**
+ * @ingroup Software
+ * @file backend/gang.hpp
+ * @brief Header of the Gang Class.
+ *
+ * @author Robson Martins (https://www.robsonmartins.com)
+ */
+// ---------------------------------------------------------------------------
+
+#ifndef BACKEND_GANG_HPP_
+#define BACKEND_GANG_HPP_
+
+// ---------------------------------------------------------------------------
+
+#include <QObject>
+#include <QString>
+#include <QByteArray>
+#include <QList>
+#include <QThread>
+#include <functional>
+#include <memory>
+
+#include "backend/crccache.hpp"
+#include "backend/devices/device.hpp"
+
+// ---------------------------------------------------------------------------
+
+/**
+ * @ingroup Software
+ * @brief Gang Class
+ * @details The purpose of this class is to run the same operation with the
+ *   same image on several programmers (stations) at once. Each station has
+ *   its own device (and Runner), running on its own thread. The image is
+ *   shared by all the stations (not copied), and so are the CRCs of its
+ *   ranges (used to verify).
+ * @nosubgrouping
+ */
+class Gang : public QObject {
+    Q_OBJECT
+
+  public:
+    /**
+     * @brief Operation run by each station (on the thread of the station).
+     * @param device Device of the station.
+     * @param image Image to use.
+     * @return True if success, false otherwise.
+     */
+    typedef std::function<bool(Device *device, const QByteArray &image)>
+        TGangAction;
+
+  public:
+    /**
+     * @brief Constructor.
+     * @param parent Pointer to parent object. Default is nullptr.
+     */
+    explicit Gang(QObject *parent = nullptr);
+    /** @brief Destructor. */
+    ~Gang();
+    /**
+     * @brief Adds a station.
+     * @details The gang takes the ownership of the device, and moves it to
+     *   the thread of the station. The device must be configured (port
+     *   included) before.
+     * @param device Pointer to the device.
+     */
+    void addStation(Device *device);
+    /** @brief Removes all the stations (canceling their operations). */
+    void clear();
+    /**
+     * @brief Returns the number of stations.
+     * @return Number of stations.
+     */
+    int getCount() const;
+    /**
+     * @brief Returns the port of a station.
+     * @param station Index of the station.
+     * @return Serial port path, or empty if the index is invalid.
+     */
+    QString getPort(int station) const;
+    /**
+     * @brief Returns the device of a station.
+     * @details The device lives on the thread of the station: it must not
+     *   be used while the gang is running.
+     * @param station Index of the station.
+     * @return Pointer to the device, or nullptr if the index is invalid.
+     */
+    Device *getDevice(int station) const;
+    /**
+     * @brief Starts an operation on all the stations.
+     * @param image Image to use (shared by all the stations).
+     * @param action Operation to run.
+     * @return True if started, false if running or without stations.
+     */
+    bool start(const QByteArray &image, TGangAction action);
+    /** @brief Cancels the running operation of all the stations. */
+    void cancel();
+    /**
+     * @brief Returns if an operation is running.
+     * @return True if any station is running, false otherwise.
+     */
+    bool isRunning() const;
+    /**
+     * @brief Returns the result of a station in the last operation.
+     * @param station Index of the station.
+     * @return True if success, false otherwise (or if running).
+     */
+    bool getResult(int station) const;
+
+  signals:
+    /**
+     * @brief Progress of a station (same as Device::onProgress).
+     * @param station Index of the station.
+     * @param current Current address.
+     * @param total Total addresses.
+     * @param done True if finished.
+     * @param success True if success.
+     * @param canceled True if canceled.
+     */
+    void onProgress(int station, uint32_t current, uint32_t total,
+                    bool done, bool success, bool canceled);
+    /**
+     * @brief A station finished the operation.
+     * @param station Index of the station.
+     * @param success True if success, false otherwise.
+     */
+    void onStationFinished(int station, bool success);
+    /**
+     * @brief All the stations finished the operation.
+     * @param passed Number of stations with success.
+     * @param failed Number of stations with failure.
+     */
+    void onFinished(int passed, int failed);
+
+  private:
+    /* @brief A station of the gang. */
+    typedef struct TGangStation {
+        /* @brief Device (lives on the thread of the station). */
+        Device *device;
+        /* @brief Thread where the device operations run. */
+        QThread *thread;
+        /* @brief Indicates if the station is running. */
+        bool running;
+        /* @brief Result of the last operation. */
+        bool success;
+    } TGangStation;
+    /* @brief Stations. */
+    QList<TGangStation> stations_;
+    /* @brief Image of the last operation (shared by the stations). */
+    QByteArray image_;
+    /* @brief Cache of the CRCs of the image (shared by the stations). */
+    std::shared_ptr<CrcCache> crcCache_;
+    /* @brief Number of stations running. */
+    int running_;
+    /*
+     * @brief Records the result of a station (on the gang thread).
+     * @param station Index of the station.
+     * @param success Result of the operation.
+     */
+    void finishStation_(int station, bool success);
+};
+
+#endif  // BACKEND_GANG_HPP_
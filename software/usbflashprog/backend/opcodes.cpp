@@ -16,21 +16,26 @@
 // ---------------------------------------------------------------------------
 
 #include <cmath>
+#include <cstring>
 #include "backend/opcodes.hpp"
 
 // ---------------------------------------------------------------------------
 
-TCmdOpCode &TCmdOpCode::operator=(const TCmdOpCode &src) {
-    this->code = src.code;
-    this->descr = src.descr;
-    this->params = src.params;
-    this->result = src.result;
-    return *this;
-}
+/* @brief Index of the opcodes table, by code (built on the first use). */
+typedef struct TCmdOpCodeIndex {
+    /* @brief Entry of each code (nullptr if unknown). */
+    const TCmdOpCode *entries[256];
+    /* @brief Constructor. */
+    TCmdOpCodeIndex() : entries() {
+        for (const auto &item : kCmdOpCodes) entries[item.code] = &item;
+    }
+} TCmdOpCodeIndex;
+
+// ---------------------------------------------------------------------------
 
 bool operator==(const TCmdOpCode &a, const TCmdOpCode &b) {
-    return (a.code == b.code && a.descr == b.descr && a.params == b.params &&
-            a.result == b.result);
+    return (a.code == b.code && !strcmp(a.descr, b.descr) &&
+            a.params == b.params && a.result == b.result);
 }
 
 // ---------------------------------------------------------------------------
@@ -45,18 +50,19 @@ bool OpCode::isOk(const void *buf, size_t size) {
 
 TCmdOpCode OpCode::getOpCode(const void *buf, size_t size) {
     if (!buf || !size) {
-        return kCmdOpCodes.at(kCmdNop);
+        return kCmdOpCodes[0];
     }
     const uint8_t *pbuf = static_cast<const uint8_t *>(buf);
     return getOpCode(pbuf[0]);
 }
 
 TCmdOpCode OpCode::getOpCode(uint8_t code) {
-    auto it = kCmdOpCodes.find(static_cast<kCmdOpCodeEnum>(code));
-    if (it == kCmdOpCodes.end()) {
-        return kCmdOpCodes.at(kCmdNop);
+    static const TCmdOpCodeIndex index;
+    const TCmdOpCode *entry = index.entries[code];
+    if (!entry) {
+        return kCmdOpCodes[0];
     }
-    return it->second;
+    return *entry;
 }
 
 float OpCode::getValueAsFloat(const void *buf, size_t size) {
@@ -16,14 +16,19 @@
 // ---------------------------------------------------------------------------
 
 #include <QDateTime>
-#include <QApplication>
+#include <QCoreApplication>
+#include <QThread>
+#include <QVector>
 #include <QLoggingCategory>
 
+#include <array>
 #include <chrono>
 #include <thread>
 #include <cstring>
 
 #include "backend/runner.hpp"
+#include "backend/checksum.hpp"
+#include "backend/rle.hpp"
 #include "devices/device.hpp"
 #include "config.hpp"
 
@@ -46,6 +51,7 @@ Q_LOGGING_CATEGORY(backendRunner, "backend.runner")
 
 #ifdef TEST_BUILD
 bool QSerialPort::connected = false;
+qint64 QSerialPort::pending = 0;
 #endif
 
 // ---------------------------------------------------------------------------
@@ -54,9 +60,34 @@ bool QSerialPort::connected = false;
 constexpr int kDisconnectTimeOut = 5000;
 /* @brief Timeout (in milliseconds) to read byte. */
 constexpr int kReadTimeOut = 3000;
+/* @brief Default window size (commands in flight). */
+constexpr uint8_t kDefaultWindowSize = 8;
+/* @brief Maximum buffer size (one byte length opcodes), in bytes. */
+constexpr uint16_t kMaxByteBufferSize = 128;
+/* @brief Maximum buffer size (wide length opcodes), in bytes. */
+constexpr uint16_t kMaxBufferSize = 4096;
+/* @brief Number of retransmissions of a frame. */
+constexpr int kFrameRetries = 3;
+/* @brief Overhead of a frame (header, tag or CRC16), in bytes. */
+constexpr int kFrameOverhead = 8;
 
 // ---------------------------------------------------------------------------
 
+/*
+ * @brief Returns the time elapsed since a time point.
+ * @param start Time point.
+ * @return Elapsed time, in microseconds.
+ */
+static uint64_t elapsedUs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now() - start)
+        .count();
+}
+
+// ---------------------------------------------------------------------------
+
+TRunnerCommand::TRunnerCommand() : opcode(kCmdOpCodes[0]) {}
+
 bool TRunnerCommand::responseIsOk() const {
     return OpCode::isOk(response.data(), response.size());
 }
@@ -138,18 +169,61 @@ bool operator==(const TRunnerCommand& a, const TRunnerCommand& b) {
 
 Runner::Runner(QObject* parent)
     : QObject(parent),
-      serial_(this),
+      transport_(Transport::create(QString())),
       timeout_(kReadTimeOut),
       running_(false),
       error_(false),
       address_(0),
-      bufferSize_(1) {
+      bufferSize_(1),
+      reqBufferSize_(1),
+      windowSize_(kDefaultWindowSize),
+      tagChecked_(false),
+      tagSupported_(false),
+      tag_(0),
+      wideChecked_(false),
+      wideSupported_(false),
+      rangeChecked_(false),
+      rangeSupported_(false),
+      rangeRemaining_(0),
+      rangeEncoded_(false),
+      writeRangeChecked_(false),
+      writeRangeSupported_(false),
+      writeRangeBlock_(0),
+      writeRangeCredits_(0),
+      writeRangeBlocks_(0),
+      writeRangeSent_(0),
+      writeRangeAcked_(0),
+      writeRangeEncoded_(false),
+      crcChecked_(false),
+      crcSupported_(false),
+      blankRangeChecked_(false),
+      blankRangeSupported_(false),
+      compression_(true),
+      encodingChecked_(false),
+      encodingSupported_(false),
+      setupChecked_(false),
+      setupSupported_(false),
+      framing_(false),
+      framingChecked_(false),
+      framingSupported_(false),
+      frameSeq_(0),
+      maxBufferSize_(kMaxBufferSize) {
+    caps_.version = 0;
+    caps_.maxBufferSize = 0;
+    caps_.features = 0;
     flags_.is16bit = false;
     flags_.pgmCePin = false;
     flags_.pgmPositive = false;
     flags_.progWithVpp = false;
     flags_.skipFF = false;
     flags_.vppOePin = false;
+    // the buffers of the data path are allocated once
+    txFrame_.reserve(kMaxBufferSize + kFrameOverhead);
+    rx_.reserve(kMaxBufferSize + kFrameOverhead);
+    chunk_.reserve(kCmdStreamChunkSize + kFrameOverhead);
+    encoded_.reserve(Rle::maxEncodedSize(kMaxBufferSize) + kFrameOverhead);
+    blockCmd_.params.reserve(kMaxBufferSize + kFrameOverhead);
+    blockCmd_.response.reserve(kMaxBufferSize + kFrameOverhead);
 }
 
 Runner::~Runner() {
@@ -181,16 +255,44 @@ bool Runner::open(const QString& path) {
     if (running_) close();
     if (path.isNull() || path.isEmpty()) return false;
     DEBUG << "Opening serial port:" << path << "...";
-    serial_.setPortName(path);
-    bool result = serial_.open(QIODevice::ReadWrite);
+    QString type = Transport::typeOf(path);
+    if (type != transportType_) {
+        // keeps the transport while the type is the same
+        transport_.reset(Transport::create(path));
+        transport_->setTrace(trace_);
+        transportType_ = type;
+    }
+    bool result = transport_->open(path);
+    tagChecked_ = false;
+    tagSupported_ = false;
+    wideChecked_ = false;
+    wideSupported_ = false;
+    rangeChecked_ = false;
+    rangeSupported_ = false;
+    rangeRemaining_ = 0;
+    writeRangeChecked_ = false;
+    writeRangeSupported_ = false;
+    writeRangeBlocks_ = 0;
+    crcChecked_ = false;
+    crcSupported_ = false;
+    blankRangeChecked_ = false;
+    blankRangeSupported_ = false;
+    encodingChecked_ = false;
+    encodingSupported_ = false;
+    setupChecked_ = false;
+    setupSupported_ = false;
+    framingChecked_ = false;
+    framingSupported_ = false;
+    caps_.version = 0;
+    caps_.maxBufferSize = 0;
+    caps_.features = 0;
+    maxBufferSize_ = kMaxBufferSize;
     if (result) {
         running_ = true;
-        // need under Windows
-        // https://community.platformio.org/t/
-        //   serial-communication-micro-usb-on-pi-pico-c/27512/5
-        serial_.setDataTerminalReady(true);
+        aliveTick_ = QDateTime::currentMSecsSinceEpoch();
         DEBUG << "Open serial port OK";
         DEBUG << "Setting timeout:" << QString("%1").arg(timeout_);
+        queryCapabilities_();
     } else {
         WARNING << "Error opening serial port";
     }
@@ -199,12 +301,23 @@ bool Runner::open(const QString& path) {
 }
 
 void Runner::close() {
-    if (serial_.isOpen()) {
+    if (transport_->isOpen()) {
         DEBUG << "Closing serial port...";
     }
-    serial_.close();
+    transport_->close();
     running_ = false;
     error_ = false;
+    tagChecked_ = false;
+    wideChecked_ = false;
+    rangeChecked_ = false;
+    rangeRemaining_ = 0;
+    writeRangeChecked_ = false;
+    writeRangeBlocks_ = 0;
+    crcChecked_ = false;
+    blankRangeChecked_ = false;
+    encodingChecked_ = false;
+    setupChecked_ = false;
+    framingChecked_ = false;
 }
 
 bool Runner::isOpen() const {
@@ -216,7 +329,7 @@ bool Runner::hasError() const {
 }
 
 QString Runner::getPath() const {
-    return serial_.portName();
+    return transport_->portName();
 }
 
 uint32_t Runner::getTimeOut() const {
@@ -229,27 +342,104 @@ void Runner::setTimeOut(uint32_t value) {
     DEBUG << "Setting timeout:" << QString("%1").arg(value);
 }
 
-uint8_t Runner::getBufferSize() const {
+uint16_t Runner::getBufferSize() const {
     return bufferSize_;
 }
 
-void Runner::setBufferSize(uint8_t value) {
+void Runner::setBufferSize(uint16_t value) {
     if (!value) value = 1;
+    if (value > kMaxBufferSize) value = kMaxBufferSize;
     // rounds to next power of two
     if (value & (value - 1)) {
         uint32_t exp = 1;
         // clang-format off
         for (exp = 1; (1 << exp) < value; exp++) {}
         // clang-format on
-        if (exp > 7) exp = 7;  // max 128
         value = 1 << exp;
     }
     if (flags_.is16bit && value == 1) value = 2;
+    reqBufferSize_ = value;
+    // old firmware: one byte length only
+    if (wideChecked_ && !wideSupported_ && value > kMaxByteBufferSize) {
+        value = kMaxByteBufferSize;
+    }
+    // firmware limit (capabilities)
+    if (value > maxBufferSize_) value = maxBufferSize_;
     if (bufferSize_ == value) return;
     bufferSize_ = value;
     DEBUG << "Setting buffer size:" << QString("%1").arg(value);
 }
 
+uint16_t Runner::getMaxBufferSize() {
+    if (running_ && !hasWideBuffer_()) return kMaxByteBufferSize;
+    return maxBufferSize_;
+}
+
+bool Runner::hasReadRange() {
+    return running_ && hasReadRange_();
+}
+
+const Runner::TCapabilities& Runner::getCapabilities() const {
+    return caps_;
+}
+
+uint8_t Runner::getWindowSize() const {
+    return windowSize_;
+}
+
+void Runner::setWindowSize(uint8_t value) {
+    if (!value) value = 1;
+    if (windowSize_ == value) return;
+    windowSize_ = value;
+    DEBUG << "Setting window size:" << QString("%1").arg(value);
+}
+
+bool Runner::getCompression() const {
+    return compression_;
+}
+
+void Runner::setCompression(bool value) {
+    compression_ = value;
+}
+
+bool Runner::getFraming() const {
+    return framing_;
+}
+
+void Runner::setFraming(bool value) {
+    framing_ = value;
+}
+
+const CommStats& Runner::getStats() const {
+    return stats_;
+}
+
+void Runner::resetStats() {
+    stats_.clear();
+}
+
+bool Runner::setTraceFile(const QString& filename) {
+    DEBUG << "Trace file:" << filename;
+    trace_.reset();
+    traceFile_.clear();
+    bool result = true;
+    if (!filename.isEmpty()) {
+        trace_ = std::make_shared<TraceWriter>();
+        result = trace_->open(filename);
+        if (result) {
+            traceFile_ = filename;
+        } else {
+            trace_.reset();
+        }
+    }
+    transport_->setTrace(trace_);
+    return result;
+}
+
+QString Runner::getTraceFile() const {
+    return traceFile_;
+}
+
 bool Runner::nop() {
     TRunnerCommand cmd;
     cmd.set(kCmdNop);
@@ -529,19 +719,7 @@ uint16_t Runner::dataGetW() {
 bool Runner::deviceConfigure(kCmdDeviceAlgorithmEnum algo,
                              const TDeviceFlags& flags) {
     TRunnerCommand cmd;
-    uint16_t value = algo;
-    value <<= 8;
-    flags_ = flags;
-    if (flags.is16bit && bufferSize_ == 1) setBufferSize(2);
-    // clang-format off
-    if (flags.skipFF     ) value |= 0x01;
-    if (flags.progWithVpp) value |= 0x02;
-    if (flags.vppOePin   ) value |= 0x04;
-    if (flags.pgmCePin   ) value |= 0x08;
-    if (flags.pgmPositive) value |= 0x10;
-    if (flags.is16bit    ) value |= 0x20;
-    // clang-format on
-    cmd.setWord(kCmdDeviceConfigure, value);
+    cmd.setWord(kCmdDeviceConfigure, configure_(algo, flags));
     if (!sendCommand_(cmd)) return false;
     return true;
 }
@@ -550,11 +728,7 @@ bool Runner::deviceSetTwp(uint32_t value) {
     TRunnerCommand cmd;
     cmd.setDWord(kCmdDeviceSetTwp, value);
     if (!sendCommand_(cmd)) return false;
-    // adjust timeout
-    uint32_t calculatedTime = (value * 2048) / 1000;  // 2KB
-    if (calculatedTime > timeout_) {
-        timeout_ = calculatedTime * 2;
-    }
+    adjustTimeout_(value);
     return true;
 }
 
@@ -562,11 +736,7 @@ bool Runner::deviceSetTwc(uint32_t value) {
     TRunnerCommand cmd;
     cmd.setDWord(kCmdDeviceSetTwc, value);
     if (!sendCommand_(cmd)) return false;
-    // adjust timeout
-    uint32_t calculatedTime = (value * 2048) / 1000;  // 2KB
-    if (calculatedTime > timeout_) {
-        timeout_ = calculatedTime * 2;
-    }
+    adjustTimeout_(value);
     return true;
 }
 
@@ -582,12 +752,46 @@ bool Runner::deviceResetBus() {
     return deviceSetupBus(kCmdDeviceOperationReset);
 }
 
+bool Runner::deviceSetup(kCmdDeviceAlgorithmEnum algo,
+                         const TDeviceFlags& flags, float vdd, float vpp,
+                         uint32_t twp, uint32_t twc,
+                         kCmdDeviceOperationEnum operation, uint8_t keep) {
+    // the voltages are sent unsigned
+    if (vdd < 0.0f || vpp < 0.0f) return false;
+    if (!hasDeviceSetup_()) {
+        // old firmware: one command for each setting
+        if (!deviceConfigure(algo, flags)) return false;
+        if (!(keep & kCmdDeviceSetupKeepTwp) && !deviceSetTwp(twp)) {
+            return false;
+        }
+        if (!(keep & kCmdDeviceSetupKeepTwc) && !deviceSetTwc(twc)) {
+            return false;
+        }
+        if (!(keep & kCmdDeviceSetupKeepVdd) && !vddSet(vdd)) return false;
+        if (!(keep & kCmdDeviceSetupKeepVpp) && !vppSet(vpp)) return false;
+        return deviceSetupBus(operation);
+    }
+    TRunnerCommand cmd;
+    cmd.set(kCmdDeviceSetup);
+    cmd.params.resize(cmd.opcode.params + 1);
+    OpCode::setWord(cmd.params.data(), 3, configure_(algo, flags));
+    OpCode::setFloat(cmd.params.data() + 2, 3, vdd);
+    OpCode::setFloat(cmd.params.data() + 4, 3, vpp);
+    OpCode::setDWord(cmd.params.data() + 6, 5, twp);
+    OpCode::setDWord(cmd.params.data() + 10, 5, twc);
+    cmd.params[15] = static_cast<char>(operation);
+    cmd.params[16] = static_cast<char>(keep);
+    if (!sendCommand_(cmd)) return false;
+    if (!(keep & kCmdDeviceSetupKeepTwp)) adjustTimeout_(twp);
+    if (!(keep & kCmdDeviceSetupKeepTwc)) adjustTimeout_(twc);
+    address_ = 0;
+    return true;
+}
+
 QByteArray Runner::deviceRead() {
     QByteArray result;
-    TRunnerCommand cmd;
-    cmd.setByte(kCmdDeviceRead, bufferSize_);
-    // setup expected response size
-    cmd.opcode.result = bufferSize_;
+    TRunnerCommand& cmd = blockCmd_;
+    bufferCommand_(cmd, kCmdDeviceRead);
     // no retry
     if (!sendCommand_(cmd, 0)) {
         DEBUG << "Error in deviceRead(). Last address:"
@@ -609,13 +813,8 @@ QByteArray Runner::deviceRead() {
 }
 
 bool Runner::deviceWrite(const QByteArray& data) {
-    TRunnerCommand cmd;
-    cmd.setByte(kCmdDeviceWrite, bufferSize_);
-    // set data
-    cmd.params.resize(bufferSize_ + 2);
-    memset(cmd.params.data() + 2, 0xFF, bufferSize_);
-    memcpy(cmd.params.data() + 2, data.data(),
-           qMin(data.size(), static_cast<int>(bufferSize_)));
+    TRunnerCommand& cmd = blockCmd_;
+    bufferCommand_(cmd, kCmdDeviceWrite, data.constData(), data.size());
     // no retry
     if (!sendCommand_(cmd, 0)) {
         DEBUG << "Error in deviceWrite(). Last address:"
@@ -632,12 +831,13 @@ bool Runner::deviceWrite(const QByteArray& data) {
 }
 
 bool Runner::deviceWriteSector(const QByteArray& data, uint16_t sectorSize) {
-    TRunnerCommand cmd;
+    TRunnerCommand& cmd = blockCmd_;
     cmd.setWord(kCmdDeviceWriteSector, sectorSize);
     // set data
-    cmd.params.resize(sectorSize + 3);
-    memset(cmd.params.data() + 3, 0xFF, sectorSize);
-    memcpy(cmd.params.data() + 3, data.data(),
+    int offset = cmd.params.size();
+    cmd.params.resize(offset + sectorSize);
+    memset(cmd.params.data() + offset, 0xFF, sectorSize);
+    memcpy(cmd.params.data() + offset, data.constData(),
            qMin(data.size(), static_cast<int>(sectorSize)));
     // no retry
     if (!sendCommand_(cmd, 0)) {
@@ -655,13 +855,8 @@ bool Runner::deviceWriteSector(const QByteArray& data, uint16_t sectorSize) {
 }
 
 bool Runner::deviceVerify(const QByteArray& data) {
-    TRunnerCommand cmd;
-    cmd.setByte(kCmdDeviceVerify, bufferSize_);
-    // set data
-    cmd.params.resize(bufferSize_ + 2);
-    memset(cmd.params.data() + 2, 0xFF, bufferSize_);
-    memcpy(cmd.params.data() + 2, data.data(),
-           qMin(data.size(), static_cast<int>(bufferSize_)));
+    TRunnerCommand& cmd = blockCmd_;
+    bufferCommand_(cmd, kCmdDeviceVerify, data.constData(), data.size());
     // no retry
     if (!sendCommand_(cmd, 0)) {
         DEBUG << "Error in deviceVerify(). Last address:"
@@ -678,8 +873,8 @@ bool Runner::deviceVerify(const QByteArray& data) {
 }
 
 bool Runner::deviceBlankCheck() {
-    TRunnerCommand cmd;
-    cmd.setByte(kCmdDeviceBlankCheck, bufferSize_);
+    TRunnerCommand& cmd = blockCmd_;
+    bufferCommand_(cmd, kCmdDeviceBlankCheck);
     // no retry
     if (!sendCommand_(cmd, 0)) {
         DEBUG << "Error in deviceBlankCheck(). Last address:"
@@ -695,6 +890,299 @@ bool Runner::deviceBlankCheck() {
     return true;
 }
 
+QByteArray Runner::deviceReadBlocks(int count) {
+    QByteArray result;
+    deviceReadBlocks(count, result);
+    return result;
+}
+
+bool Runner::deviceReadBlocks(int count, QByteArray& buffer) {
+    if (count <= 0) return true;
+    QVector<TRunnerCommand>& cmds = blockCommands_(count);
+    for (int i = 0; i < count; i++) bufferCommand_(cmds[i], kCmdDeviceRead);
+    int done = sendCommands_(cmds, count);
+    for (int i = 0; i < done; i++) {
+        buffer.append(cmds[i].response.constData() + 1, bufferSize_);
+    }
+    address_ += done * (flags_.is16bit ? (bufferSize_ / 2) : bufferSize_);
+    if (done == count) return true;
+    DEBUG << "Error in deviceReadBlocks(). Last address:"
+          << QString("0x%1").arg(address_, 6, 16, QChar('0'))
+          << "Trying use addrSet() and deviceRead()";
+    // error
+    // use addrSet and continue one by one
+    if (!addrSet(address_)) return false;
+    for (int i = done; i < count; i++) {
+        QByteArray data = deviceRead();
+        if (data.isEmpty()) {
+            addrSet(address_);
+            return false;
+        }
+        buffer.append(data);
+    }
+    return true;
+}
+
+bool Runner::deviceWriteBlocks(const QByteArray& data) {
+    int count = (data.size() + bufferSize_ - 1) / bufferSize_;
+    QVector<TRunnerCommand>& cmds = blockCommands_(count);
+    for (int i = 0; i < count; i++) {
+        bufferCommand_(cmds[i], kCmdDeviceWrite,
+                       data.constData() + i * bufferSize_,
+                       data.size() - i * bufferSize_);
+    }
+    int done = sendCommands_(cmds, count);
+    address_ += done * (flags_.is16bit ? (bufferSize_ / 2) : bufferSize_);
+    if (done == count) return true;
+    DEBUG << "Error in deviceWriteBlocks(). Last address:"
+          << QString("0x%1").arg(address_, 6, 16, QChar('0'))
+          << "Trying use addrSet() and deviceWrite()";
+    // error
+    // use addrSet and continue one by one
+    if (!addrSet(address_)) return false;
+    for (int i = done; i < count; i++) {
+        if (!deviceWrite(data.mid(i * bufferSize_, bufferSize_))) {
+            addrSet(address_);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Runner::deviceVerifyBlocks(const QByteArray& data) {
+    int count = (data.size() + bufferSize_ - 1) / bufferSize_;
+    QVector<TRunnerCommand>& cmds = blockCommands_(count);
+    for (int i = 0; i < count; i++) {
+        bufferCommand_(cmds[i], kCmdDeviceVerify,
+                       data.constData() + i * bufferSize_,
+                       data.size() - i * bufferSize_);
+    }
+    int done = sendCommands_(cmds, count);
+    address_ += done * (flags_.is16bit ? (bufferSize_ / 2) : bufferSize_);
+    if (done == count) return true;
+    DEBUG << "Error in deviceVerifyBlocks(). Last address:"
+          << QString("0x%1").arg(address_, 6, 16, QChar('0'))
+          << "Trying use addrSet() and deviceVerify()";
+    // error
+    // use addrSet and continue one by one
+    if (!addrSet(address_)) return false;
+    for (int i = done; i < count; i++) {
+        if (!deviceVerify(data.mid(i * bufferSize_, bufferSize_))) {
+            addrSet(address_);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Runner::deviceBlankCheckBlocks(int count) {
+    if (count <= 0) return true;
+    QVector<TRunnerCommand>& cmds = blockCommands_(count);
+    for (int i = 0; i < count; i++) {
+        bufferCommand_(cmds[i], kCmdDeviceBlankCheck);
+    }
+    int done = sendCommands_(cmds, count);
+    address_ += done * (flags_.is16bit ? (bufferSize_ / 2) : bufferSize_);
+    if (done == count) return true;
+    DEBUG << "Error in deviceBlankCheckBlocks(). Last address:"
+          << QString("0x%1").arg(address_, 6, 16, QChar('0'))
+          << "Trying use addrSet() and deviceBlankCheck()";
+    // error
+    // use addrSet and continue one by one
+    if (!addrSet(address_)) return false;
+    for (int i = done; i < count; i++) {
+        if (!deviceBlankCheck()) {
+            addrSet(address_);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Runner::deviceReadRangeBegin(uint32_t address, uint32_t size) {
+    if (rangeRemaining_) deviceReadRangeEnd();
+    if (!size || !hasReadRange_()) return false;
+    return startRange_(address, size);
+}
+
+QByteArray Runner::deviceReadRangeNext() {
+    QByteArray result;
+    deviceReadRangeNext(result);
+    return result;
+}
+
+bool Runner::deviceReadRangeNext(QByteArray& buffer) {
+    if (!rangeRemaining_) return false;
+    int len = qMin(rangeRemaining_, static_cast<uint32_t>(kCmdStreamChunkSize));
+    QByteArray& chunk = chunk_;
+    auto start = std::chrono::steady_clock::now();
+    int received = 0;
+    for (int i = 0; i < 3; i++) {
+        // chunk: OK + data + CRC16 (MSB first); NOK ends the stream
+        if (!read_(&chunk, 1) ||
+            static_cast<uint8_t>(chunk[0]) != kCmdResponseOk ||
+            !(received = readRangeChunk_(&chunk, len))) {
+            WARNING << "Error in deviceReadRangeNext(). Last address:"
+                    << QString("0x%1").arg(address_, 6, 16, QChar('0'));
+            stats_.add(kCmdDeviceReadRange, 0, chunk.size(),
+                       elapsedUs(start), i, true);
+            transport_->clear();
+            rangeRemaining_ = 0;
+            error_ = true;
+            return false;
+        }
+        uint16_t crc =
+            (static_cast<uint8_t>(chunk[len]) << 8) |
+            static_cast<uint8_t>(chunk[len + 1]);
+        if (Checksum::crc16(chunk.constData(), len) == crc) {
+            // response code + data (as received) + CRC16
+            stats_.add(kCmdDeviceReadRange, 0, received + 1,
+                       elapsedUs(start), i);
+            buffer.append(chunk.constData(), len);
+            rangeRemaining_ -= len;
+            address_ += (flags_.is16bit ? (len / 2) : len);
+            error_ = false;
+            return true;
+        }
+        DEBUG << "CRC error in deviceReadRangeNext(). Last address:"
+              << QString("0x%1").arg(address_, 6, 16, QChar('0'))
+              << "Restarting the stream";
+        // restart from the first address not received
+        uint32_t remaining = rangeRemaining_;
+        rangeRemaining_ -= len;
+        if (!cancelRange_() || !startRange_(address_, remaining)) break;
+    }
+    stats_.add(kCmdDeviceReadRange, 0, 0, elapsedUs(start), 0, true);
+    rangeRemaining_ = 0;
+    error_ = true;
+    return false;
+}
+
+bool Runner::deviceReadRangeEnd() {
+    if (!rangeRemaining_) return true;
+    return cancelRange_();
+}
+
+bool Runner::deviceWriteRangeBegin(uint32_t address, uint32_t size,
+                                   uint16_t blockSize, bool sector) {
+    if (writeRangeBlocks_) deviceWriteRangeEnd();
+    if (!size || !blockSize || blockSize > kCmdStreamChunkSize ||
+        (size % blockSize) || !hasWriteRange_()) {
+        return false;
+    }
+    TRunnerCommand cmd;
+    cmd.set(kCmdDeviceWriteRange);
+    cmd.params.resize(cmd.opcode.params + 1);
+    OpCode::setDWord(cmd.params.data(), 4, address);
+    OpCode::setDWord(cmd.params.data() + 3, 4, size);
+    OpCode::setWord(cmd.params.data() + 6, 3, blockSize);
+    OpCode::setBool(cmd.params.data() + 8, 2, sector);
+    writeRangeEncoded_ = selectEncoding_();
+    // no retry
+    if (!sendCommand_(cmd, 0) || !cmd.responseAsByte()) return false;
+    address_ = address;
+    writeRangeBlock_ = blockSize;
+    writeRangeCredits_ = cmd.responseAsByte();
+    writeRangeBlocks_ = size / blockSize;
+    writeRangeSent_ = 0;
+    writeRangeAcked_ = 0;
+    return true;
+}
+
+bool Runner::deviceWriteRangeNext(const QByteArray& data) {
+    if (writeRangeSent_ >= writeRangeBlocks_) {
+        error_ = true;
+        return false;
+    }
+    auto start = std::chrono::steady_clock::now();
+    // wait for a credit
+    while ((writeRangeSent_ - writeRangeAcked_) >= writeRangeCredits_) {
+        if (!writeRangeAck_()) {
+            stats_.add(kCmdDeviceWriteRange, 0, 1, elapsedUs(start), 0, true);
+            return false;
+        }
+    }
+    // block + CRC16 (MSB first)
+    txFrame_.resize(writeRangeBlock_ + 2);
+    int size = qMax(0, qMin(data.size(), static_cast<int>(writeRangeBlock_)));
+    memcpy(txFrame_.data(), data.constData(), size);
+    memset(txFrame_.data() + size, 0xFF, writeRangeBlock_ - size);
+    uint16_t crc = Checksum::crc16(txFrame_.constData(), writeRangeBlock_);
+    txFrame_[writeRangeBlock_] = static_cast<char>((crc >> 8) & 0xFF);
+    txFrame_[writeRangeBlock_ + 1] = static_cast<char>(crc & 0xFF);
+    if (writeRangeEncoded_) encodeBlock_(txFrame_, encoded_);
+    const QByteArray& block = writeRangeEncoded_ ? encoded_ : txFrame_;
+    if (transport_->write(block) != block.size()) {
+        WARNING << "Error writing to serial port. Command Device WriteRange";
+        stats_.add(kCmdDeviceWriteRange, 0, 0, elapsedUs(start), 0, true);
+        transport_->clear();
+        writeRangeBlocks_ = 0;
+        error_ = true;
+        return false;
+    }
+    writeRangeSent_++;
+    // latency: waiting for a credit and sending the block
+    stats_.add(kCmdDeviceWriteRange, block.size(), 0, elapsedUs(start));
+    return true;
+}
+
+bool Runner::deviceWriteRangeEnd() {
+    if (!writeRangeBlocks_) return !error_;
+    if (writeRangeSent_ < writeRangeBlocks_) {
+        DEBUG << "Canceling Write Range. Sent:" << writeRangeSent_ << "of"
+              << writeRangeBlocks_;
+        // a block with invalid CRC cancels the stream
+        while ((writeRangeSent_ - writeRangeAcked_) >= writeRangeCredits_) {
+            if (!writeRangeAck_()) return false;
+        }
+        QByteArray block(writeRangeBlock_ + 2, 0xFF);
+        uint16_t crc = ~Checksum::crc16(block.constData(), writeRangeBlock_);
+        block[writeRangeBlock_] = static_cast<char>((crc >> 8) & 0xFF);
+        block[writeRangeBlock_ + 1] = static_cast<char>(crc & 0xFF);
+        if (writeRangeEncoded_) encodeBlock_(block, encoded_);
+        transport_->write(writeRangeEncoded_ ? encoded_ : block);
+        writeRangeSent_++;
+    }
+    // wait for the blocks in flight
+    while (writeRangeAcked_ < writeRangeSent_) {
+        if (!writeRangeAck_()) return false;
+    }
+    writeRangeBlocks_ = 0;
+    error_ = false;
+    return true;
+}
+
+bool Runner::deviceCrc32Range(uint32_t address, uint32_t size,
+                              uint32_t& crc) {
+    if (!hasCrc32Range_()) return false;
+    TRunnerCommand cmd;
+    cmd.set(kCmdDeviceCrc32Range);
+    cmd.params.resize(cmd.opcode.params + 1);
+    OpCode::setDWord(cmd.params.data(), 4, address);
+    OpCode::setDWord(cmd.params.data() + 3, 4, size);
+    // no retry
+    if (!sendCommand_(cmd, 0)) return false;
+    crc = static_cast<uint32_t>(cmd.responseAsDWord());
+    if (size) address_ = address + (flags_.is16bit ? (size / 2) : size);
+    return true;
+}
+
+bool Runner::deviceBlankCheckRange(uint32_t address, uint32_t size,
+                                   uint32_t& dirty, uint32_t& first) {
+    if (!hasBlankCheckRange_()) return false;
+    TRunnerCommand cmd;
+    cmd.set(kCmdDeviceBlankCheckRange);
+    cmd.params.resize(cmd.opcode.params + 1);
+    OpCode::setDWord(cmd.params.data(), 4, address);
+    OpCode::setDWord(cmd.params.data() + 3, 4, size);
+    // no retry
+    if (!sendCommand_(cmd, 0)) return false;
+    first = static_cast<uint32_t>(cmd.responseAsDWord());
+    dirty = OpCode::getValueAsDWord(cmd.response.data() + 4, 5);
+    if (size) address_ = address + (flags_.is16bit ? (size / 2) : size);
+    return true;
+}
+
 TDeviceID Runner::deviceGetId() {
     TDeviceID result;
     TRunnerCommand cmd;
@@ -765,29 +1253,38 @@ void Runner::msDelay(uint32_t value) {
 }
 
 void Runner::processEvents() {
-    QApplication::processEvents();
+    // device operations run on a worker thread, that has nothing to process
+    QCoreApplication* app = QCoreApplication::instance();
+    if (!app || QThread::currentThread() != app->thread()) return;
+    QCoreApplication::processEvents();
 #ifdef Q_OS_WINDOWS
     Sleep(1);
 #endif
 }
 
 bool Runner::sendCommand_(TRunnerCommand& cmd, int retry) {
-    if (!serial_.isOpen()) {
+    if (!transport_->isOpen()) {
         WARNING << "Serial port not open. Error running command"
-                << cmd.opcode.descr.c_str();
+                << cmd.opcode.descr;
         error_ = true;
         return false;
     }
-    DEBUG << "Running" << cmd.opcode.descr.c_str()
+    DEBUG << "Running" << cmd.opcode.descr
           << "[ 0x" + QString(cmd.params.toHex()) << "]"
           << "Current Address:"
           << QString("0x%1").arg(address_, 6, 16, QChar('0'));
+    bool framed = framing_ && isFrameable_(cmd.opcode.code) && hasFraming_();
+    // a retransmitted frame never runs twice
+    if (framed) retry = qMax(retry, kFrameRetries);
     bool success = false;
-    for (int i = 0; i < (retry + 1); i++) {
-        if (!write_(cmd.params) ||
-            !read_(&cmd.response, cmd.opcode.result + 1)) {
+    auto start = std::chrono::steady_clock::now();
+    int i;
+    for (i = 0; i < (retry + 1); i++) {
+        if (framed ? !transferFrame_(cmd, i > 0)
+                   : (!write_(cmd.params) ||
+                      !read_(&cmd.response, cmd.opcode.result + 1))) {
             DEBUG << "Retrying."
-                  << "Command" << cmd.opcode.descr.c_str();
+                  << "Command" << cmd.opcode.descr;
             continue;
         }
         error_ = false;
@@ -795,16 +1292,20 @@ bool Runner::sendCommand_(TRunnerCommand& cmd, int retry) {
         break;
     }
     if (!success) {
+        stats_.add(cmd.opcode.code, cmd.params.size(), cmd.response.size(),
+                   elapsedUs(start), retry, true);
         if (cmd.opcode.code != kCmdBusAddrInc) {
             WARNING << "Error writing to or reading from serial port."
-                    << "Command" << cmd.opcode.descr.c_str();
+                    << "Command" << cmd.opcode.descr;
         }
         error_ = true;
         return false;
     }
+    stats_.add(cmd.opcode.code, cmd.params.size(), cmd.response.size(),
+               elapsedUs(start), i, !cmd.responseIsOk());
     if (!cmd.responseIsOk()) {
         WARNING << "Response NOK."
-                << "Command" << cmd.opcode.descr.c_str() << ". Response"
+                << "Command" << cmd.opcode.descr << ". Response"
                 << "[ 0x" + QString(cmd.response.toHex()) << "]";
         error_ = true;
         return false;
@@ -815,49 +1316,655 @@ bool Runner::sendCommand_(TRunnerCommand& cmd, int retry) {
     return true;
 }
 
+int Runner::sendCommands_(QVector<TRunnerCommand>& cmds, int count) {
+    if (count <= 0) return 0;
+    if (!transport_->isOpen()) {
+        WARNING << "Serial port not open. Error running command"
+                << cmds.first().opcode.descr;
+        error_ = true;
+        return 0;
+    }
+    int done = 0;
+    if ((framing_ && hasFraming_()) || !hasTags_()) {
+        // framed commands, or firmware without tagged commands:
+        // stop-and-wait
+        while (done < count && sendCommand_(cmds[done], 0)) done++;
+        return done;
+    }
+    DEBUG << "Running" << count << "x"
+          << cmds.first().opcode.descr << "(window" << windowSize_
+          << ")"
+          << "Current Address:"
+          << QString("0x%1").arg(address_, 6, 16, QChar('0'));
+    transport_->clear();
+    uint8_t firstTag = tag_;
+    tag_ += count;
+    int sent = 0, received = 0;
+    bool failed = false;
+    // send times of the commands in flight (indexed by the tag, as the
+    // window never exceeds the tags)
+    std::array<std::chrono::steady_clock::time_point, 256> sentAt;
+    while (true) {
+        // keep the window full (stop sending after an error)
+        while (!failed && sent < count && (sent - received) < windowSize_) {
+            // tag + params
+            txFrame_.resize(2);
+            txFrame_[0] = static_cast<char>(kCmdProtoTag);
+            txFrame_[1] = static_cast<char>(firstTag + sent);
+            txFrame_.append(cmds[sent].params);
+            sentAt[sent & 0xFF] = std::chrono::steady_clock::now();
+            if (transport_->write(txFrame_) != txFrame_.size()) {
+                failed = true;
+                break;
+            }
+            sent++;
+        }
+        if (received == sent) break;
+        TRunnerCommand& cmd = cmds[received];
+        auto sentTime = sentAt[received & 0xFF];
+        // tag + response code
+        if (!read_(&cmd.response, 2) ||
+            static_cast<uint8_t>(cmd.response[0]) !=
+                static_cast<uint8_t>(firstTag + received)) {
+            WARNING << "Error reading from serial port (lost sequence)."
+                    << "Command" << cmd.opcode.descr;
+            stats_.add(cmd.opcode.code, cmd.params.size() + 2,
+                       cmd.response.size(), elapsedUs(sentTime), 0,
+                       true);
+            transport_->clear();
+            error_ = true;
+            return done;
+        }
+        cmd.response.remove(0, 1);
+        // result bytes (only if OK)
+        if (cmd.responseIsOk() && cmd.opcode.result) {
+            if (!read_(&rx_, cmd.opcode.result)) {
+                WARNING << "Error reading from serial port."
+                        << "Command" << cmd.opcode.descr;
+                stats_.add(cmd.opcode.code, cmd.params.size() + 2,
+                           cmd.response.size() + 1,
+                           elapsedUs(sentTime), 0, true);
+                transport_->clear();
+                error_ = true;
+                return done;
+            }
+            cmd.response.append(rx_);
+        }
+        // tag + params, tag + response
+        stats_.add(cmd.opcode.code, cmd.params.size() + 2,
+                   cmd.response.size() + 1, elapsedUs(sentTime), 0,
+                   !cmd.responseIsOk());
+        received++;
+        if (!cmd.responseIsOk()) {
+            if (!failed) {
+                WARNING << "Response NOK."
+                        << "Command" << cmd.opcode.descr;
+            }
+            failed = true;
+        } else if (!failed) {
+            done++;
+        }
+    }
+    error_ = failed;
+    return done;
+}
+
+bool Runner::hasTags_() {
+    if (tagChecked_) return tagSupported_;
+    tagChecked_ = true;
+    tagSupported_ = false;
+    // tagged NOP: old firmware responds NOK (unknown opcode),
+    // then OK (tag 0x00 is a NOP) and OK (NOP)
+    QByteArray probe(3, 0);
+    probe[0] = static_cast<char>(kCmdProtoTag);
+    probe[2] = static_cast<char>(kCmdNop);
+    QByteArray response;
+    if (!write_(probe) || !read_(&response, 2)) {
+        DEBUG << "Tagged commands: no response";
+        return false;
+    }
+    if (response[0] == 0 &&
+        static_cast<uint8_t>(response[1]) == kCmdResponseOk) {
+        tagSupported_ = true;
+        DEBUG << "Tagged commands: supported";
+    } else {
+        // discard the response of the last NOP
+        read_(&response, 1);
+        DEBUG << "Tagged commands: not supported";
+    }
+    return tagSupported_;
+}
+
+bool Runner::queryCapabilities_() {
+    // old firmware responds only NOK (unknown opcode, no params)
+    QByteArray probe(1, static_cast<char>(kCmdProtoCaps));
+    QByteArray response;
+    auto opcode = OpCode::getOpCode(kCmdProtoCaps);
+    if (!write_(probe) || !read_(&response, 1)) {
+        DEBUG << "Capabilities: no response";
+        return false;
+    }
+    if (static_cast<uint8_t>(response[0]) != kCmdResponseOk) {
+        DEBUG << "Capabilities: not supported";
+        return false;
+    }
+    if (!read_(&response, opcode.result)) {
+        DEBUG << "Capabilities: incomplete response";
+        return false;
+    }
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(response.data());
+    caps_.version = data[0];
+    caps_.maxBufferSize = (data[1] << 8) | data[2];
+    caps_.features = (data[3] << 8) | data[4];
+    DEBUG << "Capabilities: version" << static_cast<int>(caps_.version)
+          << "max buffer" << caps_.maxBufferSize << "features"
+          << QString("0x%1").arg(caps_.features, 4, 16, QChar('0'));
+    // the feature bitmap of an unknown (newer) version is not trusted:
+    // each feature is probed on its first use
+    if (!caps_.version || caps_.version > kCmdProtoVersion) return false;
+    tagChecked_ = true;
+    tagSupported_ = (caps_.features & kCmdProtoFeatureTag);
+    wideChecked_ = true;
+    wideSupported_ = (caps_.features & kCmdProtoFeatureWide);
+    rangeChecked_ = true;
+    rangeSupported_ = (caps_.features & kCmdProtoFeatureReadRange);
+    writeRangeChecked_ = true;
+    writeRangeSupported_ = (caps_.features & kCmdProtoFeatureWriteRange);
+    crcChecked_ = true;
+    crcSupported_ = (caps_.features & kCmdProtoFeatureCrc32Range);
+    blankRangeChecked_ = true;
+    blankRangeSupported_ = (caps_.features & kCmdProtoFeatureBlankRange);
+    encodingChecked_ = true;
+    encodingSupported_ = (caps_.features & kCmdProtoFeatureRle);
+    setupChecked_ = true;
+    setupSupported_ = (caps_.features & kCmdProtoFeatureDeviceSetup);
+    // an unframed command ends the last frame (no synchronization needed)
+    framingChecked_ = true;
+    framingSupported_ = (caps_.features & kCmdProtoFeatureFrame);
+    frameSeq_ = 0;
+    // largest power of two up to the reported length
+    uint16_t size = kMaxBufferSize;
+    while (size > 1 && size > caps_.maxBufferSize) size >>= 1;
+    maxBufferSize_ = size;
+    setBufferSize(reqBufferSize_);
+    return true;
+}
+
+bool Runner::hasFraming_() {
+    if (framingChecked_) return framingSupported_;
+    framingChecked_ = true;
+    framingSupported_ = false;
+    // all-zero frame (synchronization): old firmware responds NOK
+    // (unknown opcode), then OK for each param and CRC byte (0x00 is a NOP)
+    QByteArray probe(6, 0);
+    probe[0] = static_cast<char>(kCmdProtoFrame);
+    QByteArray response;
+    if (!write_(probe) || !read_(&response, 1)) {
+        DEBUG << "Framed transport: no response";
+        return false;
+    }
+    if (response[0] == 0) {
+        // sequence zero, then empty payload and CRC
+        framingSupported_ = read_(&response, 4);
+        frameSeq_ = 0;
+        DEBUG << "Framed transport: supported";
+    } else {
+        // discard the responses of the NOPs
+        read_(&response, probe.size() - 1);
+        DEBUG << "Framed transport: not supported";
+    }
+    return framingSupported_;
+}
+
+bool Runner::transferFrame_(TRunnerCommand& cmd, bool resend) {
+    // sequence zero is the synchronization
+    if (!resend && !++frameSeq_) frameSeq_ = 1;
+    QByteArray& frame = txFrame_;
+    frame.resize(4);
+    frame[0] = static_cast<char>(kCmdProtoFrame);
+    frame[1] = static_cast<char>(frameSeq_);
+    frame[2] = static_cast<char>((cmd.params.size() >> 8) & 0xFF);
+    frame[3] = static_cast<char>(cmd.params.size() & 0xFF);
+    frame.append(cmd.params);
+    uint16_t crc = Checksum::crc16(frame.constData() + 1, frame.size() - 1, 0);
+    frame.append(static_cast<char>((crc >> 8) & 0xFF));
+    frame.append(static_cast<char>(crc & 0xFF));
+    // a retransmission discards the rest of the previous response
+    if (resend) transport_->clear();
+    if (transport_->write(frame) != frame.size()) return false;
+    QByteArray &header = rx_, &payload = cmd.response;
+    if (!read_(&header, 3)) return false;
+    if (static_cast<uint8_t>(header[0]) != frameSeq_) {
+        DEBUG << "Frame" << frameSeq_ << ": lost sequence";
+        return false;
+    }
+    int len = (static_cast<uint8_t>(header[1]) << 8) |
+              static_cast<uint8_t>(header[2]);
+    if (!read_(&payload, len + 2)) return false;
+    crc = Checksum::crc16(header.constData(), header.size(), 0);
+    crc = Checksum::crc16(payload.constData(), len, crc);
+    if (crc != ((static_cast<uint8_t>(payload[len]) << 8) |
+                static_cast<uint8_t>(payload[len + 1]))) {
+        DEBUG << "Frame" << frameSeq_ << ": bad CRC";
+        return false;
+    }
+    if (!len) {
+        DEBUG << "Frame" << frameSeq_ << ": rejected by firmware";
+        return false;
+    }
+    // the response is received in place
+    payload.resize(len);
+    return true;
+}
+
+bool Runner::isFrameable_(uint8_t code) {
+    switch (code) {
+        case kCmdDeviceReadRange:
+        case kCmdDeviceWriteRange:
+            return false;
+        default:
+            return true;
+    }
+}
+
+bool Runner::hasWideBuffer_() {
+    if (wideChecked_) return wideSupported_;
+    wideChecked_ = true;
+    wideSupported_ = false;
+    // empty read: old firmware responds NOK (unknown opcode),
+    // then OK for each param (0x00 is a NOP)
+    auto opcode = OpCode::getOpCode(kCmdDeviceReadW);
+    QByteArray probe(opcode.params + 1, 0);
+    probe[0] = static_cast<char>(kCmdDeviceReadW);
+    QByteArray response;
+    if (!write_(probe) || !read_(&response, 1)) {
+        DEBUG << "Wide length: no response";
+        return false;
+    }
+    if (static_cast<uint8_t>(response[0]) == kCmdResponseOk) {
+        wideSupported_ = true;
+        DEBUG << "Wide length: supported";
+    } else {
+        // discard the responses of the NOPs
+        read_(&response, opcode.params);
+        DEBUG << "Wide length: not supported";
+    }
+    return wideSupported_;
+}
+
+void Runner::bufferCommand_(TRunnerCommand& cmd, kCmdOpCodeEnum code,
+                            const char* data, int size) {
+    if (bufferSize_ > kMaxByteBufferSize) {
+        switch (code) {
+            case kCmdDeviceRead:
+                code = kCmdDeviceReadW;
+                break;
+            case kCmdDeviceWrite:
+                code = kCmdDeviceWriteW;
+                break;
+            case kCmdDeviceVerify:
+                code = kCmdDeviceVerifyW;
+                break;
+            case kCmdDeviceBlankCheck:
+                code = kCmdDeviceBlankCheckW;
+                break;
+            default:
+                break;
+        }
+        cmd.setWord(code, bufferSize_);
+    } else {
+        cmd.setByte(code, bufferSize_);
+    }
+    // setup expected response size
+    if (code == kCmdDeviceRead || code == kCmdDeviceReadW) {
+        cmd.opcode.result = bufferSize_;
+    }
+    if (data) {
+        // set data
+        int offset = cmd.params.size();
+        cmd.params.resize(offset + bufferSize_);
+        memset(cmd.params.data() + offset, 0xFF, bufferSize_);
+        memcpy(cmd.params.data() + offset, data,
+               qMax(0, qMin(size, static_cast<int>(bufferSize_))));
+    }
+}
+
+QVector<TRunnerCommand>& Runner::blockCommands_(int count) {
+    if (blockCmds_.size() < count) {
+        int first = blockCmds_.size();
+        blockCmds_.resize(count);
+        // the commands keep their memory
+        for (int i = first; i < count; i++) {
+            blockCmds_[i].params.reserve(kMaxBufferSize + kFrameOverhead);
+            blockCmds_[i].response.reserve(kMaxBufferSize + kFrameOverhead);
+        }
+    }
+    return blockCmds_;
+}
+
+bool Runner::hasReadRange_() {
+    if (rangeChecked_) return rangeSupported_;
+    rangeChecked_ = true;
+    rangeSupported_ = false;
+    // empty range: old firmware responds NOK (unknown opcode),
+    // then OK for each param (0x00 is a NOP)
+    auto opcode = OpCode::getOpCode(kCmdDeviceReadRange);
+    QByteArray probe(opcode.params + 1, 0);
+    probe[0] = static_cast<char>(kCmdDeviceReadRange);
+    QByteArray response;
+    if (!write_(probe) || !read_(&response, 1)) {
+        DEBUG << "Read Range: no response";
+        return false;
+    }
+    if (static_cast<uint8_t>(response[0]) == kCmdResponseOk) {
+        rangeSupported_ = true;
+        DEBUG << "Read Range: supported";
+    } else {
+        // discard the responses of the NOPs
+        read_(&response, opcode.params);
+        DEBUG << "Read Range: not supported";
+    }
+    return rangeSupported_;
+}
+
+bool Runner::startRange_(uint32_t address, uint32_t size) {
+    TRunnerCommand cmd;
+    cmd.set(kCmdDeviceReadRange);
+    cmd.params.resize(cmd.opcode.params + 1);
+    OpCode::setDWord(cmd.params.data(), 4, address);
+    OpCode::setDWord(cmd.params.data() + 3, 4, size);
+    rangeRemaining_ = 0;
+    rangeEncoded_ = selectEncoding_();
+    // no retry
+    if (!sendCommand_(cmd, 0)) return false;
+    address_ = address;
+    rangeRemaining_ = size;
+    return true;
+}
+
+bool Runner::cancelRange_() {
+    DEBUG << "Canceling Read Range. Remaining:" << rangeRemaining_;
+    // any byte cancels the stream. If the stream already ended, the
+    // firmware runs it as a NOP (and responds OK)
+    QByteArray data(1, static_cast<char>(kCmdNop));
+    bool success = (transport_->write(data) == data.size());
+    while (success) {
+        if (!read_(&data, 1)) {
+            success = false;
+        } else if (static_cast<uint8_t>(data[0]) != kCmdResponseOk ||
+                   !rangeRemaining_) {
+            // NOK (stream canceled) or OK (NOP)
+            break;
+        } else {
+            // discard the chunk in transit
+            int len = qMin(rangeRemaining_,
+                           static_cast<uint32_t>(kCmdStreamChunkSize));
+            success = (readRangeChunk_(&data, len) != 0);
+            rangeRemaining_ -= len;
+        }
+    }
+    rangeRemaining_ = 0;
+    if (!success) {
+        transport_->clear();
+        error_ = true;
+    }
+    return success;
+}
+
+int Runner::readRangeChunk_(QByteArray* chunk, int len) {
+    if (!rangeEncoded_) return read_(chunk, len + 2) ? (len + 2) : 0;
+    // encoded length (MSB first) + encoded data + CRC16
+    QByteArray& encoded = encoded_;
+    if (!read_(&encoded, 2)) return 0;
+    int encodedLen = (static_cast<uint8_t>(encoded[0]) << 8) |
+                     static_cast<uint8_t>(encoded[1]);
+    if (encodedLen > static_cast<int>(Rle::maxEncodedSize(len)) ||
+        !read_(&encoded, encodedLen + 2)) {
+        return 0;
+    }
+    chunk->resize(len + 2);
+    size_t decoded = 0;
+    if (Rle::decode(encoded.constData(), encodedLen, chunk->data(), len,
+                    decoded) &&
+        decoded == static_cast<size_t>(len)) {
+        (*chunk)[len] = encoded[encodedLen];
+        (*chunk)[len + 1] = encoded[encodedLen + 1];
+    } else {
+        // forces a CRC error (restarts the stream)
+        uint16_t crc = ~Checksum::crc16(chunk->constData(), len);
+        (*chunk)[len] = static_cast<char>((crc >> 8) & 0xFF);
+        (*chunk)[len + 1] = static_cast<char>(crc & 0xFF);
+    }
+    // encoded length + encoded data + CRC16
+    return encodedLen + 4;
+}
+
+bool Runner::hasWriteRange_() {
+    if (writeRangeChecked_) return writeRangeSupported_;
+    writeRangeChecked_ = true;
+    writeRangeSupported_ = false;
+    // empty range: old firmware responds NOK (unknown opcode),
+    // then OK for each param (0x00 is a NOP)
+    auto opcode = OpCode::getOpCode(kCmdDeviceWriteRange);
+    QByteArray probe(opcode.params + 1, 0);
+    probe[0] = static_cast<char>(kCmdDeviceWriteRange);
+    QByteArray response;
+    if (!write_(probe) || !read_(&response, 2)) {
+        DEBUG << "Write Range: no response";
+        return false;
+    }
+    if (static_cast<uint8_t>(response[0]) == kCmdResponseOk) {
+        writeRangeSupported_ = true;
+        DEBUG << "Write Range: supported";
+    } else {
+        // discard the responses of the NOPs
+        read_(&response, opcode.params - 1);
+        DEBUG << "Write Range: not supported";
+    }
+    return writeRangeSupported_;
+}
+
+bool Runner::hasCrc32Range_() {
+    if (crcChecked_) return crcSupported_;
+    crcChecked_ = true;
+    crcSupported_ = false;
+    // empty range: old firmware responds NOK (unknown opcode),
+    // then OK for each param (0x00 is a NOP)
+    auto opcode = OpCode::getOpCode(kCmdDeviceCrc32Range);
+    QByteArray probe(opcode.params + 1, 0);
+    probe[0] = static_cast<char>(kCmdDeviceCrc32Range);
+    QByteArray response;
+    if (!write_(probe) || !read_(&response, opcode.result + 1)) {
+        DEBUG << "CRC32 Range: no response";
+        return false;
+    }
+    if (static_cast<uint8_t>(response[0]) == kCmdResponseOk) {
+        crcSupported_ = true;
+        DEBUG << "CRC32 Range: supported";
+    } else {
+        // discard the responses of the remaining NOPs
+        read_(&response, opcode.params - opcode.result);
+        DEBUG << "CRC32 Range: not supported";
+    }
+    return crcSupported_;
+}
+
+bool Runner::hasBlankCheckRange_() {
+    if (blankRangeChecked_) return blankRangeSupported_;
+    blankRangeChecked_ = true;
+    blankRangeSupported_ = false;
+    // empty range: old firmware responds NOK (unknown opcode),
+    // then OK for each param (0x00 is a NOP)
+    auto opcode = OpCode::getOpCode(kCmdDeviceBlankCheckRange);
+    QByteArray probe(opcode.params + 1, 0);
+    probe[0] = static_cast<char>(kCmdDeviceBlankCheckRange);
+    QByteArray response;
+    if (!write_(probe) || !read_(&response, 1)) {
+        DEBUG << "Blank Check Range: no response";
+        return false;
+    }
+    if (static_cast<uint8_t>(response[0]) == kCmdResponseOk) {
+        // discard the result
+        blankRangeSupported_ = read_(&response, opcode.result);
+        DEBUG << "Blank Check Range: supported";
+    } else {
+        // discard the responses of the NOPs
+        read_(&response, opcode.params);
+        DEBUG << "Blank Check Range: not supported";
+    }
+    return blankRangeSupported_;
+}
+
+bool Runner::hasEncoding_() {
+    if (encodingChecked_) return encodingSupported_;
+    encodingChecked_ = true;
+    encodingSupported_ = false;
+    // raw encoding: old firmware responds NOK (unknown opcode),
+    // then OK (0x00 is a NOP)
+    QByteArray probe(2, 0);
+    probe[0] = static_cast<char>(kCmdProtoEncoding);
+    probe[1] = static_cast<char>(kCmdProtoEncodingRaw);
+    QByteArray response;
+    if (!write_(probe) || !read_(&response, 1)) {
+        DEBUG << "Stream encoding: no response";
+        return false;
+    }
+    if (static_cast<uint8_t>(response[0]) == kCmdResponseOk) {
+        encodingSupported_ = true;
+        DEBUG << "Stream encoding: supported";
+    } else {
+        // discard the response of the NOP
+        read_(&response, 1);
+        DEBUG << "Stream encoding: not supported";
+    }
+    return encodingSupported_;
+}
+
+bool Runner::hasDeviceSetup_() {
+    if (setupChecked_) return setupSupported_;
+    // reported only by the capabilities (see queryCapabilities_()): any
+    // Device Setup is a real request, so it can not be used as a probe
+    setupChecked_ = true;
+    setupSupported_ = false;
+    DEBUG << "Device Setup: not supported";
+    return setupSupported_;
+}
+
+uint16_t Runner::configure_(kCmdDeviceAlgorithmEnum algo,
+                            const TDeviceFlags& flags) {
+    uint16_t value = algo;
+    value <<= 8;
+    flags_ = flags;
+    if (flags.is16bit && bufferSize_ == 1) setBufferSize(2);
+    if (reqBufferSize_ > kMaxByteBufferSize) {
+        // old firmware: one byte length only
+        bufferSize_ = hasWideBuffer_() ? reqBufferSize_ : kMaxByteBufferSize;
+    }
+    // clang-format off
+    if (flags.skipFF     ) value |= 0x01;
+    if (flags.progWithVpp) value |= 0x02;
+    if (flags.vppOePin   ) value |= 0x04;
+    if (flags.pgmCePin   ) value |= 0x08;
+    if (flags.pgmPositive) value |= 0x10;
+    if (flags.is16bit    ) value |= 0x20;
+    // clang-format on
+    return value;
+}
+
+void Runner::adjustTimeout_(uint32_t value) {
+    uint32_t calculatedTime = (value * 2048) / 1000;  // 2KB
+    if (calculatedTime > timeout_) {
+        timeout_ = calculatedTime * 2;
+    }
+}
+
+bool Runner::selectEncoding_() {
+    if (!compression_ || !hasEncoding_()) return false;
+    QByteArray data(2, 0);
+    data[0] = static_cast<char>(kCmdProtoEncoding);
+    data[1] = static_cast<char>(kCmdProtoEncodingRle);
+    auto start = std::chrono::steady_clock::now();
+    bool success = write_(data) && read_(&data, 1) &&
+                   static_cast<uint8_t>(data[0]) == kCmdResponseOk;
+    stats_.add(kCmdProtoEncoding, 2, success ? 1 : 0, elapsedUs(start), 0,
+               !success);
+    return success;
+}
+
+bool Runner::writeRangeAck_() {
+    QByteArray response;
+    if (read_(&response, 1) &&
+        static_cast<uint8_t>(response[0]) == kCmdResponseOk) {
+        writeRangeAcked_++;
+        address_ += (flags_.is16bit ? (writeRangeBlock_ / 2)
+                                    : writeRangeBlock_);
+        return true;
+    }
+    if (response.size() == 1) {
+        DEBUG << "Error in Write Range. Last address:"
+              << QString("0x%1").arg(address_, 6, 16, QChar('0'));
+        // the firmware discards the blocks the host is allowed to send
+        int allowed = qMin(writeRangeBlocks_,
+                           writeRangeAcked_ + writeRangeCredits_);
+        if (allowed > writeRangeSent_) {
+            // encoded: empty blocks (zero length + CRC16)
+            int size = writeRangeEncoded_ ? 4 : (writeRangeBlock_ + 2);
+            QByteArray padding((allowed - writeRangeSent_) * size, 0xFF);
+            if (writeRangeEncoded_) {
+                for (int i = 0; i < padding.size(); i += size) {
+                    padding[i] = 0;
+                    padding[i + 1] = 0;
+                }
+            }
+            transport_->write(padding);
+        }
+    } else {
+        WARNING << "Error reading from serial port. "
+                   "Command Device WriteRange";
+        transport_->clear();
+    }
+    writeRangeBlocks_ = 0;
+    error_ = true;
+    return false;
+}
+
+void Runner::encodeBlock_(const QByteArray& block, QByteArray& result) const {
+    int len = block.size() - 2;
+    result.resize(Rle::maxEncodedSize(len) + 4);
+    size_t encodedLen = Rle::encode(block.constData(), len, result.data() + 2);
+    result[0] = static_cast<char>((encodedLen >> 8) & 0xFF);
+    result[1] = static_cast<char>(encodedLen & 0xFF);
+    result[encodedLen + 2] = block[len];
+    result[encodedLen + 3] = block[len + 1];
+    result.resize(encodedLen + 4);
+}
+
 bool Runner::write_(const QByteArray& data) {
     if (data.isEmpty()) return true;
-    serial_.clear();
-    return serial_.write(data) == data.size();
+    transport_->clear();
+    return transport_->write(data) == data.size();
 }
 
 bool Runner::read_(QByteArray* data, uint32_t size) {
     if (data == nullptr || !size) return true;
-    data->clear();
-    while (data->size() < size) {
-        auto start = std::chrono::steady_clock::now();
-        auto end = start;
-        int64_t elapsed = 0;
-        bool hasData = false;
-        do {
-            if (serial_.waitForReadyRead(1)) {
-                hasData = true;
-                break;
-            }
-#ifdef Q_OS_WINDOWS
-            Sleep(1);
-#else
-            std::this_thread::sleep_for(std::chrono::milliseconds(1));
-#endif
-            end = std::chrono::steady_clock::now();
-            elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
-                          end - start)
-                          .count();
-            if (timeout_ > 50 && (elapsed % 50) == 0) processEvents();
-        } while (elapsed < timeout_);
-        if (!hasData) {
+    auto start = std::chrono::steady_clock::now();
+    int64_t elapsed = 0;
+    // wakes up as soon as the data arrives (processing the application
+    // events every 50 ms, if running on the GUI thread)
+    while (!transport_->read(data, size,
+                         (timeout_ > 50) ? qMin<int64_t>(50, timeout_ - elapsed)
+                                         : timeout_)) {
+        elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                      std::chrono::steady_clock::now() - start)
+                      .count();
+        if (elapsed >= timeout_) {
             DEBUG << "Error reading serial port: timeout";
             checkAlive_();
             return false;
         }
-        data->append(serial_.readAll());
-        aliveTick_ = QDateTime::currentMSecsSinceEpoch();
-    }
-    if (data->size() > size) data->resize(size);
-    if (data->size() != size) {
-        DEBUG << "Error reading serial port: sizes are different";
-        return false;
+        processEvents();
     }
+    aliveTick_ = QDateTime::currentMSecsSinceEpoch();
     return true;
 }
 
@@ -866,6 +1973,6 @@ void Runner::checkAlive_() {
     if (QDateTime::currentMSecsSinceEpoch() - aliveTick_ > kDisconnectTimeOut) {
         WARNING << "Serial port: disconnected by timeout";
         running_ = false;
-        if (serial_.isOpen()) serial_.close();
+        if (transport_->isOpen()) transport_->close();
     }
 }
@@ -24,6 +24,7 @@
 #include <QString>
 #include <QList>
 #include <QByteArray>
+#include <QVector>
 
 #ifndef TEST_BUILD
 #include <QSerialPort>
@@ -32,7 +33,12 @@
 #include "test/mock/qserialport.hpp"
 #endif
 
+#include <memory>
+
 #include "opcodes.hpp"
+#include "stats.hpp"
+#include "trace.hpp"
+#include "transport/transport.hpp"
 
 // ---------------------------------------------------------------------------
 
@@ -59,6 +65,8 @@ typedef struct TRunnerCommand {
     QByteArray params;
     /** @brief Response of the command (raw bytes). */
     QByteArray response;
+    /** @brief Constructor (a NOP command, without parameters). */
+    TRunnerCommand();
     /**
      * @brief Returns if response is OK.
      * @return True if response is OK, else if response is NOK.
@@ -167,6 +175,15 @@ class Runner : public QObject {
         /** @brief 16-bit mode. */
         bool is16bit;
     } TDeviceFlags;
+    /** @brief Capabilities reported by the firmware. */
+    typedef struct TCapabilities {
+        /** @brief Protocol version (zero if not reported). */
+        uint8_t version;
+        /** @brief Maximum length of the buffer opcodes, in bytes. */
+        uint16_t maxBufferSize;
+        /** @brief Feature bitmap (see kCmdProtoFeatureEnum). */
+        uint16_t features;
+    } TCapabilities;
 
   public:
     /**
@@ -183,7 +200,14 @@ class Runner : public QObject {
     TSerialPortList list() const;
     /**
      * @brief Opens a serial port.
-     * @param path Path of the serial port (system dependent).
+     * @details Queries the capabilities of the firmware. If they are
+     *   reported (and the protocol version is known), the transfer mode
+     *   of each operation is selected from the feature bitmap. Otherwise
+     *   (old firmware), each feature is probed on its first use.
+     *   <br/>The transport is selected by the prefix of the path (see
+     *   Transport::create()).
+     * @param path Path of the serial port (system dependent), or of
+     *   another transport (ex.: "replay:/tmp/session.uft").
      * @return True if success, false otherwise.
      */
     bool open(const QString& path);
@@ -220,12 +244,106 @@ class Runner : public QObject {
      * @brief Returns the current buffer size value for buffer operations.
      * @return Buffer size, in bytes.
      */
-    uint8_t getBufferSize() const;
+    uint16_t getBufferSize() const;
     /**
      * @brief Sets the buffer size value for buffer operations.
-     * @param value Buffer size, in bytes.
+     * @details Buffers larger than 128 bytes use the wide length opcodes.
+     *   If the firmware does not support them, the buffer size is limited
+     *   to 128 bytes (checked by deviceConfigure()).
+     * @param value Buffer size, in bytes (up to 4096).
+     */
+    void setBufferSize(uint16_t value);
+    /**
+     * @brief Returns the maximum buffer size for buffer operations.
+     * @details If the port is open, checks if the firmware supports the
+     *   wide length opcodes (once per connection).
+     * @return 128 if the firmware does not support the wide length
+     *   opcodes, 4096 (or the maximum length reported by the firmware)
+     *   otherwise.
+     */
+    uint16_t getMaxBufferSize();
+    /**
+     * @brief Indicates if the firmware supports the Device Read Range
+     *   stream (see deviceReadRangeBegin()).
+     * @details If the port is open, checks it (once per connection).
+     * @return True if supported, false otherwise.
+     */
+    bool hasReadRange();
+    /**
+     * @brief Returns the capabilities reported by the firmware.
+     * @return Capabilities queried by open(). The version is zero if
+     *   the firmware does not support the Get Capabilities opcode.
+     */
+    const TCapabilities& getCapabilities() const;
+    /**
+     * @brief Returns the current window size (maximum number of commands
+     *   in flight) for pipelined buffer operations.
+     * @return Window size, in commands.
+     */
+    uint8_t getWindowSize() const;
+    /**
+     * @brief Sets the window size (maximum number of commands in flight)
+     *   for pipelined buffer operations.
+     * @details The pipelining is only used if the firmware supports tagged
+     *   commands. Otherwise, the commands are sent one by one.
+     * @param value Window size, in commands.
+     */
+    void setWindowSize(uint8_t value);
+    /**
+     * @brief Returns if the data streams (Read Range and Write Range)
+     *   are compressed.
+     * @return True if compression is enabled, false otherwise.
+     */
+    bool getCompression() const;
+    /**
+     * @brief Enables or disables the compression (RLE encoding) of the
+     *   data streams (Read Range and Write Range).
+     * @details The compression is only used if the firmware supports it.
+     *   Otherwise, the streams are sent raw. Default is enabled.
+     * @param value True to enable compression, false to disable.
      */
-    void setBufferSize(uint8_t value);
+    void setCompression(bool value);
+    /**
+     * @brief Returns if the commands are sent in frames.
+     * @return True if the framed transport is enabled, false otherwise.
+     */
+    bool getFraming() const;
+    /**
+     * @brief Enables or disables the framed transport.
+     * @details Each command is sent in a frame with a sequence number and
+     *   a CRC-16. A corrupted or lost frame is retransmitted, and never
+     *   runs twice, so the device address does not need to be resynced.
+     *   The framed commands are sent one by one (no tagged commands in
+     *   flight). The streams (Read Range and Write Range) are not framed.
+     *   <br/>The framed transport is only used if the firmware supports
+     *   it. Default is disabled.
+     * @param value True to enable the framed transport, false to disable.
+     */
+    void setFraming(bool value);
+    /**
+     * @brief Returns the communication statistics.
+     * @details Each command records its opcode, the bytes sent and
+     *   received, the retries and the latency (from sending the command
+     *   to receiving its response). The stream chunks are recorded under
+     *   the Read Range and Write Range opcodes.
+     * @return Statistics recorded since the last resetStats().
+     */
+    const CommStats& getStats() const;
+    /** @brief Clears the communication statistics. */
+    void resetStats();
+    /**
+     * @brief Records the serial traffic to a trace file.
+     * @details The trace can be replayed by opening the path
+     *   kTraceReplayPrefix + filename (see ReplayTransport).
+     * @param filename Name of the trace file. Empty to stop recording.
+     * @return True if success, false otherwise.
+     */
+    bool setTraceFile(const QString& filename);
+    /**
+     * @brief Returns the file the serial traffic is recorded to.
+     * @return Name of the trace file, or empty if not recording.
+     */
+    QString getTraceFile() const;
     /**
      * @brief Runs the NOP opcode.
      * @return True if success, false otherwise.
@@ -452,6 +570,26 @@ class Runner : public QObject {
      * @return True if success, false otherwise.
      */
     bool deviceResetBus();
+    /**
+     * @brief Runs the Device Setup opcode, that sets up a whole device
+     *   session (configuration, timings, voltages and bus) at once.
+     * @details If the firmware does not support it, runs the Device
+     *   Configure, Set tWP, Set tWC, VDD Set, VPP Set and Setup Bus
+     *   opcodes instead.
+     * @param algo Device Algorithm.
+     * @param flags Device Flags.
+     * @param vdd VDD voltage.
+     * @param vpp VPP voltage.
+     * @param twp tWP value.
+     * @param twc tWC value.
+     * @param operation Operation to realize.
+     * @param keep Values not set (the current ones are kept), a bit mask
+     *  of kCmdDeviceSetupKeepEnum.
+     * @return True if success, false otherwise (or a negative voltage).
+     */
+    bool deviceSetup(kCmdDeviceAlgorithmEnum algo, const TDeviceFlags& flags,
+                     float vdd, float vpp, uint32_t twp, uint32_t twc,
+                     kCmdDeviceOperationEnum operation, uint8_t keep);
     /**
      * @brief Runs the Device Read Buffer opcode.
      * @return Read buffer if success, empty otherwise.
@@ -481,6 +619,137 @@ class Runner : public QObject {
      * @return True if success, false otherwise.
      */
     bool deviceBlankCheck();
+    /**
+     * @brief Runs the Device Read Buffer opcode several times (pipelined).
+     * @param count Number of buffers to read.
+     * @return Read buffers if success. If an error occurs, returns only the
+     *   buffers read before the error, and the address points to the
+     *   first buffer not read.
+     */
+    QByteArray deviceReadBlocks(int count);
+    /**
+     * @brief Runs the Device Read Buffer opcode several times (pipelined),
+     *   appending the buffers to a QByteArray (whose allocated memory is
+     *   reused).
+     * @param count Number of buffers to read.
+     * @param buffer QByteArray to receive the read buffers (appended). If
+     *   an error occurs, receives only the buffers read before the error,
+     *   and the address points to the first buffer not read.
+     * @return True if all the buffers were read, false otherwise.
+     */
+    bool deviceReadBlocks(int count, QByteArray& buffer);
+    /**
+     * @brief Runs the Device Write Buffer opcode several times (pipelined).
+     * @param data Data to write (split in buffers).
+     * @return True if success, false otherwise. If an error occurs, the
+     *   address points to the first buffer not written.
+     */
+    bool deviceWriteBlocks(const QByteArray& data);
+    /**
+     * @brief Runs the Device Verify Buffer opcode several times (pipelined).
+     * @param data Data to verify (split in buffers).
+     * @return True if success, false otherwise. If an error occurs, the
+     *   address points to the first buffer not verified.
+     */
+    bool deviceVerifyBlocks(const QByteArray& data);
+    /**
+     * @brief Runs the Device Blank Check Buffer opcode several times
+     *   (pipelined).
+     * @param count Number of buffers to check.
+     * @return True if success, false otherwise. If an error occurs, the
+     *   address points to the first buffer not checked.
+     */
+    bool deviceBlankCheckBlocks(int count);
+    /**
+     * @brief Starts a Device Read Range stream.
+     * @details The firmware streams the range in chunks (each one with
+     *   its CRC16), without a request per buffer. Use deviceReadRangeNext()
+     *   to receive the chunks, and deviceReadRangeEnd() to cancel.
+     * @param address Start address.
+     * @param size Size of the range, in bytes.
+     * @return True if success, false otherwise (including if the firmware
+     *   does not support the Read Range opcode).
+     */
+    bool deviceReadRangeBegin(uint32_t address, uint32_t size);
+    /**
+     * @brief Receives the next chunk of the Device Read Range stream.
+     * @details If a chunk arrives corrupted, the stream is restarted
+     *   from the first address not received.
+     * @return Chunk data if success, empty otherwise (error or end of
+     *   the stream).
+     */
+    QByteArray deviceReadRangeNext();
+    /**
+     * @brief Receives the next chunk of the Device Read Range stream,
+     *   appending it to a QByteArray (whose allocated memory is reused).
+     * @param buffer QByteArray to receive the chunk data (appended).
+     * @return True if success, false otherwise (error or end of the
+     *   stream).
+     */
+    bool deviceReadRangeNext(QByteArray& buffer);
+    /**
+     * @brief Ends (or cancels) the Device Read Range stream.
+     * @return True if success, false otherwise.
+     */
+    bool deviceReadRangeEnd();
+    /**
+     * @brief Starts a Device Write Range stream.
+     * @details The blocks are sent ahead of the acknowledgments (up to
+     *   the number of credits granted by the firmware), so the firmware
+     *   programs a block while the next ones are arriving. Use
+     *   deviceWriteRangeNext() to send the blocks, and
+     *   deviceWriteRangeEnd() to finish (or cancel).
+     * @param address Start address.
+     * @param size Size of the range, in bytes (multiple of blockSize).
+     * @param blockSize Block size, in bytes.
+     * @param sector If true, writes the blocks as sectors.
+     * @return True if success, false otherwise (including if the firmware
+     *   does not support the Write Range opcode).
+     */
+    bool deviceWriteRangeBegin(uint32_t address, uint32_t size,
+                               uint16_t blockSize, bool sector = false);
+    /**
+     * @brief Sends the next block of the Device Write Range stream.
+     * @param data Data to write (one block).
+     * @return True if success, false otherwise. If an error occurs, the
+     *   stream ends, and the address points to the first block not
+     *   written.
+     */
+    bool deviceWriteRangeNext(const QByteArray& data);
+    /**
+     * @brief Ends the Device Write Range stream, waiting for the blocks
+     *   in flight. If not all blocks were sent, cancels the stream.
+     * @return True if all blocks were written, false otherwise (error or
+     *   canceled). The address points to the first block not written.
+     */
+    bool deviceWriteRangeEnd();
+    /**
+     * @brief Runs the Device CRC32 Range opcode.
+     * @details The firmware reads the range and returns only its CRC-32,
+     *   so the range can be verified without sending the data.
+     * @param address Start address.
+     * @param size Size of the range, in bytes.
+     * @param[out] crc Receives the CRC-32 of the range (see
+     *   Checksum::crc32()).
+     * @return True if success, false otherwise (including if the firmware
+     *   does not support the CRC32 Range opcode).
+     */
+    bool deviceCrc32Range(uint32_t address, uint32_t size, uint32_t& crc);
+    /**
+     * @brief Runs the Device Blank Check Range opcode.
+     * @details The firmware checks all the range, counting the non-blank
+     *   bytes/words, with only one request.
+     * @param address Start address.
+     * @param size Size of the range, in bytes.
+     * @param[out] dirty Receives the number of non-blank bytes/words (zero
+     *   if the range is blank).
+     * @param[out] first Receives the address of the first non-blank
+     *   byte/word (if any).
+     * @return True if success, false otherwise (including if the firmware
+     *   does not support the Blank Check Range opcode).
+     */
+    bool deviceBlankCheckRange(uint32_t address, uint32_t size,
+                               uint32_t& dirty, uint32_t& first);
     /**
      * @brief Runs the Device Get ID opcode.
      * @return Device/Manufacturer ID if success, zero values otherwise.
@@ -513,7 +782,10 @@ class Runner : public QObject {
      * @param value Sleep time, in msec.
      */
     static void msDelay(uint32_t value);
-    /** @brief Process Application Events. */
+    /**
+     * @brief Process Application Events.
+     *   Does nothing if not called from the main (GUI) thread.
+     */
     static void processEvents();
 
   private:
@@ -521,8 +793,14 @@ class Runner : public QObject {
     uint32_t timeout_;
     /* @brief Stores if is running. */
     bool running_;
-    /* @brief Serial port object. */
-    QSerialPort serial_;
+    /* @brief Transport to the programmer (serial port by default). */
+    std::unique_ptr<Transport> transport_;
+    /* @brief Type (path prefix) of the transport. */
+    QString transportType_;
+    /* @brief Trace recorder, shared by the transports. */
+    std::shared_ptr<TraceWriter> trace_;
+    /* @brief Name of the trace file. */
+    QString traceFile_;
     /* @brief Tickcounter used by alive timer. */
     qint64 aliveTick_;
     /* @brief Stores the last address. */
@@ -530,14 +808,217 @@ class Runner : public QObject {
     /* @brief Stores the device flags. */
     TDeviceFlags flags_;
     /* @brief Buffer size, in bytes. */
-    uint8_t bufferSize_;
+    uint16_t bufferSize_;
+    /* @brief Buffer size set by the user, in bytes. */
+    uint16_t reqBufferSize_;
     /* @brief Indicates if an error occurred in the last operation. */
     bool error_;
+    /* @brief Window size (commands in flight), for pipelined operations. */
+    uint8_t windowSize_;
+    /* @brief Indicates if the firmware was probed for tagged commands. */
+    bool tagChecked_;
+    /* @brief Indicates if the firmware supports tagged commands. */
+    bool tagSupported_;
+    /* @brief Next sequence tag. */
+    uint8_t tag_;
+    /* @brief Indicates if the firmware was probed for wide length. */
+    bool wideChecked_;
+    /* @brief Indicates if the firmware supports wide length opcodes. */
+    bool wideSupported_;
+    /* @brief Indicates if the firmware was probed for the Read Range. */
+    bool rangeChecked_;
+    /* @brief Indicates if the firmware supports the Read Range opcode. */
+    bool rangeSupported_;
+    /* @brief Bytes remaining in the current Read Range stream. */
+    uint32_t rangeRemaining_;
+    /* @brief Indicates if the current Read Range stream is RLE encoded. */
+    bool rangeEncoded_;
+    /* @brief Indicates if the firmware was probed for the Write Range. */
+    bool writeRangeChecked_;
+    /* @brief Indicates if the firmware supports the Write Range opcode. */
+    bool writeRangeSupported_;
+    /* @brief Block size of the current Write Range stream, in bytes. */
+    uint16_t writeRangeBlock_;
+    /* @brief Credits (blocks in flight) granted by the firmware. */
+    int writeRangeCredits_;
+    /* @brief Number of blocks of the current Write Range stream. */
+    int writeRangeBlocks_;
+    /* @brief Number of blocks sent in the current Write Range stream. */
+    int writeRangeSent_;
+    /* @brief Number of blocks acknowledged in the Write Range stream. */
+    int writeRangeAcked_;
+    /* @brief Indicates if the current Write Range stream is RLE encoded. */
+    bool writeRangeEncoded_;
+    /* @brief Indicates if the firmware was probed for the CRC32 Range. */
+    bool crcChecked_;
+    /* @brief Indicates if the firmware supports the CRC32 Range opcode. */
+    bool crcSupported_;
+    /* @brief Indicates if the firmware was probed for the Blank Check
+     *   Range. */
+    bool blankRangeChecked_;
+    /* @brief Indicates if the firmware supports the Blank Check Range
+     *   opcode. */
+    bool blankRangeSupported_;
+    /* @brief Indicates if the data streams are compressed (if supported). */
+    bool compression_;
+    /* @brief Indicates if the firmware was probed for stream encodings. */
+    bool encodingChecked_;
+    /* @brief Indicates if the firmware supports the stream encodings. */
+    bool encodingSupported_;
+    /* @brief Indicates if the firmware was probed for Device Setup. */
+    bool setupChecked_;
+    /* @brief Indicates if the firmware supports the Device Setup opcode. */
+    bool setupSupported_;
+    /* @brief Indicates if the commands are sent in frames (if supported). */
+    bool framing_;
+    /* @brief Indicates if the firmware was probed for the framed
+     *   transport. */
+    bool framingChecked_;
+    /* @brief Indicates if the firmware supports the Frame opcode. */
+    bool framingSupported_;
+    /* @brief Sequence number of the last frame. */
+    uint8_t frameSeq_;
+    /* @brief Capabilities reported by the firmware. */
+    TCapabilities caps_;
+    /* @brief Maximum buffer size supported by the firmware, in bytes. */
+    uint16_t maxBufferSize_;
+    /* @brief Command of a single buffer (reused). */
+    TRunnerCommand blockCmd_;
+    /* @brief Commands of a sequence of buffers (reused, only grows). */
+    QVector<TRunnerCommand> blockCmds_;
+    /* @brief Frame to send (reused). */
+    QByteArray txFrame_;
+    /* @brief Received data (reused). */
+    QByteArray rx_;
+    /* @brief Chunk of the Read Range stream (reused). */
+    QByteArray chunk_;
+    /* @brief Encoded data of the streams (reused). */
+    QByteArray encoded_;
+    /* @brief Communication statistics. */
+    CommStats stats_;
     /* @brief Sends the command.
      * @param cmd Command to send (and receive response).
      * @param retry Number of retry (default is 2).
      * @return True if success, false otherwise. */
     bool sendCommand_(TRunnerCommand& cmd, int retry = 2);
+    /* @brief Sends a sequence of commands, keeping up to [windowSize]
+     *   tagged commands in flight (or one by one, if the firmware does
+     *   not support tagged commands). Stops at the first error.
+     * @param cmds Commands to send (and receive responses).
+     * @param count Number of commands to send (from the first).
+     * @return Number of commands (from the first) run with success. */
+    int sendCommands_(QVector<TRunnerCommand>& cmds, int count);
+    /* @brief Queries the capabilities of the firmware (Get Capabilities
+     *   opcode) and, if they are known, marks all the features as
+     *   checked, according to the feature bitmap.
+     * @return True if the capabilities were applied, false otherwise. */
+    bool queryCapabilities_();
+    /* @brief Checks (once per connection) if the firmware supports
+     *   the framed transport (Frame opcode), synchronizing it.
+     * @return True if supported, false otherwise. */
+    bool hasFraming_();
+    /* @brief Sends a command in a frame, and receives its response.
+     * @param cmd Command to send (and receive response).
+     * @param resend If true, retransmits the last frame (same sequence
+     *   number), discarding the input first.
+     * @return True if success, false if the frame or the response was
+     *   lost or corrupted. */
+    bool transferFrame_(TRunnerCommand& cmd, bool resend);
+    /* @brief Checks if an opcode can be sent in a frame. The streams
+     *   (Read Range and Write Range) have their own CRC16, and the
+     *   firmware rejects them in a frame.
+     * @param code Opcode.
+     * @return True if frameable, false otherwise. */
+    static bool isFrameable_(uint8_t code);
+    /* @brief Checks (once per connection) if the firmware supports
+     *   tagged commands.
+     * @return True if supported, false otherwise. */
+    bool hasTags_();
+    /* @brief Checks (once per connection) if the firmware supports
+     *   the wide length opcodes (buffers larger than 128 bytes).
+     * @return True if supported, false otherwise. */
+    bool hasWideBuffer_();
+    /* @brief Sets a buffer command, with the current buffer size.
+     *   Uses the wide length variant of the opcode if the buffer size
+     *   does not fit in one byte. The memory of the command is reused.
+     * @param cmd Command to set.
+     * @param code OpCode of the command (one byte length).
+     * @param data Data to send (padded with 0xFF), or nullptr if none.
+     * @param size Size of data, in bytes. */
+    void bufferCommand_(TRunnerCommand& cmd, kCmdOpCodeEnum code,
+                        const char* data = nullptr, int size = 0);
+    /* @brief Prepares the commands of a sequence of buffers (grows the
+     *   list of commands, if needed).
+     * @param count Number of commands.
+     * @return Reference to the list of commands. */
+    QVector<TRunnerCommand>& blockCommands_(int count);
+    /* @brief Checks (once per connection) if the firmware supports
+     *   the Read Range opcode.
+     * @return True if supported, false otherwise. */
+    bool hasReadRange_();
+    /* @brief Sends the Read Range opcode.
+     * @param address Start address.
+     * @param size Size of the range, in bytes.
+     * @return True if success, false otherwise. */
+    bool startRange_(uint32_t address, uint32_t size);
+    /* @brief Cancels the current Read Range stream, discarding the
+     *   chunks already in transit.
+     * @return True if success, false otherwise. */
+    bool cancelRange_();
+    /* @brief Receives a chunk of the Read Range stream (after its OK),
+     *   decoding it if the stream is RLE encoded.
+     * @param chunk Pointer to QByteArray to receive the chunk data,
+     *   followed by its CRC16 (two bytes, MSB first). If the decoding
+     *   fails, the CRC16 does not match the data.
+     * @param len Size of chunk data, in bytes.
+     * @return Number of bytes received (encoded data, if encoded, and
+     *   CRC16), or zero if error. */
+    int readRangeChunk_(QByteArray* chunk, int len);
+    /* @brief Checks (once per connection) if the firmware supports
+     *   the Write Range opcode.
+     * @return True if supported, false otherwise. */
+    bool hasWriteRange_();
+    /* @brief Receives the acknowledgment of the oldest block in flight
+     *   (Write Range stream). If an error occurred, completes the bytes
+     *   the firmware expects, and ends the stream.
+     * @return True if the block was written, false otherwise. */
+    bool writeRangeAck_();
+    /* @brief Encodes a block of the Write Range stream (RLE).
+     * @param block Block data, followed by its CRC16 (two bytes).
+     * @param[out] result Encoded length (two bytes, MSB first), encoded
+     *   data and the CRC16 (of the block data). */
+    void encodeBlock_(const QByteArray& block, QByteArray& result) const;
+    /* @brief Checks (once per connection) if the firmware supports
+     *   the CRC32 Range opcode.
+     * @return True if supported, false otherwise. */
+    bool hasCrc32Range_();
+    /* @brief Checks (once per connection) if the firmware supports
+     *   the Blank Check Range opcode.
+     * @return True if supported, false otherwise. */
+    bool hasBlankCheckRange_();
+    /* @brief Checks (once per connection) if the firmware supports
+     *   the stream encodings (Encoding opcode).
+     * @return True if supported, false otherwise. */
+    bool hasEncoding_();
+    /* @brief Checks if the firmware supports the Device Setup opcode
+     *   (reported by the capabilities, see queryCapabilities_()).
+     * @return True if supported, false otherwise. */
+    bool hasDeviceSetup_();
+    /* @brief Applies the device configuration to the runner (flags and
+     *   buffer size).
+     * @param algo Device Algorithm.
+     * @param flags Device Flags.
+     * @return Param value of the Device Configure opcode. */
+    uint16_t configure_(kCmdDeviceAlgorithmEnum algo,
+                        const TDeviceFlags& flags);
+    /* @brief Adjusts the read timeout to a device timing.
+     * @param value Timing (tWP or tWC), in microseconds. */
+    void adjustTimeout_(uint32_t value);
+    /* @brief Selects the RLE encoding for the stream of the next command,
+     *   if the compression is enabled and supported by the firmware.
+     * @return True if the RLE encoding was selected, false otherwise
+     *   (the stream is raw). */
+    bool selectEncoding_();
     /* @brief Sends data via serial port.
      * @param data Data to send.
      * @return True if success, false otherwise. */
@@ -0,0 +1,156 @@
+// ---------------------------------------------------------------------------
+// USB EPROM/Flash Programmer
+//
+// Copyright (2024) Robson Martins
+//
+// This work is licensed under a Creative Commons Attribution-NonCommercial-
+// ShareAlike 4.0 International License.
+// ---------------------------------------------------------------------------
+/**
+ * @ingroup Software
+ * @file backend/serialio.cpp
+ * @brief Implementation of the Serial I/O Class.
+ *
+ * @author Robson Martins (https://www.robsonmartins.com)
+ */
+// ---------------------------------------------------------------------------
+
+#include <QElapsedTimer>
+#include <QMutexLocker>
+
+#include "backend/serialio.hpp"
+
+// ---------------------------------------------------------------------------
+
+SerialIo::SerialIo(QObject* parent)
+    : QObject(parent),
+      port_(new QSerialPort()),
+      flushQueued_(false),
+      opened_(false) {
+    // the buffers are allocated once
+    buffer_.reserve(kReceiveCapacity);
+    rx_.reserve(kReceiveCapacity);
+    out_.reserve(kReceiveCapacity);
+    port_->moveToThread(&thread_);
+    connect(port_, &QSerialPort::readyRead, port_,
+            [this]() { onReadyRead_(); });
+    connect(&thread_, &QThread::finished, port_, &QObject::deleteLater);
+    thread_.start();
+}
+
+SerialIo::~SerialIo() {
+    close();
+    thread_.quit();
+    thread_.wait();
+}
+
+bool SerialIo::open(const QString& path) {
+    bool result = false;
+    QMetaObject::invokeMethod(
+        port_,
+        [this, &path, &result]() {
+            if (port_->isOpen()) port_->close();
+            port_->setPortName(path);
+            result = port_->open(QIODevice::ReadWrite);
+            // need under Windows
+            // https://community.platformio.org/t/
+            //   serial-communication-micro-usb-on-pi-pico-c/27512/5
+            if (result) port_->setDataTerminalReady(true);
+        },
+        Qt::BlockingQueuedConnection);
+    QMutexLocker locker(&mutex_);
+    buffer_.resize(0);
+    opened_ = result;
+    path_ = result ? path : QString();
+    return result;
+}
+
+void SerialIo::close() {
+    {
+        QMutexLocker locker(&mutex_);
+        if (!opened_) return;
+        opened_ = false;
+        path_.clear();
+        buffer_.resize(0);
+    }
+    QMetaObject::invokeMethod(
+        port_, [this]() { port_->close(); }, Qt::BlockingQueuedConnection);
+}
+
+bool SerialIo::isOpen() const {
+    QMutexLocker locker(&mutex_);
+    return opened_;
+}
+
+QString SerialIo::portName() const {
+    QMutexLocker locker(&mutex_);
+    return path_;
+}
+
+qint64 SerialIo::write(const QByteArray& data) {
+    if (!isOpen()) return -1;
+    record_(kTraceWrite, data);
+    // the data is copied (the caller reuses its buffer), and the writes
+    // queued before the flush runs are sent together
+    QMutexLocker locker(&mutex_);
+    out_.append(data);
+    if (!flushQueued_) {
+        flushQueued_ = true;
+        QMetaObject::invokeMethod(
+            port_, [this]() { flush_(); }, Qt::QueuedConnection);
+    }
+    return data.size();
+}
+
+bool SerialIo::clear() {
+    if (!isOpen()) return false;
+    bool result = false;
+    // runs after the pending writes, and before the next ones (only the
+    // input is cleared: the written data may still be in the port)
+    QMetaObject::invokeMethod(
+        port_,
+        [this, &result]() {
+            result = port_->clear(QSerialPort::Input);
+            QMutexLocker locker(&mutex_);
+            buffer_.resize(0);
+        },
+        Qt::BlockingQueuedConnection);
+    return result;
+}
+
+bool SerialIo::read(QByteArray* data, int size, int msecs) {
+    if (data == nullptr) return false;
+    QElapsedTimer elapsed;
+    elapsed.start();
+    QMutexLocker locker(&mutex_);
+    while (buffer_.size() < size && elapsed.elapsed() < msecs) {
+        received_.wait(&mutex_, msecs - elapsed.elapsed());
+    }
+    if (buffer_.size() < size) {
+        data->resize(0);
+        return false;
+    }
+    take_(buffer_, data, size);
+    return true;
+}
+
+void SerialIo::onReadyRead_() {
+    qint64 available = port_->bytesAvailable();
+    if (available <= 0) return;
+    rx_.resize(available);
+    qint64 size = port_->read(rx_.data(), available);
+    if (size <= 0) return;
+    rx_.resize(size);
+    record_(kTraceRead, rx_);
+    QMutexLocker locker(&mutex_);
+    buffer_.append(rx_);
+    received_.wakeAll();
+}
+
+void SerialIo::flush_() {
+    QMutexLocker locker(&mutex_);
+    flushQueued_ = false;
+    if (out_.isEmpty()) return;
+    port_->write(out_.constData(), out_.size());
+    out_.resize(0);
+}
@@ -0,0 +1,127 @@
+// ---------------------------------------------------------------------------
+// USB EPROM/Flash Programmer
+//
+// Copyright (2024) Robson Martins
+//
+// This work is licensed under a Creative Commons Attribution-NonCommercial-
+// ShareAlike 4.0 International License.
+// ---------------------------------------------------------------------------
+/**
+ * @ingroup Software
+ * @file backend/serialio.hpp
+ * @brief Header of the Serial I/O Class.
+ *
+ * @author Robson Martins (https://www.robsonmartins.com)
+ */
+// ---------------------------------------------------------------------------
+
+#ifndef BACKEND_SERIALIO_HPP_
+#define BACKEND_SERIALIO_HPP_
+
+// ---------------------------------------------------------------------------
+
+#include <QObject>
+#include <QString>
+#include <QByteArray>
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+
+#ifndef TEST_BUILD
+#include <QSerialPort>
+#else
+#include "test/mock/qserialport.hpp"
+#endif
+
+#include "backend/transport/transport.hpp"
+
+// ---------------------------------------------------------------------------
+
+/**
+ * @ingroup Software
+ * @brief Serial I/O Class
+ * @details The purpose of this class is to run the serial port on a
+ *   dedicated I/O thread. The received data is stored by the readyRead
+ *   signal handler, and the caller waiting for it is woken up as soon as
+ *   it arrives (no polling). All methods are thread safe.
+ *   <br/>It is the transport of the paths without a registered prefix
+ *   (serial ports and pseudo-terminals).
+ * @nosubgrouping
+ */
+class SerialIo : public QObject, public Transport {
+    Q_OBJECT
+
+  public:
+    /**
+     * @brief Constructor.
+     * @param parent Pointer to parent object. Default is nullptr.
+     */
+    explicit SerialIo(QObject* parent = nullptr);
+    /** @brief Destructor. */
+    ~SerialIo() override;
+    /**
+     * @brief Opens a serial port.
+     * @param path Path of the serial port (system dependent).
+     * @return True if success, false otherwise.
+     */
+    bool open(const QString& path) override;
+    /** @brief Closes the serial port. */
+    void close() override;
+    /**
+     * @brief Returns if the serial port is opened.
+     * @return True if opened, false otherwise.
+     */
+    bool isOpen() const override;
+    /**
+     * @brief Returns the path of the serial port.
+     * @return Path of the serial port (system dependent).
+     */
+    QString portName() const override;
+    /**
+     * @brief Sends data via serial port (asynchronously, in order).
+     * @param data Data to send.
+     * @return Number of bytes queued, or -1 if the port is not opened.
+     */
+    qint64 write(const QByteArray& data) override;
+    /**
+     * @brief Discards the received data (and the serial port buffers).
+     * @return True if success, false otherwise.
+     */
+    bool clear() override;
+    /**
+     * @brief Receives data, waiting until it is available.
+     * @param data Pointer to QByteArray to receive data.
+     * @param size Size of data to receive, in bytes.
+     * @param msecs Timeout, in milliseconds.
+     * @return True if success, false if timeout (nothing is consumed).
+     */
+    bool read(QByteArray* data, int size, int msecs) override;
+
+  private:
+    /* @brief I/O thread. */
+    QThread thread_;
+    /* @brief Serial port object (lives in the I/O thread). */
+    QSerialPort* port_;
+    /* @brief Mutex of the received data. */
+    mutable QMutex mutex_;
+    /* @brief Signaled when data is received. */
+    QWaitCondition received_;
+    /* @brief Received data not consumed yet. */
+    QByteArray buffer_;
+    /* @brief Data read from the serial port (used in the I/O thread). */
+    QByteArray rx_;
+    /* @brief Data to send, not flushed to the serial port yet. */
+    QByteArray out_;
+    /* @brief Indicates if a flush of the data to send is queued. */
+    bool flushQueued_;
+    /* @brief Indicates if the serial port is opened. */
+    bool opened_;
+    /* @brief Path of the serial port. */
+    QString path_;
+    /* @brief Stores the received data (runs in the I/O thread). */
+    void onReadyRead_();
+    /* @brief Sends the queued data (runs in the I/O thread). */
+    void flush_();
+};
+
+#endif  // BACKEND_SERIALIO_HPP_
@@ -0,0 +1,122 @@
+// ---------------------------------------------------------------------------
+// USB EPROM/Flash Programmer
+//
+// Copyright (2024) Robson Martins
+//
+// This work is licensed under a Creative Commons Attribution-NonCommercial-
+// ShareAlike 4.0 International License.
+// ---------------------------------------------------------------------------
+/**
+ * @ingroup Software
+ * @file backend/stats.cpp
+ * @brief Implementation of the Communication Statistics Class.
+ *
+ * @author Robson Martins (https://www.robsonmartins.com)
+ */
+// ---------------------------------------------------------------------------
+
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+
+#include "backend/stats.hpp"
+#include "backend/opcodes.hpp"
+
+// ---------------------------------------------------------------------------
+
+/*
+ * @brief Writes the fields of the statistics as JSON.
+ * @param os Output stream.
+ * @param stats Statistics.
+ */
+static void writeJsonFields(std::ostringstream &os, const TOpCodeStats &stats) {
+    os << "\"calls\":" << stats.calls << ",\"retries\":" << stats.retries
+       << ",\"errors\":" << stats.errors << ",\"bytesOut\":" << stats.bytesOut
+       << ",\"bytesIn\":" << stats.bytesIn << ",\"totalUs\":" << stats.totalUs
+       << ",\"p50Us\":" << CommStats::percentile(stats, 50)
+       << ",\"p99Us\":" << CommStats::percentile(stats, 99);
+}
+
+// ---------------------------------------------------------------------------
+
+CommStats::CommStats() {
+    clear();
+}
+
+void CommStats::clear() {
+    memset(stats_, 0, sizeof(stats_));
+}
+
+void CommStats::add(uint8_t code, uint32_t bytesOut, uint32_t bytesIn,
+                    uint64_t us, uint32_t retries, bool error) {
+    TOpCodeStats &stats = stats_[code];
+    stats.calls++;
+    stats.retries += retries;
+    if (error) stats.errors++;
+    stats.bytesOut += bytesOut;
+    stats.bytesIn += bytesIn;
+    stats.totalUs += us;
+    size_t bucket = 0;
+    while (us && bucket < kStatsLatencyBuckets - 1) {
+        us >>= 1;
+        bucket++;
+    }
+    stats.histogram[bucket]++;
+}
+
+const TOpCodeStats &CommStats::get(uint8_t code) const {
+    return stats_[code];
+}
+
+TOpCodeStats CommStats::getTotal() const {
+    TOpCodeStats total;
+    memset(&total, 0, sizeof(total));
+    for (const TOpCodeStats &stats : stats_) {
+        total.calls += stats.calls;
+        total.retries += stats.retries;
+        total.errors += stats.errors;
+        total.bytesOut += stats.bytesOut;
+        total.bytesIn += stats.bytesIn;
+        total.totalUs += stats.totalUs;
+        for (size_t i = 0; i < kStatsLatencyBuckets; i++) {
+            total.histogram[i] += stats.histogram[i];
+        }
+    }
+    return total;
+}
+
+uint64_t CommStats::percentile(const TOpCodeStats &stats, unsigned percent) {
+    if (!stats.calls) return 0;
+    if (percent > 100) percent = 100;
+    // rank of the percentile (at least the first call)
+    uint64_t rank = (static_cast<uint64_t>(stats.calls) * percent + 99) / 100;
+    if (!rank) rank = 1;
+    uint64_t count = 0;
+    for (size_t i = 0; i < kStatsLatencyBuckets; i++) {
+        count += stats.histogram[i];
+        if (count >= rank) return (1ULL << i) - 1;
+    }
+    return (1ULL << (kStatsLatencyBuckets - 1)) - 1;
+}
+
+std::string CommStats::toJson() const {
+    std::ostringstream os;
+    os << "{";
+    writeJsonFields(os, getTotal());
+    os << ",\"opcodes\":[";
+    bool first = true;
+    for (size_t code = 0; code < 256; code++) {
+        const TOpCodeStats &stats = stats_[code];
+        if (!stats.calls) continue;
+        if (!first) os << ",";
+        first = false;
+        char hex[5];
+        snprintf(hex, sizeof(hex), "0x%02X", static_cast<unsigned>(code));
+        os << "{\"code\":\"" << hex << "\",\"name\":\""
+           << OpCode::getOpCode(static_cast<uint8_t>(code)).descr << "\",";
+        writeJsonFields(os, stats);
+        os << "}";
+    }
+    os << "]}";
+    return os.str();
+}
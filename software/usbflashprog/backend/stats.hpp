@@ -0,0 +1,113 @@
+// ---------------------------------------------------------------------------
+// USB EPROM/Flash Programmer
+//
+// Copyright (2024) Robson Martins
+//
+// This work is licensed under a Creative Commons Attribution-NonCommercial-
+// ShareAlike 4.0 International License.
+// ---------------------------------------------------------------------------
+/**
+ * @ingroup Software
+ * @file backend/stats.hpp
+ * @brief Header of the Communication Statistics Class.
+ *
+ * @author Robson Martins (https://www.robsonmartins.com)
+ */
+// ---------------------------------------------------------------------------
+
+#ifndef BACKEND_STATS_HPP_
+#define BACKEND_STATS_HPP_
+
+// ---------------------------------------------------------------------------
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// ---------------------------------------------------------------------------
+
+/**
+ * @ingroup Software
+ * @brief Number of buckets of the latency histogram. The bucket <tt>n</tt>
+ *   counts the latencies of <tt>n</tt> bits, in microseconds
+ *   (<tt>2<sup>n-1</sup></tt> to <tt>2<sup>n</sup> - 1</tt> us).
+ */
+constexpr size_t kStatsLatencyBuckets = 32;
+
+/**
+ * @ingroup Software
+ * @brief Statistics of an opcode.
+ */
+typedef struct TOpCodeStats {
+    /** @brief Number of calls. */
+    uint32_t calls;
+    /** @brief Number of retries (retransmissions). */
+    uint32_t retries;
+    /** @brief Number of failed calls. */
+    uint32_t errors;
+    /** @brief Bytes sent to the board. */
+    uint64_t bytesOut;
+    /** @brief Bytes received from the board. */
+    uint64_t bytesIn;
+    /** @brief Sum of latencies, in microseconds. */
+    uint64_t totalUs;
+    /** @brief Latency histogram (log2 of microseconds). */
+    uint32_t histogram[kStatsLatencyBuckets];
+} TOpCodeStats;
+
+/**
+ * @ingroup Software
+ * @brief Communication Statistics Class
+ * @details The purpose of this class is to record the calls of each opcode
+ *   (count, bytes, retries, errors and latency histogram). Recording a call
+ *   only updates counters of a fixed table, so it can be used in the data
+ *   path.
+ * @nosubgrouping
+ */
+class CommStats {
+  public:
+    /** @brief Constructor. */
+    CommStats();
+    /** @brief Clears all the statistics. */
+    void clear();
+    /**
+     * @brief Records a call.
+     * @param code Opcode.
+     * @param bytesOut Bytes sent to the board.
+     * @param bytesIn Bytes received from the board.
+     * @param us Latency, in microseconds.
+     * @param retries Number of retries. Default is zero.
+     * @param error True if the call failed. Default is false.
+     */
+    void add(uint8_t code, uint32_t bytesOut, uint32_t bytesIn, uint64_t us,
+             uint32_t retries = 0, bool error = false);
+    /**
+     * @brief Returns the statistics of an opcode.
+     * @param code Opcode.
+     * @return Statistics of the opcode.
+     */
+    const TOpCodeStats &get(uint8_t code) const;
+    /**
+     * @brief Returns the totals of all opcodes.
+     * @return Statistics of all opcodes (histogram included).
+     */
+    TOpCodeStats getTotal() const;
+    /**
+     * @brief Returns a percentile of the latency.
+     * @param stats Statistics of an opcode.
+     * @param percent Percentile (0 to 100).
+     * @return Upper bound of the bucket of the percentile, in microseconds.
+     */
+    static uint64_t percentile(const TOpCodeStats &stats, unsigned percent);
+    /**
+     * @brief Returns the statistics as a JSON object.
+     * @return JSON text, with the totals and the opcodes called.
+     */
+    std::string toJson() const;
+
+  private:
+    /* @brief Statistics of each opcode. */
+    TOpCodeStats stats_[256];
+};
+
+#endif  // BACKEND_STATS_HPP_
@@ -0,0 +1,157 @@
+// ---------------------------------------------------------------------------
+// USB EPROM/Flash Programmer
+//
+// Copyright (2024) Robson Martins
+//
+// This work is licensed under a Creative Commons Attribution-NonCommercial-
+// ShareAlike 4.0 International License.
+// ---------------------------------------------------------------------------
+/**
+ * @ingroup Software
+ * @file backend/trace.cpp
+ * @brief Implementation of the Communication Trace Classes.
+ *
+ * @author Robson Martins (https://www.robsonmartins.com)
+ */
+// ---------------------------------------------------------------------------
+
+#include <QMutexLocker>
+
+#include "backend/trace.hpp"
+
+// ---------------------------------------------------------------------------
+
+/* @brief Magic of the trace file. */
+static const char kTraceMagic[] = {'U', 'F', 'P', 'T'};
+/* @brief Version of the trace file format. */
+constexpr uint8_t kTraceVersion = 1;
+/* @brief Size of the pending events that triggers a flush, in bytes. */
+constexpr int kTraceFlushSize = 64 * 1024;
+
+// ---------------------------------------------------------------------------
+
+/**
+ * @brief Appends an unsigned LEB128 varint.
+ * @param[out] dest Destination.
+ * @param value Value to append.
+ */
+static void appendVarint(QByteArray &dest, uint64_t value) {
+    do {
+        uint8_t b = value & 0x7F;
+        value >>= 7;
+        if (value) b |= 0x80;
+        dest.append(static_cast<char>(b));
+    } while (value);
+}
+
+/**
+ * @brief Reads an unsigned LEB128 varint.
+ * @param src Source.
+ * @param[in,out] pos Position in the source.
+ * @param[out] value Value read.
+ * @return True if success, false if the source is truncated.
+ */
+static bool readVarint(const QByteArray &src, int &pos, uint64_t &value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (pos >= src.size()) return false;
+        uint8_t b = static_cast<uint8_t>(src[pos++]);
+        value |= static_cast<uint64_t>(b & 0x7F) << shift;
+        if (!(b & 0x80)) return true;
+    }
+    return false;
+}
+
+// ---------------------------------------------------------------------------
+
+TTraceEvent::TTraceEvent() : direction(kTraceWrite), timestamp(0) {}
+
+// ---------------------------------------------------------------------------
+
+TraceWriter::TraceWriter() : last_(0) {}
+
+TraceWriter::~TraceWriter() {
+    close();
+}
+
+bool TraceWriter::open(const QString &filename) {
+    QMutexLocker locker(&mutex_);
+    if (file_.isOpen()) {
+        flush_();
+        file_.close();
+    }
+    file_.setFileName(filename);
+    if (!file_.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+    pending_.clear();
+    pending_.append(kTraceMagic, sizeof(kTraceMagic));
+    pending_.append(static_cast<char>(kTraceVersion));
+    last_ = 0;
+    clock_.start();
+    return true;
+}
+
+void TraceWriter::close() {
+    QMutexLocker locker(&mutex_);
+    if (!file_.isOpen()) return;
+    flush_();
+    file_.close();
+}
+
+bool TraceWriter::isOpen() const {
+    QMutexLocker locker(&mutex_);
+    return file_.isOpen();
+}
+
+void TraceWriter::append(uint8_t direction, const QByteArray &data) {
+    QMutexLocker locker(&mutex_);
+    if (!file_.isOpen() || data.isEmpty()) return;
+    uint64_t now = clock_.nsecsElapsed() / 1000;
+    pending_.append(static_cast<char>(direction));
+    appendVarint(pending_, now - last_);
+    appendVarint(pending_, data.size());
+    pending_.append(data);
+    last_ = now;
+    if (pending_.size() >= kTraceFlushSize) flush_();
+}
+
+void TraceWriter::flush_() {
+    if (pending_.isEmpty()) return;
+    file_.write(pending_);
+    file_.flush();
+    pending_.clear();
+}
+
+// ---------------------------------------------------------------------------
+
+bool TraceReader::load(const QString &filename, TTraceEventList &events) {
+    events.clear();
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+    return decode(file.readAll(), events);
+}
+
+bool TraceReader::decode(const QByteArray &data, TTraceEventList &events) {
+    events.clear();
+    int pos = sizeof(kTraceMagic) + 1;
+    if (data.size() < pos ||
+        !data.startsWith(QByteArray(kTraceMagic, sizeof(kTraceMagic))) ||
+        static_cast<uint8_t>(data[pos - 1]) != kTraceVersion) {
+        return false;
+    }
+    uint64_t timestamp = 0, delta, length;
+    while (pos < data.size()) {
+        TTraceEvent event;
+        event.direction = static_cast<uint8_t>(data[pos++]);
+        if (event.direction > kTraceRead) return false;
+        if (!readVarint(data, pos, delta) || !readVarint(data, pos, length) ||
+            length > static_cast<uint64_t>(data.size() - pos)) {
+            return false;
+        }
+        timestamp += delta;
+        event.timestamp = timestamp;
+        event.data = data.mid(pos, static_cast<int>(length));
+        pos += static_cast<int>(length);
+        events.append(event);
+    }
+    return true;
+}
@@ -0,0 +1,151 @@
+// ---------------------------------------------------------------------------
+// USB EPROM/Flash Programmer
+//
+// Copyright (2024) Robson Martins
+//
+// This work is licensed under a Creative Commons Attribution-NonCommercial-
+// ShareAlike 4.0 International License.
+// ---------------------------------------------------------------------------
+/**
+ * @ingroup Software
+ * @file backend/trace.hpp
+ * @brief Header of the Communication Trace Classes.
+ *
+ * @author Robson Martins (https://www.robsonmartins.com)
+ */
+// ---------------------------------------------------------------------------
+
+#ifndef BACKEND_TRACE_HPP_
+#define BACKEND_TRACE_HPP_
+
+// ---------------------------------------------------------------------------
+
+#include <QString>
+#include <QByteArray>
+#include <QList>
+#include <QFile>
+#include <QMutex>
+#include <QElapsedTimer>
+
+#include <cstdint>
+
+// ---------------------------------------------------------------------------
+
+/**
+ * @ingroup Software
+ * @brief Prefix of the port path that replays a trace file
+ *   (ex.: "replay:/tmp/session.uft").
+ */
+constexpr const char *kTraceReplayPrefix = "replay:";
+
+/**
+ * @ingroup Software
+ * @brief Direction of a trace event.
+ */
+enum kTraceDirectionEnum {
+    /** @brief Data sent by the host. */
+    kTraceWrite = 0x00,
+    /** @brief Data received from the device. */
+    kTraceRead = 0x01,
+};
+
+/**
+ * @ingroup Software
+ * @brief Stores an event of a communication trace.
+ */
+typedef struct TTraceEvent {
+    /** @brief Direction (kTraceDirectionEnum). */
+    uint8_t direction;
+    /** @brief Time since the start of the trace, in microseconds. */
+    uint64_t timestamp;
+    /** @brief Data transferred. */
+    QByteArray data;
+    /** @brief Constructor. */
+    TTraceEvent();
+} TTraceEvent;
+
+/** @brief Type of a list of trace events. */
+typedef QList<TTraceEvent> TTraceEventList;
+
+// ---------------------------------------------------------------------------
+
+/**
+ * @ingroup Software
+ * @brief Communication Trace Writer Class
+ * @details The purpose of this class is to record the timestamped data sent
+ *   and received by the serial port to a compact binary file.
+ *   <br/>The file starts with the magic "UFPT" and the format version, and
+ *   each event is stored as the direction (1 byte), the time since the
+ *   previous event in microseconds and the data length (both as LEB128
+ *   varints), followed by the data. All methods are thread safe.
+ * @nosubgrouping
+ */
+class TraceWriter {
+  public:
+    /** @brief Constructor. */
+    TraceWriter();
+    /** @brief Destructor. */
+    ~TraceWriter();
+    /**
+     * @brief Creates the trace file, and starts the clock.
+     * @param filename Name of the file (overwritten if exists).
+     * @return True if success, false otherwise.
+     */
+    bool open(const QString &filename);
+    /** @brief Flushes and closes the trace file. */
+    void close();
+    /**
+     * @brief Returns if the trace file is opened.
+     * @return True if opened, false otherwise.
+     */
+    bool isOpen() const;
+    /**
+     * @brief Records an event, timestamped with the current time.
+     * @param direction Direction (kTraceDirectionEnum).
+     * @param data Data transferred.
+     */
+    void append(uint8_t direction, const QByteArray &data);
+
+  private:
+    /* @brief Mutex of the file. */
+    mutable QMutex mutex_;
+    /* @brief Trace file. */
+    QFile file_;
+    /* @brief Clock of the trace. */
+    QElapsedTimer clock_;
+    /* @brief Timestamp of the last event, in microseconds. */
+    uint64_t last_;
+    /* @brief Events not written to the file yet. */
+    QByteArray pending_;
+    /* @brief Writes the pending events to the file. */
+    void flush_();
+};
+
+// ---------------------------------------------------------------------------
+
+/**
+ * @ingroup Software
+ * @brief Communication Trace Reader Class
+ * @details The purpose of this class is to load a trace file recorded by
+ *   the TraceWriter class.
+ * @nosubgrouping
+ */
+class TraceReader {
+  public:
+    /**
+     * @brief Loads a trace file.
+     * @param filename Name of the file.
+     * @param[out] events List to receive the events.
+     * @return True if success, false if the file is missing or invalid.
+     */
+    static bool load(const QString &filename, TTraceEventList &events);
+    /**
+     * @brief Decodes the contents of a trace file.
+     * @param data Contents of the file.
+     * @param[out] events List to receive the events.
+     * @return True if success, false if the data is invalid.
+     */
+    static bool decode(const QByteArray &data, TTraceEventList &events);
+};
+
+#endif  // BACKEND_TRACE_HPP_
@@ -0,0 +1,169 @@
+// ---------------------------------------------------------------------------
+// USB EPROM/Flash Programmer
+//
+// Copyright (2024) Robson Martins
+//
+// This work is licensed under a Creative Commons Attribution-NonCommercial-
+// ShareAlike 4.0 International License.
+// ---------------------------------------------------------------------------
+/**
+ * @ingroup Software
+ * @file backend/transport/loopback.cpp
+ * @brief Implementation of the Loopback Transport Class.
+ *
+ * @author Robson Martins (https://www.robsonmartins.com)
+ */
+// ---------------------------------------------------------------------------
+
+#include <QMutexLocker>
+#include <QThread>
+
+#include "backend/transport/loopback.hpp"
+
+// ---------------------------------------------------------------------------
+
+LoopbackTransport::LoopbackTransport(TLoopbackHandler handler)
+    : handler_(handler),
+      opened_(false),
+      latencyUs_(0),
+      bandwidth_(0),
+      arrival_(0),
+      txFree_(0),
+      rxFree_(0) {
+    buffer_.reserve(kReceiveCapacity);
+    clock_.start();
+}
+
+bool LoopbackTransport::open(const QString &path) {
+    QMutexLocker locker(&mutex_);
+    buffer_.resize(0);
+    pending_.clear();
+    opened_ = static_cast<bool>(handler_);
+    path_ = opened_ ? path : QString();
+    return opened_;
+}
+
+void LoopbackTransport::close() {
+    QMutexLocker locker(&mutex_);
+    opened_ = false;
+    path_.clear();
+    buffer_.resize(0);
+    pending_.clear();
+}
+
+bool LoopbackTransport::isOpen() const {
+    QMutexLocker locker(&mutex_);
+    return opened_;
+}
+
+QString LoopbackTransport::portName() const {
+    QMutexLocker locker(&mutex_);
+    return path_;
+}
+
+qint64 LoopbackTransport::write(const QByteArray &data) {
+    if (!isOpen()) return -1;
+    record_(kTraceWrite, data);
+    qint64 sentAt = 0;
+    {
+        QMutexLocker locker(&mutex_);
+        if (shaped_()) {
+            qint64 now = clock_.nsecsElapsed() / 1000;
+            txFree_ = qMax(txFree_, now) + transferUs_(data.size());
+            arrival_ = txFree_ + latencyUs_;
+            sentAt = arrival_;
+        }
+    }
+    deliver_(handler_(data), sentAt);
+    return data.size();
+}
+
+bool LoopbackTransport::clear() {
+    QMutexLocker locker(&mutex_);
+    if (!opened_) return false;
+    // discards only what would have been received already
+    receive_();
+    buffer_.resize(0);
+    return true;
+}
+
+bool LoopbackTransport::read(QByteArray *data, int size, int msecs) {
+    if (data == nullptr) return false;
+    QElapsedTimer elapsed;
+    elapsed.start();
+    qint64 timeout = static_cast<qint64>(msecs) * 1000;
+    poll_(size);
+    QMutexLocker locker(&mutex_);
+    receive_();
+    while (buffer_.size() < size && elapsed.elapsed() < msecs) {
+        if (pending_.isEmpty()) {
+            received_.wait(&mutex_, msecs - elapsed.elapsed());
+        } else {
+            qint64 left =
+                qMin(timeout - elapsed.nsecsElapsed() / 1000,
+                     pending_.first().first - clock_.nsecsElapsed() / 1000);
+            locker.unlock();
+            if (left > 0) QThread::usleep(left);
+            locker.relock();
+        }
+        receive_();
+    }
+    if (buffer_.size() < size) {
+        data->resize(0);
+        return false;
+    }
+    take_(buffer_, data, size);
+    return true;
+}
+
+void LoopbackTransport::setLink(uint32_t latencyUs, uint32_t bandwidth) {
+    QMutexLocker locker(&mutex_);
+    latencyUs_ = latencyUs;
+    bandwidth_ = bandwidth;
+}
+
+void LoopbackTransport::deliver_(const QByteArray &data, qint64 sentAt) {
+    if (data.isEmpty()) return;
+    record_(kTraceRead, data);
+    QMutexLocker locker(&mutex_);
+    if (shaped_()) {
+        rxFree_ = qMax(rxFree_, sentAt) + transferUs_(data.size());
+        pending_.append(qMakePair(rxFree_ + latencyUs_, data));
+    } else {
+        buffer_.append(data);
+    }
+    received_.wakeAll();
+}
+
+void LoopbackTransport::poll_(int size) {
+    while (true) {
+        qint64 sentAt;
+        {
+            QMutexLocker locker(&mutex_);
+            int received = buffer_.size();
+            for (const auto &item : pending_) received += item.second.size();
+            if (!opened_ || received >= size) return;
+            // sent by the device as soon as possible (ex.: a stream)
+            sentAt = arrival_;
+        }
+        QByteArray data = handler_(QByteArray());
+        if (data.isEmpty()) return;
+        deliver_(data, sentAt);
+    }
+}
+
+void LoopbackTransport::receive_() {
+    qint64 now = clock_.nsecsElapsed() / 1000;
+    while (!pending_.isEmpty() && pending_.first().first <= now) {
+        buffer_.append(pending_.takeFirst().second);
+    }
+}
+
+qint64 LoopbackTransport::transferUs_(int size) const {
+    if (!bandwidth_) return 0;
+    return static_cast<qint64>(size) * 1000000 / bandwidth_;
+}
+
+bool LoopbackTransport::shaped_() const {
+    return latencyUs_ || bandwidth_;
+}
@@ -0,0 +1,148 @@
+// ---------------------------------------------------------------------------
+// USB EPROM/Flash Programmer
+//
+// Copyright (2024) Robson Martins
+//
+// This work is licensed under a Creative Commons Attribution-NonCommercial-
+// ShareAlike 4.0 International License.
+// ---------------------------------------------------------------------------
+/**
+ * @ingroup Software
+ * @file backend/transport/loopback.hpp
+ * @brief Header of the Loopback Transport Class.
+ *
+ * @author Robson Martins (https://www.robsonmartins.com)
+ */
+// ---------------------------------------------------------------------------
+
+#ifndef BACKEND_TRANSPORT_LOOPBACK_HPP_
+#define BACKEND_TRANSPORT_LOOPBACK_HPP_
+
+// ---------------------------------------------------------------------------
+
+#include <QString>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QList>
+#include <QMutex>
+#include <QPair>
+#include <QWaitCondition>
+
+#include <functional>
+
+#include "backend/transport/transport.hpp"
+
+// ---------------------------------------------------------------------------
+
+/**
+ * @ingroup Software
+ * @brief Prefix of the port path of the loopback transport
+ *   (registered by the user, see Transport::registerType()).
+ */
+constexpr const char *kLoopbackPrefix = "loopback:";
+
+/**
+ * @ingroup Software
+ * @brief Function that handles the data sent to an in-process device.
+ * @details Receives the data of each write (the stream may be split in
+ *   any way), and returns the data the device sends back (may be empty).
+ *   <br/>Empty data is a poll, made while the Runner waits for data: the
+ *   device returns the data it sends without a request (ex.: the next
+ *   chunk of a stream), if any.
+ */
+typedef std::function<QByteArray(const QByteArray &)> TLoopbackHandler;
+
+// ---------------------------------------------------------------------------
+
+/**
+ * @ingroup Software
+ * @brief Loopback Transport Class
+ * @details The purpose of this class is to connect the Runner to a device
+ *   model running in the same process, without any port.
+ *   <br/>Usage:
+ *   @code
+ *   Transport::registerType(kLoopbackPrefix, [] {
+ *       return new LoopbackTransport([](const QByteArray &data) {
+ *           return QByteArray(1, static_cast<char>(kCmdResponseOk));
+ *       });
+ *   });
+ *   runner.open("loopback:device");
+ *   @endcode
+ *   <br/>The link can be shaped (see setLink()), to emulate the latency
+ *   and the bandwidth of a real port.
+ * @nosubgrouping
+ */
+class LoopbackTransport : public Transport {
+  public:
+    /**
+     * @brief Constructor.
+     * @param handler Function that handles the data sent.
+     */
+    explicit LoopbackTransport(TLoopbackHandler handler);
+    /** @copydoc Transport::open(const QString&) */
+    bool open(const QString &path) override;
+    /** @copydoc Transport::close() */
+    void close() override;
+    /** @copydoc Transport::isOpen() */
+    bool isOpen() const override;
+    /** @copydoc Transport::portName() */
+    QString portName() const override;
+    /** @copydoc Transport::write(const QByteArray&) */
+    qint64 write(const QByteArray &data) override;
+    /** @copydoc Transport::clear() */
+    bool clear() override;
+    /** @copydoc Transport::read(QByteArray*, int, int) */
+    bool read(QByteArray *data, int size, int msecs) override;
+    /**
+     * @brief Shapes the link. Each transfer (in each direction) takes
+     *   the latency plus its size divided by the bandwidth, and the
+     *   transfers of the same direction do not overlap.
+     * @param latencyUs Latency of each transfer, in microseconds.
+     * @param bandwidth Bandwidth, in bytes per second (zero if
+     *   unlimited).
+     */
+    void setLink(uint32_t latencyUs, uint32_t bandwidth);
+
+  protected:
+    /* @brief Appends the data sent back by the device, received at the
+     *   given time (in us, see clock_), if the link is shaped. */
+    void deliver_(const QByteArray &data, qint64 sentAt);
+    /* @brief Polls the device while the received data is smaller than
+     *   the given size. */
+    void poll_(int size);
+    /* @brief Moves the data already received (pending) to the buffer. */
+    void receive_();
+    /* @brief Returns the time to transfer the given size, in us. */
+    qint64 transferUs_(int size) const;
+    /* @brief Indicates if the link is shaped. */
+    bool shaped_() const;
+    /* @brief Function that handles the data sent. */
+    TLoopbackHandler handler_;
+    /* @brief Mutex of the received data. */
+    mutable QMutex mutex_;
+    /* @brief Signaled when data is received. */
+    QWaitCondition received_;
+    /* @brief Received data not consumed yet. */
+    QByteArray buffer_;
+    /* @brief Indicates if the transport is opened. */
+    bool opened_;
+    /* @brief Path of the port. */
+    QString path_;
+    /* @brief Latency of each transfer, in us. */
+    uint32_t latencyUs_;
+    /* @brief Bandwidth, in bytes per second (zero if unlimited). */
+    uint32_t bandwidth_;
+    /* @brief Clock of the shaped link. */
+    QElapsedTimer clock_;
+    /* @brief Time (in us) the device received the last data. */
+    qint64 arrival_;
+    /* @brief Time (in us) the link to the device becomes free. */
+    qint64 txFree_;
+    /* @brief Time (in us) the link from the device becomes free. */
+    qint64 rxFree_;
+    /* @brief Data in transit from the device (time it is received, in
+     *   us, and data). */
+    QList<QPair<qint64, QByteArray>> pending_;
+};
+
+#endif  // BACKEND_TRANSPORT_LOOPBACK_HPP_
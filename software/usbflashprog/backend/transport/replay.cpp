@@ -0,0 +1,141 @@
+// ---------------------------------------------------------------------------
+// USB EPROM/Flash Programmer
+//
+// Copyright (2024) Robson Martins
+//
+// This work is licensed under a Creative Commons Attribution-NonCommercial-
+// ShareAlike 4.0 International License.
+// ---------------------------------------------------------------------------
+/**
+ * @ingroup Software
+ * @file backend/transport/replay.cpp
+ * @brief Implementation of the Trace Replay Transport Class.
+ *
+ * @author Robson Martins (https://www.robsonmartins.com)
+ */
+// ---------------------------------------------------------------------------
+
+#include <QMutexLocker>
+#include <QThread>
+
+#include <cstring>
+
+#include "backend/transport/replay.hpp"
+
+// ---------------------------------------------------------------------------
+
+ReplayTransport::ReplayTransport() : opened_(false), pos_(0), mismatches_(0) {
+    buffer_.reserve(kReceiveCapacity);
+}
+
+bool ReplayTransport::open(const QString &path) {
+    QMutexLocker locker(&mutex_);
+    opened_ = false;
+    buffer_.resize(0);
+    pending_.clear();
+    if (path != path_ || pos_ >= events_.size()) {
+        path_.clear();
+        pos_ = 0;
+        mismatches_ = 0;
+        if (!TraceReader::load(path.mid(strlen(kTraceReplayPrefix)),
+                               events_)) {
+            events_.clear();
+            return false;
+        }
+        path_ = path;
+    }
+    clock_.start();
+    opened_ = true;
+    // data received before the first write (relative to the start)
+    if (pos_ == 0) schedule_(0);
+    return true;
+}
+
+void ReplayTransport::close() {
+    QMutexLocker locker(&mutex_);
+    opened_ = false;
+    buffer_.resize(0);
+    pending_.clear();
+}
+
+bool ReplayTransport::isOpen() const {
+    QMutexLocker locker(&mutex_);
+    return opened_;
+}
+
+QString ReplayTransport::portName() const {
+    QMutexLocker locker(&mutex_);
+    return opened_ ? path_ : QString();
+}
+
+qint64 ReplayTransport::write(const QByteArray &data) {
+    QMutexLocker locker(&mutex_);
+    if (!opened_) return -1;
+    if (pos_ >= events_.size()) {
+        mismatches_++;
+        return data.size();
+    }
+    const TTraceEvent &event = events_[pos_++];
+    if (event.data != data) mismatches_++;
+    schedule_(event.timestamp);
+    return data.size();
+}
+
+bool ReplayTransport::clear() {
+    QMutexLocker locker(&mutex_);
+    if (!opened_) return false;
+    // discards only what would have been received already
+    receive_();
+    buffer_.resize(0);
+    return true;
+}
+
+bool ReplayTransport::read(QByteArray *data, int size, int msecs) {
+    if (data == nullptr) return false;
+    QElapsedTimer elapsed;
+    elapsed.start();
+    qint64 timeout = static_cast<qint64>(msecs) * 1000;
+    QMutexLocker locker(&mutex_);
+    receive_();
+    while (buffer_.size() < size) {
+        qint64 left = timeout - elapsed.nsecsElapsed() / 1000;
+        if (left <= 0) break;
+        if (!pending_.isEmpty()) {
+            left = qMin(left,
+                        pending_.first().first - clock_.nsecsElapsed() / 1000);
+        }
+        locker.unlock();
+        if (left > 0) QThread::usleep(left);
+        locker.relock();
+        receive_();
+    }
+    if (buffer_.size() < size) {
+        data->resize(0);
+        return false;
+    }
+    take_(buffer_, data, size);
+    return true;
+}
+
+int ReplayTransport::getMismatches() const {
+    QMutexLocker locker(&mutex_);
+    return mismatches_;
+}
+
+void ReplayTransport::schedule_(uint64_t base) {
+    qint64 now = clock_.nsecsElapsed() / 1000;
+    qint64 last = pending_.isEmpty() ? 0 : pending_.last().first;
+    while (pos_ < events_.size() && events_[pos_].direction == kTraceRead) {
+        const TTraceEvent &event = events_[pos_++];
+        // keeps the order, if the previous data is still pending
+        last = qMax(last, now + static_cast<qint64>(event.timestamp - base));
+        pending_.append(qMakePair(last, event.data));
+    }
+}
+
+void ReplayTransport::receive_() {
+    qint64 now = clock_.nsecsElapsed() / 1000;
+    while (!pending_.isEmpty() && pending_.first().first <= now) {
+        buffer_.append(pending_.takeFirst().second);
+    }
+}
@@ -0,0 +1,102 @@
+// ---------------------------------------------------------------------------
+// USB EPROM/Flash Programmer
+//
+// Copyright (2024) Robson Martins
+//
+// This work is licensed under a Creative Commons Attribution-NonCommercial-
+// ShareAlike 4.0 International License.
+// ---------------------------------------------------------------------------
+/**
+ * @ingroup Software
+ * @file backend/transport/replay.hpp
+ * @brief Header of the Trace Replay Transport Class.
+ *
+ * @author Robson Martins (https://www.robsonmartins.com)
+ */
+// ---------------------------------------------------------------------------
+
+#ifndef BACKEND_TRANSPORT_REPLAY_HPP_
+#define BACKEND_TRANSPORT_REPLAY_HPP_
+
+// ---------------------------------------------------------------------------
+
+#include <QString>
+#include <QByteArray>
+#include <QMutex>
+#include <QElapsedTimer>
+#include <QPair>
+#include <QList>
+
+#include "backend/transport/transport.hpp"
+#include "backend/trace.hpp"
+
+// ---------------------------------------------------------------------------
+
+/**
+ * @ingroup Software
+ * @brief Trace Replay Transport Class
+ * @details The purpose of this class is to feed a trace recorded by the
+ *   TraceWriter class back through the Runner: the data received after
+ *   each recorded write is delivered with the recorded latency.
+ *   <br/>The path is kTraceReplayPrefix followed by the name of the trace
+ *   file (ex.: "replay:/tmp/session.uft").
+ * @nosubgrouping
+ */
+class ReplayTransport : public Transport {
+  public:
+    /** @brief Constructor. */
+    ReplayTransport();
+    /**
+     * @brief Opens a trace to replay.
+     * @details Reopening the same trace continues from the current position
+     *   (so the sessions of an operation that reopens the port are replayed
+     *   in order), and restarts it after the end.
+     * @param path Path of the trace (with prefix).
+     * @return True if success, false otherwise.
+     */
+    bool open(const QString &path) override;
+    /** @copydoc Transport::close() */
+    void close() override;
+    /** @copydoc Transport::isOpen() */
+    bool isOpen() const override;
+    /** @copydoc Transport::portName() */
+    QString portName() const override;
+    /** @copydoc Transport::write(const QByteArray&) */
+    qint64 write(const QByteArray &data) override;
+    /** @copydoc Transport::clear() */
+    bool clear() override;
+    /** @copydoc Transport::read(QByteArray*, int, int) */
+    bool read(QByteArray *data, int size, int msecs) override;
+    /**
+     * @brief Returns the number of writes that did not match the trace
+     *   (since it was loaded).
+     * @return Number of mismatches.
+     */
+    int getMismatches() const;
+
+  private:
+    /* @brief Mutex of the replay state. */
+    mutable QMutex mutex_;
+    /* @brief Indicates if the transport is opened. */
+    bool opened_;
+    /* @brief Path (with prefix) of the loaded trace. */
+    QString path_;
+    /* @brief Events of the loaded trace. */
+    TTraceEventList events_;
+    /* @brief Position of the next event to replay. */
+    int pos_;
+    /* @brief Clock of the replay. */
+    QElapsedTimer clock_;
+    /* @brief Data to receive, and the time it is due (microseconds). */
+    QList<QPair<qint64, QByteArray>> pending_;
+    /* @brief Received data not consumed yet. */
+    QByteArray buffer_;
+    /* @brief Number of writes that did not match the trace. */
+    int mismatches_;
+    /* @brief Schedules the reads that follow a write (mutex locked). */
+    void schedule_(uint64_t base);
+    /* @brief Moves the due data to the buffer (mutex locked). */
+    void receive_();
+};
+
+#endif  // BACKEND_TRANSPORT_REPLAY_HPP_
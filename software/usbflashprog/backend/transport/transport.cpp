@@ -0,0 +1,97 @@
+// ---------------------------------------------------------------------------
+// USB EPROM/Flash Programmer
+//
+// Copyright (2024) Robson Martins
+//
+// This work is licensed under a Creative Commons Attribution-NonCommercial-
+// ShareAlike 4.0 International License.
+// ---------------------------------------------------------------------------
+/**
+ * @ingroup Software
+ * @file backend/transport/transport.cpp
+ * @brief Implementation of the Transport Base Class.
+ *
+ * @author Robson Martins (https://www.robsonmartins.com)
+ */
+// ---------------------------------------------------------------------------
+
+#include <QMap>
+#include <QMutexLocker>
+
+#include <cstring>
+
+#include "backend/transport/transport.hpp"
+#include "backend/transport/replay.hpp"
+#include "backend/serialio.hpp"
+
+// ---------------------------------------------------------------------------
+
+/* @brief Mutex of the registered transport types. */
+static QMutex registryMutex;
+
+/**
+ * @brief Returns the registered transport types.
+ * @return Reference to the map of prefix to factory.
+ */
+static QMap<QString, TTransportFactory> &registry() {
+    static QMap<QString, TTransportFactory> types;
+    return types;
+}
+
+// ---------------------------------------------------------------------------
+
+Transport::~Transport() {}
+
+void Transport::setTrace(std::shared_ptr<TraceWriter> trace) {
+    QMutexLocker locker(&traceMutex_);
+    trace_ = trace;
+}
+
+void Transport::record_(uint8_t direction, const QByteArray &data) {
+    std::shared_ptr<TraceWriter> trace;
+    {
+        QMutexLocker locker(&traceMutex_);
+        trace = trace_;
+    }
+    if (trace) trace->append(direction, data);
+}
+
+void Transport::take_(QByteArray &buffer, QByteArray *data, int size) {
+    data->resize(size);
+    memcpy(data->data(), buffer.constData(), size);
+    // the remaining data is moved (the memory is kept, as reserved)
+    buffer.remove(0, size);
+}
+
+void Transport::registerType(const QString &prefix,
+                             TTransportFactory factory) {
+    QMutexLocker locker(&registryMutex);
+    registry()[prefix] = factory;
+}
+
+void Transport::unregisterType(const QString &prefix) {
+    QMutexLocker locker(&registryMutex);
+    registry().remove(prefix);
+}
+
+QString Transport::typeOf(const QString &path) {
+    if (path.startsWith(kTraceReplayPrefix)) return kTraceReplayPrefix;
+    QMutexLocker locker(&registryMutex);
+    for (auto it = registry().cbegin(); it != registry().cend(); ++it) {
+        if (path.startsWith(it.key())) return it.key();
+    }
+    return QString();
+}
+
+Transport *Transport::create(const QString &path) {
+    QString type = typeOf(path);
+    if (type.isEmpty()) return new SerialIo();
+    if (type == kTraceReplayPrefix) return new ReplayTransport();
+    TTransportFactory factory;
+    {
+        QMutexLocker locker(&registryMutex);
+        factory = registry().value(type);
+    }
+    Transport *result = factory ? factory() : nullptr;
+    return result ? result : new SerialIo();
+}
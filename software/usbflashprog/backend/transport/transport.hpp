@@ -0,0 +1,146 @@
+// ---------------------------------------------------------------------------
+// USB EPROM/Flash Programmer
+//
+// Copyright (2024) Robson Martins
+//
+// This work is licensed under a Creative Commons Attribution-NonCommercial-
+// ShareAlike 4.0 International License.
+// ---------------------------------------------------------------------------
+/**
+ * @ingroup Software
+ * @file backend/transport/transport.hpp
+ * @brief Header of the Transport Base Class.
+ *
+ * @author Robson Martins (https://www.robsonmartins.com)
+ */
+// ---------------------------------------------------------------------------
+
+#ifndef BACKEND_TRANSPORT_TRANSPORT_HPP_
+#define BACKEND_TRANSPORT_TRANSPORT_HPP_
+
+// ---------------------------------------------------------------------------
+
+#include <QString>
+#include <QByteArray>
+#include <QMutex>
+
+#include <functional>
+#include <memory>
+
+#include "backend/trace.hpp"
+
+// ---------------------------------------------------------------------------
+
+class Transport;
+
+/**
+ * @ingroup Software
+ * @brief Function that creates a new transport.
+ */
+typedef std::function<Transport *()> TTransportFactory;
+
+// ---------------------------------------------------------------------------
+
+/**
+ * @ingroup Software
+ * @brief Transport Base Class
+ * @details The purpose of this class is to provide the byte stream the
+ *   Runner uses to talk to the programmer, so that the same code runs
+ *   against a serial port (or pseudo-terminal), an in-process loopback or
+ *   a recorded trace.
+ *   <br/>The transport is selected by the prefix of the port path (see
+ *   create()). A path without a registered prefix is a serial port.
+ *   <br/>The implementations must be thread safe.
+ * @nosubgrouping
+ */
+class Transport {
+  public:
+    /** @brief Destructor. */
+    virtual ~Transport();
+    /**
+     * @brief Opens the transport.
+     * @param path Path of the port (including the prefix, if any).
+     * @return True if success, false otherwise.
+     */
+    virtual bool open(const QString &path) = 0;
+    /** @brief Closes the transport. */
+    virtual void close() = 0;
+    /**
+     * @brief Returns if the transport is opened.
+     * @return True if opened, false otherwise.
+     */
+    virtual bool isOpen() const = 0;
+    /**
+     * @brief Returns the path of the port.
+     * @return Path of the port, or empty if not opened.
+     */
+    virtual QString portName() const = 0;
+    /**
+     * @brief Sends data (asynchronously, in order).
+     * @param data Data to send.
+     * @return Number of bytes queued, or -1 if not opened.
+     */
+    virtual qint64 write(const QByteArray &data) = 0;
+    /**
+     * @brief Discards the received data not consumed yet.
+     * @details The data sent before (even if still queued) is not
+     *   discarded.
+     * @return True if success, false otherwise.
+     */
+    virtual bool clear() = 0;
+    /**
+     * @brief Receives data, waiting until it is available.
+     * @param data Pointer to QByteArray to receive data.
+     * @param size Size of data to receive, in bytes.
+     * @param msecs Timeout, in milliseconds.
+     * @return True if success, false if timeout (nothing is consumed).
+     */
+    virtual bool read(QByteArray *data, int size, int msecs) = 0;
+    /**
+     * @brief Sets the recorder of the traffic.
+     * @param trace Pointer to the trace recorder (nullptr to disable).
+     */
+    void setTrace(std::shared_ptr<TraceWriter> trace);
+    /**
+     * @brief Registers a transport type.
+     * @param prefix Prefix of the port path (ex.: "loopback:").
+     * @param factory Function that creates a new transport of the type.
+     */
+    static void registerType(const QString &prefix, TTransportFactory factory);
+    /**
+     * @brief Unregisters a transport type.
+     * @param prefix Prefix of the port path.
+     */
+    static void unregisterType(const QString &prefix);
+    /**
+     * @brief Returns the transport type of a port path.
+     * @param path Path of the port.
+     * @return Registered prefix of the path, or empty if it is a serial
+     *   port.
+     */
+    static QString typeOf(const QString &path);
+    /**
+     * @brief Creates a new transport, according to the port path.
+     * @details The kTraceReplayPrefix ("replay:") type is built in.
+     * @param path Path of the port.
+     * @return Pointer to the new transport (owned by the caller).
+     */
+    static Transport *create(const QString &path);
+
+  protected:
+    /* @brief Initial capacity of the received data, in bytes. */
+    static constexpr int kReceiveCapacity = 16384;
+    /* @brief Records an event, if recording. */
+    void record_(uint8_t direction, const QByteArray &data);
+    /* @brief Moves the first bytes of the received data to the caller,
+     *   reusing the memory of both. */
+    static void take_(QByteArray &buffer, QByteArray *data, int size);
+
+  private:
+    /* @brief Mutex of the trace recorder. */
+    mutable QMutex traceMutex_;
+    /* @brief Trace recorder. */
+    std::shared_ptr<TraceWriter> trace_;
+};
+
+#endif  // BACKEND_TRANSPORT_TRANSPORT_HPP_
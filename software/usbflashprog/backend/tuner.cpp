@@ -0,0 +1,129 @@
+// ---------------------------------------------------------------------------
+// USB EPROM/Flash Programmer
+//
+// Copyright (2024) Robson Martins
+//
+// This work is licensed under a Creative Commons Attribution-NonCommercial-
+// ShareAlike 4.0 International License.
+// ---------------------------------------------------------------------------
+/**
+ * @ingroup Software
+ * @file backend/tuner.cpp
+ * @brief Implementation of the Buffer Size Tuner Class.
+ *
+ * @author Robson Martins (https://www.robsonmartins.com)
+ */
+// ---------------------------------------------------------------------------
+
+#include "backend/tuner.hpp"
+
+// ---------------------------------------------------------------------------
+
+/* @brief Minimum candidate size, in bytes. */
+constexpr uint16_t kTunerMinSize = 16;
+/* @brief Errors to give up a candidate. */
+constexpr uint32_t kTunerMaxErrors = 2;
+/* @brief Score penalty for each error (1.0 = halves the throughput). */
+constexpr double kTunerErrorPenalty = 1.0;
+
+// ---------------------------------------------------------------------------
+
+BufferTuner::BufferTuner() : index_(0), sampleSize_(0), best_(0) {}
+
+void BufferTuner::start(uint16_t initial, uint16_t maxSize,
+                        uint32_t sampleSize, uint32_t total) {
+    candidates_.clear();
+    index_ = 0;
+    sampleSize_ = sampleSize ? sampleSize : 1;
+    best_ = initial;
+    if (!initial || !maxSize) return;
+    // initial first, then larger sizes, then a smaller one
+    addCandidate_(initial, maxSize, 0);
+    addCandidate_(initial * 2UL, maxSize, total);
+    addCandidate_(initial * 4UL, maxSize, total);
+    addCandidate_(initial / 2UL, maxSize, total);
+    if (candidates_.size() < 2) candidates_.clear();
+}
+
+void BufferTuner::stop() {
+    if (!isTuning()) return;
+    selectBest_();
+    candidates_.clear();
+}
+
+void BufferTuner::skip() {
+    if (!isTuning()) return;
+    next_();
+}
+
+bool BufferTuner::isTuning() const {
+    return index_ < candidates_.size();
+}
+
+uint16_t BufferTuner::getSize() const {
+    return isTuning() ? candidates_[index_].size : best_;
+}
+
+uint16_t BufferTuner::getMaxSize() const {
+    uint16_t result = best_;
+    for (const TCandidate &c : candidates_) {
+        if (c.size > result) result = c.size;
+    }
+    return result;
+}
+
+void BufferTuner::addSample(uint16_t size, uint32_t bytes, uint64_t us,
+                            bool error) {
+    if (!isTuning()) return;
+    for (TCandidate &c : candidates_) {
+        if (c.size != size) continue;
+        c.bytes += bytes;
+        c.us += us;
+        if (error) c.errors++;
+    }
+    const TCandidate &current = candidates_[index_];
+    if (current.bytes < sampleSize_ && current.errors < kTunerMaxErrors) {
+        return;
+    }
+    next_();
+}
+
+void BufferTuner::addCandidate_(uint32_t size, uint16_t maxSize,
+                                uint32_t total) {
+    if (size < kTunerMinSize && !candidates_.empty()) return;
+    if (size > maxSize) return;
+    // the last block would be padded (past the end of the operation)
+    if (total && (total % size)) return;
+    for (const TCandidate &c : candidates_) {
+        if (c.size == size) return;
+    }
+    TCandidate c;
+    c.size = static_cast<uint16_t>(size);
+    c.bytes = 0;
+    c.us = 0;
+    c.errors = 0;
+    candidates_.push_back(c);
+}
+
+void BufferTuner::next_() {
+    index_++;
+    if (!isTuning()) selectBest_();
+}
+
+void BufferTuner::selectBest_() {
+    double bestScore = -1.0;
+    for (const TCandidate &c : candidates_) {
+        if (!c.bytes) continue;
+        double score = score_(c);
+        if (score > bestScore) {
+            bestScore = score;
+            best_ = c.size;
+        }
+    }
+}
+
+double BufferTuner::score_(const TCandidate &candidate) {
+    double us = candidate.us ? static_cast<double>(candidate.us) : 1.0;
+    double rate = candidate.bytes * 1000000.0 / us;
+    return rate / (1.0 + kTunerErrorPenalty * candidate.errors);
+}
@@ -0,0 +1,129 @@
+// ---------------------------------------------------------------------------
+// USB EPROM/Flash Programmer
+//
+// Copyright (2024) Robson Martins
+//
+// This work is licensed under a Creative Commons Attribution-NonCommercial-
+// ShareAlike 4.0 International License.
+// ---------------------------------------------------------------------------
+/**
+ * @ingroup Software
+ * @file backend/tuner.hpp
+ * @brief Header of the Buffer Size Tuner Class.
+ *
+ * @author Robson Martins (https://www.robsonmartins.com)
+ */
+// ---------------------------------------------------------------------------
+
+#ifndef BACKEND_TUNER_HPP_
+#define BACKEND_TUNER_HPP_
+
+// ---------------------------------------------------------------------------
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+
+/**
+ * @ingroup Software
+ * @brief Buffer Size Tuner Class
+ * @details The purpose of this class is to choose the buffer (block) size
+ *  that gives the best throughput on the current link.
+ *
+ *  The tuner tries a few power of two sizes around the initial one. Each
+ *  candidate is used for a sample of the operation, and the caller reports
+ *  the bytes transferred, the elapsed time and any errors. After the last
+ *  candidate, the size with the best score (bytes/s, penalized by errors)
+ *  is kept for the rest of the operation.
+ * @nosubgrouping
+ */
+class BufferTuner {
+  public:
+    /** @brief Constructor. */
+    BufferTuner();
+    /**
+     * @brief Starts the tuning.
+     * @param initial Initial buffer size, in bytes (power of two).
+     * @param maxSize Maximum buffer size, in bytes.
+     * @param sampleSize Amount of data to measure each candidate, in bytes.
+     * @param total Length of the operation, in bytes (the candidates that
+     *  do not divide it are skipped), or zero if any size fits.
+     */
+    void start(uint16_t initial, uint16_t maxSize, uint32_t sampleSize,
+               uint32_t total = 0);
+    /** @brief Stops the tuning, keeping the best size found so far. */
+    void stop();
+    /**
+     * @brief Skips the current candidate (it cannot be used), moving to
+     *  the next one.
+     */
+    void skip();
+    /**
+     * @brief Returns if the tuning is running.
+     * @return True if is tuning, false otherwise.
+     */
+    bool isTuning() const;
+    /**
+     * @brief Returns the buffer size to use.
+     * @return The current candidate while tuning, the best size after,
+     *  or zero if not started.
+     */
+    uint16_t getSize() const;
+    /**
+     * @brief Returns the largest candidate size.
+     * @return Largest candidate size, in bytes, or zero if not started.
+     */
+    uint16_t getMaxSize() const;
+    /**
+     * @brief Adds a measurement.
+     * @param size Buffer size used, in bytes.
+     * @param bytes Amount of data transferred, in bytes.
+     * @param us Elapsed time, in microseconds.
+     * @param error True if the transfer failed.
+     */
+    void addSample(uint16_t size, uint32_t bytes, uint64_t us, bool error);
+
+  private:
+    /* @brief Measurements of one candidate. */
+    typedef struct TCandidate {
+        /* @brief Buffer size, in bytes. */
+        uint16_t size;
+        /* @brief Amount of data transferred, in bytes. */
+        uint64_t bytes;
+        /* @brief Elapsed time, in microseconds. */
+        uint64_t us;
+        /* @brief Number of errors. */
+        uint32_t errors;
+    } TCandidate;
+    /* @brief Candidates. */
+    std::vector<TCandidate> candidates_;
+    /* @brief Index of the current candidate. */
+    size_t index_;
+    /* @brief Amount of data to measure each candidate, in bytes. */
+    uint32_t sampleSize_;
+    /* @brief Best size found, in bytes. */
+    uint16_t best_;
+
+  private:
+    /*
+     * @brief Adds a candidate size (if valid and not present yet).
+     * @param size Buffer size, in bytes.
+     * @param maxSize Maximum buffer size, in bytes.
+     * @param total Length of the operation, in bytes (zero if any).
+     */
+    void addCandidate_(uint32_t size, uint16_t maxSize, uint32_t total);
+    /* @brief Moves to the next candidate (selects the best after last). */
+    void next_();
+    /* @brief Selects the best candidate measured. */
+    void selectBest_();
+    /*
+     * @brief Calculates the score of a candidate.
+     * @param candidate The candidate.
+     * @return Score (higher is better).
+     */
+    static double score_(const TCandidate &candidate);
+};
+
+#endif  // BACKEND_TUNER_HPP_
@@ -0,0 +1,360 @@
+// ---------------------------------------------------------------------------
+// USB EPROM/Flash Programmer
+//
+// Copyright (2024) Robson Martins
+//
+// This work is licensed under a Creative Commons Attribution-NonCommercial-
+// ShareAlike 4.0 International License.
+// ---------------------------------------------------------------------------
+/**
+ * @ingroup Software
+ * @file cli/main.cpp
+ * @brief Implementation of the headless Command Line front end.
+ *
+ * @author Robson Martins (https://www.robsonmartins.com)
+ */
+// ---------------------------------------------------------------------------
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QCommandLineOption>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLoggingCategory>
+#include <QTextStream>
+
+#include <memory>
+
+#include "config.hpp"
+#include "backend/runner.hpp"
+#include "backend/epromfile/qepromfile.hpp"
+#include "backend/devices/parallel/dummy.hpp"
+#include "backend/devices/parallel/sram.hpp"
+#include "backend/devices/parallel/eprom.hpp"
+#include "backend/devices/parallel/eeprom.hpp"
+#include "backend/devices/parallel/flash28f.hpp"
+
+// ---------------------------------------------------------------------------
+
+/* @brief Exit code: operation succeeded. */
+constexpr int kExitSuccess = 0;
+/* @brief Exit code: operation failed on the device. */
+constexpr int kExitFailed = 1;
+/* @brief Exit code: invalid command line. */
+constexpr int kExitUsage = 2;
+/* @brief Exit code: programmer port not found. */
+constexpr int kExitPort = 3;
+/* @brief Exit code: error reading or writing the file. */
+constexpr int kExitFile = 4;
+
+/* @brief Chip family names accepted by the --chip option. */
+static const char *kChipFamilies[] = {
+    "sram", "27",   "27C",   "27C16",  "27E",   "28C",
+    "AT28C", "28F", "SST28SF", "Am28F", "i28F", "LH28F",
+    "i28F16", "dummy", "dummy16"};
+
+/* @brief Operation names accepted by the --operation option. */
+static const char *kOperations[] = {"read",   "program",     "verify",
+                                    "erase",  "blank-check", "get-id",
+                                    "unprotect", "protect"};
+
+// ---------------------------------------------------------------------------
+
+/**
+ * @brief Main routine.
+ * @param argc Number of arguments.
+ * @param argv Array of arguments.
+ * @return Exit code (zero if success).
+ */
+int main(int argc, char *argv[]);
+
+/**
+ * @brief Creates the device object of a chip family.
+ * @param family Chip family name (see kChipFamilies).
+ * @return Pointer to the new Device, or nullptr if the family is unknown.
+ */
+Device *createDevice(const QString &family);
+
+/**
+ * @brief Runs one operation on the device.
+ * @param device Pointer to the device.
+ * @param operation Operation name (see kOperations).
+ * @param filename Image file (read, program and verify).
+ * @param verify If true, verify after program or check after erase.
+ * @param[out] result JSON object to receive the operation details.
+ * @return Exit code (zero if success).
+ */
+int runOperation(Device *device, const QString &operation,
+                 const QString &filename, bool verify, QJsonObject &result);
+
+/**
+ * @brief Prints one line of JSON to stdout.
+ * @param result JSON object to print.
+ */
+void printResult(const QJsonObject &result);
+
+// ---------------------------------------------------------------------------
+
+Device *createDevice(const QString &family) {
+    if (family == "sram") return new SRAM();
+    if (family == "27") return new EPROM27();
+    if (family == "27C") return new EPROM27C();
+    if (family == "27C16") return new EPROM27C16Bit();
+    if (family == "27E") return new EPROM27E();
+    if (family == "28C") return new EEPROM28C();
+    if (family == "AT28C") return new EEPROM28AT();
+    if (family == "28F") return new Flash28F();
+    if (family == "SST28SF") return new FlashSST28SF();
+    if (family == "Am28F") return new FlashAm28F();
+    if (family == "i28F") return new FlashI28F();
+    if (family == "LH28F") return new FlashSharpI28F();
+    if (family == "i28F16") return new FlashI28F16Bit();
+    if (family == "dummy") return new Dummy();
+    if (family == "dummy16") return new Dummy16Bit();
+    return nullptr;
+}
+
+int runOperation(Device *device, const QString &operation,
+                 const QString &filename, bool verify, QJsonObject &result) {
+    const TDeviceCapabilities &cap = device->getInfo().capability;
+    QEpromFile file;
+    QByteArray buffer;
+    bool supported = true, success = false;
+
+    if (operation == "program" || operation == "verify") {
+        if (filename.isEmpty() || !QFileInfo::exists(filename)) {
+            result["error"] = "file not found";
+            return kExitFile;
+        }
+        buffer = file.read(filename, device->getSize());
+        if (buffer.isEmpty()) {
+            result["error"] = "error reading file";
+            return kExitFile;
+        }
+    } else if (operation == "read" && filename.isEmpty()) {
+        result["error"] = "missing --file";
+        return kExitUsage;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    if (operation == "read") {
+        supported = cap.hasRead;
+        if (supported) success = device->read(buffer);
+    } else if (operation == "program") {
+        supported = cap.hasProgram;
+        if (supported) success = device->program(buffer, verify);
+        if (supported && cap.hasDiffProg && device->getDiffProg()) {
+            result["dirty"] = static_cast<qint64>(device->getDirtyCount());
+        }
+    } else if (operation == "verify") {
+        supported = cap.hasVerify;
+        if (supported) success = device->verify(buffer);
+        if (supported && !device->getMismatches().isEmpty()) {
+            QJsonArray mismatches;
+            for (uint32_t address : device->getMismatches()) {
+                mismatches.append(static_cast<qint64>(address));
+            }
+            result["mismatches"] = mismatches;
+        }
+    } else if (operation == "erase") {
+        supported = cap.hasErase;
+        if (supported) success = device->erase(verify);
+    } else if (operation == "blank-check") {
+        supported = cap.hasBlankCheck;
+        if (supported) success = device->blankCheck();
+    } else if (operation == "get-id") {
+        TDeviceID id;
+        supported = cap.hasGetId;
+        if (supported) success = device->getId(id);
+        if (success) {
+            result["manufacturer"] = id.manufacturer;
+            result["device"] = id.device;
+            result["manufacturerName"] = id.getManufacturerName();
+        }
+    } else if (operation == "unprotect") {
+        supported = cap.hasUnprotect;
+        if (supported) success = device->unprotect();
+    } else if (operation == "protect") {
+        supported = cap.hasProtect;
+        if (supported) success = device->protect();
+    }
+    result["elapsedMs"] = timer.elapsed();
+
+    if (!supported) {
+        result["error"] = "operation not supported by chip";
+        return kExitUsage;
+    }
+    if (!success) {
+        result["error"] = "operation failed";
+        return kExitFailed;
+    }
+    if (operation == "read") {
+        QEpromFile::QEpromFileType type = QEpromFile::typeFromStr(
+            "." + QFileInfo(filename).suffix());
+        if (!file.write(type, filename, buffer)) {
+            result["error"] = "error writing file";
+            return kExitFile;
+        }
+    }
+    return kExitSuccess;
+}
+
+void printResult(const QJsonObject &result) {
+    QTextStream out(stdout);
+    out << QJsonDocument(result).toJson(QJsonDocument::Compact) << "\n";
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setOrganizationName(kOrganizationName);
+    QCoreApplication::setOrganizationDomain(kOrganizationDomain);
+    QCoreApplication::setApplicationName(kApplicationName);
+
+    QStringList chips, operations;
+    for (const char *item : kChipFamilies) chips << item;
+    for (const char *item : kOperations) operations << item;
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+        QString(kApplicationFullName) + " - command line");
+    parser.addHelpOption();
+    QCommandLineOption portOption(
+        {"p", "port"},
+        "Programmer serial port (default: first), or replay:<trace file>.",
+        "port");
+    QCommandLineOption chipOption({"c", "chip"},
+                                  "Chip family: " + chips.join(", ") + ".",
+                                  "family");
+    QCommandLineOption sizeOption({"s", "size"},
+                                  "Chip size in bytes (accepts 0x prefix).",
+                                  "bytes");
+    QCommandLineOption operationOption(
+        {"o", "operation"}, "Operation: " + operations.join(", ") + ".",
+        "name");
+    QCommandLineOption fileOption({"f", "file"},
+                                  "Image file (bin, hex, srec or atmel).",
+                                  "file");
+    QCommandLineOption verifyOption(
+        "verify", "Verify after program, or blank check after erase.");
+    QCommandLineOption vddRdOption("vdd-rd", "VDD to read (V).", "volts");
+    QCommandLineOption vddWrOption("vdd-wr", "VDD to program (V).", "volts");
+    QCommandLineOption vppOption("vpp", "VPP to program (V).", "volts");
+    QCommandLineOption veeOption("vee", "VEE to erase (V).", "volts");
+    QCommandLineOption twpOption("twp", "Program pulse (us).", "us");
+    QCommandLineOption twcOption("twc", "Program cycle (us).", "us");
+    QCommandLineOption skipFFOption("skip-ff", "Skip programming 0xFF.");
+    QCommandLineOption fastOption("fast", "Fast program/erase.");
+    QCommandLineOption diffOption("diff", "Program differences only.");
+    QCommandLineOption sectorOption("sector-size", "Sector size (bytes).",
+                                    "bytes");
+    QCommandLineOption bufferOption("buffer-size", "USB buffer size (bytes).",
+                                    "bytes");
+    QCommandLineOption traceOption(
+        "trace", "Record the serial traffic to a trace file.", "file");
+    QCommandLineOption listPortsOption("list-ports",
+                                       "List the attached programmers.");
+    QCommandLineOption listChipsOption("list-chips",
+                                       "List the chip families.");
+    QCommandLineOption verboseOption("verbose", "Log to stderr.");
+    parser.addOptions({portOption, chipOption, sizeOption, operationOption,
+                       fileOption, verifyOption, vddRdOption, vddWrOption,
+                       vppOption, veeOption, twpOption, twcOption,
+                       skipFFOption, fastOption, diffOption, sectorOption,
+                       bufferOption, traceOption, listPortsOption,
+                       listChipsOption, verboseOption});
+    parser.process(app);
+
+    if (!parser.isSet(verboseOption)) {
+        QLoggingCategory::setFilterRules("*=false");
+    }
+
+    Runner runner;
+    QJsonObject result;
+    if (parser.isSet(listPortsOption)) {
+        QStringList ports;
+        for (const auto &item : runner.list()) ports << item.portName();
+        result["ports"] = QJsonArray::fromStringList(ports);
+        printResult(result);
+        return kExitSuccess;
+    }
+    if (parser.isSet(listChipsOption)) {
+        result["chips"] = QJsonArray::fromStringList(chips);
+        printResult(result);
+        return kExitSuccess;
+    }
+
+    QString family = parser.value(chipOption);
+    QString operation = parser.value(operationOption);
+    QString port = parser.value(portOption);
+    bool ok = true;
+    uint32_t size = parser.value(sizeOption).toUInt(&ok, 0);
+
+    result["operation"] = operation;
+    result["chip"] = family;
+    result["success"] = false;
+
+    std::unique_ptr<Device> device(createDevice(family));
+    if (!device || !operations.contains(operation) ||
+        (parser.isSet(sizeOption) && (!ok || !size))) {
+        result["error"] = "invalid arguments (see --help)";
+        printResult(result);
+        return kExitUsage;
+    }
+    if (port.isEmpty()) {
+        TSerialPortList list = runner.list();
+        if (!list.isEmpty()) port = list.first().portName();
+    }
+    result["port"] = port;
+    if (port.isEmpty()) {
+        result["error"] = "programmer not found";
+        printResult(result);
+        return kExitPort;
+    }
+
+    device->setPort(port);
+    if (parser.isSet(sizeOption)) device->setSize(size);
+    if (parser.isSet(bufferOption)) {
+        device->setBufferSize(parser.value(bufferOption).toUInt());
+    }
+    if (parser.isSet(vddRdOption)) {
+        device->setVddRd(parser.value(vddRdOption).toFloat());
+    }
+    if (parser.isSet(vddWrOption)) {
+        device->setVddWr(parser.value(vddWrOption).toFloat());
+    }
+    if (parser.isSet(vppOption)) {
+        device->setVpp(parser.value(vppOption).toFloat());
+    }
+    if (parser.isSet(veeOption)) {
+        device->setVee(parser.value(veeOption).toFloat());
+    }
+    if (parser.isSet(twpOption)) {
+        device->setTwp(parser.value(twpOption).toUInt());
+    }
+    if (parser.isSet(twcOption)) {
+        device->setTwc(parser.value(twcOption).toUInt());
+    }
+    if (parser.isSet(sectorOption)) {
+        device->setSectorSize(parser.value(sectorOption).toUInt());
+    }
+    if (parser.isSet(traceOption) &&
+        !device->setTraceFile(parser.value(traceOption))) {
+        result["error"] = "error creating trace file";
+        printResult(result);
+        return kExitFile;
+    }
+    device->setSkipFF(parser.isSet(skipFFOption));
+    device->setFastProg(parser.isSet(fastOption));
+    device->setDiffProg(parser.isSet(diffOption));
+    result["size"] = static_cast<qint64>(device->getSize());
+
+    int code = runOperation(device.get(), operation, parser.value(fileOption),
+                            parser.isSet(verifyOption), result);
+    result["success"] = (code == kExitSuccess);
+    printResult(result);
+    return code;
+}
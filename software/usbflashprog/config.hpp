@@ -74,6 +74,9 @@ constexpr int kUsbRefreshInterval = 500;
 
 /** @brief GENERAL : Log filename. */
 constexpr const char *kLogFileName = "ufprog.log";
+/** @brief GENERAL : Communication statistics report filename (one JSON
+ *    object per line, appended after each operation). */
+constexpr const char *kStatsFileName = "ufprog_stats.jsonl";
 
 // ---------------------------------------------------------------------------
 
@@ -87,6 +90,8 @@ constexpr const char *kSettingGeneralWindowSize = "WindowSize";
 constexpr const char *kSettingGeneralLanguage = "Language";
 /** @brief SETTING : General / Last Directory. */
 constexpr const char *kSettingGeneralLastDir = "LastDir";
+/** @brief SETTING : General / Communication Statistics Report. */
+constexpr const char *kSettingGeneralStatsReport = "StatsReport";
 
 /** @brief SETTING : Programmer / Selected Device. */
 constexpr const char *kSettingProgDevice = "Prog/Device";
@@ -108,10 +113,16 @@ constexpr const char *kSettingProgVee = "Prog/VEE";
 constexpr const char *kSettingProgSkipFF = "Prog/SkipFF";
 /** @brief SETTING : Programmer / Fast Prog/Erase. */
 constexpr const char *kSettingProgFast = "Prog/FastProg";
+/** @brief SETTING : Programmer / Program Differences. */
+constexpr const char *kSettingProgDiff = "Prog/DiffProg";
 /** @brief SETTING : Programmer / Sector Size. */
 constexpr const char *kSettingProgSectorSize = "Prog/SectorSize";
 /** @brief SETTING : Programmer / Buffer Size. */
 constexpr const char *kSettingProgBufferSize = "Prog/BufferSize";
+/** @brief SETTING : Programmer / Buffer Size Auto-Tune. */
+constexpr const char *kSettingProgBufferAuto = "Prog/BufferAutoTune";
+/** @brief SETTING : Programmer / Tuned Buffer Size (group, one per port). */
+constexpr const char *kSettingProgBufferTuned = "Prog/BufferTuned";
 
 // ---------------------------------------------------------------------------
 /**
@@ -139,10 +150,14 @@ typedef struct TProgrammerSettings {
     bool skipFF;
     /** @brief Fast Prog/Erase. */
     bool fastProg;
+    /** @brief Program Differences. */
+    bool diffProg;
     /** @brief Sector Size in bytes (0 is byte prog). */
     uint16_t sectorSize;
     /** @brief Buffer Size in bytes. */
     uint16_t bufferSize;
+    /** @brief Buffer Size Auto-Tune (best size stored per port). */
+    bool bufferAuto;
 } TProgrammerSettings;
 
 /**
@@ -170,6 +185,9 @@ typedef struct TApplicationSettings {
     QString language;
     /** @brief The last opened directory. */
     QString lastDir;
+    /** @brief Saves a communication statistics report after each
+     *    operation. */
+    bool statsReport;
     /** @brief Programmer settings. */
     TProgrammerSettings prog;
 } TApplicationSettings;
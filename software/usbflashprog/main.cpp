@@ -80,6 +80,8 @@ TApplicationSettings loadSettings() {
     result.language = settings.value(kSettingGeneralLanguage).toString();
     result.windowPos = settings.value(kSettingGeneralWindowPos).toPoint();
     result.windowSize = settings.value(kSettingGeneralWindowSize).toSize();
+    result.statsReport =
+        settings.value(kSettingGeneralStatsReport).toString().toInt() != 0;
     return result;
 }
 
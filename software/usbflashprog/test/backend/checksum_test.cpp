@@ -0,0 +1,54 @@
+// ---------------------------------------------------------------------------
+// USB EPROM/Flash Programmer
+//
+// Copyright (2024) Robson Martins
+//
+// This work is licensed under a Creative Commons Attribution-NonCommercial-
+// ShareAlike 4.0 International License.
+// ---------------------------------------------------------------------------
+/**
+ * @ingroup UnitTests
+ * @file test/backend/checksum_test.cpp
+ * @brief Implementation of Unit Test for Checksum Helper Class.
+ *
+ * @author Robson Martins (https://www.robsonmartins.com)
+ */
+// ---------------------------------------------------------------------------
+
+#include "checksum_test.hpp"
+#include "../../backend/checksum.hpp"
+
+#include <cstring>
+
+// ---------------------------------------------------------------------------
+
+TEST_F(ChecksumTest, crc16) {
+    const char *data = "123456789";
+    uint8_t buf[256];
+    memset(buf, 0xFF, sizeof(buf));
+
+    EXPECT_EQ(Checksum::crc16(nullptr, 0), 0xFFFF);
+    EXPECT_EQ(Checksum::crc16(data, 0), 0xFFFF);
+    EXPECT_EQ(Checksum::crc16(data, 9), 0x29B1);
+    EXPECT_EQ(Checksum::crc16(data + 4, 5, Checksum::crc16(data, 4)), 0x29B1);
+    EXPECT_NE(Checksum::crc16(buf, sizeof(buf)), 0xFFFF);
+    buf[10] = 0xFE;
+    EXPECT_NE(Checksum::crc16(buf, sizeof(buf)),
+              Checksum::crc16(buf, sizeof(buf) - 1));
+}
+
+TEST_F(ChecksumTest, crc32) {
+    const char *data = "123456789";
+    uint8_t buf[256];
+    memset(buf, 0xFF, sizeof(buf));
+
+    EXPECT_EQ(Checksum::crc32(nullptr, 0), 0x00000000);
+    EXPECT_EQ(Checksum::crc32(data, 0), 0x00000000);
+    EXPECT_EQ(Checksum::crc32(data, 9), 0xCBF43926);
+    EXPECT_EQ(Checksum::crc32(data + 4, 5, Checksum::crc32(data, 4)),
+              0xCBF43926);
+    EXPECT_NE(Checksum::crc32(buf, sizeof(buf)), 0x00000000);
+    buf[10] = 0xFE;
+    EXPECT_NE(Checksum::crc32(buf, sizeof(buf)),
+              Checksum::crc32(buf, sizeof(buf) - 1));
+}
@@ -19,6 +19,7 @@
 #include <QObject>
 #include <QString>
 #include <cmath>
+#include <cstring>
 
 #include "chip_test.hpp"
 
@@ -33,12 +34,18 @@
 #include "../../backend/devices/parallel/eprom.hpp"
 #include "../../backend/devices/parallel/eeprom.hpp"
 #include "../../backend/devices/parallel/flash28f.hpp"
+#include "../../backend/checksum.hpp"
+#include "../../backend/runner.hpp"
+#include "../../backend/transport/loopback.hpp"
 
 // ---------------------------------------------------------------------------
 
 /* GTest macro to print to console */
 #define GTEST_COUT std::cerr << "[          ] ChipTest current: "
 
+/* Port of the emulated programmer (see ChipTest::SetUp). */
+static const QString kEmulatorPort = QString(kLoopbackPrefix) + "emulator";
+
 // ---------------------------------------------------------------------------
 // private functions
 
@@ -51,6 +58,14 @@ void runChipTests(BaseChip *emuChip, Device *device, uint32_t size);
 
 // ---------------------------------------------------------------------------
 
+void ChipTest::SetUp() {
+    Transport::registerType(kLoopbackPrefix, Emulator::createTransport);
+}
+
+void ChipTest::TearDown() {
+    Transport::unregisterType(kLoopbackPrefix);
+}
+
 TEST_F(ChipTest, device_id) {
     TDeviceID deviceId;
     for (int i = 0; i <= 0xFF; i++) {
@@ -104,6 +119,36 @@ TEST_F(ChipTest, eprom27C_test) {
     delete device;
 }
 
+TEST_F(ChipTest, eprom27C_sparse_test) {
+    ChipEPROM *emuChip = new ChipEPROM();
+    Emulator::setChip(emuChip);
+    EPROM27C *device = new EPROM27C();
+    uint32_t size = 0x008000;  // 32KB
+    device->setPort(kEmulatorPort);
+    emuChip->setSize(size);
+    device->setSize(size);
+    device->setBufferSize(64);
+    device->setTwp(1);
+    device->setTwc(1);
+
+    // partially filled image: only the blocks with data are written
+    QByteArray buffer(size, static_cast<char>(0xFF)), data;
+    Emulator::randomizeBuffer(data, 0x100);
+    memcpy(buffer.data(), data.constData(), data.size());
+    memcpy(buffer.data() + 0x4010, data.constData(), data.size());
+    buffer[size - 1] = 0x55;
+    GTEST_COUT << "Device: " << device->getInfo().name.toStdString()
+               << " Size: " << size << " (sparse)" << std::endl;
+    GTEST_COUT << "Program and Verify" << std::endl;
+    EXPECT_EQ(device->program(buffer, true), true);
+    GTEST_COUT << "Read" << std::endl;
+    QByteArray rdBuffer;
+    EXPECT_EQ(device->read(rdBuffer), true);
+    EXPECT_EQ(rdBuffer == buffer, true);
+    delete emuChip;
+    delete device;
+}
+
 TEST_F(ChipTest, eprom27C16Bit_test) {
     ChipEPROM *emuChip = new ChipEPROM();
     Emulator::setChip(emuChip);
@@ -138,6 +183,103 @@ TEST_F(ChipTest, eeprom28C_test) {
     delete device;
 }
 
+TEST_F(ChipTest, eeprom28C_diff_test) {
+    ChipEEPROM *emuChip = new ChipEEPROM();
+    Emulator::setChip(emuChip);
+    EEPROM28C *device = new EEPROM28C();
+    uint32_t size = 0x008000;  // 32KB
+    device->setPort(kEmulatorPort);
+    emuChip->setSize(size);
+    device->setSize(size);
+    device->setBufferSize(64);
+    device->setTwp(1);
+    device->setTwc(1);
+
+    QByteArray buffer;
+    Emulator::randomizeBuffer(buffer, size);
+    GTEST_COUT << "Device: " << device->getInfo().name.toStdString()
+               << " Size: " << size << " (differences)" << std::endl;
+    GTEST_COUT << "Program" << std::endl;
+    EXPECT_EQ(device->program(buffer), true);
+
+    // change a few scattered bytes and program only the differences
+    buffer[0x0000] = ~buffer[0x0000];
+    buffer[0x1234] = ~buffer[0x1234];
+    buffer[size - 1] = ~buffer[size - 1];
+    device->setDiffProg(true);
+    GTEST_COUT << "Program Differences and Verify" << std::endl;
+    EXPECT_EQ(device->program(buffer, true), true);
+    GTEST_COUT << "Read" << std::endl;
+    QByteArray rdBuffer;
+    EXPECT_EQ(device->read(rdBuffer), true);
+    EXPECT_EQ(rdBuffer == buffer, true);
+    delete emuChip;
+    delete device;
+}
+
+TEST_F(ChipTest, eeprom28C_mismatches_test) {
+    ChipEEPROM *emuChip = new ChipEEPROM();
+    Emulator::setChip(emuChip);
+    EEPROM28C *device = new EEPROM28C();
+    uint32_t size = 0x010000;  // 64KB
+    device->setPort(kEmulatorPort);
+    emuChip->setSize(size);
+    device->setSize(size);
+    device->setBufferSize(64);
+    device->setTwp(1);
+    device->setTwc(1);
+
+    QByteArray buffer;
+    Emulator::randomizeBuffer(buffer, size);
+    GTEST_COUT << "Device: " << device->getInfo().name.toStdString()
+               << " Size: " << size << " (mismatches)" << std::endl;
+    GTEST_COUT << "Program and Verify" << std::endl;
+    EXPECT_EQ(device->program(buffer, true), true);
+    EXPECT_EQ(device->getMismatches().isEmpty(), true);
+
+    // all the mismatched addresses are reported, across the ranges
+    buffer[0x0041] = ~buffer[0x0041];
+    buffer[0x0042] = ~buffer[0x0042];
+    buffer[0x9000] = ~buffer[0x9000];
+    buffer[size - 1] = ~buffer[size - 1];
+    GTEST_COUT << "Verify" << std::endl;
+    EXPECT_EQ(device->verify(buffer), false);
+    QVector<uint32_t> expected = {0x0041, 0x0042, 0x9000, size - 1};
+    EXPECT_EQ(device->getMismatches() == expected, true);
+    delete emuChip;
+    delete device;
+}
+
+TEST_F(ChipTest, eeprom28C_autotune_test) {
+    ChipEEPROM *emuChip = new ChipEEPROM();
+    Emulator::setChip(emuChip);
+    EEPROM28C *device = new EEPROM28C();
+    uint32_t size = 0x008000;  // 32KB
+    device->setPort(kEmulatorPort);
+    emuChip->setSize(size);
+    device->setSize(size);
+    device->setBufferSize(64);
+    device->setAutoTune(true);
+    device->setTwp(1);
+    device->setTwc(1);
+
+    QByteArray buffer;
+    Emulator::randomizeBuffer(buffer, size);
+    GTEST_COUT << "Device: " << device->getInfo().name.toStdString()
+               << " Size: " << size << " (auto-tune)" << std::endl;
+    GTEST_COUT << "Program and Verify" << std::endl;
+    EXPECT_EQ(device->program(buffer, true), true);
+    GTEST_COUT << "Buffer Size: " << device->getBufferSize() << std::endl;
+    EXPECT_GE(device->getBufferSize(), 32);
+    EXPECT_LE(device->getBufferSize(), 256);
+    GTEST_COUT << "Read" << std::endl;
+    QByteArray rdBuffer;
+    EXPECT_EQ(device->read(rdBuffer), true);
+    EXPECT_EQ(rdBuffer == buffer, true);
+    delete emuChip;
+    delete device;
+}
+
 TEST_F(ChipTest, eeprom28AT_test) {
     ChipEEPROM *emuChip = new ChipEEPROM();
     Emulator::setChip(emuChip);
@@ -215,11 +357,62 @@ TEST_F(ChipTest, flashI28F16Bit_test) {
     delete device;
 }
 
+TEST_F(ChipTest, runner_streams_test) {
+    ChipSRAM *emuChip = new ChipSRAM();
+    Emulator::setChip(emuChip);
+    uint32_t size = 0x002000;  // 8KB
+    emuChip->setSize(size);
+    QByteArray buffer, data;
+    Emulator::randomizeBuffer(buffer, size);
+    // runs of equal bytes (encoded by RLE)
+    buffer.replace(0x0100, 0x0400, QByteArray(0x0400, 0x00));
+    uint32_t crc = Checksum::crc32(buffer.constData(), buffer.size());
+    Runner::TDeviceFlags flags = {};
+    for (int mode = 0; mode < 4; mode++) {
+        Runner runner;
+        bool framing = (mode & 1), compression = (mode & 2);
+        GTEST_COUT << "Runner Streams" << (framing ? " (framed)" : "")
+                   << (compression ? " (RLE)" : "") << std::endl;
+        EXPECT_EQ(runner.open(kEmulatorPort), true);
+        runner.setFraming(framing);
+        runner.setCompression(compression);
+        runner.setBufferSize(64);
+        EXPECT_EQ(runner.deviceSetup(kCmdDeviceAlgorithmSRAM, flags, 5.0f,
+                                     0.0f, 1, 1, kCmdDeviceOperationProg,
+                                     kCmdDeviceSetupKeepVpp),
+                  true);
+        // write range
+        EXPECT_EQ(runner.deviceWriteRangeBegin(0, size, 256), true);
+        for (uint32_t i = 0; i < size; i += 256) {
+            EXPECT_EQ(runner.deviceWriteRangeNext(buffer.mid(i, 256)), true);
+        }
+        EXPECT_EQ(runner.deviceWriteRangeEnd(), true);
+        // read range, canceled in the middle of the stream
+        EXPECT_EQ(runner.deviceReadRangeBegin(0, size), true);
+        EXPECT_EQ(runner.deviceReadRangeNext(), buffer.left(256));
+        EXPECT_EQ(runner.deviceReadRangeEnd(), true);
+        // read range
+        data.clear();
+        EXPECT_EQ(runner.deviceReadRangeBegin(0, size), true);
+        while (runner.deviceReadRangeNext(data)) {
+        }
+        EXPECT_EQ(data == buffer, true);
+        // tagged blocks
+        EXPECT_EQ(runner.addrClr(), true);
+        EXPECT_EQ(runner.deviceVerifyBlocks(buffer.left(0x0400)), true);
+        uint32_t value = 0;
+        EXPECT_EQ(runner.deviceCrc32Range(0, size, value), true);
+        EXPECT_EQ(value, crc);
+        runner.close();
+    }
+    delete emuChip;
+}
+
 // ---------------------------------------------------------------------------
 
 void runChipTests(BaseChip *emuChip, Device *device, uint32_t size) {
     QByteArray buffer;
-    device->setPort("COM1");
+    device->setPort(kEmulatorPort);
     emuChip->setSize(size);
     device->setSize(size);
     device->setBufferSize(64);
@@ -230,7 +423,7 @@ void runChipTests(BaseChip *emuChip, Device *device, uint32_t size) {
     GTEST_COUT << "Device: " << info.name.toStdString() << " Size: " << size
                << std::endl;
 
-    EXPECT_EQ(device->getPort().toStdString(), "COM1");
+    EXPECT_EQ(device->getPort(), kEmulatorPort);
     EXPECT_EQ(device->getSize(), size);
     device->setTwp(1);
     EXPECT_EQ(device->getTwp(), 1);
@@ -34,10 +34,14 @@ class ChipTest : public testing::Test {
     ChipTest() {}
     /** @brief Destructor. */
     ~ChipTest() override {}
-    /** @brief Sets Up the test. */
-    void SetUp() override {}
+    /**
+     * @brief Sets Up the test.
+     * @details The devices run the real Runner, over a loopback transport
+     *   to the emulated programmer.
+     */
+    void SetUp() override;
     /** @brief Teardown of the test. */
-    void TearDown() override {}
+    void TearDown() override;
 };
 
 #endif  // TEST_BACKEND_CHIP_TEST_HPP_
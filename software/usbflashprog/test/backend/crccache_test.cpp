@@ -0,0 +1,72 @@
+// ---------------------------------------------------------------------------
+// USB EPROM/Flash Programmer
+//
+// Copyright (2024) Robson Martins
+//
+// This work is licensed under a Creative Commons Attribution-NonCommercial-
+// ShareAlike 4.0 International License.
+// ---------------------------------------------------------------------------
+/**
+ * @ingroup UnitTests
+ * @file test/backend/crccache_test.cpp
+ * @brief Implementation of Unit Test for CRC Cache Class.
+ *
+ * @author Robson Martins (https://www.robsonmartins.com)
+ */
+// ---------------------------------------------------------------------------
+
+#include <thread>
+#include <vector>
+
+#include "crccache_test.hpp"
+#include "../../backend/crccache.hpp"
+#include "../../backend/checksum.hpp"
+
+// ---------------------------------------------------------------------------
+
+TEST_F(CrcCacheTest, crc32) {
+    std::vector<uint8_t> image(1024);
+    for (size_t i = 0; i < image.size(); i++) image[i] = i * 7;
+    CrcCache cache;
+    EXPECT_EQ(cache.size(), 0);
+    EXPECT_EQ(cache.crc32(image.data(), 0, 1024),
+              Checksum::crc32(image.data(), 1024));
+    EXPECT_EQ(cache.crc32(image.data(), 256, 256),
+              Checksum::crc32(image.data() + 256, 256));
+    EXPECT_EQ(cache.size(), 2);
+    EXPECT_EQ(cache.getHits(), 0);
+    // same ranges: found in the cache
+    EXPECT_EQ(cache.crc32(image.data(), 0, 1024),
+              Checksum::crc32(image.data(), 1024));
+    EXPECT_EQ(cache.crc32(image.data(), 256, 256),
+              Checksum::crc32(image.data() + 256, 256));
+    EXPECT_EQ(cache.size(), 2);
+    EXPECT_EQ(cache.getHits(), 2);
+    // same offset, other length
+    EXPECT_EQ(cache.crc32(image.data(), 256, 128),
+              Checksum::crc32(image.data() + 256, 128));
+    EXPECT_EQ(cache.size(), 3);
+    cache.clear();
+    EXPECT_EQ(cache.size(), 0);
+    EXPECT_EQ(cache.getHits(), 0);
+}
+
+TEST_F(CrcCacheTest, threads) {
+    std::vector<uint8_t> image(4096, 0x55);
+    uint32_t expected = Checksum::crc32(image.data(), 1024);
+    CrcCache cache;
+    std::vector<std::thread> threads;
+    std::vector<uint32_t> results(4, 0);
+    for (size_t i = 0; i < results.size(); i++) {
+        threads.emplace_back([&cache, &image, &results, i]() {
+            for (uint32_t offset = 0; offset < 4096; offset += 1024) {
+                results[i] ^= cache.crc32(image.data(), offset, 1024);
+            }
+        });
+    }
+    for (auto &thread : threads) thread.join();
+    for (uint32_t result : results) {
+        EXPECT_EQ(result, expected ^ expected ^ expected ^ expected);
+    }
+    EXPECT_EQ(cache.size(), 4);
+}
@@ -0,0 +1,43 @@
+// ---------------------------------------------------------------------------
+// USB EPROM/Flash Programmer
+//
+// Copyright (2024) Robson Martins
+//
+// This work is licensed under a Creative Commons Attribution-NonCommercial-
+// ShareAlike 4.0 International License.
+// ---------------------------------------------------------------------------
+/**
+ * @ingroup UnitTests
+ * @file test/backend/crccache_test.hpp
+ * @brief Header of Unit Test for CRC Cache Class.
+ *
+ * @author Robson Martins (https://www.robsonmartins.com)
+ */
+// ---------------------------------------------------------------------------
+
+#ifndef TEST_BACKEND_CRCCACHE_TEST_HPP_
+#define TEST_BACKEND_CRCCACHE_TEST_HPP_
+
+#include <gtest/gtest.h>
+
+// ---------------------------------------------------------------------------
+
+/**
+ * @ingroup UnitTests
+ * @brief Test class for CRC Cache Class.
+ * @details The purpose of this class is to test the CRC Cache Class.
+ * @nosubgrouping
+ */
+class CrcCacheTest : public testing::Test {
+  protected:
+    /** @brief Constructor. */
+    CrcCacheTest() {}
+    /** @brief Destructor. */
+    ~CrcCacheTest() override {}
+    /** @brief Sets Up the test. */
+    void SetUp() override {}
+    /** @brief Teardown of the test. */
+    void TearDown() override {}
+};
+
+#endif  // TEST_BACKEND_CRCCACHE_TEST_HPP_
@@ -48,11 +48,72 @@ TEST_F(OpCodeTest, get_opcode) {
     buf[0] = kCmdVppCtrl;
     op = OpCode::getOpCode(kCmdVppCtrl);
     EXPECT_EQ(OpCode::getOpCode(buf, sizeof(buf)), op);
+    buf[0] = kCmdProtoTag;
+    op = OpCode::getOpCode(kCmdProtoTag);
+    EXPECT_EQ(OpCode::getOpCode(buf, sizeof(buf)), op);
+    EXPECT_EQ(op.params, 1);
+    EXPECT_EQ(op.result, 0);
+    buf[0] = kCmdDeviceReadRange;
+    op = OpCode::getOpCode(kCmdDeviceReadRange);
+    EXPECT_EQ(OpCode::getOpCode(buf, sizeof(buf)), op);
+    EXPECT_EQ(op.params, 6);
+    EXPECT_EQ(op.result, 0);
+    buf[0] = kCmdDeviceWriteRange;
+    op = OpCode::getOpCode(kCmdDeviceWriteRange);
+    EXPECT_EQ(OpCode::getOpCode(buf, sizeof(buf)), op);
+    EXPECT_EQ(op.params, 9);
+    EXPECT_EQ(op.result, 1);
+    buf[0] = kCmdDeviceReadW;
+    op = OpCode::getOpCode(kCmdDeviceReadW);
+    EXPECT_EQ(OpCode::getOpCode(buf, sizeof(buf)), op);
+    EXPECT_EQ(op.params, 2);
+    EXPECT_EQ(op.result, 0);
+    buf[0] = kCmdDeviceCrc32Range;
+    op = OpCode::getOpCode(kCmdDeviceCrc32Range);
+    EXPECT_EQ(OpCode::getOpCode(buf, sizeof(buf)), op);
+    EXPECT_EQ(op.params, 6);
+    EXPECT_EQ(op.result, 4);
+    buf[0] = kCmdDeviceBlankCheckRange;
+    op = OpCode::getOpCode(kCmdDeviceBlankCheckRange);
+    EXPECT_EQ(OpCode::getOpCode(buf, sizeof(buf)), op);
+    EXPECT_EQ(op.params, 6);
+    EXPECT_EQ(op.result, 8);
+    buf[0] = kCmdDeviceSetup;
+    op = OpCode::getOpCode(kCmdDeviceSetup);
+    EXPECT_EQ(OpCode::getOpCode(buf, sizeof(buf)), op);
+    EXPECT_EQ(op.params, 16);
+    EXPECT_EQ(op.result, 0);
+    buf[0] = kCmdProtoEncoding;
+    op = OpCode::getOpCode(kCmdProtoEncoding);
+    EXPECT_EQ(OpCode::getOpCode(buf, sizeof(buf)), op);
+    EXPECT_EQ(op.params, 1);
+    EXPECT_EQ(op.result, 0);
+    buf[0] = kCmdProtoFrame;
+    op = OpCode::getOpCode(kCmdProtoFrame);
+    EXPECT_EQ(OpCode::getOpCode(buf, sizeof(buf)), op);
+    EXPECT_EQ(op.params, 3);
+    EXPECT_EQ(op.result, 0);
+    buf[0] = kCmdProtoCaps;
+    op = OpCode::getOpCode(kCmdProtoCaps);
+    EXPECT_EQ(OpCode::getOpCode(buf, sizeof(buf)), op);
+    EXPECT_EQ(op.params, 0);
+    EXPECT_EQ(op.result, 5);
     buf[0] = 0xFF;
     op = OpCode::getOpCode(kCmdNop);
     EXPECT_EQ(OpCode::getOpCode(buf, sizeof(buf)), op);
 }
 
+TEST_F(OpCodeTest, opcode_table) {
+    // each entry of the table is found by its code
+    for (const auto &item : kCmdOpCodes) {
+        EXPECT_EQ(OpCode::getOpCode(item.code), item);
+        EXPECT_STREQ(OpCode::getOpCode(item.code).descr, item.descr);
+    }
+    // unknown codes are the NOP
+    EXPECT_EQ(OpCode::getOpCode(0xFF), kCmdOpCodes[0]);
+    EXPECT_EQ(OpCode::getOpCode(0xFF).code, kCmdNop);
+}
+
 TEST_F(OpCodeTest, get_value) {
     uint8_t buf[32];
     memset(buf, 0, sizeof(buf));
@@ -0,0 +1,140 @@
+// ---------------------------------------------------------------------------
+// USB EPROM/Flash Programmer
+//
+// Copyright (2024) Robson Martins
+//
+// This work is licensed under a Creative Commons Attribution-NonCommercial-
+// ShareAlike 4.0 International License.
+// ---------------------------------------------------------------------------
+/**
+ * @ingroup UnitTests
+ * @file test/backend/rle_test.cpp
+ * @brief Implementation of Unit Test for RLE Codec Class.
+ *
+ * @author Robson Martins (https://www.robsonmartins.com)
+ */
+// ---------------------------------------------------------------------------
+
+#include "rle_test.hpp"
+#include "../../backend/rle.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+
+#define GTEST_COUT std::cerr << "[          ] RleTest: "
+
+/* @brief Nominal throughput of the serial link (USB CDC), in bytes/s. */
+constexpr double kLinkBytesPerSec = 1000000.0;
+
+/*
+ * @brief Fills a buffer with pseudo-random bytes (simulates machine code).
+ * @param buf Pointer to the buffer.
+ * @param size Size of buffer, in bytes.
+ * @param seed Seed value.
+ */
+static void fillCode(uint8_t *buf, size_t size, uint32_t seed) {
+    for (size_t i = 0; i < size; i++) {
+        seed = seed * 1103515245 + 12345;
+        buf[i] = static_cast<uint8_t>(seed >> 16);
+    }
+}
+
+/*
+ * @brief Encodes, decodes and checks a buffer.
+ * @param raw Raw data.
+ * @return Size of encoded data, in bytes.
+ */
+static size_t roundTrip(const std::vector<uint8_t> &raw) {
+    std::vector<uint8_t> enc(Rle::maxEncodedSize(raw.size()));
+    std::vector<uint8_t> dec(raw.size());
+    size_t len = Rle::encode(raw.data(), raw.size(), enc.data());
+    EXPECT_LE(len, enc.size());
+    size_t decoded = 0;
+    EXPECT_TRUE(Rle::decode(enc.data(), len, dec.data(), dec.size(), decoded));
+    EXPECT_EQ(decoded, raw.size());
+    EXPECT_EQ(dec, raw);
+    return len;
+}
+
+// ---------------------------------------------------------------------------
+
+TEST_F(RleTest, encode_decode) {
+    std::vector<uint8_t> raw;
+    EXPECT_EQ(roundTrip(raw), 0);
+    raw.assign(1, 0x55);
+    EXPECT_EQ(roundTrip(raw), 2);
+    raw.assign(2, 0xFF);
+    EXPECT_EQ(roundTrip(raw), 3);
+    raw.assign(3, 0xFF);
+    EXPECT_EQ(roundTrip(raw), 2);
+    raw.assign(128, 0xFF);
+    EXPECT_EQ(roundTrip(raw), 2);
+    raw.assign(129, 0xFF);
+    EXPECT_EQ(roundTrip(raw), 4);
+    raw = {1, 2, 2, 3, 3, 3, 4, 4, 4, 4, 5};
+    EXPECT_EQ(roundTrip(raw), 10);
+    for (size_t size : {127, 128, 129, 256, 1000}) {
+        raw.resize(size);
+        fillCode(raw.data(), raw.size(), static_cast<uint32_t>(size));
+        EXPECT_LE(roundTrip(raw), Rle::maxEncodedSize(size));
+    }
+}
+
+TEST_F(RleTest, decode_malformed) {
+    uint8_t out[4];
+    size_t decoded = 0;
+    const uint8_t literal[] = {0x03, 0x01, 0x02};
+    EXPECT_FALSE(Rle::decode(literal, sizeof(literal), out, 4, decoded));
+    const uint8_t run[] = {0xFE};
+    EXPECT_FALSE(Rle::decode(run, sizeof(run), out, 4, decoded));
+    const uint8_t overflow[] = {0xFB, 0x00};
+    EXPECT_FALSE(Rle::decode(overflow, sizeof(overflow), out, 4, decoded));
+    const uint8_t nop[] = {0x80, 0xFD, 0xAA, 0x80};
+    EXPECT_TRUE(Rle::decode(nop, sizeof(nop), out, 4, decoded));
+    EXPECT_EQ(decoded, 4);
+    EXPECT_EQ(out[3], 0xAA);
+}
+
+TEST_F(RleTest, benchmark) {
+    const size_t size = 0x40000;
+    struct Image {
+        const char *name;
+        size_t code;
+    };
+    // typical ROM images: code/data followed by erased (0xFF) area
+    const Image images[] = {
+        {"full (random)", size},
+        {"code 75% + fill", size * 3 / 4},
+        {"code 50% + fill", size / 2},
+        {"code 25% + fill", size / 4},
+        {"blank", 0},
+    };
+    for (const Image &image : images) {
+        std::vector<uint8_t> raw(size, 0xFF);
+        fillCode(raw.data(), image.code, 0x1234);
+        // zeroed tables between code sections
+        for (size_t i = 0x1000; i + 0x100 <= image.code; i += 0x2000) {
+            memset(raw.data() + i, 0x00, 0x100);
+        }
+        auto start = std::chrono::steady_clock::now();
+        size_t len = roundTrip(raw);
+        double cpu = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+        double ratio = static_cast<double>(len) / size;
+        double plain = kLinkBytesPerSec;
+        double effective = size / (len / kLinkBytesPerSec + cpu);
+        EXPECT_LE(len, Rle::maxEncodedSize(size));
+        if (image.code < size) {
+            EXPECT_LT(len, size);
+        }
+        GTEST_COUT << image.name << ": ratio " << ratio << ", "
+                   << static_cast<uint64_t>(effective) << " B/s (raw "
+                   << static_cast<uint64_t>(plain) << " B/s, gain "
+                   << effective / plain << "x)" << std::endl;
+    }
+}
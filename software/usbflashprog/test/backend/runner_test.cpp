@@ -17,9 +17,90 @@
 
 #include "runner_test.hpp"
 #include "../../backend/runner.hpp"
+#include "../../backend/checksum.hpp"
+#include "../../backend/transport/loopback.hpp"
+
+#include "emulator/emulator.hpp"
+#include "emulator/sram.hpp"
 
 #include <chrono>
 #include <cstring>
+#include <memory>
+
+// ---------------------------------------------------------------------------
+
+/* Port of the emulated programmer (see RunnerTest::SetUp). */
+static const QString kEmulatorPort = QString(kLoopbackPrefix) + "emulator";
+
+/* Size of the SRAM of the emulated programmer, in bytes. */
+constexpr uint32_t kEmulatorSize = 0x1000;
+
+/* Bytes sent by the emulated programmer. */
+static uint32_t linkBytesIn = 0;
+
+/* Number of framed responses to corrupt on the link. */
+static int noisyFrames = 0;
+
+// ---------------------------------------------------------------------------
+// private functions
+
+/* Creates a loopback transport to an emulated programmer, whose link
+   counts the bytes sent by the programmer (see linkBytesIn), and
+   corrupts the CRC of the next framed responses (see noisyFrames).
+   @return Pointer to the new transport.
+ */
+static Transport *createTransport() {
+    std::shared_ptr<Emulator> emulator = std::make_shared<Emulator>();
+    return new LoopbackTransport([emulator](const QByteArray &data) {
+        QByteArray response = emulator->receive(data);
+        linkBytesIn += response.size();
+        // the frames of sequence zero synchronize the link
+        if (noisyFrames > 0 && data.size() > 1 && !response.isEmpty() &&
+            static_cast<uint8_t>(data[0]) == kCmdProtoFrame && data[1]) {
+            response[response.size() - 1] ^= 0x01;
+            noisyFrames--;
+        }
+        return response;
+    });
+}
+
+/* Writes data to the SRAM of the emulated programmer.
+   @param runner Runner (opened).
+   @param data Data to write, from the address zero.
+   @return True if success, false otherwise.
+ */
+static bool writeEmulator(Runner &runner, const QByteArray &data) {
+    Runner::TDeviceFlags flags;
+    flags.skipFF = false;
+    flags.progWithVpp = false;
+    flags.vppOePin = false;
+    flags.pgmCePin = false;
+    flags.pgmPositive = false;
+    flags.is16bit = false;
+    runner.setBufferSize(256);
+    // the SRAM is written with the bus set up to read (as SRAM::program),
+    // and loses its contents if the VDD is turned off
+    return runner.deviceSetup(kCmdDeviceAlgorithmSRAM, flags, 5.0f, 0.0f, 1,
+                              1, kCmdDeviceOperationRead,
+                              kCmdDeviceSetupKeepVpp) &&
+           runner.addrClr() && runner.deviceWriteBlocks(data);
+}
+
+// ---------------------------------------------------------------------------
+
+void RunnerTest::SetUp() {
+    Transport::registerType(kLoopbackPrefix, createTransport);
+    emuChip_ = new ChipSRAM();
+    emuChip_->setSize(kEmulatorSize);
+    Emulator::setChip(emuChip_);
+    linkBytesIn = 0;
+    noisyFrames = 0;
+}
+
+void RunnerTest::TearDown() {
+    Transport::unregisterType(kLoopbackPrefix);
+    delete emuChip_;
+}
 
 // ---------------------------------------------------------------------------
 
@@ -222,6 +303,339 @@ TEST_F(RunnerTest, cmdBusData) {
     runner.close();
 }
 
+TEST_F(RunnerTest, cmdDeviceBlocks) {
+    Runner runner;
+
+    EXPECT_EQ(runner.deviceReadBlocks(2).size(), 0);
+    EXPECT_EQ(runner.deviceWriteBlocks(QByteArray(4, 0x55)), false);
+    EXPECT_EQ(runner.deviceVerifyBlocks(QByteArray(4, 0x55)), false);
+    EXPECT_EQ(runner.deviceBlankCheckBlocks(2), false);
+
+    runner.setWindowSize(0);
+    EXPECT_EQ(runner.getWindowSize(), 1);
+    runner.setWindowSize(4);
+    EXPECT_EQ(runner.getWindowSize(), 4);
+
+    EXPECT_EQ(runner.open(QString("COM1")), true);
+    runner.setBufferSize(2);
+    EXPECT_EQ(runner.addrClr(), true);
+    EXPECT_EQ(runner.deviceReadBlocks(0).size(), 0);
+    EXPECT_EQ(runner.deviceReadBlocks(3).size(), 6);
+    EXPECT_EQ(runner.addrGet(), 6);
+    EXPECT_EQ(runner.deviceWriteBlocks(QByteArray(6, 0x55)), true);
+    EXPECT_EQ(runner.addrGet(), 12);
+    EXPECT_EQ(runner.deviceVerifyBlocks(QByteArray(5, 0x55)), true);
+    EXPECT_EQ(runner.addrGet(), 18);
+    EXPECT_EQ(runner.deviceBlankCheckBlocks(2), true);
+    EXPECT_EQ(runner.addrGet(), 22);
+    // appended to the buffer
+    QByteArray buffer(1, 0x55);
+    EXPECT_EQ(runner.deviceReadBlocks(2, buffer), true);
+    EXPECT_EQ(buffer.size(), 5);
+    EXPECT_EQ(buffer[0], 0x55);
+    EXPECT_EQ(runner.addrGet(), 26);
+    runner.close();
+}
+
+TEST_F(RunnerTest, capabilities) {
+    Runner runner;
+
+    EXPECT_EQ(runner.getCapabilities().version, 0);
+    EXPECT_EQ(runner.open(kEmulatorPort), true);
+    EXPECT_EQ(runner.getCapabilities().version, kCmdProtoVersion);
+    EXPECT_EQ(runner.getCapabilities().maxBufferSize, 4096);
+    uint16_t features = runner.getCapabilities().features;
+    EXPECT_NE(features & kCmdProtoFeatureTag, 0);
+    EXPECT_NE(features & kCmdProtoFeatureWide, 0);
+    EXPECT_NE(features & kCmdProtoFeatureReadRange, 0);
+    EXPECT_NE(features & kCmdProtoFeatureCrc32Range, 0);
+    EXPECT_NE(features & kCmdProtoFeatureRle, 0);
+    EXPECT_NE(features & kCmdProtoFeatureFrame, 0);
+    // the features reported are not probed
+    runner.resetStats();
+    EXPECT_EQ(runner.getMaxBufferSize(), 4096);
+    EXPECT_EQ(runner.hasReadRange(), true);
+    EXPECT_EQ(runner.getStats().getTotal().calls, 0);
+    // only the capabilities were received (OK + 5 bytes)
+    EXPECT_EQ(linkBytesIn, 6);
+    runner.close();
+}
+
+TEST_F(RunnerTest, bufferSize) {
+    Runner runner;
+
+    runner.setBufferSize(0);
+    EXPECT_EQ(runner.getBufferSize(), 1);
+    runner.setBufferSize(100);
+    EXPECT_EQ(runner.getBufferSize(), 128);
+    runner.setBufferSize(300);
+    EXPECT_EQ(runner.getBufferSize(), 512);
+    runner.setBufferSize(4096);
+    EXPECT_EQ(runner.getBufferSize(), 4096);
+    runner.setBufferSize(10000);
+    EXPECT_EQ(runner.getBufferSize(), 4096);
+}
+
+TEST_F(RunnerTest, compression) {
+    Runner runner;
+
+    EXPECT_EQ(runner.getCompression(), true);
+    runner.setCompression(false);
+    EXPECT_EQ(runner.getCompression(), false);
+
+    // runs (compressible) and random data (not compressible)
+    QByteArray data(kEmulatorSize, static_cast<char>(0xFF)), random;
+    Emulator::randomizeBuffer(random, 0x100);
+    data.replace(0x400, random.size(), random);
+    data.replace(0x800, 0x400, QByteArray(0x400, 0x00));
+    uint32_t bytesIn[2];
+    for (int i = 0; i < 2; i++) {
+        runner.setCompression(i != 0);
+        EXPECT_EQ(runner.open(kEmulatorPort), true);
+        EXPECT_EQ(writeEmulator(runner, data), true);
+        linkBytesIn = 0;
+        EXPECT_EQ(runner.deviceReadRangeBegin(0, kEmulatorSize), true);
+        QByteArray buffer;
+        while (runner.deviceReadRangeNext(buffer)) {
+        }
+        EXPECT_EQ(runner.hasError(), false);
+        EXPECT_EQ(runner.deviceReadRangeEnd(), true);
+        EXPECT_EQ(buffer, data);
+        bytesIn[i] = linkBytesIn;
+        runner.close();
+    }
+    // the runs are compressed
+    EXPECT_LT(bytesIn[1], bytesIn[0] / 2);
+
+    // a compressed Write Range stream
+    EXPECT_EQ(runner.open(kEmulatorPort), true);
+    EXPECT_EQ(writeEmulator(runner, QByteArray(kEmulatorSize, 0x55)), true);
+    EXPECT_EQ(runner.deviceWriteRangeBegin(0, kEmulatorSize, 0x100), true);
+    for (uint32_t addr = 0; addr < kEmulatorSize; addr += 0x100) {
+        EXPECT_EQ(runner.deviceWriteRangeNext(data.mid(addr, 0x100)), true);
+    }
+    EXPECT_EQ(runner.deviceWriteRangeEnd(), true);
+    EXPECT_EQ(runner.addrClr(), true);
+    EXPECT_EQ(runner.deviceReadBlocks(kEmulatorSize / 0x100), data);
+    runner.close();
+}
+
+TEST_F(RunnerTest, framing) {
+    Runner runner;
+
+    EXPECT_EQ(runner.getFraming(), false);
+    runner.setFraming(true);
+    EXPECT_EQ(runner.getFraming(), true);
+
+    QByteArray data;
+    Emulator::randomizeBuffer(data, kEmulatorSize);
+    EXPECT_EQ(runner.open(kEmulatorPort), true);
+    EXPECT_EQ(runner.nop(), true);
+    EXPECT_EQ(writeEmulator(runner, data), true);
+    EXPECT_EQ(runner.addrClr(), true);
+    EXPECT_EQ(runner.deviceReadBlocks(kEmulatorSize / 0x100), data);
+    // the buffers of 256 bytes are read with the wide opcode
+    EXPECT_EQ(runner.getStats().get(kCmdDeviceReadW).retries, 0);
+
+    // a corrupted response is retransmitted (not run again)
+    runner.resetStats();
+    EXPECT_EQ(runner.addrSet(0x200), true);
+    noisyFrames = 1;
+    EXPECT_EQ(runner.deviceReadBlocks(2), data.mid(0x200, 0x200));
+    EXPECT_EQ(noisyFrames, 0);
+    EXPECT_EQ(runner.getStats().get(kCmdDeviceReadW).retries, 1);
+    EXPECT_EQ(runner.addrGet(), 0x400);
+    QByteArray block(0x100, 0x5A);
+    EXPECT_EQ(runner.addrSet(0x100), true);
+    noisyFrames = 1;
+    EXPECT_EQ(runner.deviceWriteBlocks(block), true);
+    EXPECT_EQ(noisyFrames, 0);
+    EXPECT_EQ(runner.addrGet(), 0x200);
+    EXPECT_EQ(runner.addrSet(0x100), true);
+    EXPECT_EQ(runner.deviceReadBlocks(1), block);
+    runner.close();
+}
+
+TEST_F(RunnerTest, stats) {
+    Runner runner;
+
+    EXPECT_EQ(runner.getStats().getTotal().calls, 0);
+    EXPECT_EQ(runner.open(kEmulatorPort), true);
+    runner.resetStats();
+    EXPECT_EQ(runner.nop(), true);
+    EXPECT_EQ(runner.nop(), true);
+    const TOpCodeStats &nop = runner.getStats().get(kCmdNop);
+    EXPECT_EQ(nop.calls, 2);
+    EXPECT_EQ(nop.retries, 0);
+    EXPECT_EQ(nop.errors, 0);
+    EXPECT_EQ(nop.bytesOut, 2);
+    EXPECT_EQ(nop.bytesIn, 2);
+    EXPECT_EQ(runner.getStats().getTotal().calls, 2);
+    runner.resetStats();
+    EXPECT_EQ(runner.getStats().get(kCmdNop).calls, 0);
+
+    // the stream records the bytes received (encoded)
+    EXPECT_EQ(writeEmulator(runner, QByteArray(kEmulatorSize, 0x00)), true);
+    runner.resetStats();
+    linkBytesIn = 0;
+    EXPECT_EQ(runner.deviceReadRangeBegin(0, kEmulatorSize), true);
+    QByteArray buffer;
+    while (runner.deviceReadRangeNext(buffer)) {
+    }
+    EXPECT_EQ(buffer, QByteArray(kEmulatorSize, 0x00));
+    EXPECT_EQ(runner.getStats().getTotal().bytesIn, linkBytesIn);
+    EXPECT_EQ(runner.getStats().get(kCmdDeviceReadRange).calls,
+              kEmulatorSize / kCmdStreamChunkSize + 1);
+    runner.close();
+
+    // retransmissions and errors of the framed transport
+    runner.setFraming(true);
+    EXPECT_EQ(runner.open(kEmulatorPort), true);
+    EXPECT_EQ(runner.nop(), true);
+    runner.resetStats();
+    noisyFrames = 1;
+    EXPECT_EQ(runner.nop(), true);
+    EXPECT_EQ(runner.getStats().get(kCmdNop).calls, 1);
+    EXPECT_EQ(runner.getStats().get(kCmdNop).retries, 1);
+    EXPECT_EQ(runner.getStats().get(kCmdNop).errors, 0);
+    // all the retransmissions corrupted
+    noisyFrames = 100;
+    EXPECT_EQ(runner.nop(), false);
+    EXPECT_EQ(runner.getStats().get(kCmdNop).calls, 2);
+    EXPECT_EQ(runner.getStats().get(kCmdNop).errors, 1);
+    runner.close();
+}
+
+TEST_F(RunnerTest, cmdDeviceReadRange) {
+    Runner runner;
+
+    EXPECT_EQ(runner.hasReadRange(), false);
+    EXPECT_EQ(runner.deviceReadRangeBegin(0, 4), false);
+    EXPECT_EQ(runner.deviceReadRangeNext().size(), 0);
+    EXPECT_EQ(runner.deviceReadRangeEnd(), true);
+
+    EXPECT_EQ(runner.open(QString("COM1")), true);
+    EXPECT_EQ(runner.hasReadRange(), true);
+    EXPECT_EQ(runner.deviceReadRangeBegin(0, 0), false);
+    EXPECT_EQ(runner.deviceReadRangeBegin(0x10, 4), true);
+    EXPECT_EQ(runner.addrGet(), 0x10);
+    // the mock does not stream chunks
+    EXPECT_EQ(runner.deviceReadRangeNext().size(), 0);
+    EXPECT_EQ(runner.hasError(), true);
+    EXPECT_EQ(runner.deviceReadRangeEnd(), true);
+    runner.close();
+}
+
+TEST_F(RunnerTest, cmdDeviceWriteRange) {
+    Runner runner;
+
+    EXPECT_EQ(runner.deviceWriteRangeBegin(0, 4, 2), false);
+    EXPECT_EQ(runner.deviceWriteRangeNext(QByteArray(2, 0x55)), false);
+
+    EXPECT_EQ(runner.open(QString("COM1")), true);
+    EXPECT_EQ(runner.deviceWriteRangeBegin(0, 0, 2), false);
+    EXPECT_EQ(runner.deviceWriteRangeBegin(0, 3, 2), false);
+    EXPECT_EQ(runner.deviceWriteRangeBegin(0x10, 4, 2), true);
+    EXPECT_EQ(runner.addrGet(), 0x10);
+    EXPECT_EQ(runner.deviceWriteRangeNext(QByteArray(2, 0x55)), true);
+    EXPECT_EQ(runner.deviceWriteRangeNext(QByteArray(2, 0x55)), true);
+    EXPECT_EQ(runner.deviceWriteRangeNext(QByteArray(2, 0x55)), false);
+    // the mock does not acknowledge the blocks
+    EXPECT_EQ(runner.deviceWriteRangeEnd(), false);
+    EXPECT_EQ(runner.addrGet(), 0x10);
+    runner.close();
+}
+
+TEST_F(RunnerTest, cmdDeviceCrc32Range) {
+    Runner runner;
+    uint32_t crc = 0;
+
+    EXPECT_EQ(runner.deviceCrc32Range(0, 4, crc), false);
+
+    QByteArray data;
+    Emulator::randomizeBuffer(data, kEmulatorSize);
+    EXPECT_EQ(runner.open(kEmulatorPort), true);
+    EXPECT_EQ(writeEmulator(runner, data), true);
+    // the whole device (several chunks), and a range of it
+    EXPECT_EQ(runner.deviceCrc32Range(0, kEmulatorSize, crc), true);
+    EXPECT_EQ(crc, Checksum::crc32(data.constData(), data.size()));
+    EXPECT_EQ(runner.addrGet(), kEmulatorSize);
+    EXPECT_EQ(runner.deviceCrc32Range(0x110, 0x234, crc), true);
+    EXPECT_EQ(crc, Checksum::crc32(data.constData() + 0x110, 0x234));
+    EXPECT_EQ(runner.addrGet(), 0x110 + 0x234);
+    // a changed byte changes the CRC
+    data[0x200] = static_cast<char>(~data[0x200]);
+    EXPECT_EQ(runner.deviceCrc32Range(0, kEmulatorSize, crc), true);
+    EXPECT_NE(crc, Checksum::crc32(data.constData(), data.size()));
+    runner.close();
+}
+
+TEST_F(RunnerTest, cmdDeviceBlankCheckRange) {
+    Runner runner;
+    uint32_t dirty = 0, first = 0;
+
+    EXPECT_EQ(runner.deviceBlankCheckRange(0, 4, dirty, first), false);
+
+    QByteArray data(kEmulatorSize, static_cast<char>(0xFF));
+    data[0x123] = 0x00;
+    data[0x800] = 0x7F;
+    data[0x801] = static_cast<char>(0xFE);
+    EXPECT_EQ(runner.open(kEmulatorPort), true);
+    EXPECT_EQ(writeEmulator(runner, data), true);
+    EXPECT_EQ(runner.deviceBlankCheckRange(0, kEmulatorSize, dirty, first),
+              true);
+    EXPECT_EQ(dirty, 3);
+    EXPECT_EQ(first, 0x123);
+    EXPECT_EQ(runner.addrGet(), kEmulatorSize);
+    EXPECT_EQ(runner.deviceBlankCheckRange(0x124, 0x800, dirty, first),
+              true);
+    EXPECT_EQ(dirty, 2);
+    EXPECT_EQ(first, 0x800);
+    // blank range
+    EXPECT_EQ(runner.deviceBlankCheckRange(0x200, 0x400, dirty, first),
+              true);
+    EXPECT_EQ(dirty, 0);
+    runner.close();
+}
+
+TEST_F(RunnerTest, cmdDeviceSetup) {
+    Runner runner;
+    Runner::TDeviceFlags flags;
+    flags.skipFF = false;
+    flags.progWithVpp = false;
+    flags.vppOePin = false;
+    flags.pgmCePin = false;
+    flags.pgmPositive = false;
+    flags.is16bit = true;
+
+    EXPECT_EQ(runner.deviceSetup(kCmdDeviceAlgorithmEPROM, flags, 5.0f,
+                                 12.0f, 100, 10, kCmdDeviceOperationProg, 0),
+              false);
+
+    EXPECT_EQ(runner.open(QString("COM1")), true);
+    EXPECT_EQ(runner.addrSet(0x10), true);
+    EXPECT_EQ(runner.deviceSetup(kCmdDeviceAlgorithmEPROM, flags, 5.0f,
+                                 12.0f, 100, 10, kCmdDeviceOperationProg, 0),
+              true);
+    EXPECT_EQ(runner.addrGet(), 0);
+    EXPECT_EQ(runner.getBufferSize(), 2);
+    EXPECT_EQ(runner.deviceSetup(kCmdDeviceAlgorithmEPROM, flags, 0.0f,
+                                 0.0f, 0, 0, kCmdDeviceOperationReset,
+                                 kCmdDeviceSetupKeepVdd |
+                                     kCmdDeviceSetupKeepVpp |
+                                     kCmdDeviceSetupKeepTwp |
+                                     kCmdDeviceSetupKeepTwc),
+              true);
+    // negative voltages are rejected (not sent)
+    EXPECT_EQ(runner.deviceSetup(kCmdDeviceAlgorithmEPROM, flags, -5.0f,
+                                 12.0f, 100, 10, kCmdDeviceOperationProg, 0),
+              false);
+    EXPECT_EQ(runner.deviceSetup(kCmdDeviceAlgorithmEPROM, flags, 5.0f,
+                                 -12.0f, 100, 10, kCmdDeviceOperationProg, 0),
+              false);
+    runner.close();
+}
+
 TEST_F(RunnerTest, delay) {
     auto start = std::chrono::steady_clock::now();
     auto end = start;
@@ -20,6 +20,8 @@
 
 #include <gtest/gtest.h>
 
+class BaseParChip;
+
 // ---------------------------------------------------------------------------
 
 /**
@@ -34,9 +36,15 @@ class RunnerTest : public testing::Test {
     RunnerTest() {}
     /** @brief Destructor. */
     ~RunnerTest() override {}
-    /** @brief Sets Up the test. */
-    void SetUp() override {}
+    /**
+     * @brief Sets Up the test.
+     * @details The tests of the firmware features run the Runner over a
+     *   loopback transport to the emulated programmer, with an SRAM.
+     */
+    void SetUp() override;
     /** @brief Teardown of the test. */
-    void TearDown() override {}
+    void TearDown() override;
+    /* @brief Chip of the emulated programmer. */
+    BaseParChip *emuChip_;
 };
 #endif  // TEST_BACKEND_RUNNER_TEST_HPP_
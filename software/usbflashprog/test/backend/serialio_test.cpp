@@ -0,0 +1,101 @@
+// ---------------------------------------------------------------------------
+// USB EPROM/Flash Programmer
+//
+// Copyright (2024) Robson Martins
+//
+// This work is licensed under a Creative Commons Attribution-NonCommercial-
+// ShareAlike 4.0 International License.
+// ---------------------------------------------------------------------------
+/**
+ * @ingroup UnitTests
+ * @file test/backend/serialio_test.cpp
+ * @brief Implementation of Unit Test for Serial I/O Class.
+ *
+ * @author Robson Martins (https://www.robsonmartins.com)
+ */
+// ---------------------------------------------------------------------------
+
+#include <QDir>
+#include <QFile>
+
+#include <memory>
+
+#include "serialio_test.hpp"
+#include "../../backend/serialio.hpp"
+
+// ---------------------------------------------------------------------------
+
+TEST_F(SerialIoTest, open_close) {
+    SerialIo serial;
+    EXPECT_EQ(serial.isOpen(), false);
+    EXPECT_EQ(serial.write(QByteArray(1, 0)), -1);
+    EXPECT_EQ(serial.clear(), false);
+    EXPECT_EQ(serial.open(QString("COM1")), true);
+    EXPECT_EQ(serial.isOpen(), true);
+    EXPECT_EQ(serial.portName().toStdString(), "COM1");
+    serial.close();
+    EXPECT_EQ(serial.isOpen(), false);
+    EXPECT_EQ(serial.portName().isEmpty(), true);
+}
+
+TEST_F(SerialIoTest, write_read) {
+    SerialIo serial;
+    QByteArray data;
+    EXPECT_EQ(serial.read(&data, 1, 10), false);
+    EXPECT_EQ(serial.open(QString("COM1")), true);
+    EXPECT_EQ(serial.clear(), true);
+    EXPECT_EQ(serial.write(QByteArray(3, 0)), 3);
+    // the mock receives the dummy data periodically
+    EXPECT_EQ(serial.read(&data, 2, 1000), true);
+    EXPECT_EQ(data.size(), 2);
+    EXPECT_EQ(static_cast<uint8_t>(data[0]), kSerialPortDummyData[0]);
+    EXPECT_EQ(static_cast<uint8_t>(data[1]), kSerialPortDummyData[1]);
+    // the remaining data is kept
+    EXPECT_EQ(serial.read(&data, 1, 1000), true);
+    EXPECT_EQ(static_cast<uint8_t>(data[0]), kSerialPortDummyData[2]);
+    EXPECT_EQ(serial.clear(), true);
+    EXPECT_EQ(serial.read(&data, 1000, 10), false);
+    EXPECT_EQ(data.isEmpty(), true);
+    serial.close();
+}
+
+TEST_F(SerialIoTest, clear_keeps_output) {
+    SerialIo serial;
+    EXPECT_EQ(serial.open(QString("COM1")), true);
+    QSerialPort::pending = 0;
+    EXPECT_EQ(serial.write(QByteArray(3, 0)), 3);
+    // only the received data is discarded (the written data goes out)
+    EXPECT_EQ(serial.clear(), true);
+    EXPECT_EQ(QSerialPort::pending, 3);
+    serial.close();
+}
+
+TEST_F(SerialIoTest, record) {
+    QString filename = QDir(QDir::tempPath()).filePath("serialio_test.uft");
+    std::shared_ptr<TraceWriter> trace = std::make_shared<TraceWriter>();
+    SerialIo serial;
+    QByteArray data;
+    TTraceEventList events;
+    EXPECT_EQ(trace->open(filename), true);
+    serial.setTrace(trace);
+    EXPECT_EQ(serial.open(QString("COM1")), true);
+    EXPECT_EQ(serial.write(QByteArray(3, 0)), 3);
+    EXPECT_EQ(serial.read(&data, 3, 1000), true);
+    serial.close();
+    serial.setTrace(nullptr);
+    trace->close();
+    EXPECT_EQ(TraceReader::load(filename, events), true);
+    // the mock receives the dummy data periodically (even before the write)
+    int writes = 0, reads = 0;
+    for (const auto& event : events) {
+        if (event.direction == kTraceWrite) {
+            EXPECT_EQ(event.data, QByteArray(3, 0));
+            writes++;
+        } else {
+            reads++;
+        }
+    }
+    EXPECT_EQ(writes, 1);
+    EXPECT_GE(reads, 1);
+    QFile::remove(filename);
+}
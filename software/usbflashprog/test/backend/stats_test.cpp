@@ -0,0 +1,73 @@
+// ---------------------------------------------------------------------------
+// USB EPROM/Flash Programmer
+//
+// Copyright (2024) Robson Martins
+//
+// This work is licensed under a Creative Commons Attribution-NonCommercial-
+// ShareAlike 4.0 International License.
+// ---------------------------------------------------------------------------
+/**
+ * @ingroup UnitTests
+ * @file test/backend/stats_test.cpp
+ * @brief Implementation of Unit Test for Communication Statistics Class.
+ *
+ * @author Robson Martins (https://www.robsonmartins.com)
+ */
+// ---------------------------------------------------------------------------
+
+#include "stats_test.hpp"
+#include "../../backend/stats.hpp"
+#include "../../backend/opcodes.hpp"
+
+// ---------------------------------------------------------------------------
+
+TEST_F(StatsTest, add) {
+    CommStats stats;
+    EXPECT_EQ(stats.get(kCmdDeviceRead).calls, 0);
+    EXPECT_EQ(CommStats::percentile(stats.get(kCmdDeviceRead), 50), 0);
+    stats.add(kCmdDeviceRead, 2, 65, 100);
+    stats.add(kCmdDeviceRead, 2, 65, 120, 1);
+    stats.add(kCmdDeviceRead, 2, 1, 3000, 2, true);
+    stats.add(kCmdNop, 1, 1, 0);
+    const TOpCodeStats &read = stats.get(kCmdDeviceRead);
+    EXPECT_EQ(read.calls, 3);
+    EXPECT_EQ(read.retries, 3);
+    EXPECT_EQ(read.errors, 1);
+    EXPECT_EQ(read.bytesOut, 6);
+    EXPECT_EQ(read.bytesIn, 131);
+    EXPECT_EQ(read.totalUs, 3220);
+    EXPECT_EQ(read.histogram[7], 2);   // 64..127 us
+    EXPECT_EQ(read.histogram[12], 1);  // 2048..4095 us
+    TOpCodeStats total = stats.getTotal();
+    EXPECT_EQ(total.calls, 4);
+    EXPECT_EQ(total.histogram[0], 1);
+    stats.clear();
+    EXPECT_EQ(stats.getTotal().calls, 0);
+}
+
+TEST_F(StatsTest, percentile) {
+    CommStats stats;
+    for (int i = 0; i < 98; i++) stats.add(kCmdDeviceWrite, 1, 1, 100);
+    stats.add(kCmdDeviceWrite, 1, 1, 1000);
+    stats.add(kCmdDeviceWrite, 1, 1, 100000);
+    const TOpCodeStats &write = stats.get(kCmdDeviceWrite);
+    EXPECT_EQ(CommStats::percentile(write, 50), 127);
+    EXPECT_EQ(CommStats::percentile(write, 98), 127);
+    EXPECT_EQ(CommStats::percentile(write, 99), 1023);
+    EXPECT_EQ(CommStats::percentile(write, 100), 131071);
+}
+
+TEST_F(StatsTest, json) {
+    CommStats stats;
+    EXPECT_EQ(stats.toJson(),
+              "{\"calls\":0,\"retries\":0,\"errors\":0,\"bytesOut\":0,"
+              "\"bytesIn\":0,\"totalUs\":0,\"p50Us\":0,\"p99Us\":0,"
+              "\"opcodes\":[]}");
+    stats.add(kCmdNop, 1, 1, 5);
+    std::string json = stats.toJson();
+    EXPECT_NE(json.find(std::string("\"opcodes\":[{\"code\":\"0x00\","
+                                    "\"name\":\"") +
+                        OpCode::getOpCode(kCmdNop).descr + "\",\"calls\":1,"),
+              std::string::npos);
+    EXPECT_NE(json.find("\"p99Us\":7}]}"), std::string::npos);
+}
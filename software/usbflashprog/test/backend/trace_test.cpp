@@ -0,0 +1,75 @@
+// ---------------------------------------------------------------------------
+// USB EPROM/Flash Programmer
+//
+// Copyright (2024) Robson Martins
+//
+// This work is licensed under a Creative Commons Attribution-NonCommercial-
+// ShareAlike 4.0 International License.
+// ---------------------------------------------------------------------------
+/**
+ * @ingroup UnitTests
+ * @file test/backend/trace_test.cpp
+ * @brief Implementation of Unit Test for Communication Trace Classes.
+ *
+ * @author Robson Martins (https://www.robsonmartins.com)
+ */
+// ---------------------------------------------------------------------------
+
+#include <QDir>
+#include <QFile>
+#include <QThread>
+
+#include "trace_test.hpp"
+#include "../../backend/trace.hpp"
+
+// ---------------------------------------------------------------------------
+
+TEST_F(TraceTest, decode) {
+    TTraceEventList events;
+    // magic, version, write 2 bytes at 3 us, read 1 byte at 3 + 200 us
+    const char data[] = {'U',  'F',  'P',  'T', 0x01, 0x00,
+                         0x03, 0x02, 0x11, 0x22, 0x01, static_cast<char>(0xC8),
+                         0x01, 0x01, 0x33};
+    EXPECT_EQ(TraceReader::decode(QByteArray(data, sizeof(data)), events),
+              true);
+    ASSERT_EQ(events.size(), 2);
+    EXPECT_EQ(events[0].direction, kTraceWrite);
+    EXPECT_EQ(events[0].timestamp, 3u);
+    EXPECT_EQ(events[0].data, QByteArray("\x11\x22", 2));
+    EXPECT_EQ(events[1].direction, kTraceRead);
+    EXPECT_EQ(events[1].timestamp, 203u);
+    EXPECT_EQ(events[1].data, QByteArray("\x33", 1));
+    // truncated event
+    EXPECT_EQ(TraceReader::decode(QByteArray(data, sizeof(data) - 1), events),
+              false);
+    // invalid magic
+    EXPECT_EQ(TraceReader::decode(QByteArray("UFPX\x01", 5), events), false);
+    // empty trace
+    EXPECT_EQ(TraceReader::decode(QByteArray("UFPT\x01", 5), events), true);
+    EXPECT_EQ(events.isEmpty(), true);
+}
+
+TEST_F(TraceTest, write_load) {
+    QString filename = QDir(QDir::tempPath()).filePath("trace_test.uft");
+    TraceWriter writer;
+    TTraceEventList events;
+    EXPECT_EQ(writer.isOpen(), false);
+    EXPECT_EQ(writer.open(filename), true);
+    EXPECT_EQ(writer.isOpen(), true);
+    writer.append(kTraceWrite, QByteArray(3, 0x5A));
+    QThread::msleep(2);
+    writer.append(kTraceRead, QByteArray(1000, 0x0F));
+    // empty data is not recorded
+    writer.append(kTraceRead, QByteArray());
+    writer.close();
+    EXPECT_EQ(writer.isOpen(), false);
+    EXPECT_EQ(TraceReader::load(filename, events), true);
+    ASSERT_EQ(events.size(), 2);
+    EXPECT_EQ(events[0].direction, kTraceWrite);
+    EXPECT_EQ(events[0].data, QByteArray(3, 0x5A));
+    EXPECT_EQ(events[1].direction, kTraceRead);
+    EXPECT_EQ(events[1].data, QByteArray(1000, 0x0F));
+    EXPECT_GE(events[1].timestamp - events[0].timestamp, 2000u);
+    QFile::remove(filename);
+    EXPECT_EQ(TraceReader::load(filename, events), false);
+}
@@ -0,0 +1,44 @@
+// ---------------------------------------------------------------------------
+// USB EPROM/Flash Programmer
+//
+// Copyright (2024) Robson Martins
+//
+// This work is licensed under a Creative Commons Attribution-NonCommercial-
+// ShareAlike 4.0 International License.
+// ---------------------------------------------------------------------------
+/**
+ * @ingroup UnitTests
+ * @file test/backend/trace_test.hpp
+ * @brief Header of Unit Test for Communication Trace Classes.
+ *
+ * @author Robson Martins (https://www.robsonmartins.com)
+ */
+// ---------------------------------------------------------------------------
+
+#ifndef TEST_BACKEND_TRACE_TEST_HPP_
+#define TEST_BACKEND_TRACE_TEST_HPP_
+
+#include <gtest/gtest.h>
+
+// ---------------------------------------------------------------------------
+
+/**
+ * @ingroup UnitTests
+ * @brief Test class for Communication Trace Classes.
+ * @details The purpose of this class is to test the Communication Trace
+ *   Classes.
+ * @nosubgrouping
+ */
+class TraceTest : public testing::Test {
+  protected:
+    /** @brief Constructor. */
+    TraceTest() {}
+    /** @brief Destructor. */
+    ~TraceTest() override {}
+    /** @brief Sets Up the test. */
+    void SetUp() override {}
+    /** @brief Teardown of the test. */
+    void TearDown() override {}
+};
+
+#endif  // TEST_BACKEND_TRACE_TEST_HPP_
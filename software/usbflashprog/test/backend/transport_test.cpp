@@ -0,0 +1,177 @@
+// ---------------------------------------------------------------------------
+// USB EPROM/Flash Programmer
+//
+// Copyright (2024) Robson Martins
+//
+// This work is licensed under a Creative Commons Attribution-NonCommercial-
+// ShareAlike 4.0 International License.
+// ---------------------------------------------------------------------------
+/**
+ * @ingroup UnitTests
+ * @file test/backend/transport_test.cpp
+ * @brief Implementation of Unit Test for Transport Classes.
+ *
+ * @author Robson Martins (https://www.robsonmartins.com)
+ */
+// ---------------------------------------------------------------------------
+
+#include <QDir>
+#include <QFile>
+#include <QElapsedTimer>
+#include <QThread>
+
+#include <memory>
+
+#include "transport_test.hpp"
+#include "../../backend/transport/transport.hpp"
+#include "../../backend/transport/loopback.hpp"
+#include "../../backend/transport/replay.hpp"
+#include "../../backend/serialio.hpp"
+#include "../../backend/runner.hpp"
+
+// ---------------------------------------------------------------------------
+
+/* @brief Answers NOP and Proto Caps (version 1, 4 KB, wide buffers). */
+static QByteArray deviceHandler(const QByteArray &data) {
+    QByteArray result;
+    for (const auto b : data) {
+        if (static_cast<uint8_t>(b) == kCmdNop) {
+            result.append(static_cast<char>(kCmdResponseOk));
+        } else if (static_cast<uint8_t>(b) == kCmdProtoCaps) {
+            result.append(QByteArray("\xA1\x01\x10\x00\x00\x02", 6));
+        } else {
+            result.append(static_cast<char>(kCmdResponseNok));
+        }
+    }
+    return result;
+}
+
+// ---------------------------------------------------------------------------
+
+TEST_F(TransportTest, registry) {
+    std::unique_ptr<Transport> transport;
+    EXPECT_EQ(Transport::typeOf("COM1").isEmpty(), true);
+    EXPECT_EQ(Transport::typeOf("replay:file.uft"), kTraceReplayPrefix);
+    EXPECT_EQ(Transport::typeOf("loopback:test").isEmpty(), true);
+    transport.reset(Transport::create("COM1"));
+    EXPECT_NE(dynamic_cast<SerialIo *>(transport.get()), nullptr);
+    transport.reset(Transport::create("replay:file.uft"));
+    EXPECT_NE(dynamic_cast<ReplayTransport *>(transport.get()), nullptr);
+    Transport::registerType(kLoopbackPrefix, [] {
+        return new LoopbackTransport(deviceHandler);
+    });
+    EXPECT_EQ(Transport::typeOf("loopback:test"), kLoopbackPrefix);
+    transport.reset(Transport::create("loopback:test"));
+    EXPECT_NE(dynamic_cast<LoopbackTransport *>(transport.get()), nullptr);
+    Transport::unregisterType(kLoopbackPrefix);
+    EXPECT_EQ(Transport::typeOf("loopback:test").isEmpty(), true);
+}
+
+TEST_F(TransportTest, loopback) {
+    QString filename = QDir(QDir::tempPath()).filePath("transport_test.uft");
+    std::shared_ptr<TraceWriter> trace = std::make_shared<TraceWriter>();
+    LoopbackTransport loopback(deviceHandler);
+    QByteArray data;
+    TTraceEventList events;
+    EXPECT_EQ(trace->open(filename), true);
+    loopback.setTrace(trace);
+    EXPECT_EQ(loopback.isOpen(), false);
+    EXPECT_EQ(loopback.write(QByteArray(1, 0)), -1);
+    EXPECT_EQ(loopback.clear(), false);
+    EXPECT_EQ(loopback.open("loopback:test"), true);
+    EXPECT_EQ(loopback.portName().toStdString(), "loopback:test");
+    EXPECT_EQ(loopback.write(QByteArray(2, kCmdNop)), 2);
+    EXPECT_EQ(loopback.read(&data, 2, 10), true);
+    EXPECT_EQ(data, QByteArray(2, static_cast<char>(kCmdResponseOk)));
+    EXPECT_EQ(loopback.read(&data, 1, 10), false);
+    EXPECT_EQ(loopback.write(QByteArray(1, kCmdNop)), 1);
+    EXPECT_EQ(loopback.clear(), true);
+    EXPECT_EQ(loopback.read(&data, 1, 10), false);
+    loopback.close();
+    EXPECT_EQ(loopback.isOpen(), false);
+    trace->close();
+    EXPECT_EQ(TraceReader::load(filename, events), true);
+    ASSERT_EQ(events.size(), 4);
+    EXPECT_EQ(events[0].direction, kTraceWrite);
+    EXPECT_EQ(events[1].direction, kTraceRead);
+    EXPECT_EQ(events[1].data, QByteArray(2, static_cast<char>(kCmdResponseOk)));
+    QFile::remove(filename);
+}
+
+TEST_F(TransportTest, loopbackLink) {
+    LoopbackTransport loopback(deviceHandler);
+    QByteArray data;
+    QElapsedTimer elapsed;
+    // 5 ms each way, plus 1 ms per 100 bytes
+    loopback.setLink(5000, 100000);
+    EXPECT_EQ(loopback.open("loopback:test"), true);
+    elapsed.start();
+    EXPECT_EQ(loopback.write(QByteArray(100, kCmdNop)), 100);
+    EXPECT_EQ(loopback.read(&data, 100, 5), false);
+    EXPECT_EQ(loopback.read(&data, 100, 1000), true);
+    EXPECT_GE(elapsed.elapsed(), 12);
+    EXPECT_EQ(data, QByteArray(100, static_cast<char>(kCmdResponseOk)));
+    // a clear does not discard the data in transit
+    EXPECT_EQ(loopback.write(QByteArray(1, kCmdNop)), 1);
+    EXPECT_EQ(loopback.clear(), true);
+    EXPECT_EQ(loopback.read(&data, 1, 1000), true);
+    loopback.setLink(0, 0);
+    EXPECT_EQ(loopback.write(QByteArray(1, kCmdNop)), 1);
+    EXPECT_EQ(loopback.read(&data, 1, 0), true);
+    loopback.close();
+}
+
+TEST_F(TransportTest, replay) {
+    QString filename = QDir(QDir::tempPath()).filePath("transport_test.uft");
+    TraceWriter trace;
+    EXPECT_EQ(trace.open(filename), true);
+    trace.append(kTraceWrite, QByteArray("AB"));
+    QThread::msleep(20);
+    trace.append(kTraceRead, QByteArray("xy"));
+    trace.append(kTraceRead, QByteArray("z"));
+    trace.append(kTraceWrite, QByteArray("CD"));
+    trace.close();
+
+    ReplayTransport replay;
+    QByteArray data;
+    QElapsedTimer elapsed;
+    EXPECT_EQ(replay.open(QString(kTraceReplayPrefix) + "missing.uft"),
+              false);
+    EXPECT_EQ(replay.open(QString(kTraceReplayPrefix) + filename), true);
+    EXPECT_EQ(replay.isOpen(), true);
+    elapsed.start();
+    EXPECT_EQ(replay.write(QByteArray("AB")), 2);
+    // the response is received with the recorded latency
+    EXPECT_EQ(replay.read(&data, 3, 1000), true);
+    EXPECT_GE(elapsed.elapsed(), 19);
+    EXPECT_EQ(data, QByteArray("xyz"));
+    EXPECT_EQ(replay.getMismatches(), 0);
+    // different data is counted, and the trace has no response to it
+    EXPECT_EQ(replay.write(QByteArray("CE")), 2);
+    EXPECT_EQ(replay.read(&data, 1, 10), false);
+    EXPECT_EQ(replay.getMismatches(), 1);
+    // after the end of the trace
+    EXPECT_EQ(replay.write(QByteArray("AB")), 2);
+    EXPECT_EQ(replay.getMismatches(), 2);
+    replay.close();
+    EXPECT_EQ(replay.isOpen(), false);
+    QFile::remove(filename);
+}
+
+TEST_F(TransportTest, runner) {
+    Transport::registerType(kLoopbackPrefix, [] {
+        return new LoopbackTransport(deviceHandler);
+    });
+    Runner runner;
+    EXPECT_EQ(runner.open("loopback:test"), true);
+    EXPECT_EQ(runner.getPath().toStdString(), "loopback:test");
+    EXPECT_EQ(runner.getCapabilities().version, 1);
+    EXPECT_EQ(runner.getMaxBufferSize(), 4096);
+    EXPECT_EQ(runner.nop(), true);
+    runner.close();
+    // back to the serial port
+    EXPECT_EQ(runner.open("COM1"), true);
+    EXPECT_EQ(runner.getPath().toStdString(), "COM1");
+    runner.close();
+    Transport::unregisterType(kLoopbackPrefix);
+}
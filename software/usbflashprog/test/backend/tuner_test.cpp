@@ -0,0 +1,110 @@
+// ---------------------------------------------------------------------------
+// USB EPROM/Flash Programmer
+//
+// Copyright (2024) Robson Martins
+//
+// This work is licensed under a Creative Commons Attribution-NonCommercial-
+// ShareAlike 4.0 International License.
+// ---------------------------------------------------------------------------
+/**
+ * @ingroup UnitTests
+ * @file test/backend/tuner_test.cpp
+ * @brief Implementation of Unit Test for Buffer Size Tuner Class.
+ *
+ * @author Robson Martins (https://www.robsonmartins.com)
+ */
+// ---------------------------------------------------------------------------
+
+#include "tuner_test.hpp"
+#include "../../backend/tuner.hpp"
+
+// ---------------------------------------------------------------------------
+
+/*
+ * @brief Simulates the elapsed time of a transfer (fixed cost per block).
+ * @param size Buffer size, in bytes.
+ * @param bytes Amount of data, in bytes.
+ * @param blockUs Fixed cost of each block, in microseconds.
+ * @return Elapsed time, in microseconds.
+ */
+static uint64_t elapsed(uint16_t size, uint32_t bytes, uint64_t blockUs) {
+    return (bytes / size) * blockUs + bytes;
+}
+
+// ---------------------------------------------------------------------------
+
+TEST_F(TunerTest, idle) {
+    BufferTuner tuner;
+    EXPECT_FALSE(tuner.isTuning());
+    EXPECT_EQ(tuner.getSize(), 0);
+    tuner.start(4096, 4096, 1024);
+    EXPECT_TRUE(tuner.isTuning());
+    EXPECT_EQ(tuner.getSize(), 4096);
+    EXPECT_EQ(tuner.getMaxSize(), 4096);
+    tuner.start(8, 8, 1024);
+    EXPECT_FALSE(tuner.isTuning());
+    EXPECT_EQ(tuner.getSize(), 8);
+}
+
+TEST_F(TunerTest, larger) {
+    BufferTuner tuner;
+    tuner.start(64, 4096, 1024);
+    EXPECT_EQ(tuner.getMaxSize(), 256);
+    uint16_t sizes[] = {64, 128, 256, 32};
+    for (uint16_t size : sizes) {
+        EXPECT_TRUE(tuner.isTuning());
+        EXPECT_EQ(tuner.getSize(), size);
+        tuner.addSample(size, 512, elapsed(size, 512, 1000), false);
+        EXPECT_EQ(tuner.getSize(), size);
+        tuner.addSample(size, 512, elapsed(size, 512, 1000), false);
+    }
+    EXPECT_FALSE(tuner.isTuning());
+    EXPECT_EQ(tuner.getSize(), 256);
+}
+
+TEST_F(TunerTest, errors) {
+    BufferTuner tuner;
+    tuner.start(128, 128, 1024);
+    EXPECT_EQ(tuner.getMaxSize(), 128);
+    EXPECT_EQ(tuner.getSize(), 128);
+    tuner.addSample(128, 1024, elapsed(128, 1024, 100), false);
+    EXPECT_EQ(tuner.getSize(), 64);
+    tuner.addSample(64, 64, elapsed(64, 64, 100), true);
+    EXPECT_TRUE(tuner.isTuning());
+    tuner.addSample(64, 64, elapsed(64, 64, 100), true);
+    EXPECT_FALSE(tuner.isTuning());
+    EXPECT_EQ(tuner.getSize(), 128);
+    tuner.start(128, 4096, 1024);
+    tuner.addSample(128, 512, elapsed(128, 512, 100), true);
+    tuner.addSample(128, 512, elapsed(128, 512, 100), true);
+    EXPECT_EQ(tuner.getSize(), 256);
+    tuner.addSample(256, 512, elapsed(256, 512, 100), false);
+    tuner.stop();
+    EXPECT_FALSE(tuner.isTuning());
+    EXPECT_EQ(tuner.getSize(), 256);
+}
+
+TEST_F(TunerTest, unaligned) {
+    BufferTuner tuner;
+    // 320 bytes: 128 and 256 would pad the last block
+    tuner.start(64, 4096, 128, 320);
+    EXPECT_EQ(tuner.getMaxSize(), 64);
+    EXPECT_EQ(tuner.getSize(), 64);
+    tuner.addSample(64, 128, elapsed(64, 128, 1000), false);
+    EXPECT_TRUE(tuner.isTuning());
+    EXPECT_EQ(tuner.getSize(), 32);
+    tuner.addSample(32, 128, elapsed(32, 128, 1000), false);
+    EXPECT_FALSE(tuner.isTuning());
+    EXPECT_EQ(tuner.getSize(), 64);
+    // a candidate that cannot be used is skipped
+    tuner.start(64, 4096, 128, 0);
+    tuner.addSample(64, 128, elapsed(64, 128, 1000), false);
+    EXPECT_EQ(tuner.getSize(), 128);
+    tuner.skip();
+    EXPECT_EQ(tuner.getSize(), 256);
+    tuner.skip();
+    EXPECT_EQ(tuner.getSize(), 32);
+    tuner.addSample(32, 128, elapsed(32, 128, 1000), false);
+    EXPECT_FALSE(tuner.isTuning());
+    EXPECT_EQ(tuner.getSize(), 64);
+}
@@ -0,0 +1,43 @@
+// ---------------------------------------------------------------------------
+// USB EPROM/Flash Programmer
+//
+// Copyright (2024) Robson Martins
+//
+// This work is licensed under a Creative Commons Attribution-NonCommercial-
+// ShareAlike 4.0 International License.
+// ---------------------------------------------------------------------------
+/**
+ * @ingroup UnitTests
+ * @file test/backend/tuner_test.hpp
+ * @brief Header of Unit Test for Buffer Size Tuner Class.
+ *
+ * @author Robson Martins (https://www.robsonmartins.com)
+ */
+// ---------------------------------------------------------------------------
+
+#ifndef TEST_BACKEND_TUNER_TEST_HPP_
+#define TEST_BACKEND_TUNER_TEST_HPP_
+
+#include <gtest/gtest.h>
+
+// ---------------------------------------------------------------------------
+
+/**
+ * @ingroup UnitTests
+ * @brief Test class for Buffer Size Tuner Class.
+ * @details The purpose of this class is to test the Buffer Size Tuner Class.
+ * @nosubgrouping
+ */
+class TunerTest : public testing::Test {
+  protected:
+    /** @brief Constructor. */
+    TunerTest() {}
+    /** @brief Destructor. */
+    ~TunerTest() override {}
+    /** @brief Sets Up the test. */
+    void SetUp() override {}
+    /** @brief Teardown of the test. */
+    void TearDown() override {}
+};
+
+#endif  // TEST_BACKEND_TUNER_TEST_HPP_
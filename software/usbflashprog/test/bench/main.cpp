@@ -0,0 +1,341 @@
+// ---------------------------------------------------------------------------
+// USB EPROM/Flash Programmer
+//
+// Copyright (2024) Robson Martins
+//
+// This work is licensed under a Creative Commons Attribution-NonCommercial-
+// ShareAlike 4.0 International License.
+// ---------------------------------------------------------------------------
+/**
+ * @ingroup UnitTests
+ * @file test/bench/main.cpp
+ * @brief Implementation of the Throughput Benchmark.
+ * @details Drives the device classes through erase, blank check, program,
+ *  verify and read with the real Runner, over a loopback transport to the
+ *  Emulator shaped by the latency and the bandwidth of the link (see
+ *  LoopbackTransport::setLink()), and reports the results as CSV or JSON.
+ *  <br/>The link time is the time measured by the Runner (see CommStats).
+ *  The device time is the time of the emulated delays (tWP, tWC, erase
+ *  pulses). The host time is the real time of the whole operation.
+ *
+ * @author Robson Martins (https://www.robsonmartins.com)
+ */
+// ---------------------------------------------------------------------------
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QCommandLineOption>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLoggingCategory>
+#include <QRandomGenerator>
+#include <QStringList>
+#include <QTextStream>
+
+#include <memory>
+
+#include "emulator/emulator.hpp"
+#include "emulator/sram.hpp"
+#include "emulator/eprom.hpp"
+#include "emulator/eeprom.hpp"
+#include "emulator/flash28f.hpp"
+
+#include "../../backend/devices/device.hpp"
+#include "../../backend/devices/parallel/sram.hpp"
+#include "../../backend/devices/parallel/eprom.hpp"
+#include "../../backend/devices/parallel/eeprom.hpp"
+#include "../../backend/devices/parallel/flash28f.hpp"
+#include "../../backend/transport/loopback.hpp"
+
+// ---------------------------------------------------------------------------
+
+/* @brief Chip family names accepted by the --chip option. */
+static const char *kChipFamilies[] = {
+    "sram", "27",      "27C",   "27C16", "27E",  "28C",  "AT28C",
+    "28F",  "SST28SF", "Am28F", "i28F",  "LH28F", "i28F16"};
+
+/* @brief Columns of the results. */
+static const char *kColumns[] = {
+    "chip",     "size",     "run",     "operation", "success",
+    "commands", "bytesOut", "bytesIn", "linkMs",    "deviceMs",
+    "totalMs",  "hostMs",   "bytesPerSec"};
+
+/* @brief Pair of emulated chip and device class. */
+typedef struct TBenchTarget {
+    /* @brief Emulated chip. */
+    std::unique_ptr<BaseParChip> chip;
+    /* @brief Device class. */
+    std::unique_ptr<Device> device;
+} TBenchTarget;
+
+// ---------------------------------------------------------------------------
+
+/**
+ * @brief Main routine.
+ * @param argc Number of arguments.
+ * @param argv Array of arguments.
+ * @return Exit code (zero if success).
+ */
+int main(int argc, char *argv[]);
+
+/**
+ * @brief Creates the emulated chip and the device object of a chip family.
+ * @param family Chip family name (see kChipFamilies).
+ * @param[out] target Emulated chip and device (null if unknown family).
+ */
+void createTarget(const QString &family, TBenchTarget &target);
+
+/**
+ * @brief Runs one operation on the device, and returns its measures.
+ * @param device Pointer to the device.
+ * @param operation Operation name.
+ * @param buffer Data to program or verify.
+ * @param[out] result JSON object to receive the measures.
+ */
+void runOperation(Device *device, const QString &operation,
+                  const QByteArray &buffer, QJsonObject &result);
+
+// ---------------------------------------------------------------------------
+
+void createTarget(const QString &family, TBenchTarget &target) {
+    BaseParChip *chip = nullptr;
+    Device *device = nullptr;
+    if (family == "sram") {
+        chip = new ChipSRAM();
+        device = new SRAM();
+    } else if (family == "27") {
+        chip = new ChipEPROM();
+        device = new EPROM27();
+    } else if (family == "27C") {
+        chip = new ChipEPROM();
+        device = new EPROM27C();
+    } else if (family == "27C16") {
+        chip = new ChipEPROM();
+        device = new EPROM27C16Bit();
+    } else if (family == "27E") {
+        chip = new ChipEPROM();
+        device = new EPROM27E();
+    } else if (family == "28C") {
+        chip = new ChipEEPROM();
+        device = new EEPROM28C();
+    } else if (family == "AT28C") {
+        chip = new ChipEEPROM();
+        device = new EEPROM28AT();
+    } else if (family == "28F") {
+        chip = new ChipFlash28F();
+        device = new Flash28F();
+    } else if (family == "SST28SF") {
+        chip = new ChipFlashSST28F();
+        device = new FlashSST28SF();
+    } else if (family == "Am28F") {
+        chip = new ChipFlash28F();
+        device = new FlashAm28F();
+    } else if (family == "i28F") {
+        chip = new ChipFlashIntel28F();
+        device = new FlashI28F();
+    } else if (family == "LH28F") {
+        chip = new ChipFlashIntel28F();
+        device = new FlashSharpI28F();
+    } else if (family == "i28F16") {
+        chip = new ChipFlashIntel28F();
+        device = new FlashI28F16Bit();
+    }
+    target.chip.reset(chip);
+    target.device.reset(device);
+}
+
+void runOperation(Device *device, const QString &operation,
+                  const QByteArray &buffer, QJsonObject &result) {
+    QByteArray data;
+    bool success = false;
+    device->resetStats();
+    Emulator::resetDelayTime();
+    QElapsedTimer timer;
+    timer.start();
+    if (operation == "erase") {
+        success = device->erase();
+    } else if (operation == "blank-check") {
+        success = device->blankCheck();
+    } else if (operation == "program") {
+        success = device->program(buffer);
+    } else if (operation == "verify") {
+        success = device->verify(buffer);
+    } else if (operation == "read") {
+        success = device->read(data) && data == buffer;
+    }
+    qint64 hostNs = timer.nsecsElapsed();
+    TOpCodeStats total = device->getStats().getTotal();
+    uint64_t deviceUs = Emulator::getDelayTime();
+    uint64_t totalUs = total.totalUs + deviceUs;
+    result["operation"] = operation;
+    result["success"] = success;
+    result["commands"] = static_cast<qint64>(total.calls);
+    result["bytesOut"] = static_cast<qint64>(total.bytesOut);
+    result["bytesIn"] = static_cast<qint64>(total.bytesIn);
+    result["linkMs"] = total.totalUs / 1000.0;
+    result["deviceMs"] = deviceUs / 1000.0;
+    result["totalMs"] = totalUs / 1000.0;
+    result["hostMs"] = hostNs / 1000000.0;
+    result["bytesPerSec"] =
+        totalUs ? static_cast<qint64>(buffer.size() * 1000000ull / totalUs)
+                : 0;
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("ufprog_bench");
+
+    QStringList chips;
+    for (const char *item : kChipFamilies) chips << item;
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+        "Throughput benchmark of the device classes against an emulated "
+        "programmer.");
+    parser.addHelpOption();
+    QCommandLineOption chipOption(
+        {"c", "chip"},
+        "Chip families, comma separated (default: all): " + chips.join(", ") +
+            ".",
+        "families");
+    QCommandLineOption sizeOption(
+        {"s", "size"}, "Chip size in bytes (default: 0x8000).", "bytes");
+    QCommandLineOption latencyOption(
+        "latency", "Link latency per transfer, in us (default: 500).", "us");
+    QCommandLineOption bandwidthOption(
+        "bandwidth",
+        "Link bandwidth, in bytes/s (default: 1000000, 0 for unlimited).",
+        "bytes/s");
+    QCommandLineOption bufferOption(
+        "buffer-size", "USB buffer size (default: from the device).",
+        "bytes");
+    QCommandLineOption twpOption(
+        "twp", "Program pulse, in us (default: from the device).", "us");
+    QCommandLineOption twcOption(
+        "twc", "Program cycle, in us (default: from the device).", "us");
+    QCommandLineOption repeatOption(
+        "repeat", "Number of runs of each chip (default: 1).", "count");
+    QCommandLineOption seedOption(
+        "seed", "Seed of the random data (default: 1).", "seed");
+    QCommandLineOption formatOption(
+        "format", "Output format: csv (default) or json.", "format");
+    parser.addOptions({chipOption, sizeOption, latencyOption,
+                       bandwidthOption, bufferOption, twpOption, twcOption,
+                       repeatOption, seedOption, formatOption});
+    parser.process(app);
+
+    QLoggingCategory::setFilterRules("*=false");
+
+    QStringList families = chips;
+    if (parser.isSet(chipOption)) {
+        families.clear();
+        for (const QString &item : parser.value(chipOption).split(",")) {
+            if (!item.trimmed().isEmpty()) families << item.trimmed();
+        }
+    }
+    bool ok = true;
+    uint32_t size = parser.isSet(sizeOption)
+                        ? parser.value(sizeOption).toUInt(&ok, 0)
+                        : 0x8000;
+    uint32_t latency = parser.isSet(latencyOption)
+                           ? parser.value(latencyOption).toUInt()
+                           : 500;
+    uint32_t bandwidth = parser.isSet(bandwidthOption)
+                             ? parser.value(bandwidthOption).toUInt()
+                             : 1000000;
+    int repeat = parser.isSet(repeatOption)
+                     ? parser.value(repeatOption).toInt()
+                     : 1;
+    quint32 seed = parser.isSet(seedOption)
+                       ? parser.value(seedOption).toUInt()
+                       : 1;
+    QString format = parser.value(formatOption);
+    if (!ok || !size || repeat <= 0 ||
+        (!format.isEmpty() && format != "csv" && format != "json")) {
+        QTextStream(stderr) << "invalid arguments (see --help)\n";
+        return 2;
+    }
+    for (const QString &family : families) {
+        if (!chips.contains(family)) {
+            QTextStream(stderr) << "unknown chip family: " << family << "\n";
+            return 2;
+        }
+    }
+
+    Transport::registerType(kLoopbackPrefix, [latency, bandwidth] {
+        auto transport =
+            static_cast<LoopbackTransport *>(Emulator::createTransport());
+        transport->setLink(latency, bandwidth);
+        return transport;
+    });
+    QByteArray buffer(size, 0);
+    QRandomGenerator random(seed);
+    for (int i = 0; i < buffer.size(); i++) {
+        buffer[i] = static_cast<char>(random.generate());
+    }
+
+    QJsonArray results;
+    bool success = true;
+    for (const QString &family : families) {
+        for (int run = 1; run <= repeat; run++) {
+            TBenchTarget target;
+            createTarget(family, target);
+            Device *device = target.device.get();
+            Emulator::setChip(target.chip.get());
+            target.chip->setSize(size);
+            device->setPort(QString(kLoopbackPrefix) + "bench");
+            device->setSize(size);
+            if (parser.isSet(bufferOption)) {
+                device->setBufferSize(parser.value(bufferOption).toUInt());
+            }
+            if (parser.isSet(twpOption)) {
+                device->setTwp(parser.value(twpOption).toUInt());
+            }
+            if (parser.isSet(twcOption)) {
+                device->setTwc(parser.value(twcOption).toUInt());
+            }
+            const TDeviceCapabilities &cap = device->getInfo().capability;
+            QStringList operations;
+            if (cap.hasErase) operations << "erase";
+            if (cap.hasBlankCheck) operations << "blank-check";
+            if (cap.hasProgram) operations << "program";
+            if (cap.hasVerify) operations << "verify";
+            if (cap.hasRead) operations << "read";
+            for (const QString &operation : operations) {
+                QJsonObject result;
+                result["chip"] = family;
+                result["size"] = static_cast<qint64>(size);
+                result["run"] = run;
+                runOperation(device, operation, buffer, result);
+                if (!result["success"].toBool()) success = false;
+                results.append(result);
+            }
+            Emulator::setChip(nullptr);
+        }
+    }
+
+    QTextStream out(stdout);
+    if (format == "json") {
+        QJsonObject doc;
+        doc["latencyUs"] = static_cast<qint64>(latency);
+        doc["bandwidth"] = static_cast<qint64>(bandwidth);
+        doc["seed"] = static_cast<qint64>(seed);
+        doc["results"] = results;
+        out << QJsonDocument(doc).toJson(QJsonDocument::Indented);
+    } else {
+        QStringList header;
+        for (const char *column : kColumns) header << column;
+        out << header.join(",") << "\n";
+        for (const auto &item : results) {
+            QJsonObject result = item.toObject();
+            QStringList row;
+            for (const char *column : kColumns) {
+                row << result[column].toVariant().toString();
+            }
+            out << row.join(",") << "\n";
+        }
+    }
+    return success ? 0 : 1;
+}
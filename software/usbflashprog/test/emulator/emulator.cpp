@@ -16,15 +16,27 @@
 // ---------------------------------------------------------------------------
 
 #include <QRandomGenerator>
-#include <chrono>
-#include <thread>
+#include <cstring>
+#include <memory>
 
-#include "../../backend/devices/device.hpp"
+#include "../../backend/checksum.hpp"
+#include "../../backend/rle.hpp"
+#include "../../backend/transport/loopback.hpp"
 #include "emulator.hpp"
 
 // ---------------------------------------------------------------------------
 
 static BaseParChip* globalEmuParChip_ = nullptr;
+static uint64_t globalEmuDelayUs_ = 0;
+
+// ---------------------------------------------------------------------------
+
+/* @brief Maximum length of the buffer opcodes (as the firmware). */
+constexpr uint16_t kEmuMaxBufferSize = 4096;
+/* @brief Maximum length of a frame payload (as the firmware). */
+constexpr uint16_t kEmuFrameMaxSize = 4352;
+/* @brief Size of the receive ring of Write Range (as the firmware). */
+constexpr uint32_t kEmuRingSize = 4096;
 
 // ---------------------------------------------------------------------------
 
@@ -38,476 +50,736 @@ static BaseParChip* globalEmuParChip_ = nullptr;
 
 // ---------------------------------------------------------------------------
 
-Emulator::Emulator(QObject* parent)
-    : vdd_(5.0f),
+Emulator::Emulator()
+    : framed_(false),
+      frameSeq_(-1),
+      tagged_(false),
+      fenced_(false),
+      encoding_(kCmdProtoEncodingRaw),
+      streamTagged_(false),
+      rangeRemaining_(0),
+      rangeEncoded_(false),
+      writeRangeBlock_(0),
+      writeRangeBlocks_(0),
+      writeRangeReceived_(0),
+      writeRangeProgrammed_(0),
+      writeRangeCredits_(0),
+      writeRangeAllowed_(0),
+      writeRangeSector_(false),
+      writeRangeEncoded_(false),
+      writeRangeFailed_(false),
+      vdd_(5.0f),
       vpp_(12.0f),
-      timeout_(200),
-      running_(false),
-      error_(false),
       address_(0),
-      bufferSize_(1),
+      error_(false),
       twp_(1),
       twc_(1),
       algo_(kCmdDeviceAlgorithmUnknown) {
-    // clang-format off
-    flags_.skipFF      = false;
-    flags_.progWithVpp = false;
-    flags_.vppOePin    = false;
-    flags_.pgmCePin    = false;
-    flags_.pgmPositive = false;
-    flags_.is16bit     = false;
-    // clang-format on
-}
-
-Emulator::~Emulator() {
-    close();
-}
-
-TSerialPortList Emulator::list() const {
-    return QSerialPortInfo::availablePorts();
-}
-
-bool Emulator::open(const QString& path) {
-    if (running_) close();
-    if (path.isNull() || path.isEmpty()) return false;
-    path_ = path;
-    running_ = true;
-    error_ = false;
-    return true;
-}
-
-void Emulator::close() {
-    running_ = false;
-    error_ = false;
-    path_.clear();
-}
-
-bool Emulator::isOpen() const {
-    return running_;
-}
-
-bool Emulator::hasError() const {
-    return error_;
-}
-
-QString Emulator::getPath() const {
-    return path_;
-}
-
-uint32_t Emulator::getTimeOut() const {
-    return timeout_;
-}
-
-void Emulator::setTimeOut(uint32_t value) {
-    if (timeout_ == value) return;
-    timeout_ = value;
+    configure_(0);
 }
 
-uint8_t Emulator::getBufferSize() const {
-    return bufferSize_;
-}
-
-void Emulator::setBufferSize(uint8_t value) {
-    if (!value) value = 1;
-    // rounds to next power of two
-    if (value & (value - 1)) {
-        uint32_t exp = 1;
-        // clang-format off
-        for (exp = 1; (1 << exp) < value; exp++) {}
-        // clang-format on
-        if (exp > 7) exp = 7;  // max 128
-        value = 1 << exp;
-    }
-    if (flags_.is16bit && value == 1) value = 2;
-    if (bufferSize_ == value) return;
-    bufferSize_ = value;
-}
-
-bool Emulator::nop() {
-    if (error_ || !running_) {
-        error_ = true;
-        return false;
-    }
-    return true;
-}
-
-bool Emulator::vddCtrl(bool on) {
-    if (error_ || !running_ || !globalEmuParChip_) {
-        error_ = true;
-        return false;
-    }
-    globalEmuParChip_->setVDD(on);
-    return true;
-}
-
-bool Emulator::vddSet(float value) {
-    if (error_ || !running_) {
-        error_ = true;
-        return false;
-    }
-    vdd_ = value;
-    return true;
-}
-
-float Emulator::vddGet() {
-    if (error_ || !running_) {
-        error_ = true;
-        return -1.0f;
-    }
-    return vdd_;
-}
-
-float Emulator::vddGetDuty() {
-    if (error_ || !running_) {
-        error_ = true;
-        return -1.0f;
-    }
-    // fake
-    return 50.0f;
-}
-
-bool Emulator::vddInitCal() {
-    if (error_ || !running_) {
-        error_ = true;
-        return false;
-    }
-    return true;
-}
-
-bool Emulator::vddSaveCal(float value) {
-    (void)value;
-    if (error_ || !running_) {
-        error_ = true;
-        return false;
-    }
-    return true;
-}
-
-float Emulator::vddGetCal() {
-    if (error_ || !running_) {
-        error_ = true;
-        return -1.0f;
-    }
-    // fake
-    return vdd_;
-}
-
-bool Emulator::vppCtrl(bool on) {
-    if (error_ || !running_ || !globalEmuParChip_) {
-        error_ = true;
-        return false;
-    }
-    globalEmuParChip_->setVPP(on);
-    return true;
-}
-
-bool Emulator::vppSet(float value) {
-    if (error_ || !running_) {
-        error_ = true;
-        return false;
-    }
-    vpp_ = value;
-    return true;
-}
-
-float Emulator::vppGet() {
-    if (error_ || !running_) {
-        error_ = true;
-        return -1.0f;
-    }
-    return vpp_;
-}
-
-float Emulator::vppGetDuty() {
-    if (error_ || !running_) {
-        error_ = true;
-        return -1.0f;
-    }
-    // fake
-    return 50.0f;
-}
-
-bool Emulator::vppInitCal() {
-    if (error_ || !running_) {
-        error_ = true;
-        return false;
+QByteArray Emulator::receive(const QByteArray& data) {
+    input_.append(data);
+    while (step_()) {
     }
-    return true;
+    // poll: the next chunk of the stream
+    if (data.isEmpty() && rangeRemaining_) readRangeChunk_();
+    QByteArray result;
+    result.swap(output_);
+    return result;
 }
 
-bool Emulator::vppSaveCal(float value) {
-    (void)value;
-    if (error_ || !running_) {
-        error_ = true;
-        return false;
-    }
-    return true;
+Transport* Emulator::createTransport() {
+    std::shared_ptr<Emulator> emulator = std::make_shared<Emulator>();
+    return new LoopbackTransport(
+        [emulator](const QByteArray& data) { return emulator->receive(data); });
 }
 
-float Emulator::vppGetCal() {
-    if (error_ || !running_) {
-        error_ = true;
-        return -1.0f;
-    }
-    // fake
-    return vpp_;
+void Emulator::usDelay(uint64_t value) {
+    globalEmuDelayUs_ += value;
 }
 
-bool Emulator::vddOnVpp(bool on) {
-    (void)on;
-    if (error_ || !running_) {
-        error_ = true;
-        return false;
-    }
-    return true;
+void Emulator::msDelay(uint32_t value) {
+    globalEmuDelayUs_ += static_cast<uint64_t>(value) * 1000;
 }
 
-bool Emulator::vppOnA9(bool on) {
-    (void)on;
-    if (error_ || !running_) {
-        error_ = true;
-        return false;
-    }
-    return true;
+uint64_t Emulator::getDelayTime() {
+    return globalEmuDelayUs_;
 }
 
-bool Emulator::vppOnA18(bool on) {
-    (void)on;
-    if (error_ || !running_) {
-        error_ = true;
-        return false;
-    }
-    return true;
+void Emulator::resetDelayTime() {
+    globalEmuDelayUs_ = 0;
 }
 
-bool Emulator::vppOnCE(bool on) {
-    (void)on;
-    if (error_ || !running_) {
-        error_ = true;
-        return false;
-    }
-    return true;
-}
-
-bool Emulator::vppOnOE(bool on) {
-    (void)on;
-    if (error_ || !running_) {
-        error_ = true;
-        return false;
-    }
-    return true;
+void Emulator::setChip(BaseParChip* chip) {
+    if (globalEmuParChip_ == chip) return;
+    globalEmuParChip_ = chip;
 }
 
-bool Emulator::vppOnWE(bool on) {
-    (void)on;
-    if (error_ || !running_) {
-        error_ = true;
-        return false;
+void Emulator::randomizeBuffer(QByteArray& buffer, uint32_t size) {
+    if (!size) return;
+    buffer.resize(size);
+    for (int i = 0; i < buffer.size(); ++i) {
+        buffer[i] = static_cast<char>(QRandomGenerator::global()->generate());
     }
-    return true;
 }
 
-bool Emulator::setCE(bool on) {
-    if (error_ || !running_ || !globalEmuParChip_) {
-        error_ = true;
-        return false;
-    }
-    globalEmuParChip_->setCE(on);
+bool Emulator::step_() {
+    if (input_.isEmpty()) return false;
+    if (rangeRemaining_) {
+        // any byte from host cancels the stream
+        input_.remove(0, 1);
+        rangeRemaining_ = 0;
+        putChar_(kCmdResponseNok);
+        fenced_ = streamTagged_;
+        return true;
+    }
+    if (writeRangeBlocks_) return writeRangeNext_();
+    uint8_t code = static_cast<uint8_t>(input_[0]);
+    TCmdOpCode opcode = OpCode::getOpCode(code);
+    if (opcode.code != code) {
+        // opcode not found
+        runCommand_(input_.left(1));
+        input_.remove(0, 1);
+        return true;
+    }
+    int size = opcode.params + 1;
+    if (input_.size() < size) return false;
+    if (code == kCmdProtoFrame) {
+        uint16_t len = OpCode::getValueAsWord(input_.constData() + 1, 3);
+        if (len > kEmuFrameMaxSize) {
+            // corrupted frame: discards the rest of the input
+            uint8_t seq = static_cast<uint8_t>(input_[1]);
+            input_.clear();
+            putFrame_(seq, QByteArray());
+            return true;
+        }
+        size += len + 2;
+        if (input_.size() < size) return false;
+        QByteArray frame = input_.left(size);
+        input_.remove(0, size);
+        runFrame_(frame);
+        return true;
+    }
+    size += dataSize_(input_.left(size));
+    if (input_.size() < size) return false;
+    QByteArray command = input_.left(size);
+    input_.remove(0, size);
+    runCommand_(command);
     return true;
 }
 
-bool Emulator::setOE(bool on) {
-    if (error_ || !running_ || !globalEmuParChip_) {
-        error_ = true;
-        return false;
+int Emulator::dataSize_(const QByteArray& command) const {
+    const char* params = command.constData();
+    int size = command.size();
+    switch (static_cast<uint8_t>(command[0])) {
+        case kCmdDeviceWrite:
+        case kCmdDeviceVerify:
+            return OpCode::getValueAsByte(params, size);
+        case kCmdDeviceWriteW:
+        case kCmdDeviceVerifyW:
+        case kCmdDeviceWriteSector:
+            return OpCode::getValueAsWord(params, size);
+        default:
+            return 0;
+    }
+}
+
+void Emulator::runCommand_(const QByteArray& command) {
+    uint8_t code = command.isEmpty() ? 0 : static_cast<uint8_t>(command[0]);
+    TCmdOpCode opcode = OpCode::getOpCode(code);
+    int size = opcode.params + 1;
+    if (command.isEmpty() || opcode.code != code || command.size() < size) {
+        // opcode not found or nparams invalid
+        putChar_(kCmdResponseNok);
+        tagged_ = false;
+        encoding_ = kCmdProtoEncodingRaw;
+        return;
+    }
+    // an unframed command ends the retransmission of the last frame
+    if (!framed_) frameSeq_ = -1;
+    if (code == kCmdProtoTag) {
+        // echoes the tag, the response of the next command follows it
+        putChar_(OpCode::getValueAsByte(command.constData(), size));
+        tagged_ = true;
+        return;
+    }
+    if (code == kCmdProtoEncoding) {
+        // selects the encoding of the stream of the next command
+        encoding_ = OpCode::getValueAsByte(command.constData(), size);
+        if (encoding_ == kCmdProtoEncodingRaw ||
+            encoding_ == kCmdProtoEncodingRle) {
+            putChar_(kCmdResponseOk);
+        } else {
+            encoding_ = kCmdProtoEncodingRaw;
+            putChar_(kCmdResponseNok);
+        }
+        return;
     }
-    globalEmuParChip_->setOE(on);
-    return true;
-}
-
-bool Emulator::setWE(bool on) {
-    if (error_ || !running_ || !globalEmuParChip_) {
-        error_ = true;
-        return false;
+    // an untagged command ends the discarding of a failed pipeline
+    if (!tagged_) fenced_ = false;
+    if (fenced_) {
+        // the data of the command was received with it (discarded)
+        putChar_(kCmdResponseNok);
+    } else {
+        error_ = false;
+        runOpCode_(code, command, size);
+    }
+    tagged_ = false;
+    encoding_ = kCmdProtoEncodingRaw;
+}
+
+void Emulator::runOpCode_(uint8_t code, const QByteArray& command,
+                          int size) {
+    const char* params = command.constData();
+    const char* data = params + size;
+    int len = dataSize_(command);
+    bool is16bit = flags_.is16bit;
+    bool success;
+    uint32_t id, value;
+    uint8_t keep;
+    QByteArray buffer;
+    switch (code) {
+        case kCmdNop:
+            putChar_(kCmdResponseOk);
+            break;
+        case kCmdProtoCaps:
+            buffer.resize(6);
+            buffer[0] = static_cast<char>(kCmdResponseOk);
+            buffer[1] = static_cast<char>(kCmdProtoVersion);
+            OpCode::setWord(buffer.data() + 1, 3, kEmuMaxBufferSize);
+            OpCode::setWord(
+                buffer.data() + 3, 3,
+                kCmdProtoFeatureTag | kCmdProtoFeatureWide |
+                    kCmdProtoFeatureReadRange | kCmdProtoFeatureWriteRange |
+                    kCmdProtoFeatureCrc32Range | kCmdProtoFeatureBlankRange |
+                    kCmdProtoFeatureRle | kCmdProtoFeatureDeviceSetup |
+                    kCmdProtoFeatureFrame);
+            putBuf_(buffer);
+            break;
+        case kCmdVddCtrl:
+            vddCtrl_(OpCode::getValueAsBool(params, size));
+            putChar_(kCmdResponseOk);
+            break;
+        case kCmdVppCtrl:
+            vppCtrl_(OpCode::getValueAsBool(params, size));
+            putChar_(kCmdResponseOk);
+            break;
+        case kCmdVddSetV:
+            vdd_ = OpCode::getValueAsFloat(params, size);
+            putChar_(kCmdResponseOk);
+            break;
+        case kCmdVppSetV:
+            vpp_ = OpCode::getValueAsFloat(params, size);
+            putChar_(kCmdResponseOk);
+            break;
+        case kCmdVddGetV:
+        case kCmdVddGetCal:
+            putFloat_(vdd_);
+            break;
+        case kCmdVppGetV:
+        case kCmdVppGetCal:
+            putFloat_(vpp_);
+            break;
+        case kCmdVddGetDuty:
+        case kCmdVppGetDuty:
+            // fake
+            putFloat_(50.0f);
+            break;
+        case kCmdVddInitCal:
+        case kCmdVddSaveCal:
+        case kCmdVddOnVpp:
+        case kCmdVppInitCal:
+        case kCmdVppSaveCal:
+        case kCmdVppOnA9:
+        case kCmdVppOnA18:
+        case kCmdVppOnCE:
+        case kCmdVppOnOE:
+        case kCmdVppOnWE:
+            putChar_(kCmdResponseOk);
+            break;
+        case kCmdBusCE:
+            setCE_(OpCode::getValueAsBool(params, size));
+            putChar_(kCmdResponseOk);
+            break;
+        case kCmdBusOE:
+            setOE_(OpCode::getValueAsBool(params, size));
+            putChar_(kCmdResponseOk);
+            break;
+        case kCmdBusWE:
+            setWE_(OpCode::getValueAsBool(params, size));
+            putChar_(kCmdResponseOk);
+            break;
+        case kCmdBusAddrClr:
+        case kCmdBusAddrInc:
+        case kCmdBusAddrSet:
+        case kCmdBusAddrSetB:
+        case kCmdBusAddrSetW:
+            if (code == kCmdBusAddrClr) {
+                success = addrClr_();
+            } else if (code == kCmdBusAddrInc) {
+                success = addrInc_();
+            } else {
+                success = addrSet_(OpCode::getValueAsDWord(params, size));
+            }
+            putChar_(success ? kCmdResponseOk : kCmdResponseNok);
+            break;
+        case kCmdBusDataClr:
+        case kCmdBusDataSet:
+        case kCmdBusDataSetW:
+            success = dataSet_((code == kCmdBusDataClr)
+                                   ? 0
+                                   : OpCode::getValueAsWord(params, size));
+            putChar_(success ? kCmdResponseOk : kCmdResponseNok);
+            break;
+        case kCmdBusDataGet:
+            putValue_(dataGet_() & 0xFF, 1);
+            break;
+        case kCmdBusDataGetW:
+            putValue_(dataGet_(), 2);
+            break;
+        case kCmdDeviceSetTwp:
+            twp_ = OpCode::getValueAsDWord(params, size);
+            putChar_(kCmdResponseOk);
+            break;
+        case kCmdDeviceSetTwc:
+            twc_ = OpCode::getValueAsDWord(params, size);
+            putChar_(kCmdResponseOk);
+            break;
+        case kCmdDeviceConfigure:
+            configure_(OpCode::getValueAsWord(params, size));
+            putChar_(kCmdResponseOk);
+            break;
+        case kCmdDeviceSetupBus:
+            if (deviceSetupBus_(OpCode::getValueAsByte(params, size))) {
+                putChar_(kCmdResponseOk);
+            } else {
+                putFailure_();
+            }
+            break;
+        case kCmdDeviceSetup:
+            // validates all the params before applying any of them
+            value = OpCode::getValueAsWord(params, 3);
+            keep = static_cast<uint8_t>(params[16]);
+            if (!isAlgorithm_(value >> 8) ||
+                static_cast<uint8_t>(params[15]) > kCmdDeviceOperationGetId) {
+                putFailure_();
+                break;
+            }
+            configure_(value);
+            if (!(keep & kCmdDeviceSetupKeepTwp)) {
+                twp_ = OpCode::getValueAsDWord(params + 6, 5);
+            }
+            if (!(keep & kCmdDeviceSetupKeepTwc)) {
+                twc_ = OpCode::getValueAsDWord(params + 10, 5);
+            }
+            if (!(keep & kCmdDeviceSetupKeepVdd)) {
+                vdd_ = OpCode::getValueAsFloat(params + 2, 3);
+            }
+            if (!(keep & kCmdDeviceSetupKeepVpp)) {
+                vpp_ = OpCode::getValueAsFloat(params + 4, 3);
+            }
+            if (deviceSetupBus_(static_cast<uint8_t>(params[15]))) {
+                putChar_(kCmdResponseOk);
+            } else {
+                putFailure_();
+            }
+            break;
+        case kCmdDeviceRead:
+        case kCmdDeviceReadW:
+            len = (code == kCmdDeviceRead)
+                      ? OpCode::getValueAsByte(params, size)
+                      : OpCode::getValueAsWord(params, size);
+            buffer.append(static_cast<char>(kCmdResponseOk));
+            if (readBuffer_(is16bit ? (len / 2) : len, buffer) &&
+                buffer.size() == len + 1) {
+                putBuf_(buffer);
+            } else {
+                putFailure_();
+            }
+            break;
+        case kCmdDeviceReadRange:
+            readRange_(OpCode::getValueAsDWord(params, 4),
+                       OpCode::getValueAsDWord(params + 3, 4));
+            break;
+        case kCmdDeviceWrite:
+        case kCmdDeviceWriteW:
+        case kCmdDeviceWriteSector:
+        case kCmdDeviceVerify:
+        case kCmdDeviceVerifyW:
+            // a frame may bring less data than the command requires
+            success = (command.size() - size >= len);
+            if (success && (code == kCmdDeviceWrite ||
+                            code == kCmdDeviceWriteW)) {
+                success = writeBuffer_(data, len);
+            } else if (success && code == kCmdDeviceWriteSector) {
+                success = writeSector_(data, len);
+            } else if (success) {
+                success = verifyBuffer_(data, len);
+            }
+            if (success) {
+                putChar_(kCmdResponseOk);
+            } else {
+                putFailure_();
+            }
+            break;
+        case kCmdDeviceWriteRange:
+            writeRange_(OpCode::getValueAsDWord(params, 4),
+                        OpCode::getValueAsDWord(params + 3, 4),
+                        OpCode::getValueAsWord(params + 6, 3),
+                        OpCode::getValueAsBool(params + 8, 2));
+            break;
+        case kCmdDeviceBlankCheck:
+        case kCmdDeviceBlankCheckW:
+            len = (code == kCmdDeviceBlankCheck)
+                      ? OpCode::getValueAsByte(params, size)
+                      : OpCode::getValueAsWord(params, size);
+            if (blankCheckBuffer_(is16bit ? (len / 2) : len, value, id,
+                                  false) &&
+                !value) {
+                putChar_(kCmdResponseOk);
+            } else {
+                putFailure_();
+            }
+            break;
+        case kCmdDeviceCrc32Range:
+            crc32Range_(OpCode::getValueAsDWord(params, 4),
+                        OpCode::getValueAsDWord(params + 3, 4));
+            break;
+        case kCmdDeviceBlankCheckRange:
+            blankCheckRange_(OpCode::getValueAsDWord(params, 4),
+                             OpCode::getValueAsDWord(params + 3, 4));
+            break;
+        case kCmdDeviceGetId:
+            if (deviceGetId_(id)) {
+                putValue_(id, 4);
+            } else {
+                putChar_(kCmdResponseNok);
+            }
+            break;
+        case kCmdDeviceErase:
+            putChar_(deviceErase_() ? kCmdResponseOk : kCmdResponseNok);
+            break;
+        case kCmdDeviceProtect:
+        case kCmdDeviceUnprotect:
+            success = deviceProtect_(code == kCmdDeviceProtect);
+            putChar_(success ? kCmdResponseOk : kCmdResponseNok);
+            break;
+        default:
+            putChar_(kCmdResponseNok);
+            break;
     }
-    globalEmuParChip_->setWE(on);
-    return true;
 }
 
-bool Emulator::addrClr() {
-    if (error_ || !running_ || !globalEmuParChip_) {
-        error_ = true;
-        return false;
+void Emulator::runFrame_(const QByteArray& frame) {
+    uint8_t seq = static_cast<uint8_t>(frame[1]);
+    int len = frame.size() - 6;
+    uint16_t crc = Checksum::crc16(frame.constData() + 1, len + 3, 0);
+    if (crc != OpCode::getValueAsWord(frame.constData() + len + 3, 3)) {
+        // corrupted frame: discards the rest of the input
+        input_.clear();
+        putFrame_(seq, QByteArray());
+        return;
+    }
+    if (!seq) {
+        // synchronization
+        frameSeq_ = -1;
+        putFrame_(seq, QByteArray());
+        return;
+    }
+    if (seq == frameSeq_) {
+        // retransmission: resends the last response, without running
+        putFrame_(seq, frameOut_);
+        return;
+    }
+    QByteArray payload = frame.mid(4, len);
+    uint8_t code = len ? static_cast<uint8_t>(payload[0]) : 0;
+    frameOut_.clear();
+    framed_ = true;
+    if (!len || OpCode::getOpCode(code).code != code ||
+        !isFrameable_(code)) {
+        putChar_(kCmdResponseNok);
+    } else {
+        runCommand_(payload);
     }
-    address_ = 0;
-    globalEmuParChip_->setAddrBus(address_);
-    return true;
+    framed_ = false;
+    frameSeq_ = seq;
+    putFrame_(seq, frameOut_);
 }
 
-bool Emulator::addrInc() {
-    if (error_ || !running_ || !globalEmuParChip_) {
-        error_ = true;
-        return false;
+bool Emulator::isFrameable_(uint8_t code) {
+    switch (code) {
+        case kCmdDeviceReadRange:
+        case kCmdDeviceWriteRange:
+        case kCmdProtoTag:
+        case kCmdProtoEncoding:
+        case kCmdProtoFrame:
+            return false;
+        default:
+            return true;
     }
-    address_++;
-    globalEmuParChip_->setAddrBus(address_);
-    return true;
 }
 
-bool Emulator::addrSet(uint32_t value) {
-    if (!value) return addrClr();
-    if (error_ || !running_ || !globalEmuParChip_) {
-        error_ = true;
-        return false;
+bool Emulator::isAlgorithm_(uint8_t algo) {
+    switch (algo) {
+        case kCmdDeviceAlgorithmUnknown:
+        case kCmdDeviceAlgorithmSRAM:
+        case kCmdDeviceAlgorithmEPROM:
+        case kCmdDeviceAlgorithmEEPROM28C64:
+        case kCmdDeviceAlgorithmEEPROM28C256:
+        case kCmdDeviceAlgorithmFlash28F:
+        case kCmdDeviceAlgorithmFlashSST28SF:
+        case kCmdDeviceAlgorithmFlashAm28F:
+        case kCmdDeviceAlgorithmFlashI28F:
+            return true;
+        default:
+            return false;
     }
-    address_ = value;
-    globalEmuParChip_->setAddrBus(address_);
-    return true;
 }
 
-bool Emulator::addrSetB(uint8_t value) {
-    if (!value) return addrClr();
-    if (error_ || !running_ || !globalEmuParChip_) {
-        error_ = true;
-        return false;
-    }
-    address_ = value;
-    globalEmuParChip_->setAddrBus(address_);
-    return true;
+void Emulator::putFrame_(uint8_t seq, const QByteArray& payload) {
+    QByteArray frame(3, 0);
+    frame[0] = static_cast<char>(seq);
+    OpCode::setWord(frame.data(), 3, payload.size());
+    frame.append(payload);
+    uint16_t crc = Checksum::crc16(frame.constData(), frame.size(), 0);
+    frame.append(static_cast<char>((crc >> 8) & 0xFF));
+    frame.append(static_cast<char>(crc & 0xFF));
+    output_.append(frame);
 }
 
-bool Emulator::addrSetW(uint16_t value) {
-    if (!value) return addrClr();
-    if (error_ || !running_ || !globalEmuParChip_) {
-        error_ = true;
-        return false;
-    }
-    address_ = value;
-    globalEmuParChip_->setAddrBus(address_);
-    return true;
+void Emulator::putChar_(uint8_t c) {
+    (framed_ ? frameOut_ : output_).append(static_cast<char>(c));
 }
 
-uint32_t Emulator::addrGet() const {
-    return address_;
+void Emulator::putBuf_(const QByteArray& data) {
+    (framed_ ? frameOut_ : output_).append(data);
 }
 
-bool Emulator::dataClr() {
-    if (error_ || !running_ || !globalEmuParChip_) {
-        error_ = true;
-        return false;
+void Emulator::putValue_(uint32_t value, int size) {
+    QByteArray response(size + 1, 0);
+    response[0] = static_cast<char>(kCmdResponseOk);
+    if (size == 1) {
+        OpCode::setByte(response.data(), 2, value);
+    } else if (size == 2) {
+        OpCode::setWord(response.data(), 3, value);
+    } else {
+        OpCode::setDWord(response.data(), 5, value);
     }
-    globalEmuParChip_->setDataBus(0);
-    return true;
+    putBuf_(response);
 }
 
-bool Emulator::dataSet(uint8_t value) {
-    if (!value) return dataClr();
-    if (error_ || !running_ || !globalEmuParChip_) {
-        error_ = true;
-        return false;
-    }
-    globalEmuParChip_->setDataBus(value);
-    return true;
+void Emulator::putFloat_(float value) {
+    QByteArray response(3, 0);
+    response[0] = static_cast<char>(kCmdResponseOk);
+    OpCode::setFloat(response.data(), 3, value);
+    putBuf_(response);
 }
 
-bool Emulator::dataSetW(uint16_t value) {
-    if (!value) return dataClr();
-    if (error_ || !running_ || !globalEmuParChip_) {
-        error_ = true;
-        return false;
-    }
-    globalEmuParChip_->setDataBus(value);
-    return true;
+void Emulator::putFailure_() {
+    putChar_(kCmdResponseNok);
+    fenced_ = tagged_;
 }
 
-uint8_t Emulator::dataGet() {
-    if (error_ || !running_ || !globalEmuParChip_) {
-        error_ = true;
-        return 0xff;
+void Emulator::readRange_(uint32_t addr, uint32_t size) {
+    if ((flags_.is16bit && (size % 2)) || (size && !addrSet_(addr))) {
+        putFailure_();
+        return;
     }
-    uint16_t data = globalEmuParChip_->getDataBus();
-    return static_cast<uint8_t>(data & 0xff);
+    putChar_(kCmdResponseOk);
+    // the chunks are sent when the host polls (see receive())
+    rangeRemaining_ = size;
+    rangeEncoded_ = (encoding_ == kCmdProtoEncodingRle);
+    streamTagged_ = tagged_;
 }
 
-uint16_t Emulator::dataGetW() {
-    if (error_ || !running_ || !globalEmuParChip_) {
-        error_ = true;
-        return 0xffff;
+void Emulator::readRangeChunk_() {
+    uint32_t len =
+        qMin(rangeRemaining_, static_cast<uint32_t>(kCmdStreamChunkSize));
+    QByteArray chunk(1, static_cast<char>(kCmdResponseOk));
+    error_ = false;
+    if (!readBuffer_(flags_.is16bit ? (len / 2) : len, chunk)) {
+        // error: ends the stream
+        rangeRemaining_ = 0;
+        putChar_(kCmdResponseNok);
+        fenced_ = streamTagged_;
+        return;
+    }
+    uint16_t crc = Checksum::crc16(chunk.constData() + 1, len);
+    if (rangeEncoded_) {
+        // OK + encoded length + encoded data + CRC16 (of decoded data)
+        QByteArray encoded(Rle::maxEncodedSize(len) + 3, 0);
+        size_t encodedLen =
+            Rle::encode(chunk.constData() + 1, len, encoded.data() + 3);
+        encoded[0] = static_cast<char>(kCmdResponseOk);
+        OpCode::setWord(encoded.data(), 3, encodedLen);
+        encoded.resize(encodedLen + 3);
+        chunk.swap(encoded);
+    }
+    chunk.append(static_cast<char>((crc >> 8) & 0xFF));
+    chunk.append(static_cast<char>(crc & 0xFF));
+    putBuf_(chunk);
+    rangeRemaining_ -= len;
+}
+
+void Emulator::writeRange_(uint32_t addr, uint32_t size, uint16_t block,
+                           bool sector) {
+    bool rle = (encoding_ == kCmdProtoEncodingRle);
+    // one slot per block: [encoded length] + data + CRC16
+    uint32_t slot = rle ? (Rle::maxEncodedSize(block) + 4) : (block + 2);
+    uint32_t credits = qMin<uint32_t>(kEmuRingSize / slot, 0xFF);
+    if (size && (!block || block > kCmdStreamChunkSize || (size % block) ||
+                 (flags_.is16bit && (block % 2)) || !addrSet_(addr))) {
+        putFailure_();
+        putChar_(0);
+        return;
+    }
+    putChar_(kCmdResponseOk);
+    putChar_(credits);
+    if (!size) return;
+    writeRangeBlock_ = block;
+    writeRangeBlocks_ = size / block;
+    writeRangeReceived_ = 0;
+    writeRangeProgrammed_ = 0;
+    writeRangeCredits_ = credits;
+    writeRangeAllowed_ = writeRangeBlocks_;
+    writeRangeSector_ = sector;
+    writeRangeEncoded_ = rle;
+    writeRangeFailed_ = false;
+    streamTagged_ = tagged_;
+}
+
+bool Emulator::writeRangeNext_() {
+    // [encoded length] + data + CRC16
+    int size = writeRangeBlock_ + 2;
+    if (writeRangeEncoded_) {
+        // encoded length (MSB first)
+        if (input_.size() < 2) return false;
+        size = ((static_cast<uint8_t>(input_[0]) << 8) |
+                static_cast<uint8_t>(input_[1])) +
+               4;
+    }
+    if (input_.size() < size) return false;
+    if (!writeRangeFailed_) {
+        QByteArray block(writeRangeBlock_, 0);
+        const char* data = input_.constData();
+        bool success = true;
+        if (writeRangeEncoded_) {
+            size_t decoded = 0;
+            size_t slot = Rle::maxEncodedSize(writeRangeBlock_) + 4;
+            // an encoded block larger than the slot is an error
+            success = (static_cast<size_t>(size) <= slot) &&
+                      Rle::decode(data + 2, size - 4, block.data(),
+                                  block.size(), decoded) &&
+                      decoded == static_cast<size_t>(block.size());
+        } else {
+            memcpy(block.data(), data, block.size());
+        }
+        // CRC error (or canceled by host)
+        success = success &&
+                  Checksum::crc16(block.constData(), block.size()) ==
+                      OpCode::getValueAsWord(data + size - 3, 3);
+        error_ = false;
+        if (success) {
+            success = writeRangeSector_
+                          ? writeSector_(block.constData(), block.size())
+                          : writeBuffer_(block.constData(), block.size());
+        }
+        if (success) {
+            writeRangeProgrammed_++;
+            putChar_(kCmdResponseOk);
+        } else {
+            writeRangeFailed_ = true;
+            putChar_(kCmdResponseNok);
+            fenced_ = streamTagged_;
+            // discards the blocks that the host is allowed to send
+            writeRangeAllowed_ =
+                qMin(writeRangeBlocks_,
+                     writeRangeProgrammed_ + writeRangeCredits_);
+        }
     }
-    return globalEmuParChip_->getDataBus();
-}
-
-bool Emulator::deviceSetTwp(uint32_t value) {
-    if (value == twp_) return true;
-    twp_ = value;
-    return true;
-}
-
-bool Emulator::deviceSetTwc(uint32_t value) {
-    if (value == twc_) return true;
-    twc_ = value;
+    input_.remove(0, size);
+    writeRangeReceived_++;
+    if (writeRangeReceived_ >= writeRangeAllowed_) writeRangeBlocks_ = 0;
     return true;
 }
 
-bool Emulator::deviceConfigure(kCmdDeviceAlgorithmEnum algo,
-                               const TDeviceFlags& flags) {
+void Emulator::crc32Range_(uint32_t addr, uint32_t size) {
+    bool success = !(flags_.is16bit && (size % 2)) &&
+                   (!size || addrSet_(addr));
+    uint32_t crc = 0;
+    QByteArray chunk;
+    uint32_t len;
+    while (success && size) {
+        len = qMin(size, static_cast<uint32_t>(kCmdStreamChunkSize));
+        chunk.clear();
+        success = readBuffer_(flags_.is16bit ? (len / 2) : len, chunk);
+        crc = Checksum::crc32(chunk.constData(), chunk.size(), crc);
+        size -= len;
+    }
+    if (!success && tagged_) {
+        // in a pipeline, a NOK has no result
+        putFailure_();
+        return;
+    }
+    QByteArray response(5, 0);
+    response[0] = static_cast<char>(success ? kCmdResponseOk
+                                            : kCmdResponseNok);
+    OpCode::setDWord(response.data(), 5, success ? crc : 0);
+    putBuf_(response);
+}
+
+void Emulator::blankCheckRange_(uint32_t addr, uint32_t size) {
+    uint32_t dirty = 0, first = 0;
+    bool success =
+        !(flags_.is16bit && (size % 2)) &&
+        (!size ||
+         (addrSet_(addr) &&
+          blankCheckBuffer_(flags_.is16bit ? (size / 2) : size, dirty,
+                            first, true)));
+    if (!success && tagged_) {
+        // in a pipeline, a NOK has no result
+        putFailure_();
+        return;
+    }
+    QByteArray response(9, 0);
+    response[0] = static_cast<char>(success ? kCmdResponseOk
+                                            : kCmdResponseNok);
+    OpCode::setDWord(response.data(), 5, (success && dirty) ? addr + first : 0);
+    OpCode::setDWord(response.data() + 4, 5, success ? dirty : 0);
+    putBuf_(response);
+}
+
+void Emulator::configure_(uint16_t config) {
+    algo_ = (config >> 8) & 0xFF;
     // clang-format off
-    flags_.skipFF      = flags.skipFF     ;
-    flags_.progWithVpp = flags.progWithVpp;
-    flags_.vppOePin    = flags.vppOePin   ;
-    flags_.pgmCePin    = flags.pgmCePin   ;
-    flags_.pgmPositive = flags.pgmPositive;
-    flags_.is16bit     = flags.is16bit    ;
+    flags_.skipFF      = (config & 0x01);
+    flags_.progWithVpp = (config & 0x02);
+    flags_.vppOePin    = (config & 0x04);
+    flags_.pgmCePin    = (config & 0x08);
+    flags_.pgmPositive = (config & 0x10);
+    flags_.is16bit     = (config & 0x20);
     // clang-format on
-    algo_ = algo;
-    if (flags.is16bit && bufferSize_ == 1) setBufferSize(2);
-    return true;
-}
-
-bool Emulator::deviceSetupBus(kCmdDeviceOperationEnum operation) {
-    if (error_ || !running_ || !globalEmuParChip_) {
-        error_ = true;
-        return false;
-    }
-    return deviceSetupBus_(operation);
-}
-
-bool Emulator::deviceResetBus() {
-    return deviceSetupBus(kCmdDeviceOperationReset);
 }
 
-QByteArray Emulator::deviceRead() {
-    QByteArray result;
-    if (error_ || !running_ || !globalEmuParChip_) {
-        error_ = true;
-        return result;
-    }
+bool Emulator::readBuffer_(uint32_t count, QByteArray& buffer) {
     uint16_t data;
-    int increment = flags_.is16bit ? 2 : 1;
-    for (int i = 0; i < bufferSize_; i += increment) {
+    for (uint32_t i = 0; i < count; i++) {
         data = deviceRead_();
         // inc address
-        addrInc();
-        if (error_) {
-            result.clear();
-            break;
-        }
-        if (flags_.is16bit) result.append((data & 0xFF00) >> 8);
-        result.append(data & 0xFF);
+        addrInc_();
+        if (error_) return false;
+        if (flags_.is16bit) buffer.append((data & 0xFF00) >> 8);
+        buffer.append(data & 0xFF);
     }
-    return result;
+    return true;
 }
 
-bool Emulator::deviceWrite(const QByteArray& data) {
-    if (error_ || !running_ || !globalEmuParChip_) {
-        error_ = true;
-        return false;
-    }
-    if (data.size() != bufferSize_) return false;
-    uint32_t startAddr = addrGet();
+bool Emulator::writeBuffer_(const char* data, int size) {
+    if (flags_.is16bit && (size % 2)) return false;
     uint16_t rd, wr;
     int increment = flags_.is16bit ? 2 : 1;
-    for (int i = 0; i < bufferSize_; i += increment) {
+    for (int i = 0; i < size; i += increment) {
         wr = data[i] & 0xFF;
         if (flags_.is16bit) {
             wr <<= 8;
@@ -515,7 +787,7 @@ bool Emulator::deviceWrite(const QByteArray& data) {
         }
         if (!deviceWrite_(wr)) return false;
         // PGM/~CE is LO
-        if (flags_.pgmCePin) setWE(true);
+        if (flags_.pgmCePin) setWE_(true);
         // read
         rd = deviceRead_(true);
         // verify
@@ -525,22 +797,17 @@ bool Emulator::deviceWrite(const QByteArray& data) {
         }
         if (error_ || rd != wr) return false;
         // inc address
-        addrInc();
+        addrInc_();
     }
-    if (error_) return false;
-    return true;
+    return !error_;
 }
 
-bool Emulator::deviceWriteSector(const QByteArray& data, uint16_t sectorSize) {
-    if (error_ || !running_ || !globalEmuParChip_) {
-        error_ = true;
-        return false;
-    }
-    if (data.size() != sectorSize) return false;
-    uint32_t startAddr = addrGet();
-    uint16_t rd, wr;
+bool Emulator::writeSector_(const char* data, int size) {
+    if (flags_.is16bit && (size % 2)) return false;
+    uint32_t startAddr = address_;
+    uint16_t wr;
     int increment = flags_.is16bit ? 2 : 1;
-    for (int i = 0; i < sectorSize; i += increment) {
+    for (int i = 0; i < size; i += increment) {
         wr = data[i] & 0xFF;
         if (flags_.is16bit) {
             wr <<= 8;
@@ -548,44 +815,24 @@ bool Emulator::deviceWriteSector(const QByteArray& data, uint16_t sectorSize) {
         }
         if (!deviceWrite_(wr)) return false;
         // inc address
-        addrInc();
+        addrInc_();
     }
     if (error_) return false;
     // PGM/~CE is LO
-    if (flags_.pgmCePin) setWE(true);
-    addrSet(startAddr);
-    for (int i = 0; i < sectorSize; i += increment) {
-        wr = data[i] & 0xFF;
-        if (flags_.is16bit) {
-            wr <<= 8;
-            wr |= (data[i + 1] & 0xFF);
-        }
-        // read
-        rd = deviceRead_();
-        // verify
-        if (!flags_.is16bit) {
-            rd &= 0xFF;
-            wr &= 0xFF;
-        }
-        if (error_ || rd != wr) return false;
-        // inc address
-        addrInc();
-    }
-    if (error_) return false;
-    return true;
+    if (flags_.pgmCePin) setWE_(true);
+    uint32_t endAddr = address_;
+    addrSet_(startAddr);
+    if (!verifyBuffer_(data, size)) return false;
+    return addrSet_(endAddr);
 }
 
-bool Emulator::deviceVerify(const QByteArray& data) {
-    if (error_ || !running_ || !globalEmuParChip_) {
-        error_ = true;
-        return false;
-    }
-    if (data.size() != bufferSize_) return false;
+bool Emulator::verifyBuffer_(const char* data, int size) {
+    if (flags_.is16bit && (size % 2)) return false;
     uint16_t rd, wr;
     int increment = flags_.is16bit ? 2 : 1;
     // PGM/~CE is LO
-    if (flags_.pgmCePin) setWE(true);
-    for (int i = 0; i < bufferSize_; i += increment) {
+    if (flags_.pgmCePin) setWE_(true);
+    for (int i = 0; i < size; i += increment) {
         wr = data[i] & 0xFF;
         if (flags_.is16bit) {
             wr <<= 8;
@@ -600,96 +847,108 @@ bool Emulator::deviceVerify(const QByteArray& data) {
         }
         if (error_ || rd != wr) return false;
         // inc address
-        addrInc();
+        addrInc_();
     }
-    if (error_) return false;
-    return true;
+    return !error_;
 }
 
-bool Emulator::deviceBlankCheck() {
-    if (error_ || !running_ || !globalEmuParChip_) {
-        error_ = true;
-        return false;
-    }
-    uint16_t rd, wr = 0xFFFF;
-    int increment = flags_.is16bit ? 2 : 1;
+bool Emulator::blankCheckBuffer_(uint32_t count, uint32_t& dirty,
+                                 uint32_t& first, bool range) {
+    uint16_t rd, blank = flags_.is16bit ? 0xFFFF : 0xFF;
+    dirty = 0;
+    first = count;
     // PGM/~CE is LO
-    if (flags_.pgmCePin) setWE(true);
-    for (int i = 0; i < bufferSize_; i += increment) {
+    if (flags_.pgmCePin) setWE_(true);
+    for (uint32_t i = 0; i < count; i++) {
         // read
         rd = deviceRead_();
-        if (!flags_.is16bit) {
-            rd &= 0xFF;
-            wr &= 0xFF;
+        if (!flags_.is16bit) rd &= 0xFF;
+        // check
+        if (rd != blank) {
+            if (!dirty) first = i;
+            dirty++;
+            if (!range) break;
         }
-        // verify
-        if (error_ || rd != wr) return false;
         // inc address
-        addrInc();
+        addrInc_();
+        if (error_) return false;
     }
-    if (error_) return false;
     return true;
 }
 
-TDeviceID Emulator::deviceGetId() {
-    TDeviceID result;
-    if (error_ || !running_ || !globalEmuParChip_) {
+void Emulator::vddCtrl_(bool on) {
+    if (!globalEmuParChip_) {
         error_ = true;
-        return result;
+        return;
     }
-    result = deviceGetId_();
-    return result;
+    globalEmuParChip_->setVDD(on);
 }
 
-bool Emulator::deviceErase() {
-    if (error_ || !running_ || !globalEmuParChip_) {
+void Emulator::vppCtrl_(bool on) {
+    if (!globalEmuParChip_) {
         error_ = true;
-        return false;
+        return;
     }
-    return deviceErase_();
+    globalEmuParChip_->setVPP(on);
 }
 
-bool Emulator::deviceUnprotect() {
-    if (error_ || !running_ || !globalEmuParChip_) {
+void Emulator::setCE_(bool on) {
+    if (!globalEmuParChip_) {
         error_ = true;
-        return false;
+        return;
     }
-    return deviceProtect_(false);
+    globalEmuParChip_->setCE(on);
 }
 
-bool Emulator::deviceProtect() {
-    if (error_ || !running_ || !globalEmuParChip_) {
+void Emulator::setOE_(bool on) {
+    if (!globalEmuParChip_) {
         error_ = true;
-        return false;
+        return;
     }
-    return deviceProtect_(true);
+    globalEmuParChip_->setOE(on);
 }
 
-void Emulator::usDelay(uint64_t value) {
-    (void)value;
-    return;
+void Emulator::setWE_(bool on) {
+    if (!globalEmuParChip_) {
+        error_ = true;
+        return;
+    }
+    globalEmuParChip_->setWE(on);
 }
 
-void Emulator::msDelay(uint32_t value) {
-    (void)value;
-    return;
+bool Emulator::addrClr_() {
+    return addrSet_(0);
 }
 
-void Emulator::processEvents() {
-    return;
+bool Emulator::addrInc_() {
+    return addrSet_(address_ + 1);
 }
 
-void Emulator::setChip(BaseParChip* chip) {
-    if (globalEmuParChip_ == chip) return;
-    globalEmuParChip_ = chip;
+bool Emulator::addrSet_(uint32_t value) {
+    if (!globalEmuParChip_) {
+        error_ = true;
+        return false;
+    }
+    address_ = value;
+    globalEmuParChip_->setAddrBus(address_);
+    return true;
 }
 
-void Emulator::randomizeBuffer(QByteArray& buffer, uint32_t size) {
-    if (!size) return;
-    buffer.resize(size);
-    for (int i = 0; i < buffer.size(); ++i) {
-        buffer[i] = static_cast<char>(QRandomGenerator::global()->generate());
+bool Emulator::dataSet_(uint16_t value) {
+    if (!globalEmuParChip_) {
+        error_ = true;
+        return false;
+    }
+    globalEmuParChip_->setDataBus(value);
+    return true;
+}
+
+uint16_t Emulator::dataGet_() {
+    if (!globalEmuParChip_) {
+        error_ = true;
+        return 0xFFFF;
     }
+    return globalEmuParChip_->getDataBus();
 }
 
 uint16_t Emulator::deviceRead_(bool fromProg, bool sendCmd) {
@@ -702,20 +961,13 @@ uint16_t Emulator::deviceRead_(bool fromProg, bool sendCmd) {
             deviceSendCmdRead_();
         }
     }
-    // ~OE/VPP is LO
-    if (flags_.vppOePin) vddOnVpp(false);
     // ~OE is LO
-    setOE(true);
+    setOE_(true);
     // get data
-    if (flags_.is16bit) {
-        data = dataGetW();
-    } else {
-        data = dataGet();
-    }
+    data = dataGet_();
+    if (!flags_.is16bit) data &= 0xFF;
     // ~OE is HI
-    setOE(false);
-    // ~OE/VPP is VDD
-    if (flags_.vppOePin) vddOnVpp(true);
+    setOE_(false);
     return data;
 }
 
@@ -727,29 +979,24 @@ bool Emulator::deviceWrite_(uint16_t value, bool disableSkipFF, bool disableVpp,
     if (!flags_.skipFF || !emptyData || disableSkipFF) {
         if (flags_.progWithVpp && !disableVpp) {
             // VPP on
-            vddOnVpp(false);
-            vppCtrl(true);
+            vppCtrl_(true);
         }
         // Send write command (if in the algorithm)
         if (sendCmd) deviceSendCmdWrite_();
         // Set DataBus
-        if (flags_.is16bit) {
-            dataSetW(value);
-        } else {
-            dataSet(value);
-        }
+        dataSet_(value);
         if (flags_.pgmPositive) {
             // PGM is HI (start prog pulse)
-            setWE(false);
+            setWE_(false);
             usDelay(twp_);  // tWP uS
             // PGM is LO (end prog pulse)
-            setWE(true);
+            setWE_(true);
         } else {
             // ~PGM is LO (start prog pulse)
-            setWE(true);
+            setWE_(true);
             usDelay(twp_);  // tWP uS
             // ~PGM is HI (end prog pulse)
-            setWE(false);
+            setWE_(false);
         }
         usDelay(twc_);  // tWC uS
         // check status (if in the algorithm)
@@ -758,8 +1005,7 @@ bool Emulator::deviceWrite_(uint16_t value, bool disableSkipFF, bool disableVpp,
         }
         if (flags_.progWithVpp && !disableVpp) {
             // VPP off
-            vppCtrl(false);
-            vddOnVpp(true);
+            vppCtrl_(false);
         }
         if (error_) return false;
     }
@@ -769,7 +1015,7 @@ bool Emulator::deviceWrite_(uint16_t value, bool disableSkipFF, bool disableVpp,
 bool Emulator::writeAtAddr_(uint32_t addr, uint16_t data, bool disableVpp,
                             bool sendCmd) {
     bool success = true;
-    if (!addrSet(addr)) success = false;
+    if (!addrSet_(addr)) success = false;
     if (!deviceWrite_(data, true, disableVpp, sendCmd)) success = false;
     // sleep tWP
     usDelay(twp_);
@@ -779,7 +1025,7 @@ bool Emulator::writeAtAddr_(uint32_t addr, uint16_t data, bool disableVpp,
 uint16_t Emulator::readAtAddr_(uint32_t addr, bool sendCmd) {
     // Read one byte/word at address
     // set address
-    if (!addrSet(addr)) return (flags_.is16bit ? 0xFFFF : 0xFF);
+    if (!addrSet_(addr)) return (flags_.is16bit ? 0xFFFF : 0xFF);
     // read data
     return deviceRead_(false, sendCmd);
 }
@@ -793,7 +1039,7 @@ bool Emulator::deviceSendCmd_(const TDeviceCommand* cmd, size_t size,
     uint32_t addr;
     for (int i = 0; i < count; i++) {
         // get addr (current or cmd defined)
-        addr = (cmd[i].addr == ANY_ADDRESS) ? addrGet() : cmd[i].addr;
+        addr = (cmd[i].addr == ANY_ADDRESS) ? address_ : cmd[i].addr;
         // write at address, without call sendcmd itself
         if (!writeAtAddr_(addr, cmd[i].data, disableVpp, false)) {
             success = false;
@@ -809,11 +1055,11 @@ bool Emulator::deviceCheckStatus_() {
     switch (algo_) {
         case kCmdDeviceAlgorithmFlashI28F:
             // ~OE is LO
-            setOE(true);
+            setOE_(true);
             // get status byte
-            status = dataGet();
+            status = dataGet_() & 0xFF;
             // ~OE is HI
-            setOE(false);
+            setOE_(false);
             // Status == OK
             return (status & 0xFE) == kDeviceStatusByteOkI28F;
         default:
@@ -892,86 +1138,71 @@ bool Emulator::deviceSendCmdGetId_() {
     }
 }
 
-bool Emulator::deviceSetupBus_(kCmdDeviceOperationEnum operation) {
+bool Emulator::deviceSetupBus_(uint8_t operation) {
     // reset bus
     // VDD off and VPP off
-    vddCtrl(false);
-    vppCtrl(false);
-    vddOnVpp(false);
+    vddCtrl_(false);
+    vppCtrl_(false);
     // Clear AddrBus
-    addrClr();
+    addrClr_();
     // ~OE is HI
-    setOE(false);
+    setOE_(false);
     // ~CE is HI
-    setCE(false);
+    setCE_(false);
     if (flags_.pgmPositive) {
         // PGM is LO (no prog pulse)
-        setWE(true);
+        setWE_(true);
     } else {
         // ~PGM is HI (no prog pulse)
-        setWE(false);
+        setWE_(false);
     }
-    // VPP on xx disabled
-    vppOnA9(false);
-    vppOnA18(false);
-    vppOnCE(false);
-    vppOnOE(false);
-    vppOnWE(false);
     // Clear DataBus
-    dataClr();
+    dataSet_(0);
 
     // setupbus
     switch (operation) {
         case kCmdDeviceOperationRead:
             // VDD Rd on
-            vddCtrl(true);
-            // VDD Rd on VPP
-            vddOnVpp(true);
+            vddCtrl_(true);
             if (flags_.pgmCePin) {
                 // PGM/~CE is LO
-                setWE(true);
+                setWE_(true);
             } else {
                 // ~PGM is HI
-                setWE(false);
+                setWE_(false);
             }
             // ~CE is LO (if pin connected)
-            setCE(true);
+            setCE_(true);
             break;
         case kCmdDeviceOperationProg:
             // VDD Wr on
-            vddCtrl(true);
+            vddCtrl_(true);
             if (flags_.pgmPositive) {
                 // PGM is LO
-                setWE(true);
+                setWE_(true);
             } else {
                 // ~PGM is HI
-                setWE(false);
+                setWE_(false);
             }
             // ~CE is LO (if pin connected)
-            setCE(true);
+            setCE_(true);
             // Disable Software Data Protection (if any)
             disableSDP_();
             break;
         case kCmdDeviceOperationGetId:
             // VDD Rd on
-            vddCtrl(true);
+            vddCtrl_(true);
             if (flags_.pgmCePin) {
                 // PGM/~CE is LO
-                setWE(true);
+                setWE_(true);
             } else {
                 // ~PGM is HI
-                setWE(false);
+                setWE_(false);
             }
             // ~CE is LO (if pin connected)
-            setCE(true);
-            if (!flags_.vppOePin) {
-                // VDD Rd on VPP
-                vddOnVpp(true);
-            }
+            setCE_(true);
             // ~OE is LO
-            setOE(true);
-            // VPP on A9
-            vppOnA9(true);
+            setOE_(true);
             break;
         case kCmdDeviceOperationReset:
         default:
@@ -981,29 +1212,26 @@ bool Emulator::deviceSetupBus_(kCmdDeviceOperationEnum operation) {
     return !error_;
 }
 
-TDeviceID Emulator::deviceGetId_() {
-    TDeviceID result;
+bool Emulator::deviceGetId_(uint32_t& id) {
     // Setup bus
-    if (!deviceSetupBus_(kCmdDeviceOperationGetId)) return result;
+    if (!deviceSetupBus_(kCmdDeviceOperationGetId)) return false;
     uint16_t manufacturer, device;
     // Send GetID command
     deviceSendCmdGetId_();
 
     // Get manufacturer data
-    manufacturer = flags_.is16bit ? dataGetW() : dataGet();
+    manufacturer = flags_.is16bit ? dataGet_() : (dataGet_() & 0xFF);
     // Increment Address (0x01)
-    addrInc();
+    addrInc_();
     // Get device data
-    device = flags_.is16bit ? dataGetW() : dataGet();
+    device = flags_.is16bit ? dataGet_() : (dataGet_() & 0xFF);
 
     // If success, return data
-    if (!error_) {
-        result.manufacturer = manufacturer;
-        result.device = device;
-    }
+    bool success = !error_;
+    if (success) id = (manufacturer << 16) | device;
     // Close resources
     deviceSetupBus_(kCmdDeviceOperationReset);
-    return result;
+    return success;
 }
 
 bool Emulator::deviceErase_() {
@@ -1041,29 +1269,25 @@ bool Emulator::deviceErase27E_() {
     // Erase entire chip
     // 27E Algorithm
     // Addr = 0
-    addrClr();
+    addrClr_();
     // Data = 0xFF
-    dataSetW(0xFFFF);
-    // VPP on A9
-    vppOnA9(true);
+    dataSet_(0xFFFF);
     if (flags_.pgmPositive) {
         // PGM is HI (start erase pulse)
-        setWE(false);
+        setWE_(false);
         msDelay(100);  // Erase Pulse
         // PGM is LO (end erase pulse)
-        setWE(true);
+        setWE_(true);
     } else {
         // ~PGM is LO (start erase pulse)
-        setWE(true);
+        setWE_(true);
         msDelay(100);  // Erase Pulse
         // ~PGM is HI (end erase pulse)
-        setWE(false);
+        setWE_(false);
     }
     usDelay(twc_);  // tWC uS
-    // VPP on A9 off
-    vppOnA9(false);
     // PGM/~CE is LO
-    if (flags_.pgmCePin) setWE(true);
+    if (flags_.pgmCePin) setWE_(true);
     return !error_;
 }
 
@@ -1082,7 +1306,7 @@ bool Emulator::deviceProtect28C_(bool protect, bool is256) {
     // EEPROM 28C/X28/AT28 Protect/Unprotect Algorithm
     bool success = true;
     // ~CE is LO
-    setCE(true);
+    setCE_(true);
     // write command
     if (protect && !is256) {
         success = SEND_CMD(kDeviceCmdProtect28C64);
@@ -1096,7 +1320,7 @@ bool Emulator::deviceProtect28C_(bool protect, bool is256) {
     // sleep tWC
     usDelay(twc_);
     // ~CE is HI
-    setCE(false);
+    setCE_(false);
     return success;
 }
 
@@ -1110,5 +1334,6 @@ void Emulator::disableSdpFlashSST28SF_() {
         // read at address, without call sendcmd itself
         readAtAddr_(addr, false);
     }
-    addrClr();
-}
\ No newline at end of file
+    addrClr_();
+}
+
@@ -20,188 +20,65 @@
 
 // ---------------------------------------------------------------------------
 
-#include <QObject>
-#include <QString>
-#include <QList>
+#include <QByteArray>
 
-#include "mock/qserialport.hpp"
 #include "chip.hpp"
 #include "devcmd.hpp"
 
 #include "../../backend/opcodes.hpp"
-
-// ---------------------------------------------------------------------------
-
-/**
- * @ingroup UnitTests
- * @brief List of serial ports info.
- */
-typedef QList<QSerialPortInfo> TSerialPortList;
-
-// ---------------------------------------------------------------------------
-// Forward
-struct TDeviceID;
+#include "../../backend/transport/transport.hpp"
 
 // ---------------------------------------------------------------------------
 
 /**
  * @ingroup UnitTests
  * @brief Emulator Class.
- * @details The purpose of this class is to run commands and get response
- *   via Chip Emulator (for tests).
+ * @details The purpose of this class is to emulate the programmer (the
+ *   firmware protocol and the device algorithms) over the Chip Emulator,
+ *   behind a LoopbackTransport, so the tests run the real Runner.
+ *   <br/>Usage:
+ *   @code
+ *   Transport::registerType(kLoopbackPrefix, Emulator::createTransport);
+ *   Emulator::setChip(chip);
+ *   device->setPort("loopback:emulator");
+ *   @endcode
  * @nosubgrouping
  */
-class Emulator : public QObject {
-    Q_OBJECT
-
+class Emulator {
   public:
-    /** @brief Device settings. */
-    typedef struct TDeviceFlags {
-        /** @brief Skip Write 0xFF. */
-        bool skipFF;
-        /** @brief Prog with VPP on. */
-        bool progWithVpp;
-        /** @brief VPP/~OE Pin. */
-        bool vppOePin;
-        /** @brief ~PGM/~CE Pin. */
-        bool pgmCePin;
-        /** @brief PGM positive. */
-        bool pgmPositive;
-        /** @brief 16-bit mode. */
-        bool is16bit;
-    } TDeviceFlags;
-
-  public:
-    /** @copydoc Runner::Runner(QObject*) */
-    explicit Emulator(QObject* parent = nullptr);
-    /** @copydoc Runner::~Runner() */
-    ~Emulator();
-    /** @copydoc Runner::list() */
-    TSerialPortList list() const;
-    /** @copydoc Runner::open(const QString&) */
-    bool open(const QString& path);
-    /** @copydoc Runner::close() */
-    void close();
-    /** @copydoc Runner::isOpen() */
-    bool isOpen() const;
-    /** @copydoc Runner::hasError() */
-    bool hasError() const;
-    /** @copydoc Runner::getPath() */
-    QString getPath() const;
-    /** @copydoc Runner::getTimeOut() */
-    uint32_t getTimeOut() const;
-    /** @copydoc Runner::setTimeOut(uint32_t) */
-    void setTimeOut(uint32_t value);
-    /** @copydoc Runner::getBufferSize() */
-    uint8_t getBufferSize() const;
-    /** @copydoc Runner::setBufferSize(uint8_t) */
-    void setBufferSize(uint8_t value);
-    /** @copydoc Runner::nop() */
-    bool nop();
-    /** @copydoc Runner::vddCtrl(bool) */
-    bool vddCtrl(bool on = true);
-    /** @copydoc Runner::vddSet(float) */
-    bool vddSet(float value);
-    /** @copydoc Runner::vddGet() */
-    float vddGet();
-    /** @copydoc Runner::vddGetDuty() */
-    float vddGetDuty();
-    /** @copydoc Runner::vddInitCal() */
-    bool vddInitCal();
-    /** @copydoc Runner::vddSaveCal(float) */
-    bool vddSaveCal(float value);
-    /** @copydoc Runner::vddGetCal() */
-    float vddGetCal();
-    /** @copydoc Runner::vppCtrl(bool) */
-    bool vppCtrl(bool on = true);
-    /** @copydoc Runner::vppSet(float) */
-    bool vppSet(float value);
-    /** @copydoc Runner::vppGet() */
-    float vppGet();
-    /** @copydoc Runner::vppGetDuty() */
-    float vppGetDuty();
-    /** @copydoc Runner::vppInitCal() */
-    bool vppInitCal();
-    /** @copydoc Runner::vppSaveCal(float) */
-    bool vppSaveCal(float value);
-    /** @copydoc Runner::vppGetCal() */
-    float vppGetCal();
-    /** @copydoc Runner::vddOnVpp(bool) */
-    bool vddOnVpp(bool on = true);
-    /** @copydoc Runner::vppOnA9(bool) */
-    bool vppOnA9(bool on = true);
-    /** @copydoc Runner::vppOnA18(bool) */
-    bool vppOnA18(bool on = true);
-    /** @copydoc Runner::vppOnCE(bool) */
-    bool vppOnCE(bool on = true);
-    /** @copydoc Runner::vppOnOE(bool) */
-    bool vppOnOE(bool on = true);
-    /** @copydoc Runner::vppOnWE(bool) */
-    bool vppOnWE(bool on = true);
-    /** @copydoc Runner::setCE(bool) */
-    bool setCE(bool on = true);
-    /** @copydoc Runner::setOE(bool) */
-    bool setOE(bool on = true);
-    /** @copydoc Runner::setWE(bool) */
-    bool setWE(bool on = true);
-    /** @copydoc Runner::addrClr() */
-    bool addrClr();
-    /** @copydoc Runner::addrInc() */
-    bool addrInc();
-    /** @copydoc Runner::addrSet(uint32_t) */
-    bool addrSet(uint32_t value);
-    /** @copydoc Runner::addrSetB(uint8_t) */
-    bool addrSetB(uint8_t value);
-    /** @copydoc Runner::addrSetW(uint16_t) */
-    bool addrSetW(uint16_t value);
-    /** @copydoc Runner::addrGet() */
-    uint32_t addrGet() const;
-    /** @copydoc Runner::dataClr() */
-    bool dataClr();
-    /** @copydoc Runner::dataSet(uint8_t) */
-    bool dataSet(uint8_t value);
-    /** @copydoc Runner::dataSetW(uint16_t) */
-    bool dataSetW(uint16_t value);
-    /** @copydoc Runner::dataGet() */
-    uint8_t dataGet();
-    /** @copydoc Runner::dataGetW() */
-    uint16_t dataGetW();
-    /** @copydoc Runner::deviceSetTwp(uint32_t) */
-    bool deviceSetTwp(uint32_t value);
-    /** @copydoc Runner::deviceSetTwc(uint32_t) */
-    bool deviceSetTwc(uint32_t value);
-    /** @copydoc
-     * Runner::deviceConfigure(kCmdDeviceAlgorithmEnum, const TDeviceFlags&) */
-    bool deviceConfigure(kCmdDeviceAlgorithmEnum algo,
-                         const TDeviceFlags& flags);
-    /** @copydoc Runner::deviceSetupBus(kCmdDeviceOperationEnum) */
-    bool deviceSetupBus(kCmdDeviceOperationEnum operation);
-    /** @copydoc Runner::deviceResetBus() */
-    bool deviceResetBus();
-    /** @copydoc Runner::deviceRead() */
-    QByteArray deviceRead();
-    /** @copydoc Runner::deviceWrite(const QByteArray&) */
-    bool deviceWrite(const QByteArray& data);
-    /** @copydoc Runner::deviceWriteSector(const QByteArray&, uint16_t) */
-    bool deviceWriteSector(const QByteArray& data, uint16_t sectorSize);
-    /** @copydoc Runner::deviceVerify(const QByteArray&) */
-    bool deviceVerify(const QByteArray& data);
-    /** @copydoc Runner::deviceBlankCheck() */
-    bool deviceBlankCheck();
-    /** @copydoc Runner::deviceGetId() */
-    TDeviceID deviceGetId();
-    /** @copydoc Runner::deviceErase() */
-    bool deviceErase();
-    /** @copydoc Runner::deviceUnprotect() */
-    bool deviceUnprotect();
-    /** @copydoc Runner::deviceProtect() */
-    bool deviceProtect();
-    /** @copydoc Runner::usDelay(uint64_t) */
+    /** @brief Constructor. */
+    Emulator();
+    /**
+     * @brief Runs the data sent by the host (see TLoopbackHandler).
+     * @details An incomplete command waits for the rest of its data. Empty
+     *   data is a poll, that sends the next chunk of a Read Range stream.
+     * @param data Data sent by the host.
+     * @return Data sent back to the host (may be empty).
+     */
+    QByteArray receive(const QByteArray& data);
+    /**
+     * @brief Creates a loopback transport to a new emulated programmer.
+     * @return Pointer to the new transport (owned by the caller).
+     */
+    static Transport* createTransport();
+    /**
+     * @brief Waits (emulated) for the given time.
+     * @param value Time, in microseconds.
+     */
     static void usDelay(uint64_t value);
-    /** @copydoc Runner::msDelay(uint32_t) */
+    /**
+     * @brief Waits (emulated) for the given time.
+     * @param value Time, in milliseconds.
+     */
     static void msDelay(uint32_t value);
-    /** @copydoc Runner::processEvents() */
-    static void processEvents();
+    /**
+     * @brief Returns the time spent by the emulated device in delays
+     *   (tWP, tWC, erase pulses) since resetDelayTime() (global).
+     * @return Time, in microseconds.
+     */
+    static uint64_t getDelayTime();
+    /** @brief Resets the time spent in delays (global). */
+    static void resetDelayTime();
     /**
      * @brief Sets the chip for emulation (global).
      * @param chip Pointer to instance of the Chip Class.
@@ -215,21 +92,69 @@ class Emulator : public QObject {
     static void randomizeBuffer(QByteArray& buffer, uint32_t size);
 
   private:
-    /* @brief Stores the serial port path. */
-    QString path_;
+    /* @brief Device settings. */
+    typedef struct TDeviceFlags {
+        /* @brief Skip Write 0xFF. */
+        bool skipFF;
+        /* @brief Prog with VPP on. */
+        bool progWithVpp;
+        /* @brief VPP/~OE Pin. */
+        bool vppOePin;
+        /* @brief ~PGM/~CE Pin. */
+        bool pgmCePin;
+        /* @brief PGM positive. */
+        bool pgmPositive;
+        /* @brief 16-bit mode. */
+        bool is16bit;
+    } TDeviceFlags;
+
+    /* @brief Data received and not run yet. */
+    QByteArray input_;
+    /* @brief Data to send to the host. */
+    QByteArray output_;
+    /* @brief Response of the last frame. */
+    QByteArray frameOut_;
+    /* @brief Indicates if running a framed command. */
+    bool framed_;
+    /* @brief Sequence of the last frame (-1 if none). */
+    int frameSeq_;
+    /* @brief Indicates if the current command is tagged. */
+    bool tagged_;
+    /* @brief Indicates if discarding a failed pipeline. */
+    bool fenced_;
+    /* @brief Encoding of the stream of the next command. */
+    uint8_t encoding_;
+    /* @brief Indicates if the current stream was tagged. */
+    bool streamTagged_;
+    /* @brief Bytes remaining in the current Read Range stream. */
+    uint32_t rangeRemaining_;
+    /* @brief Indicates if the Read Range stream is encoded (RLE). */
+    bool rangeEncoded_;
+    /* @brief Block size of the current Write Range stream, in bytes. */
+    uint16_t writeRangeBlock_;
+    /* @brief Blocks of the current Write Range stream (0 if none). */
+    uint32_t writeRangeBlocks_;
+    /* @brief Blocks received in the current Write Range stream. */
+    uint32_t writeRangeReceived_;
+    /* @brief Blocks programmed in the current Write Range stream. */
+    uint32_t writeRangeProgrammed_;
+    /* @brief Blocks the host is allowed to send ahead. */
+    uint32_t writeRangeCredits_;
+    /* @brief Blocks to receive (and discard) after an error. */
+    uint32_t writeRangeAllowed_;
+    /* @brief Indicates if the Write Range stream writes sectors. */
+    bool writeRangeSector_;
+    /* @brief Indicates if the Write Range stream is encoded (RLE). */
+    bool writeRangeEncoded_;
+    /* @brief Indicates if the Write Range stream failed. */
+    bool writeRangeFailed_;
     /* @brief Stores the VDD value, in volts. */
     float vdd_;
     /* @brief Stores the VPP value, in volts. */
     float vpp_;
-    /* @brief Command timeout, in msec. */
-    uint32_t timeout_;
-    /* @brief Stores if is running. */
-    bool running_;
     /* @brief Stores the last address. */
     uint32_t address_;
-    /* @brief Buffer size, in bytes. */
-    uint8_t bufferSize_;
-    /* @brief Indicates if an error occurred in the last operation. */
+    /* @brief Indicates if the chip failed in the current command. */
     bool error_;
     /* @brief tWP Setting (microseconds). */
     uint32_t twp_;
@@ -239,6 +164,106 @@ class Emulator : public QObject {
     TDeviceFlags flags_;
     /* @brief Stores device algorithm. */
     uint8_t algo_;
+
+    /* @brief Runs the next command (or block) of the input.
+     * @return True if run, false if the input is incomplete. */
+    bool step_();
+    /* @brief Returns the size of the data sent after the parameters.
+     * @param command Opcode and parameters of the command.
+     * @return Size of the data, in bytes. */
+    int dataSize_(const QByteArray& command) const;
+    /* @brief Runs a command.
+     * @param command Opcode, parameters and data of the command. */
+    void runCommand_(const QByteArray& command);
+    /* @brief Runs the handler of an opcode (already checked).
+     * @param code OpCode.
+     * @param command Opcode, parameters and data of the command.
+     * @param size Size of the opcode and parameters, in bytes. */
+    void runOpCode_(uint8_t code, const QByteArray& command, int size);
+    /* @brief Runs a frame (header, payload and CRC16). */
+    void runFrame_(const QByteArray& frame);
+    /* @brief Returns if an opcode can be sent in a frame. */
+    static bool isFrameable_(uint8_t code);
+    /* @brief Returns if an algorithm is known. */
+    static bool isAlgorithm_(uint8_t algo);
+    /* @brief Sends a frame (sequence, length, payload and CRC16). */
+    void putFrame_(uint8_t seq, const QByteArray& payload);
+    /* @brief Sends a byte (to the frame, if framed). */
+    void putChar_(uint8_t c);
+    /* @brief Sends data (to the frame, if framed). */
+    void putBuf_(const QByteArray& data);
+    /* @brief Sends OK and a value of the given size (1: byte, 2: word,
+     *   4: dword). */
+    void putValue_(uint32_t value, int size);
+    /* @brief Sends OK and a float value. */
+    void putFloat_(float value);
+    /* @brief Sends a NOK response, and fences a failed pipeline. */
+    void putFailure_();
+    /* @brief Starts a Read Range stream. */
+    void readRange_(uint32_t addr, uint32_t size);
+    /* @brief Sends the next chunk of the Read Range stream. */
+    void readRangeChunk_();
+    /* @brief Starts a Write Range stream. */
+    void writeRange_(uint32_t addr, uint32_t size, uint16_t block,
+                     bool sector);
+    /* @brief Receives the next block of the Write Range stream.
+     * @return True if received, false if the input is incomplete. */
+    bool writeRangeNext_();
+    /* @brief Runs the CRC32 Range command. */
+    void crc32Range_(uint32_t addr, uint32_t size);
+    /* @brief Runs the Blank Check Range command. */
+    void blankCheckRange_(uint32_t addr, uint32_t size);
+    /* @brief Applies the settings of a Configure command. */
+    void configure_(uint16_t config);
+    /* @brief Reads bytes/words from the device, at current address.
+     * @param count Number of bytes/words.
+     * @param[out] buffer Data read (two bytes per word, MSB first).
+     * @return True if success, false otherwise. */
+    bool readBuffer_(uint32_t count, QByteArray& buffer);
+    /* @brief Writes and verifies bytes/words, at current address.
+     * @param data Pointer to the data.
+     * @param size Size of the data, in bytes.
+     * @return True if success, false otherwise. */
+    bool writeBuffer_(const char* data, int size);
+    /* @brief Writes a sector, then verifies it.
+     * @param data Pointer to the data.
+     * @param size Size of the data, in bytes.
+     * @return True if success, false otherwise. */
+    bool writeSector_(const char* data, int size);
+    /* @brief Verifies bytes/words, at current address.
+     * @param data Pointer to the data.
+     * @param size Size of the data, in bytes.
+     * @return True if success, false otherwise. */
+    bool verifyBuffer_(const char* data, int size);
+    /* @brief Checks if bytes/words are blank, at current address.
+     * @param count Number of bytes/words.
+     * @param[out] dirty Number of bytes/words not blank.
+     * @param[out] first Index of the first byte/word not blank.
+     * @param range If true, checks all the range. Otherwise, stops at the
+     *   first byte/word not blank (as the Blank Check command).
+     * @return True if success, false otherwise. */
+    bool blankCheckBuffer_(uint32_t count, uint32_t& dirty, uint32_t& first,
+                           bool range);
+    /* @brief Sets the VDD on/off. */
+    void vddCtrl_(bool on);
+    /* @brief Sets the VPP on/off. */
+    void vppCtrl_(bool on);
+    /* @brief Sets the ~CE pin. */
+    void setCE_(bool on);
+    /* @brief Sets the ~OE pin. */
+    void setOE_(bool on);
+    /* @brief Sets the ~WE pin. */
+    void setWE_(bool on);
+    /* @brief Clears the address bus. */
+    bool addrClr_();
+    /* @brief Increments the address bus. */
+    bool addrInc_();
+    /* @brief Sets the address bus. */
+    bool addrSet_(uint32_t value);
+    /* @brief Sets the data bus. */
+    bool dataSet_(uint16_t value);
+    /* @brief Gets the data bus. */
+    uint16_t dataGet_();
     /* @brief Device Read Algorithm.
      * @param fromProg If true, indicates call after programming action.
      *   False (default) indicates call to read only.
@@ -319,10 +344,11 @@ class Emulator : public QObject {
     /* @brief Device Setup Bus Algorithm.
      * @param operation Operation to perform.
      * @return True if success, false otherwise. */
-    bool deviceSetupBus_(kCmdDeviceOperationEnum operation);
+    bool deviceSetupBus_(uint8_t operation);
     /* @brief Device Get ID Algorithm.
-     * @return Device/Manufacturer ID if success, zero values otherwise. */
-    TDeviceID deviceGetId_();
+     * @param[out] id Manufacturer (MSB) and device (LSB) IDs.
+     * @return True if success, false otherwise. */
+    bool deviceGetId_(uint32_t& id);
     /* @brief Device Erase Algorithm.
      * @return True if success, false otherwise. */
     bool deviceErase_();
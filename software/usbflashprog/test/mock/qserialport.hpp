@@ -18,6 +18,8 @@
 #include <QString>
 #include <QTimer>
 
+#include <cstring>
+
 // ---------------------------------------------------------------------------
 
 constexpr const char *kSerialPortDummyPort = "COM1";
@@ -58,6 +60,8 @@ class QSerialPort : public QObject {
 
   public:
     static bool connected;
+    /* bytes written and not discarded by clear() (the mock never sends) */
+    static qint64 pending;
     enum Directions { Input = 1, Output = 2, AllDirections = Input | Output };
 
     explicit QSerialPort(QObject *parent = nullptr)
@@ -107,16 +111,33 @@ class QSerialPort : public QObject {
         return data;
     }
 
+    qint64 read(char *data, qint64 maxSize) {
+        if (!connected) return 0;
+        qint64 size = qMin<qint64>(maxSize, sizeof(kSerialPortDummyData));
+        memcpy(data, kSerialPortDummyData, size);
+        return size;
+    }
+
     bool clear(Directions directions = AllDirections) {
-        (void)directions;
+        if (directions & Output) pending = 0;
         return connected;
     }
 
     qint64 write(const QByteArray &data) {
         if (!connected) return 0;
+        pending += data.size();
+        respond_();
         return data.size();
     }
 
+    qint64 write(const char *data, qint64 size) {
+        (void)data;
+        if (!connected) return 0;
+        pending += size;
+        respond_();
+        return size;
+    }
+
     bool flush() { return connected; }
 
     bool waitForBytesWritten(int msecs = 30000) {
@@ -136,6 +157,12 @@ class QSerialPort : public QObject {
     void onTimer() { emit readyRead(); }
 
   private:
+    /* signals the response to a write, as a device would (queued) */
+    void respond_() {
+        QMetaObject::invokeMethod(
+            this, [this]() { emit readyRead(); }, Qt::QueuedConnection);
+    }
+
     QString portName_;
     bool opened_;
     QTimer *timer_;
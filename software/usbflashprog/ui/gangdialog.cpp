@@ -0,0 +1,139 @@
+// ---------------------------------------------------------------------------
+// USB EPROM/Flash Programmer
+//
+// Copyright (2024) Robson Martins
+//
+// This work is licensed under a Creative Commons Attribution-NonCommercial-
+// ShareAlike 4.0 International License.
+// ---------------------------------------------------------------------------
+/**
+ * @ingroup Software
+ * @file ui/gangdialog.cpp
+ * @brief Implementation of the Gang Program Dialog Class.
+ *
+ * @author Robson Martins (https://www.robsonmartins.com)
+ */
+// ---------------------------------------------------------------------------
+
+#include <QString>
+#include <QProgressBar>
+#include <QTableWidgetItem>
+#include <QHeaderView>
+#include <QBrush>
+
+#include "gangdialog.hpp"
+#include "./ui_gangdialog.h"
+#include "config.hpp"
+
+// ---------------------------------------------------------------------------
+
+GangDialog::GangDialog(QWidget *parent, Gang *gang, const QByteArray &image,
+                       bool canVerify)
+    : QDialog(parent),
+      ui_(new Ui::GangDialog),
+      gang_(gang),
+      image_(image),
+      canVerify_(canVerify),
+      passed_(0),
+      failed_(0),
+      elapsed_(0) {
+    ui_->setupUi(this);
+    setWindowFlag(Qt::WindowContextHelpButtonHint, false);
+    setWindowTitle(QString(kApplicationFullName) + " - " +
+                   tr("Gang Program"));
+    ui_->checkBoxVerify->setEnabled(canVerify);
+    ui_->checkBoxVerify->setChecked(canVerify);
+    ui_->tableWidgetStations->setRowCount(gang_->getCount());
+    for (int i = 0; i < gang_->getCount(); i++) {
+        ui_->tableWidgetStations->setItem(
+            i, 0, new QTableWidgetItem(gang_->getPort(i)));
+        QProgressBar *bar = new QProgressBar();
+        bar->setRange(0, 100);
+        bar->setValue(0);
+        ui_->tableWidgetStations->setCellWidget(i, 1, bar);
+        ui_->tableWidgetStations->setItem(i, 2, new QTableWidgetItem());
+    }
+    ui_->tableWidgetStations->horizontalHeader()->setSectionResizeMode(
+        1, QHeaderView::Stretch);
+    connect(gang_, &Gang::onProgress, this, &GangDialog::onGangProgress);
+    connect(gang_, &Gang::onStationFinished, this,
+            &GangDialog::onGangStationFinished);
+    connect(gang_, &Gang::onFinished, this, &GangDialog::onGangFinished);
+    updateSummary_();
+}
+
+GangDialog::~GangDialog() {
+    gang_->disconnect(this);
+    delete ui_;
+}
+
+void GangDialog::reject() {
+    if (gang_->isRunning()) {
+        // closes only after the stations finish
+        gang_->cancel();
+        return;
+    }
+    QDialog::reject();
+}
+
+void GangDialog::on_pushButtonStart_clicked() {
+    bool verify = ui_->checkBoxVerify->isChecked();
+    for (int i = 0; i < gang_->getCount(); i++) {
+        auto bar = qobject_cast<QProgressBar *>(
+            ui_->tableWidgetStations->cellWidget(i, 1));
+        if (bar) bar->setValue(0);
+        QTableWidgetItem *item = ui_->tableWidgetStations->item(i, 2);
+        item->setText(tr("Running"));
+        item->setForeground(QBrush());
+    }
+    timer_.start();
+    if (!gang_->start(image_, [verify](Device *device,
+                                       const QByteArray &image) {
+            return device->program(image, verify);
+        })) {
+        return;
+    }
+    ui_->pushButtonStart->setEnabled(false);
+    ui_->checkBoxVerify->setEnabled(false);
+}
+
+void GangDialog::onGangProgress(int station, uint32_t current,
+                                uint32_t total, bool done, bool success,
+                                bool canceled) {
+    auto bar = qobject_cast<QProgressBar *>(
+        ui_->tableWidgetStations->cellWidget(station, 1));
+    if (!bar) return;
+    if (done && success) {
+        bar->setValue(100);
+    } else if (total) {
+        bar->setValue(static_cast<int>(current * 100.0 / total));
+    }
+}
+
+void GangDialog::onGangStationFinished(int station, bool success) {
+    QTableWidgetItem *item = ui_->tableWidgetStations->item(station, 2);
+    if (!item) return;
+    item->setText(success ? tr("Passed") : tr("Failed"));
+    item->setForeground(success ? Qt::darkGreen : Qt::red);
+}
+
+void GangDialog::onGangFinished(int passed, int failed) {
+    passed_ += passed;
+    failed_ += failed;
+    elapsed_ += timer_.elapsed();
+    ui_->pushButtonStart->setEnabled(true);
+    ui_->checkBoxVerify->setEnabled(canVerify_);
+    updateSummary_();
+}
+
+void GangDialog::updateSummary_() {
+    QString summary = tr("Stations: %1 | Passed: %2 | Failed: %3")
+                          .arg(gang_->getCount())
+                          .arg(passed_)
+                          .arg(failed_);
+    if (elapsed_ > 0) {
+        double perHour = (passed_ + failed_) * 3600000.0 / elapsed_;
+        summary += " | " + tr("Chips/hour: %1").arg(perHour, 0, 'f', 0);
+    }
+    ui_->labelSummary->setText(summary);
+}
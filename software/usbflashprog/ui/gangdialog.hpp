@@ -0,0 +1,96 @@
+// ---------------------------------------------------------------------------
+// USB EPROM/Flash Programmer
+//
+// Copyright (2024) Robson Martins
+//
+// This work is licensed under a Creative Commons Attribution-NonCommercial-
+// ShareAlike 4.0 International License.
+// ---------------------------------------------------------------------------
+/**
+ * @ingroup Software
+ * @file ui/gangdialog.hpp
+ * @brief Header of the Gang Program Dialog Class.
+ *
+ * @author Robson Martins (https://www.robsonmartins.com)
+ */
+// ---------------------------------------------------------------------------
+
+#ifndef UI_GANGDIALOG_HPP_
+#define UI_GANGDIALOG_HPP_
+
+#include <QDialog>
+#include <QByteArray>
+#include <QElapsedTimer>
+
+#include "backend/gang.hpp"
+
+// ---------------------------------------------------------------------------
+
+// clang-format off
+QT_BEGIN_NAMESPACE
+namespace Ui { class GangDialog; }
+QT_END_NAMESPACE
+// clang-format on
+
+// ---------------------------------------------------------------------------
+
+/**
+ * @ingroup Software
+ * @brief Gang Program Dialog Class
+ * @details The purpose of this class is to program (and verify) the same
+ *   image on all the stations of a gang, showing the progress and the
+ *   result of each station. Each batch is started by the user (after
+ *   replacing the chips), and the totals of the session are shown.
+ * @nosubgrouping
+ */
+class GangDialog : public QDialog {
+    Q_OBJECT
+
+  public:
+    /**
+     * @brief Constructor.
+     * @param parent Pointer to parent object.
+     * @param gang Pointer to the gang (with the stations already added).
+     * @param image Image to program.
+     * @param canVerify If true, enables the verify option. False otherwise.
+     */
+    GangDialog(QWidget *parent, Gang *gang, const QByteArray &image,
+               bool canVerify = true);
+    /** @brief Destructor. */
+    ~GangDialog();
+
+  public slots:
+    /** @brief Closes the dialog (or cancels the running batch). */
+    void reject() override;
+
+  private slots:
+    /* auto slots */
+    void on_pushButtonStart_clicked();
+    /* manual slots */
+    void onGangProgress(int station, uint32_t current, uint32_t total,
+                        bool done, bool success, bool canceled);
+    void onGangStationFinished(int station, bool success);
+    void onGangFinished(int passed, int failed);
+
+  private:
+    /* @brief Pointer to UI object. */
+    Ui::GangDialog *ui_;
+    /* @brief Pointer to the gang. */
+    Gang *gang_;
+    /* @brief Image to program. */
+    QByteArray image_;
+    /* @brief If true, the verify option is enabled. */
+    bool canVerify_;
+    /* @brief Measures the time of the running batch. */
+    QElapsedTimer timer_;
+    /* @brief Chips programmed with success in the session. */
+    int passed_;
+    /* @brief Chips with failure in the session. */
+    int failed_;
+    /* @brief Time of the batches of the session, in milliseconds. */
+    int64_t elapsed_;
+    /* @brief Updates the summary of the session. */
+    void updateSummary_();
+};
+
+#endif  // UI_GANGDIALOG_HPP_
@@ -31,17 +31,25 @@
 #include <QAction>
 #include <QSettings>
 #include <QSignalBlocker>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTableWidgetItem>
 
 #include <cstdio>
 #include <cstring>
 #include <string>
 #include <locale>
 #include <cmath>
+#include <memory>
 
 #include "mainwindow.hpp"
 #include "./ui_mainwindow.h"
 
 #include "settings.hpp"
+#include "gangdialog.hpp"
 #include "backend/opcodes.hpp"
 #include "backend/devices/parallel/dummy.hpp"
 #include "backend/devices/parallel/sram.hpp"
@@ -54,6 +62,15 @@
 /* @brief Minimum length of dialog labels, in characters. */
 constexpr int kDialogLabelMinLength = 80;
 
+// ---------------------------------------------------------------------------
+
+TDeviceActionResult::TDeviceActionResult()
+    : success(false),
+      size(0),
+      dirtyCount(0),
+      bufferSize(0),
+      autoTune(false) {}
+
 // ---------------------------------------------------------------------------
 // General
 
@@ -103,6 +120,7 @@ MainWindow::MainWindow(QWidget *parent)
     ui_->actionSave->setEnabled(false);
     connectSignals_();
     enableDiagControls_(false);
+    deviceThread_.start();
     enumTimer_.start(kUsbEnumerateInterval);
 
     checksumLabel_ = new QLabel();
@@ -131,11 +149,10 @@ MainWindow::~MainWindow() {
     // save settings
     saveSettings_();
 
+    destroyDevice_();
+    deviceThread_.quit();
+    deviceThread_.wait();
     delete progress_;
-    if (device_) {
-        device_->disconnect();
-        delete device_;
-    }
     delete hexeditor_;
     delete checksumLabel_;
     delete ui_;
@@ -450,13 +467,15 @@ void MainWindow::on_actionRead_triggered(bool checked) {
         if (!showDialogFileChanged_()) return;
     }
     if (!showActionWarningDialog_()) return;
-    configureDeviceFromControls_();
     showDialogActionProgress_(ui_->actionRead->text());
-    QByteArray buffer;
-    if (device_->read(buffer)) {
-        hexeditor_->setSize(device_->getSize());
-        hexeditor_->putData(buffer);
-    }
+    auto buffer = std::make_shared<QByteArray>();
+    runDeviceAction_(
+        [buffer](Device *device) { return device->read(*buffer); },
+        [this, buffer](const TDeviceActionResult &result) {
+            if (!result.success) return;
+            hexeditor_->setSize(result.size);
+            hexeditor_->putData(*buffer);
+        });
 }
 
 void MainWindow::on_actionDoProgram_triggered(bool checked) {
@@ -464,9 +483,8 @@ void MainWindow::on_actionDoProgram_triggered(bool checked) {
     QByteArray data = hexeditor_->getData();
     if (!showDifferentSizeDialog_(data)) return;
     if (!showActionWarningDialog_()) return;
-    configureDeviceFromControls_();
     showDialogActionProgress_(ui_->actionDoProgram->text());
-    device_->program(data);
+    runDeviceAction_([data](Device *device) { return device->program(data); });
 }
 
 void MainWindow::on_actionProgramAndVerify_triggered(bool checked) {
@@ -477,35 +495,48 @@ void MainWindow::on_actionProgramAndVerify_triggered(bool checked) {
     QByteArray data = hexeditor_->getData();
     if (!showDifferentSizeDialog_(data)) return;
     if (!showActionWarningDialog_()) return;
-    configureDeviceFromControls_();
     showDialogActionProgress_(ui_->actionProgramAndVerify->text());
-    device_->program(data, true);
+    runDeviceAction_(
+        [data](Device *device) { return device->program(data, true); });
+}
+
+void MainWindow::on_actionGangProgram_triggered(bool checked) {
+    if (!device_ || !device_->getInfo().capability.hasProgram) return;
+    QByteArray data = hexeditor_->getData();
+    if (!showDifferentSizeDialog_(data)) return;
+    if (!showActionWarningDialog_()) return;
+    // one station for each programmer attached
+    Gang gang;
+    for (int i = 0; i < ui_->comboBoxProgPort->count(); i++) {
+        Device *device = newDevice_(ui_->btnProgDevice->text());
+        device->setSize(device_->getSize());
+        device->setAutoTune(settings_.prog.bufferAuto);
+        deviceConfiguration_(ui_->comboBoxProgPort->itemText(i))(device);
+        gang.addStation(device);
+    }
+    GangDialog dialog(this, &gang, data,
+                      device_->getInfo().capability.hasVerify);
+    dialog.exec();
 }
 
 void MainWindow::on_actionVerify_triggered(bool checked) {
     if (!device_ || !device_->getInfo().capability.hasVerify) return;
     if (!showActionWarningDialog_()) return;
-    configureDeviceFromControls_();
     showDialogActionProgress_(ui_->actionVerify->text());
-    device_->verify(hexeditor_->getData());
+    QByteArray data = hexeditor_->getData();
+    runDeviceAction_([data](Device *device) { return device->verify(data); });
 }
 
 void MainWindow::on_actionDoErase_triggered(bool checked) {
     if (!device_ || !device_->getInfo().capability.hasErase) return;
     if (!showActionWarningDialog_()) return;
-    configureDeviceFromControls_();
     showDialogActionProgress_(ui_->actionDoErase->text());
-    if (device_->erase()) {
-        progress_->hide();
-        QMessageBox::information(
-            this, progress_->windowTitle(),
-            tr("Device is blank").leftJustified(kDialogLabelMinLength));
-    } else {
-        progress_->hide();
-        QMessageBox::critical(
-            this, progress_->windowTitle(),
-            tr("Device is not blank").leftJustified(kDialogLabelMinLength));
-    }
+    runDeviceAction_([](Device *device) { return device->erase(); },
+                     [this](const TDeviceActionResult &result) {
+                         showActionResultDialog_(
+                             result.success, tr("Device is blank"),
+                             tr("Device is not blank"));
+                     });
 }
 
 void MainWindow::on_actionEraseAndBlankCheck_triggered(bool checked) {
@@ -514,103 +545,75 @@ void MainWindow::on_actionEraseAndBlankCheck_triggered(bool checked) {
         return;
     }
     if (!showActionWarningDialog_()) return;
-    configureDeviceFromControls_();
     showDialogActionProgress_(ui_->actionEraseAndBlankCheck->text());
-    if (device_->erase(true)) {
-        progress_->hide();
-        QMessageBox::information(
-            this, progress_->windowTitle(),
-            tr("Device is blank").leftJustified(kDialogLabelMinLength));
-    } else {
-        progress_->hide();
-        QMessageBox::critical(
-            this, progress_->windowTitle(),
-            tr("Device is not blank").leftJustified(kDialogLabelMinLength));
-    }
+    runDeviceAction_([](Device *device) { return device->erase(true); },
+                     [this](const TDeviceActionResult &result) {
+                         showActionResultDialog_(result.success,
+                                                 tr("Device is blank"),
+                                                 notBlankMessage_(result));
+                     });
 }
 
 void MainWindow::on_actionBlankCheck_triggered(bool checked) {
     if (!device_ || !device_->getInfo().capability.hasBlankCheck) return;
     if (!showActionWarningDialog_()) return;
-    configureDeviceFromControls_();
     showDialogActionProgress_(ui_->actionBlankCheck->text());
-    if (device_->blankCheck()) {
-        progress_->hide();
-        QMessageBox::information(
-            this, progress_->windowTitle(),
-            tr("Device is blank").leftJustified(kDialogLabelMinLength));
-    } else {
-        progress_->hide();
-        QMessageBox::critical(
-            this, progress_->windowTitle(),
-            tr("Device is not blank").leftJustified(kDialogLabelMinLength));
-    }
+    runDeviceAction_([](Device *device) { return device->blankCheck(); },
+                     [this](const TDeviceActionResult &result) {
+                         showActionResultDialog_(result.success,
+                                                 tr("Device is blank"),
+                                                 notBlankMessage_(result));
+                     });
 }
 
 void MainWindow::on_actionGetID_triggered(bool checked) {
     if (!device_ || !device_->getInfo().capability.hasGetId) return;
     if (!showActionWarningDialog_()) return;
-    TDeviceID deviceId;
-    configureDeviceFromControls_();
     showDialogActionProgress_(ui_->actionGetID->text());
-    if (device_->getId(deviceId)) {
-        progress_->hide();
-        QMessageBox::information(
-            this, progress_->windowTitle(),
-            tr("Manufacturer: 0x%1 (%2)")
-                    .arg(QString("%1")
-                             .arg(deviceId.manufacturer, 4, 16, QChar('0'))
-                             .toUpper())
-                    .arg(deviceId.getManufacturerName())
-                    .leftJustified(kDialogLabelMinLength) +
-                "\n" +
-                tr("Device : 0x%1")
-                    .arg(QString("%1")
-                             .arg(deviceId.device, 4, 16, QChar('0'))
-                             .toUpper())
-                    .leftJustified(kDialogLabelMinLength));
-    } else {
-        progress_->hide();
-        QMessageBox::critical(this, progress_->windowTitle(),
-                              tr("Device doesn't support getting ID")
-                                  .leftJustified(kDialogLabelMinLength));
-    }
+    auto deviceId = std::make_shared<TDeviceID>();
+    runDeviceAction_(
+        [deviceId](Device *device) { return device->getId(*deviceId); },
+        [this, deviceId](const TDeviceActionResult &result) {
+            showActionResultDialog_(
+                result.success,
+                tr("Manufacturer: 0x%1 (%2)")
+                        .arg(QString("%1")
+                                 .arg(deviceId->manufacturer, 4, 16, QChar('0'))
+                                 .toUpper())
+                        .arg(deviceId->getManufacturerName())
+                        .leftJustified(kDialogLabelMinLength) +
+                    "\n" +
+                    tr("Device : 0x%1")
+                        .arg(QString("%1")
+                                 .arg(deviceId->device, 4, 16, QChar('0'))
+                                 .toUpper())
+                        .leftJustified(kDialogLabelMinLength),
+                tr("Device doesn't support getting ID"));
+        });
 }
 
 void MainWindow::on_actionUnprotect_triggered(bool checked) {
     if (!device_ || !device_->getInfo().capability.hasUnprotect) return;
     if (!showActionWarningDialog_()) return;
-    configureDeviceFromControls_();
     showDialogActionProgress_(ui_->actionUnprotect->text());
-    if (device_->unprotect()) {
-        progress_->hide();
-        QMessageBox::information(
-            this, progress_->windowTitle(),
-            tr("Device is unprotected").leftJustified(kDialogLabelMinLength));
-    } else {
-        progress_->hide();
-        QMessageBox::critical(
-            this, progress_->windowTitle(),
-            tr("Unprotect failure").leftJustified(kDialogLabelMinLength));
-    }
+    runDeviceAction_([](Device *device) { return device->unprotect(); },
+                     [this](const TDeviceActionResult &result) {
+                         showActionResultDialog_(
+                             result.success, tr("Device is unprotected"),
+                             tr("Unprotect failure"));
+                     });
 }
 
 void MainWindow::on_actionProtect_triggered(bool checked) {
     if (!device_ || !device_->getInfo().capability.hasProtect) return;
     if (!showActionWarningDialog_()) return;
-    configureDeviceFromControls_();
     showDialogActionProgress_(ui_->actionProtect->text());
-    if (device_->protect()) {
-        progress_->hide();
-        QMessageBox::information(
-            this, progress_->windowTitle(),
-            tr("Device is protected").leftJustified(kDialogLabelMinLength));
-    } else {
-        progress_->hide();
-        QMessageBox::critical(
-            this, progress_->windowTitle(),
-            tr("Protect failure").leftJustified(kDialogLabelMinLength));
-    }
+    runDeviceAction_([](Device *device) { return device->protect(); },
+                     [this](const TDeviceActionResult &result) {
+                         showActionResultDialog_(
+                             result.success, tr("Device is protected"),
+                             tr("Protect failure"));
+                     });
 }
 
 void MainWindow::on_btnRead_clicked() {
@@ -677,6 +680,10 @@ void MainWindow::on_checkBoxProgFast_toggled(bool checked) {
     saveSettings_();
 }
 
+void MainWindow::on_checkBoxProgDiff_toggled(bool checked) {
+    saveSettings_();
+}
+
 void MainWindow::on_comboBoxProgSectorSize_currentIndexChanged(int index) {
     saveSettings_();
 }
@@ -688,7 +695,7 @@ void MainWindow::on_comboBoxProgSize_currentIndexChanged(int index) {
         }
         uint32_t size = static_cast<uint32_t>(
             ceil(powf(2, ui_->comboBoxProgSize->currentIndex()) * 512.0f));
-        device_->setSize(size);
+        setupDevice_([size](Device *device) { device->setSize(size); });
         configureProgControls_();
         hexeditor_->fill(0xFF);
         saveSettings_();
@@ -702,6 +709,8 @@ void MainWindow::loadSettings_() {
         configurator.value(kSettingGeneralWindowPos).toPoint();
     settings_.windowSize =
         configurator.value(kSettingGeneralWindowSize).toSize();
+    settings_.statsReport =
+        configurator.value(kSettingGeneralStatsReport).toString().toInt() != 0;
 
     settings_.prog.device = configurator.value(kSettingProgDevice).toString();
     settings_.prog.size =
@@ -722,6 +731,8 @@ void MainWindow::loadSettings_() {
         configurator.value(kSettingProgSkipFF).toString().toInt() != 0;
     settings_.prog.fastProg =
         configurator.value(kSettingProgFast).toString().toInt() != 0;
+    settings_.prog.diffProg =
+        configurator.value(kSettingProgDiff).toString().toInt() != 0;
     settings_.prog.sectorSize =
         configurator.value(kSettingProgSectorSize).toString().toUInt();
     settings_.prog.bufferSize =
@@ -730,21 +741,28 @@ void MainWindow::loadSettings_() {
     if (!settings_.prog.bufferSize) {
         settings_.prog.bufferSize = kDefaultDeviceBufferSize;
     }
+    settings_.prog.bufferAuto =
+        configurator.value(kSettingProgBufferAuto).toString().toInt() != 0;
 
     if (!settings_.prog.device.isEmpty()) {
         ui_->btnProgDevice->setText(settings_.prog.device);
         createDevice_();
-        device_->setSize(settings_.prog.size);
-        device_->setTwp(settings_.prog.twp);
-        device_->setTwc(settings_.prog.twc);
-        device_->setVddRd(settings_.prog.vddRd);
-        device_->setVddWr(settings_.prog.vddWr);
-        device_->setVpp(settings_.prog.vpp);
-        device_->setVee(settings_.prog.vee);
-        device_->setSkipFF(settings_.prog.skipFF);
-        device_->setFastProg(settings_.prog.fastProg);
-        device_->setSectorSize(settings_.prog.sectorSize);
-        device_->setBufferSize(settings_.prog.bufferSize);
+        TProgrammerSettings prog = settings_.prog;
+        setupDevice_([prog](Device *device) {
+            device->setSize(prog.size);
+            device->setTwp(prog.twp);
+            device->setTwc(prog.twc);
+            device->setVddRd(prog.vddRd);
+            device->setVddWr(prog.vddWr);
+            device->setVpp(prog.vpp);
+            device->setVee(prog.vee);
+            device->setSkipFF(prog.skipFF);
+            device->setFastProg(prog.fastProg);
+            device->setDiffProg(prog.diffProg);
+            device->setSectorSize(prog.sectorSize);
+            device->setBufferSize(prog.bufferSize);
+            device->setAutoTune(prog.bufferAuto);
+        });
     }
 
     configureProgControls_();
@@ -773,6 +791,7 @@ void MainWindow::saveSettings_() {
     settings_.prog.vee = ui_->spinBoxProgVEE->value();
     settings_.prog.skipFF = ui_->checkBoxProgSkipFF->isChecked();
     settings_.prog.fastProg = ui_->checkBoxProgFast->isChecked();
+    settings_.prog.diffProg = ui_->checkBoxProgDiff->isChecked();
     settings_.prog.sectorSize = 0;
     if (ui_->comboBoxProgSectorSize->currentIndex() != 0) {
         settings_.prog.sectorSize =
@@ -797,42 +816,100 @@ void MainWindow::saveSettings_() {
                           QString::number(settings_.prog.skipFF ? 1 : 0));
     configurator.setValue(kSettingProgFast,
                           QString::number(settings_.prog.fastProg ? 1 : 0));
+    configurator.setValue(kSettingProgDiff,
+                          QString::number(settings_.prog.diffProg ? 1 : 0));
     configurator.setValue(kSettingProgSectorSize,
                           QString::number(settings_.prog.sectorSize));
     configurator.setValue(kSettingProgBufferSize,
                           QString::number(settings_.prog.bufferSize));
+    configurator.setValue(kSettingProgBufferAuto,
+                          QString::number(settings_.prog.bufferAuto ? 1 : 0));
 }
 
 void MainWindow::createDevice_() {
-    if (device_) {
-        device_->disconnect();
-        delete device_;
-        device_ = nullptr;
-    }
-    createDeviceIfSRAM_(ui_->btnProgDevice->text());
-    createDeviceIfEPROM_(ui_->btnProgDevice->text());
-    createDeviceIfErasableEPROM_(ui_->btnProgDevice->text());
-    createDeviceIfEEPROM_(ui_->btnProgDevice->text());
-    createDeviceIfFlash28F_(ui_->btnProgDevice->text());
-    if (!device_) {
-        if (ui_->btnProgDevice->text() == ui_->actionDummy->text()) {
-            device_ = new Dummy(this);
+    destroyDevice_();
+    device_ = newDevice_(ui_->btnProgDevice->text());
+    device_->setBufferSize(settings_.prog.bufferSize);
+    device_->setAutoTune(settings_.prog.bufferAuto);
+    connect(device_, &Device::onProgress, this, &MainWindow::onActionProgress,
+            Qt::QueuedConnection);
+    // the device operations run on the worker thread
+    device_->setParent(nullptr);
+    device_->moveToThread(&deviceThread_);
+}
+
+void MainWindow::destroyDevice_() {
+    if (!device_) return;
+    device_->disconnect();
+    device_->cancel();
+    // deleted on the worker thread, after the running operation (if any)
+    device_->deleteLater();
+    device_ = nullptr;
+}
+
+void MainWindow::setupDevice_(std::function<void(Device *)> setup) {
+    Device *device = device_;
+    QMetaObject::invokeMethod(
+        device, [device, setup]() { setup(device); },
+        Qt::BlockingQueuedConnection);
+}
+
+void MainWindow::runDeviceAction_(
+    std::function<bool(Device *)> action,
+    std::function<void(const TDeviceActionResult &)> finished) {
+    Device *device = device_;
+    auto configure = deviceConfiguration_(ui_->comboBoxPort->currentText());
+    QMetaObject::invokeMethod(
+        device,
+        [this, device, configure, action, finished]() {
+            configure(device);
+            device->resetStats();
+            TDeviceActionResult result;
+            result.success = action(device);
+            result.size = device->getSize();
+            result.dirtyCount = device->getDirtyCount();
+            result.port = device->getPort();
+            result.bufferSize = device->getBufferSize();
+            result.autoTune = device->getAutoTune();
+            result.name = device->getInfo().name;
+            result.stats = device->getStats();
+            QMetaObject::invokeMethod(
+                this,
+                [this, finished, result]() {
+                    saveTunedBufferSize_(result);
+                    updateStats_(result);
+                    if (settings_.statsReport) saveStatsReport_(result);
+                    if (finished) finished(result);
+                },
+                Qt::QueuedConnection);
+        },
+        Qt::QueuedConnection);
+}
+
+Device *MainWindow::newDevice_(const QString &label) {
+    Device *device = createDeviceIfSRAM_(label);
+    if (!device) device = createDeviceIfEPROM_(label);
+    if (!device) device = createDeviceIfErasableEPROM_(label);
+    if (!device) device = createDeviceIfEEPROM_(label);
+    if (!device) device = createDeviceIfFlash28F_(label);
+    if (!device) {
+        if (label == ui_->actionDummy->text()) {
+            device = new Dummy(this);
             hexeditor_->setMode(QHexEditor::Mode8Bits);
         } else {
-            device_ = new Dummy16Bit(this);
+            device = new Dummy16Bit(this);
             hexeditor_->setMode(QHexEditor::Mode16Bits);
         }
-        device_->setSize(2048);
+        device->setSize(2048);
         ui_->actionDoProgram->setText(tr("Program"));
         ui_->btnProgram->setToolTip(ui_->actionDoProgram->text());
         ui_->comboBoxProgSize->setEnabled(true);
         ui_->labelProgSize->setEnabled(true);
     }
-    device_->setBufferSize(settings_.prog.bufferSize);
-    connect(device_, &Device::onProgress, this, &MainWindow::onActionProgress);
+    return device;
 }
 
-void MainWindow::createDeviceIfSRAM_(const QString &label) {
+Device *MainWindow::createDeviceIfSRAM_(const QString &label) {
     uint32_t size = 0x800;
     bool found = false, custom = false;
     if (label == ui_->actionSRAM_2KB->text()) {
@@ -852,18 +929,19 @@ void MainWindow::createDeviceIfSRAM_(const QString &label) {
         custom = true;
     }
     if (found) {
-        device_ = new SRAM(this);
+        Device *device = new SRAM(this);
         ui_->actionDoProgram->setText(tr("Test SRAM"));
         ui_->btnProgram->setToolTip(ui_->actionDoProgram->text());
-        device_->setSize(size);
+        device->setSize(size);
         hexeditor_->setMode(QHexEditor::Mode8Bits);
         ui_->comboBoxProgSize->setEnabled(custom);
         ui_->labelProgSize->setEnabled(custom);
-        return;
+        return device;
     }
+    return nullptr;
 }
 
-void MainWindow::createDeviceIfEPROM_(const QString &label) {
+Device *MainWindow::createDeviceIfEPROM_(const QString &label) {
     uint32_t size = 0x800;
     bool found = false, custom = false;
     // 27xxx
@@ -901,12 +979,12 @@ void MainWindow::createDeviceIfEPROM_(const QString &label) {
     if (found) {
         ui_->actionDoProgram->setText(tr("Program"));
         ui_->btnProgram->setToolTip(ui_->actionDoProgram->text());
-        device_ = new EPROM27(this);
-        device_->setSize(size);
+        Device *device = new EPROM27(this);
+        device->setSize(size);
         hexeditor_->setMode(QHexEditor::Mode8Bits);
         ui_->comboBoxProgSize->setEnabled(custom);
         ui_->labelProgSize->setEnabled(custom);
-        return;
+        return device;
     }
     size = 0x800;
     found = false;
@@ -949,12 +1027,12 @@ void MainWindow::createDeviceIfEPROM_(const QString &label) {
     if (found) {
         ui_->actionDoProgram->setText(tr("Program"));
         ui_->btnProgram->setToolTip(ui_->actionDoProgram->text());
-        device_ = new EPROM27C(this);
-        device_->setSize(size);
+        Device *device = new EPROM27C(this);
+        device->setSize(size);
         hexeditor_->setMode(QHexEditor::Mode8Bits);
         ui_->comboBoxProgSize->setEnabled(custom);
         ui_->labelProgSize->setEnabled(custom);
-        return;
+        return device;
     }
     size = 0x20000;
     found = false;
@@ -985,16 +1063,17 @@ void MainWindow::createDeviceIfEPROM_(const QString &label) {
     if (found) {
         ui_->actionDoProgram->setText(tr("Program"));
         ui_->btnProgram->setToolTip(ui_->actionDoProgram->text());
-        device_ = new EPROM27C16Bit(this);
-        device_->setSize(size);
+        Device *device = new EPROM27C16Bit(this);
+        device->setSize(size);
         hexeditor_->setMode(QHexEditor::Mode16Bits);
         ui_->comboBoxProgSize->setEnabled(custom);
         ui_->labelProgSize->setEnabled(custom);
-        return;
+        return device;
     }
+    return nullptr;
 }
 
-void MainWindow::createDeviceIfErasableEPROM_(const QString &label) {
+Device *MainWindow::createDeviceIfErasableEPROM_(const QString &label) {
     uint32_t size = 0x8000;
     bool found = false, custom = false;
     float vpp = 12.0f, vee = 14.0f, vdd = 5.0f;
@@ -1026,15 +1105,15 @@ void MainWindow::createDeviceIfErasableEPROM_(const QString &label) {
     if (found) {
         ui_->actionDoProgram->setText(tr("Program"));
         ui_->btnProgram->setToolTip(ui_->actionDoProgram->text());
-        device_ = new EPROM27E(this);
-        device_->setSize(size);
-        device_->setVpp(vpp);
-        device_->setVee(vee);
-        device_->setVddWr(vdd);
+        Device *device = new EPROM27E(this);
+        device->setSize(size);
+        device->setVpp(vpp);
+        device->setVee(vee);
+        device->setVddWr(vdd);
         hexeditor_->setMode(QHexEditor::Mode8Bits);
         ui_->comboBoxProgSize->setEnabled(custom);
         ui_->labelProgSize->setEnabled(custom);
-        return;
+        return device;
     }
     found = false;
     vpp = 12.0f;
@@ -1060,15 +1139,15 @@ void MainWindow::createDeviceIfErasableEPROM_(const QString &label) {
     if (found) {
         ui_->actionDoProgram->setText(tr("Program"));
         ui_->btnProgram->setToolTip(ui_->actionDoProgram->text());
-        device_ = new EPROM27E(this);
-        device_->setSize(size);
-        device_->setVpp(vpp);
-        device_->setVee(vee);
-        device_->setVddWr(vdd);
+        Device *device = new EPROM27E(this);
+        device->setSize(size);
+        device->setVpp(vpp);
+        device->setVee(vee);
+        device->setVddWr(vdd);
         hexeditor_->setMode(QHexEditor::Mode8Bits);
         ui_->comboBoxProgSize->setEnabled(false);
         ui_->labelProgSize->setEnabled(false);
-        return;
+        return device;
     }
     found = false;
     vpp = 12.75f;
@@ -1089,15 +1168,15 @@ void MainWindow::createDeviceIfErasableEPROM_(const QString &label) {
     if (found) {
         ui_->actionDoProgram->setText(tr("Program"));
         ui_->btnProgram->setToolTip(ui_->actionDoProgram->text());
-        device_ = new EPROM27E(this);
-        device_->setSize(size);
-        device_->setVpp(vpp);
-        device_->setVee(vee);
-        device_->setVddWr(vdd);
+        Device *device = new EPROM27E(this);
+        device->setSize(size);
+        device->setVpp(vpp);
+        device->setVee(vee);
+        device->setVddWr(vdd);
         hexeditor_->setMode(QHexEditor::Mode8Bits);
         ui_->comboBoxProgSize->setEnabled(false);
         ui_->labelProgSize->setEnabled(false);
-        return;
+        return device;
     }
     found = false;
     vpp = 12.0f;
@@ -1120,20 +1199,21 @@ void MainWindow::createDeviceIfErasableEPROM_(const QString &label) {
     if (found) {
         ui_->actionDoProgram->setText(tr("Program"));
         ui_->btnProgram->setToolTip(ui_->actionDoProgram->text());
-        device_ = new EPROM27E(this);
-        device_->setSize(size);
-        device_->setVpp(vpp);
-        device_->setVee(vee);
-        device_->setVddRd(vdd);
-        device_->setVddWr(vdd);
+        Device *device = new EPROM27E(this);
+        device->setSize(size);
+        device->setVpp(vpp);
+        device->setVee(vee);
+        device->setVddRd(vdd);
+        device->setVddWr(vdd);
         hexeditor_->setMode(QHexEditor::Mode8Bits);
         ui_->comboBoxProgSize->setEnabled(false);
         ui_->labelProgSize->setEnabled(false);
-        return;
+        return device;
     }
+    return nullptr;
 }
 
-void MainWindow::createDeviceIfEEPROM_(const QString &label) {
+Device *MainWindow::createDeviceIfEEPROM_(const QString &label) {
     uint32_t size = 0x800;
     bool found = false, custom = false;
     // X28
@@ -1189,12 +1269,12 @@ void MainWindow::createDeviceIfEEPROM_(const QString &label) {
     if (found) {
         ui_->actionDoProgram->setText(tr("Program"));
         ui_->btnProgram->setToolTip(ui_->actionDoProgram->text());
-        device_ = new EEPROM28C(this);
-        device_->setSize(size);
+        Device *device = new EEPROM28C(this);
+        device->setSize(size);
         hexeditor_->setMode(QHexEditor::Mode8Bits);
         ui_->comboBoxProgSize->setEnabled(custom);
         ui_->labelProgSize->setEnabled(custom);
-        return;
+        return device;
     }
     size = 0x800;
     found = false;
@@ -1232,16 +1312,17 @@ void MainWindow::createDeviceIfEEPROM_(const QString &label) {
     if (found) {
         ui_->actionDoProgram->setText(tr("Program"));
         ui_->btnProgram->setToolTip(ui_->actionDoProgram->text());
-        device_ = new EEPROM28AT(this);
-        device_->setSize(size);
+        Device *device = new EEPROM28AT(this);
+        device->setSize(size);
         hexeditor_->setMode(QHexEditor::Mode8Bits);
         ui_->comboBoxProgSize->setEnabled(custom);
         ui_->labelProgSize->setEnabled(custom);
-        return;
+        return device;
     }
+    return nullptr;
 }
 
-void MainWindow::createDeviceIfFlash28F_(const QString &label) {
+Device *MainWindow::createDeviceIfFlash28F_(const QString &label) {
     uint32_t size = 0x2000;
     float vdd = 5.0f;
     bool found = false, custom = false;
@@ -1281,14 +1362,14 @@ void MainWindow::createDeviceIfFlash28F_(const QString &label) {
     if (found) {
         ui_->actionDoProgram->setText(tr("Program"));
         ui_->btnProgram->setToolTip(ui_->actionDoProgram->text());
-        device_ = new Flash28F(this);
-        device_->setSize(size);
-        device_->setVddRd(vdd);
-        device_->setVddWr(vdd);
+        Device *device = new Flash28F(this);
+        device->setSize(size);
+        device->setVddRd(vdd);
+        device->setVddWr(vdd);
         hexeditor_->setMode(QHexEditor::Mode8Bits);
         ui_->comboBoxProgSize->setEnabled(custom);
         ui_->labelProgSize->setEnabled(custom);
-        return;
+        return device;
     }
     size = 0x80000;
     vdd = 5.0f;
@@ -1313,14 +1394,14 @@ void MainWindow::createDeviceIfFlash28F_(const QString &label) {
     if (found) {
         ui_->actionDoProgram->setText(tr("Program"));
         ui_->btnProgram->setToolTip(ui_->actionDoProgram->text());
-        device_ = new FlashSST28SF(this);
-        device_->setSize(size);
-        device_->setVddRd(vdd);
-        device_->setVddWr(vdd);
+        Device *device = new FlashSST28SF(this);
+        device->setSize(size);
+        device->setVddRd(vdd);
+        device->setVddWr(vdd);
         hexeditor_->setMode(QHexEditor::Mode8Bits);
         ui_->comboBoxProgSize->setEnabled(custom);
         ui_->labelProgSize->setEnabled(custom);
-        return;
+        return device;
     }
     size = 0x8000;
     vdd = 5.0f;
@@ -1347,14 +1428,14 @@ void MainWindow::createDeviceIfFlash28F_(const QString &label) {
     if (found) {
         ui_->actionDoProgram->setText(tr("Program"));
         ui_->btnProgram->setToolTip(ui_->actionDoProgram->text());
-        device_ = new FlashAm28F(this);
-        device_->setSize(size);
-        device_->setVddRd(vdd);
-        device_->setVddWr(vdd);
+        Device *device = new FlashAm28F(this);
+        device->setSize(size);
+        device->setVddRd(vdd);
+        device->setVddWr(vdd);
         hexeditor_->setMode(QHexEditor::Mode8Bits);
         ui_->comboBoxProgSize->setEnabled(custom);
         ui_->labelProgSize->setEnabled(custom);
-        return;
+        return device;
     }
     size = 0x20000;
     vdd = 5.0f;
@@ -1384,14 +1465,14 @@ void MainWindow::createDeviceIfFlash28F_(const QString &label) {
     if (found) {
         ui_->actionDoProgram->setText(tr("Program"));
         ui_->btnProgram->setToolTip(ui_->actionDoProgram->text());
-        device_ = new FlashI28F(this);
-        device_->setSize(size);
-        device_->setVddRd(vdd);
-        device_->setVddWr(vdd);
+        Device *device = new FlashI28F(this);
+        device->setSize(size);
+        device->setVddRd(vdd);
+        device->setVddWr(vdd);
         hexeditor_->setMode(QHexEditor::Mode8Bits);
         ui_->comboBoxProgSize->setEnabled(custom);
         ui_->labelProgSize->setEnabled(custom);
-        return;
+        return device;
     }
     size = 0x80000;
     vdd = 5.0f;
@@ -1411,14 +1492,14 @@ void MainWindow::createDeviceIfFlash28F_(const QString &label) {
     if (found) {
         ui_->actionDoProgram->setText(tr("Program"));
         ui_->btnProgram->setToolTip(ui_->actionDoProgram->text());
-        device_ = new FlashSharpI28F(this);
-        device_->setSize(size);
-        device_->setVddRd(vdd);
-        device_->setVddWr(vdd);
+        Device *device = new FlashSharpI28F(this);
+        device->setSize(size);
+        device->setVddRd(vdd);
+        device->setVddWr(vdd);
         hexeditor_->setMode(QHexEditor::Mode8Bits);
         ui_->comboBoxProgSize->setEnabled(custom);
         ui_->labelProgSize->setEnabled(custom);
-        return;
+        return device;
     }
     size = 0x80000;
     vdd = 5.0f;
@@ -1448,15 +1529,16 @@ void MainWindow::createDeviceIfFlash28F_(const QString &label) {
     if (found) {
         ui_->actionDoProgram->setText(tr("Program"));
         ui_->btnProgram->setToolTip(ui_->actionDoProgram->text());
-        device_ = new FlashI28F16Bit(this);
-        device_->setSize(size);
-        device_->setVddRd(vdd);
-        device_->setVddWr(vdd);
+        Device *device = new FlashI28F16Bit(this);
+        device->setSize(size);
+        device->setVddRd(vdd);
+        device->setVddWr(vdd);
         hexeditor_->setMode(QHexEditor::Mode16Bits);
         ui_->comboBoxProgSize->setEnabled(custom);
         ui_->labelProgSize->setEnabled(custom);
-        return;
+        return device;
     }
+    return nullptr;
 }
 
 void MainWindow::configureProgControls_() {
@@ -1470,6 +1552,7 @@ void MainWindow::configureProgControls_() {
     ui_->spinBoxProgVEE->blockSignals(true);
     ui_->checkBoxProgFast->blockSignals(true);
     ui_->checkBoxProgSkipFF->blockSignals(true);
+    ui_->checkBoxProgDiff->blockSignals(true);
     ui_->comboBoxProgSectorSize->blockSignals(true);
     ui_->comboBoxProgSize->blockSignals(true);
 
@@ -1480,6 +1563,7 @@ void MainWindow::configureProgControls_() {
 
     ui_->checkBoxProgFast->setEnabled(capability.hasFastProg && port);
     ui_->checkBoxProgSkipFF->setEnabled(capability.hasSkipFF && port);
+    ui_->checkBoxProgDiff->setEnabled(capability.hasDiffProg && port);
     ui_->comboBoxProgSectorSize->setEnabled(capability.hasSectorSize && port);
     ui_->labelProgSectorSize->setEnabled(
         ui_->comboBoxProgSectorSize->isEnabled());
@@ -1488,6 +1572,7 @@ void MainWindow::configureProgControls_() {
     ui_->actionDoProgram->setEnabled(ui_->menuProgram->isEnabled());
     ui_->actionProgramAndVerify->setEnabled(capability.hasProgram &&
                                             capability.hasVerify && port);
+    ui_->actionGangProgram->setEnabled(ui_->menuProgram->isEnabled());
     ui_->actionVerify->setEnabled(capability.hasVerify && port);
     ui_->menuErase->setEnabled(capability.hasErase && port);
     ui_->actionDoErase->setEnabled(ui_->menuErase->isEnabled());
@@ -1546,6 +1631,7 @@ void MainWindow::configureProgControls_() {
         ui_->spinBoxProgVEE->setValue(device_->getVee());
         ui_->checkBoxProgFast->setChecked(device_->getFastProg());
         ui_->checkBoxProgSkipFF->setChecked(device_->getSkipFF());
+        ui_->checkBoxProgDiff->setChecked(device_->getDiffProg());
 
         uint16_t sectorSize = device_->getSectorSize();
         int currentIndex = 0;
@@ -1579,29 +1665,106 @@ void MainWindow::configureProgControls_() {
     ui_->spinBoxProgVEE->blockSignals(false);
     ui_->checkBoxProgFast->blockSignals(false);
     ui_->checkBoxProgSkipFF->blockSignals(false);
+    ui_->checkBoxProgDiff->blockSignals(false);
     ui_->comboBoxProgSectorSize->blockSignals(false);
     ui_->comboBoxProgSize->blockSignals(false);
 }
 
-void MainWindow::configureDeviceFromControls_() {
-    device_->setPort(ui_->comboBoxPort->currentText());
+std::function<void(Device *)> MainWindow::deviceConfiguration_(
+    const QString &port) const {
+    uint16_t bufferSize = bufferSizeForPort_(port);
     uint32_t twp = ui_->spinBoxProgTWP->value();
     if (ui_->comboBoxProgTWPUnit->currentIndex() == 1) twp *= 1000;
-    device_->setTwp(twp);
     uint32_t twc = ui_->spinBoxProgTWC->value();
     if (ui_->comboBoxProgTWCUnit->currentIndex() == 1) twc *= 1000;
-    device_->setTwc(twc);
-    device_->setVddRd(ui_->spinBoxProgVDDrd->value());
-    device_->setVddWr(ui_->spinBoxProgVDDwr->value());
-    device_->setVpp(ui_->spinBoxProgVPP->value());
-    device_->setVee(ui_->spinBoxProgVEE->value());
-    device_->setSkipFF(ui_->checkBoxProgSkipFF->isChecked());
-    device_->setFastProg(ui_->checkBoxProgFast->isChecked());
+    float vddRd = ui_->spinBoxProgVDDrd->value();
+    float vddWr = ui_->spinBoxProgVDDwr->value();
+    float vpp = ui_->spinBoxProgVPP->value();
+    float vee = ui_->spinBoxProgVEE->value();
+    bool skipFF = ui_->checkBoxProgSkipFF->isChecked();
+    bool fastProg = ui_->checkBoxProgFast->isChecked();
+    bool diffProg = ui_->checkBoxProgDiff->isChecked();
     uint16_t sectorSize = 0;
     if (ui_->comboBoxProgSectorSize->currentIndex() != 0) {
         sectorSize = ui_->comboBoxProgSectorSize->currentText().toInt();
     }
-    device_->setSectorSize(sectorSize);
+    return [=](Device *device) {
+        device->setPort(port);
+        device->setBufferSize(bufferSize);
+        device->setTwp(twp);
+        device->setTwc(twc);
+        device->setVddRd(vddRd);
+        device->setVddWr(vddWr);
+        device->setVpp(vpp);
+        device->setVee(vee);
+        device->setSkipFF(skipFF);
+        device->setFastProg(fastProg);
+        device->setDiffProg(diffProg);
+        device->setSectorSize(sectorSize);
+    };
+}
+
+QString MainWindow::tunedBufferSizeKey_(const QString &port) const {
+    QString name = port;
+    // the separators would create subgroups
+    name.replace('/', '_').replace('\\', '_');
+    return QString(kSettingProgBufferTuned) + "/" + name;
+}
+
+uint16_t MainWindow::bufferSizeForPort_(const QString &port) const {
+    if (!settings_.prog.bufferAuto || port.isEmpty()) {
+        return settings_.prog.bufferSize;
+    }
+    QSettings configurator;
+    uint16_t value =
+        configurator.value(tunedBufferSizeKey_(port)).toString().toUInt();
+    return value ? value : settings_.prog.bufferSize;
+}
+
+void MainWindow::saveTunedBufferSize_(const TDeviceActionResult &result) {
+    if (!result.autoTune || result.port.isEmpty()) return;
+    if (result.bufferSize == bufferSizeForPort_(result.port)) return;
+    QSettings configurator;
+    configurator.setValue(tunedBufferSizeKey_(result.port),
+                          QString::number(result.bufferSize));
+}
+
+void MainWindow::updateStats_(const TDeviceActionResult &result) {
+    ui_->tableWidgetStats->setRowCount(0);
+    const CommStats &stats = result.stats;
+    for (int code = 0; code < 256; code++) {
+        const TOpCodeStats &op = stats.get(code);
+        if (!op.calls) continue;
+        QStringList values;
+        values << QString::fromLatin1(OpCode::getOpCode(code).descr)
+               << QString::number(op.calls) << QString::number(op.retries)
+               << QString::number(op.errors) << QString::number(op.bytesOut)
+               << QString::number(op.bytesIn)
+               << QString::number(CommStats::percentile(op, 50))
+               << QString::number(CommStats::percentile(op, 99));
+        int row = ui_->tableWidgetStats->rowCount();
+        ui_->tableWidgetStats->insertRow(row);
+        for (int col = 0; col < values.size(); col++) {
+            ui_->tableWidgetStats->setItem(row, col,
+                                           new QTableWidgetItem(values[col]));
+        }
+    }
+    ui_->tableWidgetStats->resizeColumnsToContents();
+}
+
+void MainWindow::saveStatsReport_(const TDeviceActionResult &result) {
+    QJsonObject report =
+        QJsonDocument::fromJson(
+            QByteArray::fromStdString(result.stats.toJson()))
+            .object();
+    report.insert("date", QDateTime::currentDateTime().toString(Qt::ISODate));
+    report.insert("device", result.name);
+    report.insert("port", result.port);
+    report.insert("bufferSize", result.bufferSize);
+    report.insert("success", result.success);
+    QFile file(QDir::homePath() + "/" + QString(kStatsFileName));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append)) return;
+    file.write(QJsonDocument(report).toJson(QJsonDocument::Compact) + "\n");
 }
 
 void MainWindow::showDialogActionProgress_(const QString &msg) {
@@ -1614,6 +1777,27 @@ void MainWindow::showDialogActionProgress_(const QString &msg) {
     progress_->open();
 }
 
+void MainWindow::showActionResultDialog_(bool success, const QString &okMsg,
+                                         const QString &errorMsg) {
+    progress_->hide();
+    if (success) {
+        QMessageBox::information(this, progress_->windowTitle(),
+                                 okMsg.leftJustified(kDialogLabelMinLength));
+    } else {
+        QMessageBox::critical(this, progress_->windowTitle(),
+                              errorMsg.leftJustified(kDialogLabelMinLength));
+    }
+}
+
+QString MainWindow::notBlankMessage_(
+    const TDeviceActionResult &result) const {
+    QString msg = tr("Device is not blank");
+    if (result.dirtyCount) {
+        msg += "\n" + tr("Non-blank cells: %1").arg(result.dirtyCount);
+    }
+    return msg;
+}
+
 bool MainWindow::showDifferentSizeDialog_(const QByteArray &data) {
     if (data.size() != device_->getSize()) {
         if (QMessageBox::question(
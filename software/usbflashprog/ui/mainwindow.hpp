@@ -20,8 +20,10 @@
 
 #include <QMainWindow>
 #include <QTimer>
+#include <QThread>
 #include <QCloseEvent>
 #include <QProgressDialog>
+#include <functional>
 
 #include "ui/qhexeditor.hpp"
 #include "backend/runner.hpp"
@@ -38,6 +40,35 @@ QT_END_NAMESPACE
 
 // ---------------------------------------------------------------------------
 
+/**
+ * @ingroup Software
+ * @brief Stores the state of the device at the end of an action.
+ * @details Read on the worker thread, so the GUI thread does not access
+ *   the device while (or after) it runs there.
+ */
+typedef struct TDeviceActionResult {
+    /** @brief Result of the action. */
+    bool success;
+    /** @brief Device size, in bytes. */
+    uint32_t size;
+    /** @brief Number of non-blank cells found by the action. */
+    uint32_t dirtyCount;
+    /** @brief Serial port path. */
+    QString port;
+    /** @brief Buffer size (tuned by the action, if auto-tune is enabled). */
+    uint16_t bufferSize;
+    /** @brief Auto-tune of the buffer size enabled. */
+    bool autoTune;
+    /** @brief Device algorithm name. */
+    QString name;
+    /** @brief Communication statistics of the action. */
+    CommStats stats;
+    /** @brief Constructor. */
+    TDeviceActionResult();
+} TDeviceActionResult;
+
+// ---------------------------------------------------------------------------
+
 /**
  * @ingroup Software
  * @brief Main Window GUI Class
@@ -78,6 +109,7 @@ class MainWindow : public QMainWindow {
     void on_actionRead_triggered(bool checked = false);
     void on_actionDoProgram_triggered(bool checked = false);
     void on_actionProgramAndVerify_triggered(bool checked = false);
+    void on_actionGangProgram_triggered(bool checked = false);
     void on_actionVerify_triggered(bool checked = false);
     void on_actionDoErase_triggered(bool checked = false);
     void on_actionEraseAndBlankCheck_triggered(bool checked = false);
@@ -101,6 +133,7 @@ class MainWindow : public QMainWindow {
     void on_spinBoxProgVEE_valueChanged(double value);
     void on_checkBoxProgSkipFF_toggled(bool checked = false);
     void on_checkBoxProgFast_toggled(bool checked = false);
+    void on_checkBoxProgDiff_toggled(bool checked = false);
     void on_comboBoxProgSectorSize_currentIndexChanged(int index);
     void on_comboBoxProgSize_currentIndexChanged(int index);
     /* editor */
@@ -176,6 +209,8 @@ class MainWindow : public QMainWindow {
     QTimer refreshTimer_;
     /* @brief Runner object (Diag). */
     Runner runner_;
+    /* @brief Worker thread where the device operations run (Prog). */
+    QThread deviceThread_;
     /* @brief Device pointer (Prog). */
     Device *device_;
     /* @brief If true, no shows warning about action over device (Prog). */
@@ -188,40 +223,122 @@ class MainWindow : public QMainWindow {
     void saveSettings_();
     /* @brief Creates device (Prog). */
     void createDevice_();
+    /* @brief Destroys the device, if any (Prog). */
+    void destroyDevice_();
+    /*
+     * @brief Changes the device on the worker thread, and waits (Prog).
+     * @param setup Changes to apply (called on the worker thread).
+     */
+    void setupDevice_(std::function<void(Device *)> setup);
+    /*
+     * @brief Runs an operation of the device on the worker thread (Prog).
+     * @details The device is configured from the ui values and its
+     *   statistics are cleared on the worker thread, before the operation.
+     * @param action Operation to run (called on the worker thread).
+     * @param finished Called with the result of the operation
+     *   (on the GUI thread). Optional.
+     */
+    void runDeviceAction_(
+        std::function<bool(Device *)> action,
+        std::function<void(const TDeviceActionResult &)> finished = nullptr);
+    /*
+     * @brief Creates a device of the selected type (Prog).
+     * @param label The selected device text.
+     * @return Pointer to the new device.
+     */
+    Device *newDevice_(const QString &label);
     /*
      * @brief Creates device if it's a SRAM (Prog).
      * @param label The triggered action text.
+     * @return Pointer to the new device, or nullptr if it's not.
      */
-    void createDeviceIfSRAM_(const QString &label);
+    Device *createDeviceIfSRAM_(const QString &label);
     /*
      * @brief Creates device if it's an EPROM (Prog).
      * @param label The triggered action text.
+     * @return Pointer to the new device, or nullptr if it's not.
      */
-    void createDeviceIfEPROM_(const QString &label);
+    Device *createDeviceIfEPROM_(const QString &label);
     /*
      * @brief Creates device if it's an Erasable EPROM (Prog).
      * @param label The triggered action text.
+     * @return Pointer to the new device, or nullptr if it's not.
      */
-    void createDeviceIfErasableEPROM_(const QString &label);
+    Device *createDeviceIfErasableEPROM_(const QString &label);
     /*
      * @brief Creates device if it's an EEPROM (Prog).
      * @param label The triggered action text.
+     * @return Pointer to the new device, or nullptr if it's not.
      */
-    void createDeviceIfEEPROM_(const QString &label);
+    Device *createDeviceIfEEPROM_(const QString &label);
     /*
      * @brief Creates device if it's an Flash 28F (Prog).
      * @param label The triggered action text.
+     * @return Pointer to the new device, or nullptr if it's not.
      */
-    void createDeviceIfFlash28F_(const QString &label);
+    Device *createDeviceIfFlash28F_(const QString &label);
     /* @brief Enables/Disables the controls (Prog). */
     void configureProgControls_();
-    /* @brief Configures the device based in the ui values (Prog). */
-    void configureDeviceFromControls_();
+    /*
+     * @brief Returns the configuration of a device based in the ui
+     *   values (Prog).
+     * @details The values are read when called, so the configuration
+     *   can be applied later, on the thread of the device.
+     * @param port Serial port path.
+     * @return Function that configures a device.
+     */
+    std::function<void(Device *)> deviceConfiguration_(
+        const QString &port) const;
+    /*
+     * @brief Returns the settings key of the tuned buffer size (Prog).
+     * @param port Serial port path.
+     * @return Settings key.
+     */
+    QString tunedBufferSizeKey_(const QString &port) const;
+    /*
+     * @brief Returns the buffer size to use with a port (Prog).
+     * @param port Serial port path.
+     * @return The tuned size for the port (if auto-tune is enabled and
+     *   the port was tuned), or the configured buffer size.
+     */
+    uint16_t bufferSizeForPort_(const QString &port) const;
+    /*
+     * @brief Saves the buffer size tuned by the last operation (Prog).
+     * @param result State of the device at the end of the operation.
+     */
+    void saveTunedBufferSize_(const TDeviceActionResult &result);
+    /*
+     * @brief Shows the communication statistics of the last operation.
+     * @param result State of the device at the end of the operation.
+     */
+    void updateStats_(const TDeviceActionResult &result);
+    /*
+     * @brief Appends the communication statistics of the last operation
+     *   to the report file.
+     * @param result State of the device at the end of the operation.
+     */
+    void saveStatsReport_(const TDeviceActionResult &result);
     /*
      * @brief Shows the progress dialog (Prog).
      * @param msg Text to display.
      */
     void showDialogActionProgress_(const QString &msg);
+    /*
+     * @brief Hides the progress dialog and shows the result of an
+     *   action (Prog).
+     * @param success True if the action was successful, false otherwise.
+     * @param okMsg Text to display on success.
+     * @param errorMsg Text to display on failure.
+     */
+    void showActionResultDialog_(bool success, const QString &okMsg,
+                                 const QString &errorMsg);
+    /*
+     * @brief Returns the message about a device that is not blank, with
+     *   the number of non-blank cells, if known (Prog).
+     * @param result State of the device at the end of the operation.
+     * @return The message.
+     */
+    QString notBlankMessage_(const TDeviceActionResult &result) const;
     /*
      * @brief Shows the different size dialog (Prog).
      * @param data Data to compare with device (size).
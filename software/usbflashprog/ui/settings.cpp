@@ -37,6 +37,10 @@ SettingsDialog::SettingsDialog(QWidget *parent, bool enableBtnCal)
         logFileInfo.arg("\n" + QDir::toNativeSeparators(QDir::homePath() + "/" +
                                                         QString(kLogFileName)));
     ui_->labelLogFileInfo->setText(logFileInfo);
+    QString statsFileInfo = ui_->checkBoxStatsReport->toolTip();
+    statsFileInfo = statsFileInfo.arg(QDir::toNativeSeparators(
+        QDir::homePath() + "/" + QString(kStatsFileName)));
+    ui_->checkBoxStatsReport->setToolTip(statsFileInfo);
     ui_->pushButtonVddInitCal->setEnabled(enableBtnCal);
     ui_->pushButtonVppInitCal->setEnabled(enableBtnCal);
     size_t count = sizeof(kAppSupportedLanguages) / sizeof(TLanguageSettings);
@@ -85,6 +89,8 @@ TApplicationSettings SettingsDialog::loadSettings_() {
         // Default
         app.prog.bufferSize = kDefaultDeviceBufferSize;
     }
+    app.prog.bufferAuto =
+        settings.value(kSettingProgBufferAuto).toString().toInt() != 0;
 
     if (app.logLevel >= 0 && app.logLevel <= 5) {
         ui_->comboBoxLogLevel->setCurrentIndex(app.logLevel);
@@ -97,6 +103,8 @@ TApplicationSettings SettingsDialog::loadSettings_() {
         ui_->labelLogFileInfo->setVisible(false);
     }
 
+    ui_->checkBoxStatsReport->setChecked(app.statsReport);
+
     ui_->comboBoxLanguage->setCurrentIndex(0);
     size_t count = sizeof(kAppSupportedLanguages) / sizeof(TLanguageSettings);
     for (size_t i = 0; i < count; i++) {
@@ -110,6 +118,7 @@ TApplicationSettings SettingsDialog::loadSettings_() {
     int index = static_cast<int>(std::log2(app.prog.bufferSize));
     ui_->comboBoxBufferSize->setCurrentIndex(index);
     ui_->labelBufferSizeInfo->setVisible(index < 4);
+    ui_->checkBoxBufferAuto->setChecked(app.prog.bufferAuto);
 
     return app;
 }
@@ -122,13 +131,25 @@ TApplicationSettings SettingsDialog::saveSettings_() {
     TLanguageSettings lang =
         kAppSupportedLanguages[ui_->comboBoxLanguage->currentIndex()];
     app.language = lang.code;
+    app.statsReport = ui_->checkBoxStatsReport->isChecked();
     app.prog.bufferSize = static_cast<uint16_t>(
         std::pow(2, ui_->comboBoxBufferSize->currentIndex()));
+    app.prog.bufferAuto = ui_->checkBoxBufferAuto->isChecked();
+
+    // a new buffer size restarts the tuning
+    if (settings.value(kSettingProgBufferSize).toString().toUInt() !=
+        app.prog.bufferSize) {
+        settings.remove(kSettingProgBufferTuned);
+    }
 
     settings.setValue(kSettingGeneralLogLevel, QString::number(app.logLevel));
     settings.setValue(kSettingGeneralLanguage, app.language);
+    settings.setValue(kSettingGeneralStatsReport,
+                      QString::number(app.statsReport ? 1 : 0));
     settings.setValue(kSettingProgBufferSize,
                       QString::number(app.prog.bufferSize));
+    settings.setValue(kSettingProgBufferAuto,
+                      QString::number(app.prog.bufferAuto ? 1 : 0));
 
     return app;
 }